@@ -4177,6 +4177,91 @@ bool CEncoder::AvoidRetryOnSmallSpill() const
         context->m_retryManager.IsFirstTry();
 }
 
+// Quote str as a JSON string literal
+static std::string EscapeJSONString(const std::string& str)
+{
+    std::string escaped = "\"";
+    for (char c : str)
+    {
+        switch (c)
+        {
+        case '"':  escaped += "\\\""; break;
+        case '\\': escaped += "\\\\"; break;
+        case '\b': escaped += "\\b"; break;
+        case '\f': escaped += "\\f"; break;
+        case '\n': escaped += "\\n"; break;
+        case '\r': escaped += "\\r"; break;
+        case '\t': escaped += "\\t"; break;
+        default:
+            if ((unsigned char)c < 0x20)
+            {
+                char buf[8];
+                snprintf(buf, sizeof(buf), "\\u%04x", (unsigned)(unsigned char)c);
+                escaped += buf;
+            }
+            else
+            {
+                escaped += c;
+            }
+            break;
+        }
+    }
+    escaped += "\"";
+    return escaped;
+}
+
+static unsigned BBBankConflicts(const FINALIZER_INFO* jitInfo, unsigned bb)
+{
+    return jitInfo->BBNumBankConflicts ? jitInfo->BBNumBankConflicts[bb] : 0;
+}
+
+// Write the static performance estimate vISA computed for this kernel as a
+// JSON side file next to the other shader dumps. One file is produced per
+// kernel, SIMD width and retry so that generated code quality can be
+// compared across driver versions without running on hardware.
+static void DumpStaticPerfStats(CShader* program, const FINALIZER_INFO* jitInfo)
+{
+    std::string fileName = IGC::Debug::GetDumpName(program, "perf.json");
+    FILE* fp = fopen(fileName.c_str(), "w");
+    if (fp == NULL)
+    {
+        return;
+    }
+
+    unsigned staticCycle = 0, sendStallCycle = 0, bankConflicts = 0;
+    for (unsigned i = 0; i < jitInfo->BBNum; i++)
+    {
+        staticCycle += jitInfo->BBInfo[i].staticCycle;
+        sendStallCycle += jitInfo->BBInfo[i].sendStallCycle;
+        bankConflicts += BBBankConflicts(jitInfo, i);
+    }
+
+    fprintf(fp, "{\n");
+    fprintf(fp, "  \"kernel\": %s,\n", EscapeJSONString(program->entry->getName().str()).c_str());
+    fprintf(fp, "  \"simd\": %u,\n", (unsigned)numLanes(program->m_dispatchSize));
+    fprintf(fp, "  \"instructions\": %d,\n", jitInfo->numAsmCount);
+    fprintf(fp, "  \"grf_used\": %d,\n", jitInfo->numGRFUsed);
+    fprintf(fp, "  \"spill\": %s,\n", jitInfo->isSpill ? "true" : "false");
+    fprintf(fp, "  \"spill_mem_used\": %u,\n", jitInfo->isSpill ? jitInfo->spillMemUsed : 0);
+    fprintf(fp, "  \"grf_spill_fill\": %u,\n", jitInfo->numGRFSpillFill);
+    fprintf(fp, "  \"flag_spill_store\": %u,\n", jitInfo->numFlagSpillStore);
+    fprintf(fp, "  \"flag_spill_load\": %u,\n", jitInfo->numFlagSpillLoad);
+    fprintf(fp, "  \"static_cycles\": %u,\n", staticCycle);
+    fprintf(fp, "  \"send_stall_cycles\": %u,\n", sendStallCycle);
+    fprintf(fp, "  \"bank_conflicts\": %u,\n", bankConflicts);
+    fprintf(fp, "  \"blocks\": [");
+    for (unsigned i = 0; i < jitInfo->BBNum; i++)
+    {
+        const CM_BB_INFO& bb = jitInfo->BBInfo[i];
+        fprintf(fp, "%s\n    {\"id\": %d, \"loop_depth\": %u, \"static_cycles\": %u, "
+            "\"send_stall_cycles\": %u, \"bank_conflicts\": %u}",
+            i == 0 ? "" : ",", bb.id, (unsigned)bb.loopNestLevel, bb.staticCycle,
+            bb.sendStallCycle, BBBankConflicts(jitInfo, i));
+    }
+    fprintf(fp, "%s]\n}\n", jitInfo->BBNum == 0 ? "" : "\n  ");
+    fclose(fp);
+}
+
 void CEncoder::Compile()
 {
     COMPILER_TIME_START(m_program->GetContext(), TIME_CG_vISAEmitPass);
@@ -4295,6 +4380,11 @@ void CEncoder::Compile()
         m_program->m_staticCycle = staticCycle;
     }
 
+    if (IGC_IS_FLAG_ENABLED(DumpStaticPerfStats))
+    {
+        DumpStaticPerfStats(m_program, jitInfo);
+    }
+
     if (jitInfo->isSpill && AvoidRetryOnSmallSpill())
     {
         context->m_retryManager.Disable();
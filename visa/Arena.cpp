@@ -36,44 +36,270 @@ int maxArenaLength = 0;
 int currentMallocSize = 0;
 #endif
 using namespace vISA;
+
+// Set once the calling thread's cache has been destroyed; arena managers that
+// outlive it (e.g., statics) then free their arenas directly.
+static thread_local bool blockCacheDestroyed = false;
+
+void
+ArenaStats::print(std::ostream& os) const
+{
+	os << "allocs: " << numAllocs
+	   << ", allocated: " << bytesAllocated << " (peak " << peakBytesAllocated << ")"
+	   << ", reserved: " << bytesReserved << " (peak " << peakBytesReserved << ")"
+	   << ", arenas: " << numArenas << " (" << numArenasRecycled << " recycled)"
+	   << ", resets: " << numResets << "\n";
+}
+
 void*
-ArenaHeader::AllocSpace (size_t size)
+ArenaHeader::AllocSpace (size_t size, size_t align, size_t& padded)
 {
 	assert( WordAlign (size_t (_nextByte)) == size_t (_nextByte) );
-	void * allocSpace = _nextByte;
 
-	if (size)
+	if (size == 0)
 	{
-		size = WordAlign (size);
+		return 0;
+	}
+
+	unsigned char* allocSpace = (unsigned char*) AlignUp (size_t (_nextByte), align);
+	size = WordAlign (size);
+
+	// compare sizes rather than pointers so a large padding cannot overflow
+	if (allocSpace > _lastByte || size > size_t (_lastByte - allocSpace))
+	{
+		return 0;
+	}
 
-		if (_nextByte + size <= _lastByte) {
-			_nextByte += size;
+	padded = (allocSpace + size) - _nextByte;
+	_nextByte = allocSpace + size;
+	return allocSpace;
+}
+
+ArenaBlockCache::ArenaBlockCache() : cachedBytes(0)
+{
+	for (unsigned i = 0; i <= maxSizeLog2 - minSizeLog2; i++)
+	{
+		freeLists[i] = 0;
+	}
+}
+
+ArenaBlockCache::~ArenaBlockCache()
+{
+	for (unsigned i = 0; i <= maxSizeLog2 - minSizeLog2; i++)
+	{
+		while (freeLists[i])
+		{
+			FreeBlock* block = freeLists[i];
+			freeLists[i] = block->next;
+			delete [] (unsigned char*) block;
 		}
+	}
+	cachedBytes = 0;
+	blockCacheDestroyed = true;
+}
+
+ArenaBlockCache*
+ArenaBlockCache::get()
+{
+	if (blockCacheDestroyed)
+	{
+		return NULL;
+	}
+	static thread_local ArenaBlockCache cache;
+	return &cache;
+}
+
+size_t
+ArenaBlockCache::GetSizeClass (size_t dataSize)
+{
+	if (dataSize > maxCachedSize)
+	{
+		// not cached, only keep it word aligned
+		return ArenaHeader::WordAlign (dataSize);
+	}
+	size_t sizeClass = minCachedSize;
+	while (sizeClass < dataSize)
+	{
+		sizeClass <<= 1;
+	}
+	return sizeClass;
+}
+
+unsigned
+ArenaBlockCache::GetBucket (size_t dataSize)
+{
+	assert(ArenaHeader::IsPow2 (dataSize) && dataSize >= minCachedSize && dataSize <= maxCachedSize);
+	unsigned bucket = 0;
+	while ((minCachedSize << bucket) < dataSize)
+	{
+		bucket++;
+	}
+	return bucket;
+}
+
+unsigned char*
+ArenaBlockCache::Acquire (size_t dataSize)
+{
+	if (dataSize < minCachedSize || dataSize > maxCachedSize || !ArenaHeader::IsPow2 (dataSize))
+	{
+		return 0;
+	}
+	unsigned bucket = GetBucket (dataSize);
+	FreeBlock* block = freeLists[bucket];
+	if (block)
+	{
+		freeLists[bucket] = block->next;
+		cachedBytes -= ArenaHeader::GetArenaSize (dataSize);
+	}
+	return (unsigned char*) block;
+}
+
+bool
+ArenaBlockCache::Release (ArenaHeader* arena)
+{
+	size_t dataSize = arena->size;
+	size_t blockSize = ArenaHeader::GetArenaSize (dataSize);
+	if (dataSize < minCachedSize || dataSize > maxCachedSize || !ArenaHeader::IsPow2 (dataSize) ||
+		cachedBytes + blockSize > maxCachedBytes)
+	{
+		return false;
+	}
+	unsigned bucket = GetBucket (dataSize);
+	arena->~ArenaHeader();
+	FreeBlock* block = (FreeBlock*) arena;
+	block->next = freeLists[bucket];
+	freeLists[bucket] = block;
+	cachedBytes += blockSize;
+	return true;
+}
 
-		else {
-			allocSpace = 0;
+ArenaHeader*
+ArenaManager::GetArena (size_t size, size_t align)
+{
+	// worst case padding needed to satisfy the alignment
+	size_t needed = size + (align > ArenaHeader::defaultAlign ? align - 1 : 0);
+	ArenaHeader** prev = &_spareArenas;
+	for (ArenaHeader* spare = _spareArenas; spare != NULL; spare = spare->_nextArena)
+	{
+		if (spare->GetFreeSpace () >= needed)
+		{
+			*prev = spare->_nextArena;
+			spare->_nextArena = _arenas;
+			_arenas = spare;
+			return _arenas;
 		}
+		prev = &spare->_nextArena;
+	}
+	return CreateArena (size, align);
+}
+
+ArenaHeader*
+ArenaManager::CreateArena (size_t size, size_t align)
+{
+	size_t needed = size + (align > ArenaHeader::defaultAlign ? align - 1 : 0);
+	size_t arenaDataSize = (needed > _defaultArenaSize) ? needed : _defaultArenaSize;
+	arenaDataSize = ArenaBlockCache::GetSizeClass (arenaDataSize);
+
+	ArenaBlockCache* cache = ArenaBlockCache::get();
+	unsigned char* arena = cache ? cache->Acquire (arenaDataSize) : NULL;
+	if (arena != NULL)
+	{
+		_stats.numArenasRecycled++;
 	}
 	else
 	{
-		allocSpace = 0;
+		arena = new unsigned char[ArenaHeader::GetArenaSize (arenaDataSize)];
+#ifdef COLLECT_ALLOCATION_STATS
+		numMallocCalls++;
+		totalMallocSize += arenaDataSize;
+		currentMallocSize += arenaDataSize;
+#endif
 	}
 
-	return allocSpace;
+	ArenaHeader* newArena = new (arena)ArenaHeader(arenaDataSize, _arenas);
+	// Add new arena to the head of queue
+	newArena->_nextArena = _arenas;
+	_arenas = newArena;
+
+	_stats.numArenas++;
+	_stats.bytesReserved += arenaDataSize;
+	if (_stats.bytesReserved > _stats.peakBytesReserved)
+	{
+		_stats.peakBytesReserved = _stats.bytesReserved;
+	}
+
+	//std::cout << "Create new Buffer: " << (arenaDataSize / 1024) << " KB" << std::endl;
+
+#ifdef COLLECT_ALLOCATION_STATS
+	int numArenas = 0;
+	for( ArenaHeader *tmpArena = _arenas; tmpArena != NULL; tmpArena = tmpArena->_nextArena )
+	{
+		numArenas++;
+	}
+	if( numArenas > maxArenaLength )
+	{
+		maxArenaLength = numArenas;
+	}
+	if( numArenas == 1 )
+	{
+		numMemManagers++;
+	}
+#endif
+
+	return _arenas;
 }
 
 void
-ArenaManager::FreeArenas()
+ArenaManager::Reset()
 {
+	// move every arena to the spare list, largest first so that the next
+	// allocations are served from the biggest block
 	while (_arenas)
 	{
+		ArenaHeader* arena = _arenas;
+		_arenas = _arenas->_nextArena;
+		arena->Rewind();
+
+		ArenaHeader** pos = &_spareArenas;
+		while (*pos != NULL && (*pos)->size >= arena->size)
+		{
+			pos = &(*pos)->_nextArena;
+		}
+		arena->_nextArena = *pos;
+		*pos = arena;
+	}
+
+	_arenas = _spareArenas;
+	_spareArenas = _arenas->_nextArena;
+	_arenas->_nextArena = NULL;
+
+	_stats.bytesAllocated = 0;
+	_stats.numResets++;
+}
+
+void
+ArenaManager::FreeArenas()
+{
+	ArenaBlockCache* cache = ArenaBlockCache::get();
+	ArenaHeader* lists[2] = { _arenas, _spareArenas };
+	for (int i = 0; i < 2; i++)
+	{
+		ArenaHeader* arena = lists[i];
+		while (arena)
+		{
+			ArenaHeader* next = arena->_nextArena;
+			_stats.bytesReserved -= arena->size;
+			if (cache == NULL || !cache->Release (arena))
+			{
 #ifdef COLLECT_ALLOCATION_STATS
-        currentMallocSize -= _arenas->size;
+				currentMallocSize -= arena->size;
 #endif
-		unsigned char* killed = (unsigned char*) _arenas;
-		_arenas = _arenas->_nextArena;
-		delete [] killed;
+				delete [] (unsigned char*) arena;
+			}
+			arena = next;
+		}
 	}
 
 	_arenas = 0;
+	_spareArenas = 0;
 }
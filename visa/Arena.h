@@ -26,7 +26,13 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 // A memory arena class implementation.
 
-// NOTE: Object requiring dword alignment is NOT supported.
+// Allocations are dword aligned by default; callers may request any larger
+// power-of-two alignment through AllocDataSpace(size, align).
+//
+// Arena blocks are sized in power-of-two classes and, when an ArenaManager
+// is destroyed, are handed back to a per-thread cache instead of being freed,
+// so that the next Mem_Manager created on the same thread (for the next
+// kernel, the next LivenessAnalysis, ...) reuses them without calling malloc.
 
 #ifndef _ARENA_H_
 #define _ARENA_H_
@@ -52,28 +58,66 @@ extern int currentMallocSize;
 namespace vISA
 {
     class Mem_Manager;
+
+    // Per-manager allocation statistics. The peak values are high-water marks
+    // that survive ArenaManager::Reset().
+    struct ArenaStats
+    {
+        size_t numAllocs;           // number of non-empty allocation requests
+        size_t bytesAllocated;      // bytes handed out since the last reset (incl. padding)
+        size_t peakBytesAllocated;  // high-water mark of bytesAllocated
+        size_t bytesReserved;       // bytes currently held in arenas
+        size_t peakBytesReserved;   // high-water mark of bytesReserved
+        size_t numArenas;           // arenas obtained by this manager
+        size_t numArenasRecycled;   // ... of which came from the thread cache
+        size_t numResets;
+
+        ArenaStats() : numAllocs(0), bytesAllocated(0), peakBytesAllocated(0),
+            bytesReserved(0), peakBytesReserved(0), numArenas(0),
+            numArenasRecycled(0), numResets(0) {}
+
+        void print(std::ostream& os) const;
+    };
+
     class ArenaHeader
     {
         friend class ArenaManager;
+        friend class ArenaBlockCache;
 
     public:
 
+        // Default alignment of arena allocations.
+        static const size_t defaultAlign = 4;
+        // Alignment of the first data byte of every arena.
+        static const size_t dataAlign = 16;
+
         // Functions
 
+        static bool IsPow2(size_t val)
+        {
+            return val != 0 && (val & (val - 1)) == 0;
+        }
+
+        static size_t AlignUp(size_t addr, size_t align)
+        {
+            assert(IsPow2(align));
+            return (addr + align - 1) & ~(align - 1);
+        }
+
         static size_t WordAlign(size_t addr)
         {
-            return (addr + 0x3) & ~0x3;
+            return AlignUp(addr, defaultAlign);
         }
 
         static size_t GetArenaSize(size_t dataSize)
         {
-            return WordAlign(sizeof (ArenaHeader)) + dataSize;
+            return AlignUp(sizeof (ArenaHeader), dataAlign) + dataSize;
         }
 
         unsigned char* GetArenaData() const
         {
             assert(WordAlign(size_t(this)) == size_t(this));
-            return (unsigned char*)(WordAlign(size_t(this) + sizeof(ArenaHeader)));
+            return (unsigned char*)(this) + AlignUp(sizeof(ArenaHeader), dataAlign);
         }
 
         void* operator new (size_t, unsigned char* memory)
@@ -101,7 +145,20 @@ namespace vISA
             _nextArena = 0;
         }
 
-        void* AllocSpace(size_t size);
+        // Returns NULL if the request does not fit in this arena. Otherwise
+        // padded is set to the number of bytes consumed, including padding.
+        void* AllocSpace(size_t size, size_t align, size_t& padded);
+
+        // Make the whole arena available again.
+        void Rewind()
+        {
+            _nextByte = GetArenaData();
+        }
+
+        size_t GetFreeSpace() const
+        {
+            return _lastByte - _nextByte;
+        }
 
         // Data
 
@@ -111,6 +168,54 @@ namespace vISA
         size_t size;
     };
 
+    // Per-thread cache of arena blocks, bucketed by power-of-two data size.
+    // Blocks larger than maxCachedSize are returned to the system right away,
+    // and the cache never holds more than maxCachedBytes in total.
+    class ArenaBlockCache
+    {
+    public:
+
+        static const unsigned minSizeLog2 = 10;  // 1KB
+        static const unsigned maxSizeLog2 = 22;  // 4MB
+        static const size_t   minCachedSize = (size_t)1 << minSizeLog2;
+        static const size_t   maxCachedSize = (size_t)1 << maxSizeLog2;
+        static const size_t   maxCachedBytes = (size_t)32 << 20;
+
+        // Cache for the calling thread, NULL once the thread is tearing down.
+        static ArenaBlockCache* get();
+
+        // Round a requested arena data size up to its size class.
+        static size_t GetSizeClass(size_t dataSize);
+
+        // Returns a block whose data size is exactly dataSize (which must be
+        // a size class) or NULL if none is cached.
+        unsigned char* Acquire(size_t dataSize);
+
+        // Take ownership of an arena. Returns false if the cache is full or
+        // the arena is not cacheable, in which case the caller frees it.
+        bool Release(ArenaHeader* arena);
+
+        size_t GetCachedBytes() const { return cachedBytes; }
+
+        ~ArenaBlockCache();
+
+    private:
+
+        ArenaBlockCache();
+        ArenaBlockCache(const ArenaBlockCache&);
+        ArenaBlockCache& operator=(const ArenaBlockCache&);
+
+        static unsigned GetBucket(size_t dataSize);
+
+        struct FreeBlock
+        {
+            FreeBlock* next;
+        };
+
+        FreeBlock* freeLists[maxSizeLog2 - minSizeLog2 + 1];
+        size_t     cachedBytes;
+    };
+
     class ArenaManager
     {
         friend class Mem_Manager;
@@ -121,9 +226,10 @@ namespace vISA
 
         ArenaManager(size_t defaultArenaSize) :
             _arenas(0),
+            _spareArenas(0),
             _defaultArenaSize(defaultArenaSize)
         {
-            CreateArena(_defaultArenaSize);
+            CreateArena(_defaultArenaSize, ArenaHeader::defaultAlign);
         }
 
         ~ArenaManager()
@@ -131,8 +237,9 @@ namespace vISA
             FreeArenas();
         }
 
-        void* AllocDataSpace(size_t size)
+        void* AllocDataSpace(size_t size, size_t align = ArenaHeader::defaultAlign)
         {
+            assert(ArenaHeader::IsPow2(align));
             // Do separate memory allocations of debugMemAlloc is set, to allow
             // valgrind/drmemory to find more buffer over-reads/writes
 #if !defined(NDEBUG) && defined(vISA_DEBUG_MEM_ALLOC)
@@ -142,15 +249,23 @@ namespace vISA
 
             if (size)
             {
-                space = _arenas->AllocSpace(size);
+                size_t padded = 0;
+                space = _arenas->AllocSpace(size, align, padded);
 
                 if (space == 0)
                 {
-                    CreateArena(size);
-                    space = _arenas->AllocSpace(size);
+                    GetArena(size, align);
+                    space = _arenas->AllocSpace(size, align, padded);
                 }
 
                 assert(space);
+
+                _stats.numAllocs++;
+                _stats.bytesAllocated += padded;
+                if (_stats.bytesAllocated > _stats.peakBytesAllocated)
+                {
+                    _stats.peakBytesAllocated = _stats.bytesAllocated;
+                }
             }
 
 #ifdef COLLECT_ALLOCATION_STATS
@@ -161,51 +276,26 @@ namespace vISA
             return space;
         }
 
-        ArenaHeader* CreateArena(size_t size)
-        {
-            size_t arenaDataSize = (size > _defaultArenaSize) ? size : _defaultArenaSize;
-            arenaDataSize = ArenaHeader::WordAlign(arenaDataSize);
-            unsigned char * arena =
-                new unsigned char[ArenaHeader::GetArenaSize(arenaDataSize)];
-
-            ArenaHeader* newArena = new (arena)ArenaHeader(arenaDataSize, _arenas);
-            // Add new arena to the head of queue
-            if (_arenas != NULL)
-            {
-                newArena->_nextArena = _arenas;
-            }
-
-            //std::cout << "Create new Buffer: " << (arenaDataSize / 1024) << " KB" << std::endl;
-            _arenas = newArena;
+        // Make an arena with room for size bytes at the given alignment the
+        // current one, preferring a rewound arena left over from Reset().
+        ArenaHeader* GetArena(size_t size, size_t align);
 
-#ifdef COLLECT_ALLOCATION_STATS
-            numMallocCalls++;
-            totalMallocSize += arenaDataSize;
-            currentMallocSize += arenaDataSize;
-            int numArenas = 0;
-            for( ArenaHeader *tmpArena = _arenas; tmpArena != NULL; tmpArena = tmpArena->_nextArena )
-            {
-                numArenas++;
-            }
-            if( numArenas > maxArenaLength )
-            {
-                maxArenaLength = numArenas;
-            }
-            if( numArenas == 1 )
-            {
-                numMemManagers++;
-            }
-#endif
+        ArenaHeader* CreateArena(size_t size, size_t align);
 
-            return _arenas;
-        }
+        // Rewind all arenas so their memory can be handed out again. Nothing
+        // is returned to the system.
+        void Reset();
 
         void FreeArenas();
 
+        const ArenaStats& GetStats() const { return _stats; }
+
         // Data
 
-        ArenaHeader * _arenas;
+        ArenaHeader * _arenas;      // arenas in use, head is the current one
+        ArenaHeader * _spareArenas; // rewound arenas waiting for reuse
         const size_t  _defaultArenaSize;
+        ArenaStats    _stats;
     };
 }
 #endif
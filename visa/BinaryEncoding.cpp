@@ -32,14 +32,11 @@ using namespace vISA;
 
 // Initlaize the platform dependent bit positions to some illegal value
 // They will be set to the correct value by the Init() function
-// Technically these should be TLS, but I'm counting on the fact that
-// these values will be fixed for a given platform, and an application
-// should never invoke the jitter twice with different platform strings.
+// These are shared by all threads: the values are the same for every BDW+
+// platform, and InitPlatform() writes them exactly once before any encoder
+// reads them.
 // Initlaize the platform dependent bit positions to some illegal value
-// They will be set to the correct value by the Init() function
-// Technically these should be TLS, but I'm counting on the fact that
-// these values will be fixed for a given platform, and an application
-// should never invoke the jitter twice with different platform strings.
+// They will be set to the correct value by the InitPlatform() function
 unsigned long bitsFlagSubRegNum[] = {128, 128};
 unsigned long bitsNibCtrl[] = {128, 128};
 unsigned long bitsMrfRegNumHWord[] = {128, 128};
@@ -2846,19 +2843,6 @@ inline BinaryEncoding::Status BinaryEncoding::ProduceBinaryInstructions()
     //define offsetVector to record forward jumps/calls
     std::vector<ForwardJmpOffset> offsetVector;
 
-    if (doCompaction())
-    {
-        for ( uint8_t i=0; i<(int)COMPACT_TABLE_SIZE; i++ )
-        {
-            BDWCompactControlTable.AddIndex(IVBCompactControlTable[i], i);
-            BDWCompactSourceTable.AddIndex(IVBCompactSourceTable[i], i);
-            BDWCompactSubRegTable.AddIndex(IVBCompactSubRegTable[i], i);
-            BDWCompactSubRegTable.AddIndex1(IVBCompactSubRegTable[i] & 0x1F, i);
-            BDWCompactSubRegTable.AddIndex2(IVBCompactSubRegTable[i] & 0x3FF, i);
-            BDWCompactDataTypeTableStr.AddIndex(BDWCompactDataTypeTable[i], i);
-        }
-    }
-
      /**
      * Traverse the flow graph basic block
      */
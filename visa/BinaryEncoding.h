@@ -758,34 +758,37 @@ namespace vISA
         {
             BinaryEncodingBase::InitPlatform();
 
-            // BDW+ encoding
-            SET_BIT_RANGE(bitsFlagRegNum, 33, 33);
-            SET_BIT_RANGE(bitsFlagSubRegNum, 32, 32);
-            SET_BIT_RANGE(bitsNibCtrl, 11, 11);
-            SET_BIT_RANGE(bitsMrfRegNumHWord, 76, 69);   // MRF is not used
-            SET_BIT_RANGE(bits3SrcFlagSubRegNum, 32, 32);
-            SET_BIT_RANGE(bits3SrcFlagRegNum, 33, 33);
-            SET_BIT_RANGE(bits3SrcSrcType, 45, 43);
-            SET_BIT_RANGE(bits3SrcDstType, 48, 46);
-            SET_BIT_RANGE(bits3SrcNibCtrl, 11, 11);
-
-            SET_BIT_RANGE(bitsDepCtrl, 10, 9);
-            SET_BIT_RANGE(bitsWECtrl, 34, 34);
-            SET_BIT_RANGE(bitsDstRegFile, 36, 35);
-            SET_BIT_RANGE(bitsDstType, 40, 37);
-            SET_BIT_RANGE(bitsDstIdxRegNum, 60, 57);
-            SET_BIT_RANGE(bitsDstIdxImmOWord, 56, 52);
-            SET_BIT_RANGE(bitsDstIdxImmByte, 56, 48);
-            SET_BIT_RANGE(bitsDstIdxImmMSB, 47, 47);
-            SET_BIT_RANGES(bitsSrcRegFile, 42, 41, 90, 89);
-            SET_BIT_RANGES(bitsSrcType, 46, 43, 94, 91);
-            SET_BIT_RANGES(bitsSrcIdxRegNum, 76, 73, 108, 105);
-            SET_BIT_RANGES(bitsSrcIdxImmOWord, 72, 68, 104, 100);
-            SET_BIT_RANGES(bitsSrcIdxImmByte, 72, 64, 104, 96);
-            SET_BIT_RANGES(bitsSrcIdxImmMSB, 95, 95, 121, 121);
-            SET_BIT_RANGE(bitsJIP, 127, 96);
-            SET_BIT_RANGE(bitsUIP, 95, 64);
-            SET_BIT_RANGES2(bits3SrcSrcMod, 38, 37, 40, 39, 42, 41);
+            // the remaining bit locations are also process-wide, see
+            // BinaryEncodingBase::InitPlatform()
+            static std::once_flag initialized;
+            std::call_once(initialized, []()
+            {
+                // BDW+ encoding
+                SET_BIT_RANGE(bitsFlagSubRegNum, 32, 32);
+                SET_BIT_RANGE(bitsNibCtrl, 11, 11);
+                SET_BIT_RANGE(bitsMrfRegNumHWord, 76, 69);   // MRF is not used
+                SET_BIT_RANGE(bits3SrcFlagSubRegNum, 32, 32);
+                SET_BIT_RANGE(bits3SrcSrcType, 45, 43);
+                SET_BIT_RANGE(bits3SrcDstType, 48, 46);
+                SET_BIT_RANGE(bits3SrcNibCtrl, 11, 11);
+
+                SET_BIT_RANGE(bitsDepCtrl, 10, 9);
+                SET_BIT_RANGE(bitsWECtrl, 34, 34);
+                SET_BIT_RANGE(bitsDstRegFile, 36, 35);
+                SET_BIT_RANGE(bitsDstType, 40, 37);
+                SET_BIT_RANGE(bitsDstIdxRegNum, 60, 57);
+                SET_BIT_RANGE(bitsDstIdxImmOWord, 56, 52);
+                SET_BIT_RANGE(bitsDstIdxImmByte, 56, 48);
+                SET_BIT_RANGE(bitsDstIdxImmMSB, 47, 47);
+                SET_BIT_RANGES(bitsSrcType, 46, 43, 94, 91);
+                SET_BIT_RANGES(bitsSrcIdxRegNum, 76, 73, 108, 105);
+                SET_BIT_RANGES(bitsSrcIdxImmOWord, 72, 68, 104, 100);
+                SET_BIT_RANGES(bitsSrcIdxImmByte, 72, 64, 104, 96);
+                SET_BIT_RANGES(bitsSrcIdxImmMSB, 95, 95, 121, 121);
+                SET_BIT_RANGE(bitsJIP, 127, 96);
+                SET_BIT_RANGE(bitsUIP, 95, 64);
+                SET_BIT_RANGES2(bits3SrcSrcMod, 38, 37, 40, 39, 42, 41);
+            });
         }
 
 
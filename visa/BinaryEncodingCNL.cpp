@@ -2475,22 +2475,7 @@ void BinaryEncodingCNL::DoAll()
 	FixInst();
     BinaryEncodingBase::InitPlatform();
     // BDW/CHV/SKL/BXT/CNL use the same compaction tables except from 3src.
-    for ( uint8_t i=0; i<(int)COMPACT_TABLE_SIZE; i++ )
-    {
-        BDWCompactControlTable.AddIndex(IVBCompactControlTable[i], i);
-        BDWCompactSourceTable.AddIndex(IVBCompactSourceTable[i], i);
-        BDWCompactSubRegTable.AddIndex(IVBCompactSubRegTable[i], i);
-        BDWCompactSubRegTable.AddIndex1(IVBCompactSubRegTable[i] & 0x1F, i);
-        BDWCompactSubRegTable.AddIndex2(IVBCompactSubRegTable[i] & 0x3FF, i);
-        if (getGenxPlatform() > GENX_CNL)
-        {  
-            BDWCompactDataTypeTableStr.AddIndex(ICLCompactDataTypeTable[i], i);
-        }
-        else
-        {
-            BDWCompactDataTypeTableStr.AddIndex(BDWCompactDataTypeTable[i], i);
-        }
-    }
+    BDWCompactDataTypeTableStr.UseICLTable(getGenxPlatform() > GENX_CNL);
 
 	int globalInstNum = 0;
 	int globalHalfInstNum = 0;
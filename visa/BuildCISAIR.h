@@ -40,10 +40,15 @@ class VISAFunction;
 extern FILE *CISAin;
 extern FILE *CISAout;
 extern int CISAdebug;
+// scan an in-memory buffer in place (defined in CISA.l); the last two
+// bytes of the buffer must be NUL
+void *CISAScanInPlace(char *base, size_t size);
+void CISADeleteScanBuffer(void *buffer);
 #endif
 
 #include "VISABuilderAPIDefinition.h"
 #include "visa_wa.h"
+#include <functional>
 
 //#define TIME_vISA_LOADING
 //#define TIME_IR_CONSTRUCTION
@@ -82,6 +87,9 @@ public:
         m_currentKernel = NULL;
         m_pWaTable = pWaTable;
         nativeRelocs = NULL;
+        m_mappedInput = NULL;
+        m_mappedSize = 0;
+        m_scanBuffer = NULL;
     }
 
 	virtual ~CISA_IR_Builder();
@@ -91,19 +99,20 @@ public:
 	// routines for initializing and ending CISA parser
 	//
 	// to make the tool quit when there is incorrect input file
-	bool openCISAParsingFile(const char* fileName, char* mode)
-	{
-		if( (CISAin = fopen(fileName, mode)) == NULL)
-		{
-			fprintf(stderr,"Cannot open file %s\n", fileName);
-			return false;
-		}
-		return true;
-	}
-
-    void closeCISAParsingFile() {fclose(CISAin);}
+	bool openCISAParsingFile(const char* fileName, char* mode);
+    void closeCISAParsingFile();
 
     #endif
+    // copy a token's text into the builder's arena; the parser holds on
+    // to these strings for as long as the builder lives
+    char *internParseString(const char *str, size_t len)
+    {
+        char *copy = (char *)m_mem.alloc(len + 1);
+        memcpy(copy, str, len);
+        copy[len] = '\0';
+        return copy;
+    }
+
     /**************START VISA BUILDER API*****************************/
 
     static int CreateBuilder(CISA_IR_Builder *&builder,
@@ -773,6 +782,13 @@ public:
     VISAKernelImpl* getCurrentKernel() const { return m_currentKernel; }
     std::list<VISAKernelImpl*>& getKernels() { return m_kernels; }
 
+    // Run fn(i) for every i < numItems on numThreads workers that share this
+    // builder and the calling thread's platform and stepping.
+    void runOnWorkers(unsigned numItems, unsigned numThreads, const std::function<void(unsigned)>& fn);
+
+    // number of worker threads used to decode the routines of a vISA binary
+    unsigned getNumReaderThreads(unsigned numRoutines);
+
     void InitVisaWaTable(TARGET_PLATFORM platform, Stepping step);
 
     void setTestName(std::string name) { testName = name; }
@@ -818,6 +834,9 @@ private:
 
     void emitFCPatchFile();
 
+    // number of worker threads used to optimize/RA the compilation units in Compile()
+    unsigned getNumCompileThreads(unsigned numUnits);
+
     std::string testName;
 
     PVISA_WA_TABLE m_pWaTable;
@@ -825,6 +844,11 @@ private:
     NativeRelocs* nativeRelocs;
 
     void* gtpin_init = nullptr;
+
+    // set while the current input file is scanned out of a mapping
+    char* m_mappedInput;
+    size_t m_mappedSize;
+    void* m_scanBuffer;
 };
 extern _THREAD CISA_IR_Builder * pCisaBuilder;
 #endif
@@ -29,6 +29,16 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <sstream>
 #include <fstream>
 #include <list>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#if !defined(DLL_MODE) && !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 #include "visa_igc_common_header.h"
 #include "Common_ISA.h"
@@ -80,6 +90,69 @@ CISA_IR_Builder::~CISA_IR_Builder()
     }
 }
 
+#ifndef DLL_MODE
+bool CISA_IR_Builder::openCISAParsingFile(const char* fileName, char* mode)
+{
+#ifndef _WIN32
+    // Lex the file straight out of a private mapping rather than streaming
+    // it through stdio. Flex needs two NUL bytes after the text, which the
+    // zero-filled tail of the last page provides; files ending on (or just
+    // short of) a page boundary take the fopen path below.
+    int fd = ::open(fileName, O_RDONLY);
+    if (fd >= 0)
+    {
+        struct stat st;
+        long pageSize = sysconf(_SC_PAGESIZE);
+        if (fstat(fd, &st) == 0 && st.st_size > 0 && pageSize > 0)
+        {
+            size_t size = (size_t)st.st_size;
+            size_t tail = size % (size_t)pageSize;
+            if (tail != 0 && (size_t)pageSize - tail >= 2)
+            {
+                void* base = mmap(NULL, size + 2, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+                if (base != MAP_FAILED)
+                {
+                    m_scanBuffer = CISAScanInPlace((char*)base, size + 2);
+                    if (m_scanBuffer)
+                    {
+                        ::close(fd);
+                        m_mappedInput = (char*)base;
+                        m_mappedSize = size + 2;
+                        return true;
+                    }
+                    munmap(base, size + 2);
+                }
+            }
+        }
+        ::close(fd);
+    }
+#endif
+
+	if( (CISAin = fopen(fileName, mode)) == NULL)
+	{
+		fprintf(stderr,"Cannot open file %s\n", fileName);
+		return false;
+	}
+	return true;
+}
+
+void CISA_IR_Builder::closeCISAParsingFile()
+{
+#ifndef _WIN32
+    if (m_mappedInput)
+    {
+        CISADeleteScanBuffer(m_scanBuffer);
+        munmap(m_mappedInput, m_mappedSize);
+        m_mappedInput = NULL;
+        m_mappedSize = 0;
+        m_scanBuffer = NULL;
+        return;
+    }
+#endif
+    fclose(CISAin);
+}
+#endif
+
 void CISA_IR_Builder::InitVisaWaTable(TARGET_PLATFORM platform, Stepping step)
 {
 
@@ -326,6 +399,16 @@ int CISA_IR_Builder::CreateBuilder(
 		}
 	}
 
+    // In-memory JIT mode builds G4 IR straight from the builder calls; keep the
+    // Common ISA side of the BOTH path only if a vISA dump has been requested.
+    if (buildOption == CM_CISA_BUILDER_BOTH &&
+        builder->m_options.getOption(vISA_InMemoryJIT) &&
+        !builder->m_options.getOption(vISA_DumpvISA) &&
+        !builder->m_options.getOption(vISA_GenerateISAASM))
+    {
+        builder->mBuildOption = CM_CISA_BUILDER_GEN;
+    }
+
     // emit location info always for these cases
     if (mode == vISABuilderMode::vISA_MEDIA && builder->m_options.getOption(vISA_outputToFile))
     {
@@ -710,6 +793,86 @@ void Stitch_Compiled_Units( common_isa_header header, std::list<G4_Kernel*>& com
 
 // default size of the kernel mem manager in bytes
 #define KERNEL_MEM_SIZE    (4*1024*1024)
+// Run fn(i) for every i < numItems on numThreads workers. The thread-local
+// jitter state (builder, platform and stepping) is copied from the calling
+// thread. Worker timers are added to the caller's once the workers finish, so
+// the per-phase times sum the work of all threads while TIMER_TOTAL stays the
+// caller's wall time.
+void CISA_IR_Builder::runOnWorkers(
+    unsigned numItems,
+    unsigned numThreads,
+    const std::function<void(unsigned)>& fn)
+{
+    TARGET_PLATFORM platform = getGenxPlatform();
+    Stepping step = GetStepping();
+    const char* stepStr = GetSteppingString();
+    std::atomic<unsigned> nextItem(0);
+    std::vector<TimerSnapshot> workerTimers(numThreads);
+
+    auto worker = [&](unsigned tid)
+    {
+        initTimer();
+        pCisaBuilder = this;
+        SetVisaPlatform(platform);
+        InitStepping();
+        if (step != Step_none)
+        {
+            SetStepping(stepStr);
+        }
+
+        for (unsigned i = nextItem++; i < numItems; i = nextItem++)
+        {
+            fn(i);
+        }
+        saveTimers(workerTimers[tid]);
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < numThreads; ++i)
+    {
+        workers.emplace_back(worker, i);
+    }
+    for (auto& w : workers)
+    {
+        w.join();
+    }
+    for (auto& timers : workerTimers)
+    {
+        mergeTimers(timers);
+    }
+}
+
+unsigned CISA_IR_Builder::getNumCompileThreads(unsigned numUnits)
+{
+    unsigned numThreads = m_options.getuInt32Option(vISA_NumCompileThreads);
+    if (numThreads == 0)
+    {
+        numThreads = std::thread::hardware_concurrency();
+    }
+
+    // 3D targets may update the shared options during RA, and unique label
+    // dumps depend on the builder's current kernel; keep both serial.
+    if (m_options.getTarget() == VISA_3D ||
+        m_options.getOption(vISA_UniqueLabels))
+    {
+        numThreads = 1;
+    }
+
+    return numUnits < numThreads ? numUnits : numThreads;
+}
+
+unsigned CISA_IR_Builder::getNumReaderThreads(unsigned numRoutines)
+{
+    // The CISA and both paths also rebuild the vISA binary while decoding, and
+    // debug info maps the vISA offsets of each routine; keep both serial.
+    if (mBuildOption != CM_CISA_BUILDER_GEN ||
+        m_options.getOption(vISA_GenerateDebugInfo))
+    {
+        return 1;
+    }
+    return getNumCompileThreads(numRoutines);
+}
+
 int CISA_IR_Builder::Compile( const char* nameInput)
 {
 
@@ -720,6 +883,7 @@ int CISA_IR_Builder::Compile( const char* nameInput)
 
     if (IS_VISA_BOTH_PATH)
     {
+        startTimer(TIMER_CISA_EMIT);
 
         std::list< VISAKernelImpl *>::iterator iter = m_kernels.begin();
         std::list< VISAKernelImpl *>::iterator end = m_kernels.end();
@@ -746,6 +910,7 @@ int CISA_IR_Builder::Compile( const char* nameInput)
 
         if (status != CM_SUCCESS)
         {
+            stopTimer(TIMER_CISA_EMIT);
             return status;
         }
 
@@ -756,6 +921,8 @@ int CISA_IR_Builder::Compile( const char* nameInput)
         {
             m_cisaBinary->isaDumpVerify(m_kernels, &m_options);
         }
+
+        stopTimer(TIMER_CISA_EMIT);
     }
 
     /*
@@ -797,6 +964,13 @@ int CISA_IR_Builder::Compile( const char* nameInput)
         std::list<G4_Kernel*> compilationUnits;
         std::list<VISAKernelImpl*> kernels;
         std::list<VISAKernelImpl*> functions;
+
+        // Optimization, RA and scheduling of the units are independent of each other,
+        // so they may run on worker threads. Stitching and encoding below stay serial,
+        // which keeps the binary layout and relocations deterministic.
+        unsigned numThreads = getNumCompileThreads((unsigned)m_kernels.size());
+        std::vector<VISAKernelImpl*> parallelUnits;
+
         for( iter = m_kernels.begin(), i = 0; iter != end; iter++, i++ )
         {
             VISAKernelImpl* kernel = (*iter);
@@ -827,6 +1001,12 @@ int CISA_IR_Builder::Compile( const char* nameInput)
                 kernels.push_back(kernel);
             }
 
+            if (numThreads > 1)
+            {
+                parallelUnits.push_back(kernel);
+                continue;
+            }
+
             m_currentKernel = kernel;
 
             int status =  kernel->compileFastPath();
@@ -837,6 +1017,26 @@ int CISA_IR_Builder::Compile( const char* nameInput)
             }
         }
 
+        if (numThreads > 1)
+        {
+            // Each unit owns its Mem_Manager and IR_Builder, so G4 IR construction,
+            // optimization, RA and scheduling of different units are independent.
+            std::vector<int> unitStatus(parallelUnits.size(), CM_SUCCESS);
+            runOnWorkers((unsigned)parallelUnits.size(), numThreads, [&](unsigned i)
+            {
+                unitStatus[i] = parallelUnits[i]->compileFastPath();
+            });
+            for (int unitSt : unitStatus)
+            {
+                // report the first failure in m_kernels order, as the serial path does
+                if (unitSt != CM_SUCCESS)
+                {
+                    stopTimer(TIMER_TOTAL);
+                    return unitSt;
+                }
+            }
+        }
+
         savedFCallStates savedFCallState;
 
         for(std::list<VISAKernelImpl*>::iterator kernel_it = kernels.begin();
@@ -2470,6 +2470,10 @@ public:
 
 #include "HWCapsOpen.inc"
 
+    // GRF bank of reg and whether the three source GRFs in regNum collide
+    unsigned int getGRFBank(unsigned int reg) const;
+    bool isBankConflict(const unsigned int* regNum) const;
+
 private:
     G4_SrcRegRegion* createBindlessExDesc(uint32_t exdesc);
 
@@ -42,6 +42,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "common.h"
 #include "Timer.h"
 #include "PhyRegUsage.h"
+#include "LocalRA.h"
 
 using namespace vISA;
 //
@@ -1375,6 +1376,36 @@ input_info_t *IR_Builder::getRetIPArg() {
     return RetIP;
 }
 
+unsigned int IR_Builder::getGRFBank(unsigned int reg) const
+{
+    // Banks alternate every GRF with one GRF bank division and every
+    // other GRF pair otherwise. With low/high bundles, GRFs from
+    // SECOND_HALF_BANK_START_GRF onwards use separate banks.
+    unsigned int bank = oneGRFBankDivision() ? (reg & 0x1) : ((reg & 0x2) >> 1);
+    if (lowHighBundle() && reg >= SECOND_HALF_BANK_START_GRF)
+    {
+        bank += 2;
+    }
+
+    return bank;
+}
+
+bool IR_Builder::isBankConflict(const unsigned int* regNum) const
+{
+    if (regNum[1] == regNum[2])
+    {
+        return false;
+    }
+
+    if (twoSourcesCollision())
+    {
+        return getGRFBank(regNum[1]) == getGRFBank(regNum[2]);
+    }
+
+    return getGRFBank(regNum[0]) == getGRFBank(regNum[1]) &&
+        getGRFBank(regNum[1]) == getGRFBank(regNum[2]);
+}
+
 // check if an operand is aligned to <align_byte>
 bool IR_Builder::isOpndAligned( G4_Operand *opnd, unsigned short &offset, int align_byte )
 {
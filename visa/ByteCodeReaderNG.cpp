@@ -46,6 +46,8 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
 #include <list>
+#include <memory>
+#include <vector>
 
 #include "JitterDataStruct.h"
 #include "visa_igc_common_header.h"
@@ -2242,15 +2244,16 @@ static void readRoutineNG(unsigned& bytePos, const char* buf, vISA::Mem_Manager&
     container.stringPool.resize(header.string_count);
     for (unsigned i = 0; i < header.string_count; i++)
     {
-        char* str = (char*)mem.alloc(STRING_LEN);
         unsigned j = 0;
-        while (buf[bytePos] != '\0' && j < STRING_LEN)
+        while (buf[bytePos + j] != '\0' && j < STRING_LEN)
         {
-            str[j++] = buf[bytePos++];
+            j++;
         }
         ASSERT_USER(j < STRING_LEN, "string exceeds the maximum length allowed");
+        char* str = (char*)mem.alloc(j + 1);
+        memcpy(str, &buf[bytePos], j);
         str[j] = '\0';
-        bytePos++;
+        bytePos += j + 1;
         header.strings[i] = str;
         container.stringPool[i] = str;
     }
@@ -2697,6 +2700,12 @@ extern bool readIsaBinaryNG(const char* buf, CISA_IR_Builder* builder, vector<VI
         fileVarDecls[i] = fileVar;
     }
 
+    // Index the routines from the header first. Their builders are created
+    // serially and in header order, kernels before functions, since
+    // AddKernel/AddFunction assign the IDs used to stitch the functions into
+    // the kernels in Compile().
+    std::vector<compiled_unit_info_t*> routines;
+    std::vector<bool> routineIsKernel;
     if (kernelName != NULL)
     {
         int kernelIndex = -1;
@@ -2714,9 +2723,28 @@ extern bool readIsaBinaryNG(const char* buf, CISA_IR_Builder* builder, vector<VI
             return false;
         }
 
-        bytePos = isaHeader.kernels[kernelIndex].offset;
+        routines.push_back(&isaHeader.kernels[kernelIndex]);
+        routineIsKernel.push_back(true);
+    }
+    else
+    {
+        for (unsigned int k = 0; k < isaHeader.num_kernels; k++)
+        {
+            routines.push_back(&isaHeader.kernels[k]);
+            routineIsKernel.push_back(true);
+        }
+    }
+    for (unsigned int i = 0; i < isaHeader.num_functions; i++)
+    {
+        routines.push_back(&isaHeader.functions[i]);
+        routineIsKernel.push_back(false);
+    }
 
-        RoutineContainer container;
+    std::vector<RoutineContainer> containers(routines.size());
+    for (unsigned r = 0; r < routines.size(); r++)
+    {
+        compiled_unit_info_t& routine = *routines[r];
+        RoutineContainer& container = containers[r];
         container.builder = builder;
         container.fileVarDecls = fileVarDecls;
         container.fileVarsCount = fileVarsCount;
@@ -2724,132 +2752,59 @@ extern bool readIsaBinaryNG(const char* buf, CISA_IR_Builder* builder, vector<VI
         container.majorVersion = isaHeader.major_version;
         container.minorVersion = isaHeader.minor_version;
 
-        builder->AddKernel(container.kernelBuilder, isaHeader.kernels[kernelIndex].name);
-
-        for (int i = 0; i < isaHeader.kernels[kernelIndex].variable_reloc_symtab.num_syms; i++)
+        if (routineIsKernel[r])
         {
-            reloc_sym& varRelocSym = isaHeader.kernels[kernelIndex].variable_reloc_symtab.reloc_syms[i];
-            ((VISAKernelImpl*)container.kernelBuilder)->addVarRelocEntry(varRelocSym.symbolic_index, varRelocSym.resolved_index);
+            builder->AddKernel(container.kernelBuilder, routine.name);
         }
-
-        for (int i = 0; i < isaHeader.kernels[kernelIndex].function_reloc_symtab.num_syms; i++)
+        else
         {
-            reloc_sym& funcRelocSym = isaHeader.kernels[kernelIndex].function_reloc_symtab.reloc_syms[i];
-            ((VISAKernelImpl*)container.kernelBuilder)->addFuncRelocEntry(funcRelocSym.symbolic_index, funcRelocSym.resolved_index);
+            VISAFunction* funcPtr = NULL;
+            builder->AddFunction(funcPtr, routine.name);
+            container.kernelBuilder = (VISAKernel*)funcPtr;
         }
 
-        ((VISAKernelImpl*)container.kernelBuilder)->setupRelocTable();
-
         VISAKernelImpl* kernelImpl = (VISAKernelImpl*)container.kernelBuilder;
-        kernelImpl->setIsKernel(true);
-        kernels.push_back(container.kernelBuilder);
-
-        readRoutineNG(bytePos, buf, mem, container);
-
-        for (unsigned int i = 0; i < isaHeader.num_functions; i++)
+        for (int i = 0; i < routine.variable_reloc_symtab.num_syms; i++)
         {
-            bytePos = isaHeader.functions[i].offset;
-
-            VISAFunction* funcPtr = NULL;
-            builder->AddFunction(funcPtr, isaHeader.functions[i].name);
-
-            container.kernelBuilder = (VISAKernel*)funcPtr;
+            reloc_sym& varRelocSym = routine.variable_reloc_symtab.reloc_syms[i];
+            kernelImpl->addVarRelocEntry(varRelocSym.symbolic_index, varRelocSym.resolved_index);
+        }
 
-            for (int m = 0; m < isaHeader.functions[i].variable_reloc_symtab.num_syms; m++)
-            {
-                reloc_sym& varRelocSym = isaHeader.functions[i].variable_reloc_symtab.reloc_syms[m];
-                ((VISAKernelImpl*)container.kernelBuilder)->addVarRelocEntry(varRelocSym.symbolic_index, varRelocSym.resolved_index);
-            }
+        for (int i = 0; i < routine.function_reloc_symtab.num_syms; i++)
+        {
+            reloc_sym& funcRelocSym = routine.function_reloc_symtab.reloc_syms[i];
+            kernelImpl->addFuncRelocEntry(funcRelocSym.symbolic_index, funcRelocSym.resolved_index);
+        }
 
-            for (int m = 0; m < isaHeader.functions[i].function_reloc_symtab.num_syms; m++)
-            {
-                reloc_sym& funcRelocSym = isaHeader.functions[i].function_reloc_symtab.reloc_syms[m];
-                ((VISAKernelImpl*)container.kernelBuilder)->addFuncRelocEntry(funcRelocSym.symbolic_index, funcRelocSym.resolved_index);
-            }
+        // Setup relocation table in IR_Builder if one exists
+        kernelImpl->setupRelocTable();
 
-            // Setup relocation table in IR_Builder if one exists
-            ((VISAKernelImpl*)container.kernelBuilder)->setupRelocTable();
+        kernelImpl->setIsKernel(routineIsKernel[r]);
+        kernels.push_back(container.kernelBuilder);
+    }
 
-            ((VISAKernelImpl*)container.kernelBuilder)->setIsKernel(false);
-            kernels.push_back(container.kernelBuilder);
+    // Then decode the routine bodies. A routine only creates variables and
+    // instructions in its own VISAKernelImpl, and its decoded header goes to
+    // its own Mem_Manager, so the routines may be decoded in parallel.
+    std::vector<std::unique_ptr<vISA::Mem_Manager>> routineMem(routines.size());
+    auto readRoutine = [&](unsigned r)
+    {
+        routineMem[r].reset(new vISA::Mem_Manager(4096));
+        unsigned routinePos = routines[r]->offset;
+        readRoutineNG(routinePos, buf, *routineMem[r], containers[r]);
+    };
 
-            readRoutineNG(bytePos, buf, mem, container);
-        }
+    unsigned numThreads = builder->getNumReaderThreads((unsigned)routines.size());
+    if (numThreads > 1)
+    {
+        builder->runOnWorkers((unsigned)routines.size(), numThreads, readRoutine);
     }
     else
     {
-        for( unsigned int k = 0; k < isaHeader.num_kernels; k++ )
+        for (unsigned r = 0; r < routines.size(); r++)
         {
-            bytePos = isaHeader.kernels[k].offset;
-
-            RoutineContainer container;
-            container.builder = builder;
-            container.fileVarDecls = fileVarDecls;
-            container.fileVarsCount = fileVarsCount;
-            container.kernelBuilder = NULL;
-            container.majorVersion = isaHeader.major_version;
-            container.minorVersion = isaHeader.minor_version;
-
-            builder->AddKernel(container.kernelBuilder, isaHeader.kernels[k].name);
-
-            for (int i = 0; i < isaHeader.kernels[k].variable_reloc_symtab.num_syms; i++)
-            {
-                reloc_sym& varRelocSym = isaHeader.kernels[k].variable_reloc_symtab.reloc_syms[i];
-                ((VISAKernelImpl*)container.kernelBuilder)->addVarRelocEntry(varRelocSym.symbolic_index, varRelocSym.resolved_index);
-            }
-
-            for (int i = 0; i < isaHeader.kernels[k].function_reloc_symtab.num_syms; i++)
-            {
-                reloc_sym& funcRelocSym = isaHeader.kernels[k].function_reloc_symtab.reloc_syms[i];
-                ((VISAKernelImpl*)container.kernelBuilder)->addFuncRelocEntry(funcRelocSym.symbolic_index, funcRelocSym.resolved_index);
-            }
-
-            // Setup relocation table in IR_Builder if one exists
-            ((VISAKernelImpl*)container.kernelBuilder)->setupRelocTable();
-
-            ((VISAKernelImpl*)container.kernelBuilder)->setIsKernel(true);
-            kernels.push_back(container.kernelBuilder);
-
-            readRoutineNG(bytePos, buf, mem, container);
+            readRoutine(r);
         }
-
-        for (unsigned int i = 0; i < isaHeader.num_functions; i++)
-            {
-                RoutineContainer container;
-
-                container.builder = builder;
-                container.fileVarDecls = fileVarDecls;
-                container.fileVarsCount = fileVarsCount;
-                container.majorVersion = isaHeader.major_version;
-                container.minorVersion = isaHeader.minor_version;
-
-                bytePos = isaHeader.functions[i].offset;
-
-                VISAFunction* funcPtr = NULL;
-                builder->AddFunction(funcPtr, isaHeader.functions[i].name);
-
-                container.kernelBuilder = (VISAKernel*)funcPtr;
-
-                for( int m = 0; m < isaHeader.functions[i].variable_reloc_symtab.num_syms; m++ )
-                {
-                    reloc_sym& varRelocSym = isaHeader.functions[i].variable_reloc_symtab.reloc_syms[m];
-                    ((VISAKernelImpl*)container.kernelBuilder)->addVarRelocEntry( varRelocSym.symbolic_index, varRelocSym.resolved_index );
-                }
-
-                for( int m = 0; m < isaHeader.functions[i].function_reloc_symtab.num_syms; m++ )
-                {
-                    reloc_sym& funcRelocSym = isaHeader.functions[i].function_reloc_symtab.reloc_syms[m];
-                    ((VISAKernelImpl*)container.kernelBuilder)->addFuncRelocEntry( funcRelocSym.symbolic_index, funcRelocSym.resolved_index );
-                }
-
-                // Setup relocation table in IR_Builder if one exists
-                ((VISAKernelImpl*) container.kernelBuilder)->setupRelocTable();
-
-                ((VISAKernelImpl*)container.kernelBuilder)->setIsKernel(false);
-                kernels.push_back(container.kernelBuilder);
-
-                readRoutineNG(bytePos, buf, mem, container);
-            }
     }
 
     return true;
@@ -3667,6 +3667,11 @@ void CFGStructurizer::run()
         // New BBs generated, reassign block Ids.
         CFG->reassignBlockIDs();
     }
+    else
+    {
+        // edges may still have been retargeted
+        CFG->invalidateCFGAnalyses();
+    }
 }
 
 void doCFGStructurize(FlowGraph *FG)
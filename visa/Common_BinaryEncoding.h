@@ -29,6 +29,9 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "FlowGraph.h"
 #include "Timer.h"
 
+#include <unordered_map>
+#include <mutex>
+
 extern "C" void* allocCodeBlock(size_t sz);
 
 
@@ -414,7 +417,7 @@ class BinInstList : public std::vector<BinInst *> {};
 const uint32_t COMPACT_TABLE_SIZE = 32;
 const uint32_t COMPACT_TABLE_SIZE_3SRC = 4;
 
-static uint32_t IVBCompactControlTable[COMPACT_TABLE_SIZE]=
+static constexpr uint32_t IVBCompactControlTable[COMPACT_TABLE_SIZE]=
 {
     0x00000002, //000,0000,0000,0000,0010
     0x00004000, //000,0100,0000,0000,0000
@@ -450,7 +453,7 @@ static uint32_t IVBCompactControlTable[COMPACT_TABLE_SIZE]=
     0x00028100  //010,1000,0001,0000,0000
 };
 
-static uint32_t IVBCompactSourceTable[COMPACT_TABLE_SIZE]=
+static constexpr uint32_t IVBCompactSourceTable[COMPACT_TABLE_SIZE]=
 {
     0x00000000, //000000000000
     0x00000002, //000000000010
@@ -486,7 +489,7 @@ static uint32_t IVBCompactSourceTable[COMPACT_TABLE_SIZE]=
     0x00000588  //010110001000
 };
 
-static uint32_t IVBCompactSubRegTable[COMPACT_TABLE_SIZE]=
+static constexpr uint32_t IVBCompactSubRegTable[COMPACT_TABLE_SIZE]=
 {
     0x00000000, //000,0000,0000,0000
     0x00000001, //000,0000,0000,0001
@@ -560,7 +563,7 @@ static uint32_t IVBCompactDataTypeTable[COMPACT_TABLE_SIZE]=
 // DataTypeIndex Compact Instruction Field Mappings 1/2 Source Operands DevBDW
 // DataTypeIndex 21-Bit Mapping Mapped Meaning
 
-static uint32_t BDWCompactDataTypeTable[COMPACT_TABLE_SIZE]=
+static constexpr uint32_t BDWCompactDataTypeTable[COMPACT_TABLE_SIZE]=
 {
     0x00040001, //001000000000000000001
     0x00040040, //001000000000001000000
@@ -596,7 +599,7 @@ static uint32_t BDWCompactDataTypeTable[COMPACT_TABLE_SIZE]=
     0x0004B248, //001001011001001001000
 };
 
-static uint32_t ICLCompactDataTypeTable[COMPACT_TABLE_SIZE] =
+static constexpr uint32_t ICLCompactDataTypeTable[COMPACT_TABLE_SIZE] =
 {
     0x40001, // 001000000000000000001
     0x40040, // 001000000000001000000
@@ -831,36 +834,121 @@ static struct _CompactSourceTable_
 
 namespace vISA
 {
-    class _BDWCompactControlTable_
+    //
+    // Perfect-hash indices over the BDW+ compaction tables above.
+    //
+    // Every table key (optionally masked, for the partial sub-register lookups)
+    // is hashed with a per-table multiplier into one of COMPACT_HASH_SLOTS slots,
+    // and each slot records the first table index whose key lands there. The
+    // multipliers were chosen so that distinct keys never share a slot, which is
+    // checked by the static_asserts below, so a lookup is one probe plus a key
+    // compare. The slots are computed at compile time from the same tables used
+    // to decompact, so the two can't get out of sync.
+    //
+    const uint32_t COMPACT_HASH_BITS = 7;
+    const uint32_t COMPACT_HASH_SLOTS = 1 << COMPACT_HASH_BITS;
+    const uint8_t COMPACT_HASH_EMPTY = 0xFF;
+
+    constexpr uint32_t compactHash(uint32_t key, uint32_t mult)
     {
-        const static unsigned maxEntry = 111;
-    Mem_Manager& mem;
+        return (uint32_t)(key * mult) >> (32 - COMPACT_HASH_BITS);
+    }
 
-        struct HashNode
-        {
-            uint32_t key;
-            uint8_t  idx;
-            HashNode* next;
+    // first index in [i, COMPACT_TABLE_SIZE) whose key hashes to slot
+    constexpr uint8_t compactHashSlot(const uint32_t* keys, uint32_t mask, uint32_t mult,
+        uint32_t slot, uint32_t i)
+    {
+        return i == COMPACT_TABLE_SIZE ? COMPACT_HASH_EMPTY :
+            compactHash(keys[i] & mask, mult) == slot ? (uint8_t)i :
+            compactHashSlot(keys, mask, mult, slot, i + 1);
+    }
 
-            HashNode(uint32_t k, uint8_t i, HashNode *nxt) : key(k), idx(i), next(nxt) {}
-        void *operator new(size_t sz, Mem_Manager& m) {return m.alloc(sz);}
-        };
+    // whether key i collides with a different key in [j, COMPACT_TABLE_SIZE)
+    constexpr bool compactHashCollides(const uint32_t* keys, uint32_t mask, uint32_t mult,
+        uint32_t i, uint32_t j)
+    {
+        return j == COMPACT_TABLE_SIZE ? false :
+            ((keys[i] & mask) != (keys[j] & mask) &&
+                compactHash(keys[i] & mask, mult) == compactHash(keys[j] & mask, mult)) ||
+            compactHashCollides(keys, mask, mult, i, j + 1);
+    }
 
-        HashNode* table[maxEntry];
+    constexpr bool isPerfectCompactHash(const uint32_t* keys, uint32_t mask, uint32_t mult,
+        uint32_t i)
+    {
+        return i == COMPACT_TABLE_SIZE ? true :
+            !compactHashCollides(keys, mask, mult, i, i + 1) &&
+            isPerfectCompactHash(keys, mask, mult, i + 1);
+    }
 
-        unsigned FindEntry(uint32_t key)
+    template <unsigned... Is> struct CompactHashSeq { };
+    template <unsigned N, unsigned... Is>
+    struct MakeCompactHashSeq : MakeCompactHashSeq<N - 1, N - 1, Is...> { };
+    template <unsigned... Is>
+    struct MakeCompactHashSeq<0, Is...> { typedef CompactHashSeq<Is...> type; };
+
+    struct CompactHashSlots
+    {
+        uint8_t idx[COMPACT_HASH_SLOTS];
+    };
+
+    template <unsigned... Is>
+    constexpr CompactHashSlots makeCompactHashSlots(const uint32_t* keys, uint32_t mask,
+        uint32_t mult, CompactHashSeq<Is...>)
+    {
+        return CompactHashSlots{ { compactHashSlot(keys, mask, mult, Is, 0)... } };
+    }
+
+    class CompactHashIndex
+    {
+        const uint32_t* keys;
+        uint32_t mask;
+        uint32_t mult;
+        CompactHashSlots slots;
+
+    public:
+        constexpr CompactHashIndex(const uint32_t* k, uint32_t m, uint32_t mul) :
+            keys(k), mask(m), mult(mul),
+            slots(makeCompactHashSlots(k, m, mul, MakeCompactHashSeq<COMPACT_HASH_SLOTS>::type()))
         {
-            return key % maxEntry;
-            // return (key & 0xF) | (key >> 9);
         }
 
-    public:
+        constexpr bool isPerfect() const
+        {
+            return isPerfectCompactHash(keys, mask, mult, 0);
+        }
 
-    _BDWCompactControlTable_ (Mem_Manager& m) : mem(m)
+        bool FindIndex(uint32_t &index, uint32_t key) const
         {
-            for (unsigned i = 0; i < maxEntry; i++)
-                table[i] = NULL;
+            uint8_t idx = slots.idx[compactHash(key, mult)];
+            if (idx == COMPACT_HASH_EMPTY || (keys[idx] & mask) != key)
+            {
+                return false;
+            }
+            index = idx;
+            return true;
         }
+    };
+
+    static constexpr CompactHashIndex BDWCompactControlHash(IVBCompactControlTable, 0xFFFFFFFF, 0xD8F16ADF);
+    static constexpr CompactHashIndex BDWCompactSourceHash(IVBCompactSourceTable, 0xFFFFFFFF, 0x91B7584B);
+    static constexpr CompactHashIndex BDWCompactSubRegHash(IVBCompactSubRegTable, 0xFFFFFFFF, 0x3A902931);
+    static constexpr CompactHashIndex BDWCompactSubRegHash1(IVBCompactSubRegTable, 0x1F, 0x2265B1F5);
+    static constexpr CompactHashIndex BDWCompactSubRegHash2(IVBCompactSubRegTable, 0x3FF, 0xD8F16ADF);
+    static constexpr CompactHashIndex BDWCompactDataTypeHash(BDWCompactDataTypeTable, 0xFFFFFFFF, 0x6A8AC4BB);
+    static constexpr CompactHashIndex ICLCompactDataTypeHash(ICLCompactDataTypeTable, 0xFFFFFFFF, 0xD8F16ADF);
+
+    static_assert(BDWCompactControlHash.isPerfect(), "control table hash has collisions");
+    static_assert(BDWCompactSourceHash.isPerfect(), "source table hash has collisions");
+    static_assert(BDWCompactSubRegHash.isPerfect(), "subreg table hash has collisions");
+    static_assert(BDWCompactSubRegHash1.isPerfect(), "subreg (dst) table hash has collisions");
+    static_assert(BDWCompactSubRegHash2.isPerfect(), "subreg (dst/src0) table hash has collisions");
+    static_assert(BDWCompactDataTypeHash.isPerfect(), "BDW datatype table hash has collisions");
+    static_assert(ICLCompactDataTypeHash.isPerfect(), "ICL datatype table hash has collisions");
+
+    class _BDWCompactControlTable_
+    {
+    public:
 
         bool FindIndex(uint32_t &index,
             uint32_t bits_033_032,
@@ -876,72 +964,17 @@ namespace vISA
                 (bits_023_012 << 4) |
                 (bits_031_031 << 16) |
                 (bits_033_032 << 17);
-            for (HashNode* n = table[FindEntry(i)]; n != NULL; n = n->next)
-            {
-                if (n->key == i)
-                {
-                    index = n->idx;
-                    return true;
-                }
-            }
-            return false;
-        }
-
-        void AddIndex(uint32_t key, uint8_t idx)
-        {
-            int entry = FindEntry(key);
-            table[entry] = new (mem)HashNode(key, idx, table[entry]);
+            return BDWCompactControlHash.FindIndex(index, i);
         }
     };
 
     class _BDWCompactSourceTable_
     {
-        const static unsigned maxEntry = 61;
-    Mem_Manager& mem;
-
-        struct HashNode
-        {
-            uint32_t key;
-            uint8_t  idx;
-            HashNode* next;
-
-            HashNode(uint32_t k, uint8_t i, HashNode *nxt) : key(k), idx(i), next(nxt) {}
-        void *operator new(size_t sz, Mem_Manager& m) {return m.alloc(sz);}
-        };
-
-        HashNode* table[maxEntry];
-
-        unsigned FindEntry(uint32_t key)
-        {
-            return key % maxEntry;
-            //return (key & 0x3) | ((key & 0x3f8) >> 1);
-        }
-
     public:
 
-    _BDWCompactSourceTable_ (Mem_Manager& m) : mem(m)
-        {
-            for (unsigned i = 0; i < maxEntry; i++)
-                table[i] = NULL;
-        }
-
         bool FindIndex(uint32_t &index, uint32_t bits)
         {
-            for (HashNode* n = table[FindEntry(bits)]; n != NULL; n = n->next)
-            {
-                if (n->key == bits)
-                {
-                    index = n->idx;
-                    return true;
-                }
-            }
-            return false;
-        }
-
-        void AddIndex(uint32_t key, uint8_t idx)
-        {
-            int entry = FindEntry(key);
-            table[entry] = new (mem)HashNode(key, idx, table[entry]);
+            return BDWCompactSourceHash.FindIndex(index, bits);
         }
 
         uint32_t GetBits_120_109(uint32_t index)
@@ -957,52 +990,8 @@ namespace vISA
 
     class _BDWCompactSubRegTable_
     {
-        const static unsigned maxEntry = 37;
-        const static unsigned maxEntry1 = 37;
-        const static unsigned maxEntry2 = 37;
-
-    Mem_Manager& mem;
-
-        struct HashNode
-        {
-            uint32_t key;
-            uint8_t  idx;
-            HashNode* next;
-
-            HashNode(uint32_t k, uint8_t i, HashNode *nxt) : key(k), idx(i), next(nxt) {}
-        void *operator new(size_t sz, Mem_Manager& m) {return m.alloc(sz);}
-        };
-
-        HashNode* table[maxEntry];
-        HashNode* table1[maxEntry1];
-        HashNode* table2[maxEntry2];
-
-        unsigned FindEntry(uint32_t key)
-        {
-            return key % maxEntry;
-            //return (key >> 12) | ((key & 0xF) << 3) | (key & 0x380) ;
-        }
-
-        unsigned FindEntry1(uint32_t key)
-        {
-            return key % maxEntry1;
-        }
-
-        unsigned FindEntry2(uint32_t key)
-        {
-            return key % maxEntry2;
-        }
-
     public:
 
-    _BDWCompactSubRegTable_ (Mem_Manager& m) : mem(m)
-        {
-            for (unsigned i = 0; i < maxEntry; i++)
-            {
-                table[i] = table1[i] = table2[i] = NULL;
-            }
-        }
-
         bool FindIndex(uint32_t &index,
             uint32_t bits_100_096,
             uint32_t bits_068_064,
@@ -1011,29 +1000,13 @@ namespace vISA
             uint32_t i = bits_052_048 |
                 (bits_068_064 << 5) |
                 (bits_100_096 << 10);
-            for (HashNode* n = table[FindEntry(i)]; n != NULL; n = n->next)
-            {
-                if (n->key == i)
-                {
-                    index = n->idx;
-                    return true;
-                }
-            }
-            return false;
+            return BDWCompactSubRegHash.FindIndex(index, i);
         }
 
         bool FindIndex1(uint32_t &index,
             uint32_t bits_052_048)
         {
-            for (HashNode* n = table1[FindEntry1(bits_052_048)]; n != NULL; n = n->next)
-            {
-                if (n->key == bits_052_048)
-                {
-                    index = n->idx;
-                    return true;
-                }
-            }
-            return false;
+            return BDWCompactSubRegHash1.FindIndex(index, bits_052_048);
         }
 
         bool FindIndex2(uint32_t &index,
@@ -1042,55 +1015,7 @@ namespace vISA
         {
             uint32_t i = bits_052_048 |
                 (bits_068_064 << 5);
-            for (HashNode* n = table2[FindEntry2(i)]; n != NULL; n = n->next)
-            {
-                if (n->key == i)
-                {
-                    index = n->idx;
-                    return true;
-                }
-            }
-            return false;
-        }
-
-        void AddIndex(uint32_t key, uint8_t idx)
-        {
-            int entry = FindEntry(key);
-            table[entry] = new (mem)HashNode(key, idx, table[entry]);
-        }
-
-        void AddIndex1(uint32_t key, uint8_t idx)
-        {
-            int entry = FindEntry1(key);
-            HashNode* n = table1[entry];
-            for (; n != NULL; n = n->next)
-            {
-                if (n->key == key)
-                {
-                    break;
-                }
-            }
-            if (n == NULL)
-            {
-                table1[entry] = new (mem)HashNode(key, idx, table1[entry]);
-            }
-        }
-
-        void AddIndex2(uint32_t key, uint8_t idx)
-        {
-            int entry = FindEntry2(key);
-            HashNode* n = table2[entry];
-            for (; n != NULL; n = n->next)
-            {
-                if (n->key == key)
-                {
-                    break;
-                }
-            }
-            if (n == NULL)
-            {
-                table2[entry] = new (mem)HashNode(key, idx, table2[entry]);
-            }
+            return BDWCompactSubRegHash2.FindIndex(index, i);
         }
 
         uint32_t GetBits_100_096(uint32_t index)
@@ -1113,33 +1038,18 @@ namespace vISA
     // add Str in below struct to differentiate its loop up table
     class _BDWCompactDataTypeTableStr_
     {
-        const static unsigned maxEntry = 111;
-    Mem_Manager& mem;
+        const CompactHashIndex* hash;
 
-        struct HashNode
-        {
-            uint32_t key;
-            uint8_t  idx;
-            HashNode* next;
-
-            HashNode(uint32_t k, uint8_t i, HashNode *nxt) : key(k), idx(i), next(nxt) {}
-        void *operator new(size_t sz, Mem_Manager& m) {return m.alloc(sz);}
-        };
-
-        HashNode* table[maxEntry];
+    public:
 
-        unsigned FindEntry(uint32_t key)
+        _BDWCompactDataTypeTableStr_() : hash(&BDWCompactDataTypeHash)
         {
-            return key % maxEntry;
-            //return ((key & 0x3FC) >> 2) | ((key & 0x3000) >> 4);
         }
 
-    public:
-
-    _BDWCompactDataTypeTableStr_ (Mem_Manager& m) : mem(m)
+        // ICL+ uses a different datatype table; everything else is shared with BDW
+        void UseICLTable(bool useICL)
         {
-            for (unsigned i = 0; i < maxEntry; i++)
-                table[i] = NULL;
+            hash = useICL ? &ICLCompactDataTypeHash : &BDWCompactDataTypeHash;
         }
 
         bool FindIndex(uint32_t &index,
@@ -1151,21 +1061,7 @@ namespace vISA
             i = bits_046_035 |
                 (bits_094_089 << 12) |
                 (bits_063_061 << 18);
-            for (HashNode* n = table[FindEntry(i)]; n != NULL; n = n->next)
-            {
-                if (n->key == i)
-                {
-                    index = n->idx;
-                    return true;
-                }
-            }
-            return false;
-        }
-
-        void AddIndex(uint32_t key, uint8_t idx)
-        {
-            int entry = FindEntry(key);
-            table[entry] = new (mem)HashNode(key, idx, table[entry]);
+            return hash->FindIndex(index, i);
         }
 
     };
@@ -1433,11 +1329,7 @@ namespace vISA
         _CompactSourceTable3SrcCHV_ CompactSourceTable3SrcCHV;
 
     BinaryEncodingBase(Mem_Manager &m, G4_Kernel& k, std::string fname) 
-        : BDWCompactControlTable(m),
-        BDWCompactSourceTable(m),
-        BDWCompactSubRegTable(m),
-        BDWCompactDataTypeTableStr(m),
-        mem(m),
+        : mem(m),
         fileName(fname),
         kernel(k),
         instCounts(0)
@@ -1508,14 +1400,65 @@ namespace vISA
 
         uint32_t        instCounts;
 
+        // Outcome of compacting an instruction, keyed on its uncompacted encoding.
+        // Kernels tend to repeat the same few encodings (movs, adds with the same
+        // regions and types), so later copies skip the table lookups entirely.
+        struct CompactionKey
+        {
+            uint32_t DWords[DWORDS_PER_INST];
+            bool is3Src;
+
+            CompactionKey(BinInst *mybin) : is3Src(mybin->GetIs3Src())
+            {
+                for (int i = 0; i < DWORDS_PER_INST; i++)
+                {
+                    DWords[i] = mybin->DWords[i];
+                }
+            }
+
+            bool operator==(const CompactionKey& other) const
+            {
+                return is3Src == other.is3Src &&
+                    DWords[0] == other.DWords[0] && DWords[1] == other.DWords[1] &&
+                    DWords[2] == other.DWords[2] && DWords[3] == other.DWords[3];
+            }
+        };
+
+        struct CompactionKeyHash
+        {
+            size_t operator()(const CompactionKey& key) const
+            {
+                size_t h = key.is3Src;
+                for (int i = 0; i < DWORDS_PER_INST; i++)
+                {
+                    h = h * 0x9E3779B1 + key.DWords[i];
+                }
+                return h;
+            }
+        };
+
+        struct CompactionResult
+        {
+            bool compacted;
+            uint32_t DWords[2]; // the compacted encoding, if any
+        };
+
+        std::unordered_map<CompactionKey, CompactionResult, CompactionKeyHash> compactionCache;
+
     public:
-        // all platform specific bit locations are initialized here
+        // all platform specific bit locations are initialized here.
+        // They are process-wide and the same for every BDW+ platform, so
+        // they are written once and encoders on other threads only read them.
         static void InitPlatform()
         {
-            // BDW+ encoding
-            SET_BIT_RANGE(bitsFlagRegNum, 33, 33);
-            SET_BIT_RANGE(bits3SrcFlagRegNum, 33, 33);
-            SET_BIT_RANGES(bitsSrcRegFile, 42, 41, 90, 89);
+            static std::once_flag initialized;
+            std::call_once(initialized, []()
+            {
+                // BDW+ encoding
+                SET_BIT_RANGE(bitsFlagRegNum, 33, 33);
+                SET_BIT_RANGE(bits3SrcFlagRegNum, 33, 33);
+                SET_BIT_RANGES(bitsSrcRegFile, 42, 41, 90, 89);
+            });
         }
 
         inline uint32_t GetSrc0RegFile(BinInst *mybin)
@@ -2306,8 +2249,34 @@ namespace vISA
             return false;
         }
 
+        // the must-compact assertions need the full check, so don't short-cut those
+        bool useCache = !mybin->GetMustCompactFlag();
+        CompactionKey key(mybin);
+        if (useCache)
+        {
+            auto iter = compactionCache.find(key);
+            if (iter != compactionCache.end())
+            {
+                if (iter->second.compacted)
+                {
+                    mybin->DWords[0] = iter->second.DWords[0];
+                    mybin->DWords[1] = iter->second.DWords[1];
+                }
+                return iter->second.compacted;
+            }
+        }
+
         bool result = BDWcompactOneInstruction(inst);
 
+        if (useCache)
+        {
+            CompactionResult cached;
+            cached.compacted = result;
+            cached.DWords[0] = mybin->DWords[0];
+            cached.DWords[1] = mybin->DWords[1];
+            compactionCache.emplace(key, cached);
+        }
+
         return result;
     }
 
@@ -84,6 +84,7 @@ void G4_BB::removePredEdge(G4_BB* pred)
         if (*it != pred) continue;
         // found
         Preds.erase(it);
+        parent->invalidateCFGAnalyses();
         return;
     }
     MUST_BE_TRUE(false, ERROR_FLOWGRAPH); // edge is not found
@@ -96,6 +97,7 @@ void G4_BB::removeSuccEdge(G4_BB* succ)
         if (*it != succ) continue;
         // found
         Succs.erase(it);
+        parent->invalidateCFGAnalyses();
         return;
     }
     MUST_BE_TRUE(false, ERROR_FLOWGRAPH); // edge is not found
@@ -425,7 +427,10 @@ G4_BB* FlowGraph::createNewBB(bool insertInFG)
 
     // Increment counter only when new BB is inserted in FlowGraph
     if (insertInFG)
+    {
         numBBId++;
+        invalidateCFGAnalyses();
+    }
 
     if (builder->getOptions()->getTarget() == VISA_3D)
     {
@@ -766,6 +771,7 @@ void FlowGraph::NormalizeFlowGraph()
 //
 void FlowGraph::constructFlowGraph(INST_LIST& instlist)
 {
+    invalidateCFGAnalyses();
     MUST_BE_TRUE(!instlist.empty(), ERROR_SYNTAX("empty instruction list"));
 
     pKernel->renameAliasDeclares();
@@ -2009,6 +2015,7 @@ void doDFS(G4_BB* startBB, unsigned int p)
 //
 void FlowGraph::removeUnreachableBlocks()
 {
+    invalidateCFGAnalyses();
     unsigned preId = 0;
     std::vector<bool> canRemove(BBs.size(), false);
 
@@ -2522,6 +2529,7 @@ void FlowGraph::removeRedundMov()
 //
 void FlowGraph::removeEmptyBlocks()
 {
+    invalidateCFGAnalyses();
     bool changed = true;
 
     while (changed)
@@ -2644,6 +2652,116 @@ void FlowGraph::removeEmptyBlocks()
     }
 }
 
+//
+// Merge each block into its layout predecessor if the predecessor falls through
+// into it and neither has any other edge. The merged block has no internal
+// label, so later passes (e.g., the local scheduler) may move instructions
+// across the old boundary. A block is not merged if its label is the target
+// of any JIP/UIP or branch, or if either block is a call/return/init/exit block.
+//
+void FlowGraph::mergeFallThroughChains()
+{
+    std::set<G4_Operand*> targetLabels;
+    for (G4_BB* bb : BBs)
+    {
+        for (G4_INST* inst : *bb)
+        {
+            if (!inst->isFlowControl())
+            {
+                continue;
+            }
+            for (int i = 0; i < G4_MAX_SRCS; i++)
+            {
+                if (inst->getSrc(i) && inst->getSrc(i)->isLabel())
+                {
+                    targetLabels.insert(inst->getSrc(i));
+                }
+            }
+            if (inst->asCFInst()->getJip())
+            {
+                targetLabels.insert(inst->asCFInst()->getJip());
+            }
+            if (inst->asCFInst()->getUip())
+            {
+                targetLabels.insert(inst->asCFInst()->getUip());
+            }
+        }
+    }
+
+    auto canMerge = [&targetLabels](G4_BB* pred, G4_BB* succ)
+    {
+        if (pred->Succs.size() != 1 || pred->Succs.front() != succ ||
+            succ->Preds.size() != 1 || succ->Preds.front() != pred)
+        {
+            return false;
+        }
+        if (pred->getBBType() != G4_BB_NONE_TYPE || succ->getBBType() != G4_BB_NONE_TYPE)
+        {
+            return false;
+        }
+        if (pred->empty() || pred->back()->isFlowControl())
+        {
+            return false;
+        }
+        INST_LIST_ITER it = succ->begin();
+        if (it == succ->end() || !(*it)->isLabel() ||
+            (*it)->getLabel()->isFuncLabel() ||
+            targetLabels.count((*it)->getLabel()))
+        {
+            return false;
+        }
+        // the only flow control allowed in succ is its last instruction
+        for (++it; it != succ->end(); ++it)
+        {
+            if ((*it)->isLabel() || ((*it)->isFlowControl() && *it != succ->back()))
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    bool changed = false;
+    for (BB_LIST_ITER it = BBs.begin(); it != BBs.end();)
+    {
+        BB_LIST_ITER next = std::next(it);
+        if (next == BBs.end() || !canMerge(*it, *next))
+        {
+            it = next;
+            continue;
+        }
+
+        G4_BB* pred = *it;
+        G4_BB* succ = *next;
+
+        // drop succ's label and move the rest of its instructions to pred
+        succ->pop_front();
+        pred->splice(pred->end(), succ, succ->begin(), succ->end());
+
+        pred->Succs.clear();
+        for (G4_BB* s : succ->Succs)
+        {
+            pred->Succs.push_back(s);
+            std::replace(s->Preds.begin(), s->Preds.end(), succ, pred);
+        }
+
+        if (succ->getStartBlock() != NULL)
+        {
+            succ->getStartBlock()->removeBlockFromBBList(succ->getId());
+        }
+        succ->Succs.clear();
+        succ->Preds.clear();
+        BBs.erase(next);
+        changed = true;
+        // stay on pred, it may absorb its new successor as well
+    }
+
+    if (changed)
+    {
+        reassignBlockIDs();
+    }
+}
+
 //
 // If multiple freturns exist in a flowgraph create a new basic block
 // with an freturn. Replace all freturns with jumps.
@@ -2771,6 +2889,7 @@ void FlowGraph::linkDummyBB()
 //
 void FlowGraph::reassignBlockIDs()
 {
+    invalidateCFGAnalyses();
     //
     // re-assign block id so that we can use id to determine the ordering of
     // two blocks in the code layout; namely which one is ahead of the other.
@@ -4347,6 +4466,44 @@ void G4_BB::emitInstructionInfo(std::ostream& output, INST_LIST_ITER &it)
     }
 }
 
+//
+// Count the three source instructions whose allocated GRF sources collide
+// in a bank.
+//
+unsigned int G4_BB::countBankConflicts()
+{
+    unsigned int numConflicts = 0;
+    for (G4_INST* inst : instList)
+    {
+        if (inst->getNumSrc() != 3 || inst->isSend())
+        {
+            continue;
+        }
+
+        unsigned int regNum[3];
+        bool allGRF = true;
+        for (int i = 0; i < 3 && allGRF; i++)
+        {
+            G4_Operand* src = inst->getSrc(i);
+            allGRF = src && src->isSrcRegRegion() &&
+                src->asSrcRegRegion()->getBase() &&
+                src->asSrcRegRegion()->getBase()->isRegVar() &&
+                src->asSrcRegRegion()->getBase()->asRegVar()->isGreg();
+            if (allGRF)
+            {
+                regNum[i] = src->getLinearizedStart() / GENX_GRF_REG_SIZ;
+            }
+        }
+
+        if (allGRF && parent->builder->isBankConflict(regNum))
+        {
+            numConflicts++;
+        }
+    }
+
+    return numConflicts;
+}
+
 void G4_BB::emitBankConflict(std::ostream& output, G4_INST *inst)
 {
     int regNum[2][G4_MAX_SRCS];
@@ -5134,120 +5291,97 @@ static bool checkVisitID(FuncInfo* func1, FuncInfo* func2)
 }
 
 //
-// Find dominators for each function
+// Find the immediate dominator of each function in the call graph.
+// sortedFuncTable is a post-order of the (acyclic) call graph, so walking it backwards
+// visits every caller before its callees and the Cooper-Harvey-Kennedy intersection
+// converges in a single pass. funcIDom[i] is the index of the idom of sortedFuncTable[i].
 //
-void FlowGraph::findDominators(std::map<FuncInfo*, std::set<FuncInfo*>>& domMap)
+void FlowGraph::findDominators(std::vector<unsigned>& funcIDom)
 {
-    std::map<FuncInfo*, std::set<FuncInfo*>> predMap;
+    unsigned int funcTableSize = static_cast<unsigned int> (sortedFuncTable.size());
+    auto getFuncIndex = [funcTableSize](FuncInfo* func)
+    {
+        return (func->getScopeID() == UINT_MAX) ? funcTableSize - 1 : func->getScopeID() - 1;
+    };
 
-    for (auto func : sortedFuncTable)
+    std::vector<std::vector<unsigned>> preds(funcTableSize);
+    for (unsigned int i = 0; i < funcTableSize; i++)
     {
-        if (func == kernelInfo)
+        for (auto callee : sortedFuncTable[i]->getCallees())
         {
-            std::set<FuncInfo*> initSet;
-            initSet.insert(kernelInfo);
-            domMap.insert(std::make_pair(kernelInfo, initSet));
-        }
-        else
-        {
-            std::set<FuncInfo*> initSet;
-            for (auto funcTmp : sortedFuncTable)
-            {
-                initSet.insert(funcTmp);
-            }
-            domMap.insert(std::make_pair(func, initSet));
+            preds[getFuncIndex(callee)].push_back(i);
         }
+    }
 
-        for (auto callee : func->getCallees())
+    funcIDom.assign(funcTableSize, UINT_MAX);
+    if (funcTableSize == 0)
+    {
+        return;
+    }
+    funcIDom[funcTableSize - 1] = funcTableSize - 1;
+
+    for (unsigned int funcID = funcTableSize - 1; funcID-- > 0;)
+    {
+        unsigned int newIDom = UINT_MAX;
+        for (auto pred : preds[funcID])
         {
-            std::map<FuncInfo*, std::set<FuncInfo*>>::iterator predMapIter = predMap.find(callee);
-            if (predMapIter == predMap.end())
+            if (funcIDom[pred] == UINT_MAX)
             {
-                std::set<FuncInfo*> initSet;
-                initSet.insert(func);
-                predMap.insert(std::make_pair(callee, initSet));
+                continue;
             }
-            else
+            if (newIDom == UINT_MAX)
             {
-                (*predMapIter).second.insert(func);
+                newIDom = pred;
+                continue;
             }
-        }
-    }
-
-    bool changed = false;
-    do
-    {
-        changed = false;
-
-        unsigned int funcTableSize = static_cast<unsigned int> (sortedFuncTable.size());
-        unsigned int funcID = funcTableSize - 1;
-        do
-        {
-            funcID--;
-            FuncInfo* func = sortedFuncTable[funcID];
-
-            std::map<FuncInfo*, std::set<FuncInfo*>>::iterator predMapIter = predMap.find(func);
-            if (predMapIter != predMap.end())
+            // larger index is closer to the kernel
+            unsigned int finger1 = pred, finger2 = newIDom;
+            while (finger1 != finger2)
             {
-                std::set<FuncInfo*>& domSet = (*domMap.find(func)).second;
-                std::set<FuncInfo*> oldDomSet = domSet;
-                domSet.clear();
-                domSet.insert(func);
-
-                std::vector<unsigned int> funcVec(funcTableSize);
-                for (unsigned int i = 0; i < funcTableSize; i++)
-                {
-                    funcVec[i] = 0;
-                }
-
-                std::set<FuncInfo*>& predSet = (*predMapIter).second;
-                for (auto pred : predSet)
-                {
-                    for (auto predDom : (*domMap.find(pred)).second)
-                    {
-                        unsigned int domID = (predDom->getScopeID() == UINT_MAX) ? funcTableSize - 1 : predDom->getScopeID() - 1;
-                        funcVec[domID]++;
-                    }
-                }
-
-                unsigned int predSetSize = static_cast<unsigned int> (predSet.size());
-                for (unsigned int i = 0; i < funcTableSize; i++)
+                while (finger1 < finger2)
                 {
-                    if (funcVec[i] == predSetSize)
-                    {
-                        FuncInfo* newFunc = sortedFuncTable[i];
-                        domSet.insert(newFunc);
-                        if (oldDomSet.find(newFunc) == oldDomSet.end())
-                            changed = true;
-                    }
+                    finger1 = funcIDom[finger1];
                 }
-
-                if (oldDomSet.size() != domSet.size())
+                while (finger2 < finger1)
                 {
-                    changed = true;
+                    finger2 = funcIDom[finger2];
                 }
             }
-        } while (funcID != 0);
-
-    } while (changed);
+            newIDom = finger1;
+        }
+        funcIDom[funcID] = newIDom;
+    }
 }
 
 //
 // Check if func1 is a dominator of func2
 //
-static bool checkDominator(FuncInfo* func1, FuncInfo* func2, std::map<FuncInfo*, std::set<FuncInfo*>>& domMap)
+bool FlowGraph::isFuncDominator(FuncInfo* func1, FuncInfo* func2) const
 {
-    std::map<FuncInfo*, std::set<FuncInfo*>>::iterator domMapIter = domMap.find(func2);
-
-    if (domMapIter != domMap.end())
+    unsigned int funcTableSize = static_cast<unsigned int> (sortedFuncTable.size());
+    if (funcIDoms.size() != funcTableSize)
     {
-        std::set<FuncInfo*> domSet = (*domMapIter).second;
-        std::set<FuncInfo*>::iterator domSetIter = domSet.find(func1);
+        return false;
+    }
+    auto getFuncIndex = [funcTableSize](FuncInfo* func)
+    {
+        return (func->getScopeID() == UINT_MAX) ? funcTableSize - 1 : func->getScopeID() - 1;
+    };
 
-        if (domSetIter != domSet.end())
+    unsigned int domID = getFuncIndex(func1);
+    unsigned int funcID = getFuncIndex(func2);
+    // idoms always have a larger index, stop once we walked past func1
+    while (funcID != UINT_MAX && funcID <= domID)
+    {
+        if (funcID == domID)
         {
             return true;
         }
+        if (funcIDoms[funcID] == funcID)
+        {
+            break;
+        }
+        funcID = funcIDoms[funcID];
     }
 
     return false;
@@ -5278,19 +5412,15 @@ unsigned int FlowGraph::resolveVarScope(G4_Declare* dcl, FuncInfo* func)
     {
         // This is safe if the global variable usage is
         // self-contained under the calling function
-        std::map<FuncInfo*, std::set<FuncInfo*>> domMap;
-
-        findDominators(domMap);
-
         FuncInfo* oldFunc = sortedFuncTable[oldID - 1];
 
         if (checkVisitID(func, oldFunc) &&
-            checkDominator(func, oldFunc, domMap))
+            isFuncDominator(func, oldFunc))
         {
             return newID;
         }
         else if (checkVisitID(oldFunc, func) &&
-            checkDominator(oldFunc, func, domMap))
+            isFuncDominator(oldFunc, func))
         {
             return oldID;
         }
@@ -5303,9 +5433,9 @@ unsigned int FlowGraph::resolveVarScope(G4_Declare* dcl, FuncInfo* func)
             {
                 FuncInfo* currFunc = sortedFuncTable[funcID];
                 if (checkVisitID(currFunc, func) &&
-                    checkDominator(currFunc, func, domMap) &&
+                    isFuncDominator(currFunc, func) &&
                     checkVisitID(currFunc, oldFunc) &&
-                    checkDominator(currFunc, oldFunc, domMap))
+                    isFuncDominator(currFunc, oldFunc))
                 {
                     return currFunc->getScopeID();
                 }
@@ -5397,6 +5527,12 @@ void FlowGraph::markScope()
         id++;
     }
 
+    if (builder->getOption(vISA_EnableGlobalScopeAnalysis))
+    {
+        // computed once here instead of for every operand in resolveVarScope()
+        findDominators(funcIDoms);
+    }
+
     for (auto func : sortedFuncTable)
     {
         markVarScope(func->getBBList(), func);
@@ -5977,111 +6113,286 @@ void FuncInfo::dump() const
     std::cerr << "\n";
 }
 
-PostDom::PostDom(G4_Kernel& k) : kernel(k)
+#ifdef _DEBUG
+size_t DomTree::computeSignature() const
 {
-    auto numBBs = k.fg.BBs.size();
-    postDoms.resize(numBBs);
-    immPostDoms.resize(numBBs);
+    // Hash the blocks and their successors in order, so that retargeting an
+    // edge is caught even when the block and edge counts do not change.
+    std::hash<const void*> hashPtr;
+    size_t hash = fg.BBs.size();
+    auto combine = [&hash](size_t v)
+    {
+        hash ^= v + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    };
+    for (auto bb : fg.BBs)
+    {
+        combine(hashPtr(bb));
+        combine(bb->getId());
+        for (auto succ : bb->Succs)
+        {
+            combine(hashPtr(succ));
+        }
+        // terminates this block's successor list
+        combine(~(size_t)0);
+    }
+    return hash;
 }
+#endif
 
-void PostDom::run()
+bool DomTree::isStale() const
 {
-    exitBB = nullptr;
-    for (auto bb_rit = kernel.fg.BBs.rbegin(); bb_rit != kernel.fg.BBs.rend(); bb_rit++)
+    if (!valid || cfgVersion != fg.getCFGVersion())
     {
-        auto bb = *bb_rit;
-        if (bb->size() > 0)
-        {
-            auto lastInst = bb->back();
-            if (lastInst->isEOT())
-            {
-                exitBB = bb;
-                break;
-            }
-        }
+        return true;
     }
+#ifdef _DEBUG
+    MUST_BE_TRUE(computeSignature() == cfgHash,
+        "CFG was modified without calling FlowGraph::invalidateCFGAnalyses()");
+#endif
+    return false;
+}
 
-    MUST_BE_TRUE(exitBB != nullptr, "Exit BB not found!");
+void DomTree::recompute()
+{
+    unsigned numIds = 0;
+    for (auto bb : fg.BBs)
+    {
+        numIds = std::max(numIds, bb->getId() + 1);
+    }
+    virtualRoot = numIds;
 
-    postDoms[exitBB->getId()] = { exitBB };
-    std::unordered_set<G4_BB*> allBBs;
-    for (auto bb : kernel.fg.BBs)
+    idBB.assign(numIds + 1, nullptr);
+    for (auto bb : fg.BBs)
     {
-        allBBs.insert(bb);
+        idBB[bb->getId()] = bb;
     }
 
-    for (auto bb : kernel.fg.BBs)
+    auto preds = [this](G4_BB* bb) -> BB_LIST& { return isPostDom ? bb->Succs : bb->Preds; };
+    auto succs = [this](G4_BB* bb) -> BB_LIST& { return isPostDom ? bb->Preds : bb->Succs; };
+
+    // roots are the successors of the virtual node
+    std::vector<G4_BB*> roots;
+    if (isPostDom)
     {
-        if (bb != exitBB)
+        for (auto bb : fg.BBs)
         {
-            postDoms[bb->getId()] = allBBs;
+            if (bb->Succs.empty())
+            {
+                roots.push_back(bb);
+            }
         }
     }
+    else if (!fg.BBs.empty())
+    {
+        roots.push_back(fg.getEntryBB() ? fg.getEntryBB() : fg.BBs.front());
+    }
 
-    // Actual post dom computation
-    bool change = true;
-    while (change)
+    // post-order numbering of the (reverse) CFG starting from the virtual node
+    std::vector<unsigned> postOrder(numIds + 1, UINT_MAX);
+    std::vector<unsigned> rpo;      // ids in reverse post-order, virtual node excluded
+    rpo.reserve(numIds);
     {
-        change = false;
-        for (auto bb : kernel.fg.BBs)
+        std::vector<bool> visited(numIds, false);
+        std::vector<std::pair<G4_BB*, BB_LIST_ITER>> stack;
+        unsigned nextPO = 0;
+        for (auto root : roots)
         {
-            if (bb == exitBB)
+            if (visited[root->getId()])
+            {
                 continue;
-
-            std::unordered_set<G4_BB*> tmp = { bb };
-            // Compute intersection of pdom of successors
-            std::unordered_map<G4_BB*, unsigned int> numInstances;
-            for (auto succs : bb->Succs)
+            }
+            visited[root->getId()] = true;
+            stack.push_back(std::make_pair(root, succs(root).begin()));
+            while (!stack.empty())
             {
-                auto& pdomSucc = postDoms[succs->getId()];
-                for (auto pdomSuccBB : pdomSucc)
+                G4_BB* bb = stack.back().first;
+                BB_LIST_ITER& it = stack.back().second;
+                if (it != succs(bb).end())
                 {
-                    auto it = numInstances.find(pdomSuccBB);
-                    if (it == numInstances.end())
-                        numInstances.insert(std::make_pair(pdomSuccBB, 1));
-                    else
-                        it->second = it->second + 1;
+                    G4_BB* next = *it;
+                    ++it;
+                    if (!visited[next->getId()])
+                    {
+                        visited[next->getId()] = true;
+                        stack.push_back(std::make_pair(next, succs(next).begin()));
+                    }
+                }
+                else
+                {
+                    postOrder[bb->getId()] = nextPO++;
+                    rpo.push_back(bb->getId());
+                    stack.pop_back();
                 }
             }
+        }
+        postOrder[virtualRoot] = nextPO;
+        std::reverse(rpo.begin(), rpo.end());
+    }
+
+    iDoms.assign(numIds + 1, -1);
+    iDoms[virtualRoot] = virtualRoot;
+    for (auto root : roots)
+    {
+        iDoms[root->getId()] = virtualRoot;
+    }
 
-            // Common BBs appear in numInstances map with second value == bb->Succs count
-            for (auto commonBBs : numInstances)
+    auto intersect = [&](unsigned finger1, unsigned finger2)
+    {
+        while (finger1 != finger2)
+        {
+            while (postOrder[finger1] < postOrder[finger2])
             {
-                if (commonBBs.second == bb->Succs.size())
-                    tmp.insert(commonBBs.first);
+                finger1 = iDoms[finger1];
             }
+            while (postOrder[finger2] < postOrder[finger1])
+            {
+                finger2 = iDoms[finger2];
+            }
+        }
+        return finger1;
+    };
 
-            // Check if postDom set changed for bb in current iter
-            if (tmp.size() != postDoms[bb->getId()].size())
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (auto id : rpo)
+        {
+            G4_BB* bb = idBB[id];
+            if (iDoms[id] == (int) virtualRoot)
             {
-                postDoms[bb->getId()] = tmp;
-                change = true;
                 continue;
             }
-            else
+            int newIDom = -1;
+            for (auto pred : preds(bb))
             {
-                auto& pdomBB = postDoms[bb->getId()];
-                for (auto tmpBB : tmp)
+                unsigned predId = pred->getId();
+                if (iDoms[predId] < 0)
                 {
-                    if (pdomBB.find(tmpBB) == pdomBB.end())
-                    {
-                        postDoms[bb->getId()] = tmp;
-                        change = true;
-                        break;
-                    }
-                    if (change)
-                        break;
+                    continue;
                 }
+                newIDom = newIDom < 0 ? predId : intersect(predId, newIDom);
+            }
+            if (newIDom != iDoms[id])
+            {
+                iDoms[id] = newIDom;
+                changed = true;
+            }
+        }
+    }
+
+    // number the dominator tree
+    std::vector<std::vector<unsigned>> children(numIds + 1);
+    for (auto id : rpo)
+    {
+        if (iDoms[id] >= 0)
+        {
+            children[iDoms[id]].push_back(id);
+        }
+    }
+    dfsIn.assign(numIds + 1, 0);
+    dfsOut.assign(numIds + 1, 0);
+    {
+        unsigned counter = 0;
+        std::vector<std::pair<unsigned, unsigned>> stack;
+        stack.push_back(std::make_pair(virtualRoot, 0u));
+        dfsIn[virtualRoot] = counter++;
+        while (!stack.empty())
+        {
+            unsigned node = stack.back().first;
+            unsigned& childIdx = stack.back().second;
+            if (childIdx < children[node].size())
+            {
+                unsigned child = children[node][childIdx++];
+                dfsIn[child] = counter++;
+                stack.push_back(std::make_pair(child, 0u));
+            }
+            else
+            {
+                dfsOut[node] = counter++;
+                stack.pop_back();
+            }
+        }
+    }
+
+    if (!isPostDom)
+    {
+        for (auto bb : fg.BBs)
+        {
+            bb->setIDom(getIDom(bb));
+        }
+    }
+
+    cfgVersion = fg.getCFGVersion();
+#ifdef _DEBUG
+    cfgHash = computeSignature();
+#endif
+    valid = true;
+}
+
+G4_BB* DomTree::getCommonDominator(G4_BB* bb1, G4_BB* bb2) const
+{
+    if (!isReachable(bb1) || !isReachable(bb2))
+    {
+        return nullptr;
+    }
+    unsigned id1 = bb1->getId(), id2 = bb2->getId();
+    // walk up from bb1 until reaching a node containing bb2 in its subtree
+    while (id1 != virtualRoot &&
+        !(dfsIn[id1] <= dfsIn[id2] && dfsOut[id2] <= dfsOut[id1]))
+    {
+        id1 = iDoms[id1];
+    }
+    return id1 == virtualRoot ? nullptr : idBB[id1];
+}
+
+void DomTree::dump(std::ostream& os) const
+{
+    for (auto bb : fg.BBs)
+    {
+        G4_BB* idom = getIDom(bb);
+        os << "BB" << bb->getId() << (isPostDom ? " ipdom: " : " idom: ");
+        if (idom)
+        {
+            os << "BB" << idom->getId();
+        }
+        else
+        {
+            os << (isReachable(bb) ? "<root>" : "<unreachable>");
+        }
+        os << "\n";
+    }
+}
+
+PostDom::PostDom(G4_Kernel& k) : kernel(k)
+{
+}
+
+void PostDom::run()
+{
+    exitBB = nullptr;
+    for (auto bb_rit = kernel.fg.BBs.rbegin(); bb_rit != kernel.fg.BBs.rend(); bb_rit++)
+    {
+        auto bb = *bb_rit;
+        if (bb->size() > 0)
+        {
+            auto lastInst = bb->back();
+            if (lastInst->isEOT())
+            {
+                exitBB = bb;
+                break;
             }
         }
     }
 
-    updateImmPostDom();
+    MUST_BE_TRUE(exitBB != nullptr, "Exit BB not found!");
+
+    kernel.fg.getPostDomTree();
 }
 
-std::unordered_set<G4_BB*>& PostDom::getPostDom(G4_BB* bb)
+bool PostDom::postDominates(G4_BB* bb1, G4_BB* bb2)
 {
-    return postDoms[bb->getId()];
+    return kernel.fg.getPostDomTree().dominates(bb1, bb2);
 }
 
 void PostDom::dumpImmDom()
@@ -6089,7 +6400,7 @@ void PostDom::dumpImmDom()
     for (auto bb : kernel.fg.BBs)
     {
         printf("BB%d - ", bb->getId());
-        auto& pdomBBs = immPostDoms[bb->getId()];
+        auto pdomBBs = getImmPostDom(bb);
         for (auto pdomBB : pdomBBs)
         {
             printf("BB%d", pdomBB->getId());
@@ -6103,31 +6414,15 @@ void PostDom::dumpImmDom()
     }
 }
 
-std::vector<G4_BB*>& PostDom::getImmPostDom(G4_BB* bb)
-{
-    return immPostDoms[bb->getId()];
-}
-
-void PostDom::updateImmPostDom()
+std::vector<G4_BB*> PostDom::getImmPostDom(G4_BB* bb)
 {
-    // Update immPostDom vector with correct ordering
-    for (auto bb : kernel.fg.BBs)
+    DomTree& pdom = kernel.fg.getPostDomTree();
+    std::vector<G4_BB*> immPostDoms;
+    for (G4_BB* pdomBB = bb; pdomBB != nullptr; pdomBB = pdom.getIDom(pdomBB))
     {
-        {
-            auto& postDomBBs = postDoms[bb->getId()];
-            auto& immPostDomBB = immPostDoms[bb->getId()];
-            immPostDomBB.resize(postDomBBs.size());
-            immPostDomBB[0] = bb;
-
-            for (auto pdomBB : postDomBBs)
-            {
-                if (pdomBB == bb)
-                    continue;
-
-                immPostDomBB[postDomBBs.size() - postDoms[pdomBB->getId()].size()] = pdomBB;
-            }
-        }
+        immPostDoms.push_back(pdomBB);
     }
+    return immPostDoms;
 }
 
 G4_BB* PostDom::getCommonImmDom(std::unordered_set<G4_BB*>& bbs)
@@ -6135,37 +6430,29 @@ G4_BB* PostDom::getCommonImmDom(std::unordered_set<G4_BB*>& bbs)
     if (bbs.size() == 0)
         return nullptr;
 
+    DomTree& pdom = kernel.fg.getPostDomTree();
     unsigned int maxId = (*bbs.begin())->getId();
-
-    auto commonImmDoms = getImmPostDom(*bbs.begin());
+    G4_BB* commonPDom = *bbs.begin();
     for (auto bb : bbs)
     {
         if (bb->getId() > maxId)
             maxId = bb->getId();
 
-        auto& postDomBB = postDoms[bb->getId()];
-        for (unsigned int i = 0; i != commonImmDoms.size(); i++)
+        if (commonPDom)
         {
-            if (commonImmDoms[i])
-            {
-                if (postDomBB.find(commonImmDoms[i]) == postDomBB.end())
-                {
-                    commonImmDoms[i] = nullptr;
-                }
-            }
+            commonPDom = pdom.getCommonDominator(commonPDom, bb);
         }
     }
 
     // Return first imm dom that is not a BB from bbs set
-    for (unsigned int i = 0; i != commonImmDoms.size(); i++)
+    for (G4_BB* pdomBB = commonPDom; pdomBB != nullptr; pdomBB = pdom.getIDom(pdomBB))
     {
-        if (commonImmDoms[i] &&
-            // Common imm pdom must be lexically last BB
-            commonImmDoms[i]->getId() >= maxId &&
-            ((commonImmDoms[i]->size() > 1 && commonImmDoms[i]->front()->isLabel()) ||
-            (commonImmDoms[i]->size() > 0 && !commonImmDoms[i]->front()->isLabel())))
+        if (// Common imm pdom must be lexically last BB
+            pdomBB->getId() >= maxId &&
+            ((pdomBB->size() > 1 && pdomBB->front()->isLabel()) ||
+            (pdomBB->size() > 0 && !pdomBB->front()->isLabel())))
         {
-            return commonImmDoms[i];
+            return pdomBB;
         }
     }
 
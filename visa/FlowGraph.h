@@ -447,6 +447,7 @@ public:
     void emitBasicInstructionIga(char* instSyntax, std::ostream& output, INST_LIST_ITER &it, int *suppressRegs, int *lastRegs);
     void emitInstructionInfo(std::ostream& output, INST_LIST_ITER &it);
     void emitBankConflict(std::ostream& output, G4_INST *inst);
+    unsigned int countBankConflicts();
 
     void emitDepInfo(std::ostream& output, G4_INST *inst, int offset);
 
@@ -642,6 +643,74 @@ typedef std::pair<BB_LIST_ITER, BB_LIST_ITER> GRAPH_CUT_BOUNDS;
 namespace vISA
 {
 class G4_Kernel; // forward declaration
+
+//
+// Dominator (or post-dominator) tree of a flow graph.
+// It is built with the Cooper-Harvey-Kennedy iterative algorithm over dense BB ids,
+// and the tree is numbered by DFS so that dominance queries take constant time.
+// Post-dominators are computed on the reverse CFG with a virtual exit node that
+// succeeds every block without successors.
+// Use FlowGraph::getDomTree()/getPostDomTree() to get an up-to-date tree instead of
+// building one directly.
+//
+class DomTree
+{
+public:
+    DomTree(FlowGraph& f, bool postDom) : fg(f), isPostDom(postDom) {}
+
+    void recompute();
+    // true if the CFG changed since the tree was last computed
+    bool isStale() const;
+
+    // immediate (post-)dominator, NULL for the entry/exit and unreachable blocks
+    G4_BB* getIDom(G4_BB* bb) const
+    {
+        int idom = iDoms[bb->getId()];
+        return idom < 0 || idom == (int) virtualRoot ? nullptr : idBB[idom];
+    }
+
+    bool isReachable(G4_BB* bb) const { return iDoms[bb->getId()] >= 0; }
+
+    // true if bb1 (post-)dominates bb2; a block dominates itself
+    bool dominates(G4_BB* bb1, G4_BB* bb2) const
+    {
+        unsigned id1 = bb1->getId(), id2 = bb2->getId();
+        if (iDoms[id1] < 0 || iDoms[id2] < 0)
+        {
+            return id1 == id2;
+        }
+        return dfsIn[id1] <= dfsIn[id2] && dfsOut[id2] <= dfsOut[id1];
+    }
+
+    // nearest block that (post-)dominates both, NULL if there is none
+    G4_BB* getCommonDominator(G4_BB* bb1, G4_BB* bb2) const;
+
+    void dump(std::ostream& os = std::cerr) const;
+
+private:
+    FlowGraph& fg;
+    const bool isPostDom;
+    unsigned virtualRoot = 0;       // id of the virtual entry/exit node
+
+    // FlowGraph::getCFGVersion() at the time of computation
+    unsigned cfgVersion = 0;
+    bool valid = false;
+#ifdef _DEBUG
+    size_t cfgHash = 0;
+#endif
+
+    std::vector<G4_BB*> idBB;       // BB id -> BB
+    std::vector<int> iDoms;         // BB id -> idom id; -1 if unreachable
+    std::vector<unsigned> dfsIn;    // pre/post numbers in the dominator tree
+    std::vector<unsigned> dfsOut;
+
+#ifdef _DEBUG
+    // hash of the block list and every block's successor list, used to catch
+    // CFG edits that did not invalidate the analyses
+    size_t computeSignature() const;
+#endif
+};
+
 class FlowGraph
 {
     // Data
@@ -674,6 +743,15 @@ private:
     // stores all endift inst that have labels associated with it
     std::unordered_map<G4_INST*, G4_Label*> endifWithLabels;
 
+    // cached CFG analyses, see getDomTree()/getPostDomTree()
+    unsigned cfgVersion;
+    DomTree domTree;
+    DomTree postDomTree;
+
+    // immediate dominator of each function in the call graph, indexed
+    // by its position in sortedFuncTable
+    std::vector<unsigned> funcIDoms;
+
 public:
     typedef std::pair<G4_BB*, G4_BB*> Edge;
     typedef std::set<G4_BB*> Blocks;
@@ -853,7 +931,8 @@ public:
 
     FlowGraph(INST_LIST_NODE_ALLOCATOR& alloc, G4_Kernel* kernel, Mem_Manager& m) : entryBB(NULL), traversalNum(0), numBBId(0), reducible(true),
       doIPA(false), hasStackCalls(false), isStackCallFunc(false), loopLabelId(0), autoLabelId(0),
-      pKernel(kernel), mem(m), instListAlloc(alloc),
+      pKernel(kernel), cfgVersion(0), domTree(*this, false), postDomTree(*this, true),
+      mem(m), instListAlloc(alloc),
       builder(NULL), globalOpndHT(m), framePtrDcl(NULL), stackPtrDcl(NULL),
       scratchRegDcl(NULL), pseudoVCEDcl(NULL) {}
 
@@ -864,8 +943,36 @@ public:
         builder = pBuilder;
     }
 
+    //
+    // Dominator and post-dominator trees of the CFG. They are computed on first use
+    // and recomputed only when the CFG changed since then.
+    //
+    DomTree& getDomTree()
+    {
+        if (domTree.isStale())
+        {
+            domTree.recompute();
+        }
+        return domTree;
+    }
+    DomTree& getPostDomTree()
+    {
+        if (postDomTree.isStale())
+        {
+            postDomTree.recompute();
+        }
+        return postDomTree;
+    }
+    //
+    // Invalidate cached CFG analyses. Edge and block manipulation through FlowGraph
+    // methods does this automatically; call it after editing BBs or Preds/Succs directly.
+    //
+    void invalidateCFGAnalyses() { cfgVersion++; }
+    unsigned getCFGVersion() const { return cfgVersion; }
+
     void addPredSuccEdges(G4_BB* pred, G4_BB* succ, bool tofront=true)
     {
+        invalidateCFGAnalyses();
         if (tofront)
             pred->Succs.push_front(succ);
         else
@@ -887,6 +994,7 @@ public:
     void removePredSuccEdges(G4_BB* pred, G4_BB* succ)
     {
         MUST_BE_TRUE(pred != NULL && succ != NULL, ERROR_INTERNAL_ARGUMENT);
+        invalidateCFGAnalyses();
 
         BB_LIST_ITER lt = pred->Succs.begin();
         for (; lt != pred->Succs.end(); ++lt){
@@ -933,6 +1041,11 @@ public:
     //
     void removeEmptyBlocks();
     //
+    // Merge chains of layout-consecutive blocks that always execute together
+    // (single successor/single predecessor, falling through) into one block.
+    //
+    void mergeFallThroughChains();
+    //
     // Add a dummy BB for multiple-exit flow graph
     //
     void linkDummyBB();
@@ -1004,7 +1117,8 @@ public:
 
 	void traverseFunc(FuncInfo* func, unsigned int *ptr);
 	void topologicalSortCallGraph();
-	void findDominators(std::map<FuncInfo*, std::set<FuncInfo*>>& domMap);
+	void findDominators(std::vector<unsigned>& funcIDom);
+	bool isFuncDominator(FuncInfo* func1, FuncInfo* func2) const;
 	unsigned int resolveVarScope(G4_Declare* dcl, FuncInfo* func);
 	void markVarScope(std::vector<G4_BB*>& BBList, FuncInfo* func);
 	void markScope();
@@ -1088,6 +1202,8 @@ private:
 	DO(GRAPH_COLORING_SPILL_FF_BC_RA) \
 	DO(GRAPH_COLORING_SPILL_RR_RA) \
 	DO(GRAPH_COLORING_SPILL_FF_RA) \
+	DO(LINEAR_SCAN_RA) \
+	DO(LINEAR_SCAN_SPILL_RA) \
 	DO(UNKNOWN_RA)
 
 enum RA_Type
@@ -1595,19 +1711,16 @@ class PostDom
 {
 public:
     PostDom(G4_Kernel&);
-    std::unordered_set<G4_BB*>& getPostDom(G4_BB*);
-    std::vector<G4_BB*>& getImmPostDom(G4_BB*);
+    bool postDominates(G4_BB* bb1, G4_BB* bb2);
+    // bb followed by its post-dominators, innermost first
+    std::vector<G4_BB*> getImmPostDom(G4_BB*);
     void run();
     void dumpImmDom();
     G4_BB* getCommonImmDom(std::unordered_set<G4_BB*>&);
 
 private:
-    const G4_Kernel& kernel;
+    G4_Kernel& kernel;
     G4_BB* exitBB = nullptr;
-    std::vector<std::unordered_set<G4_BB*>> postDoms;
-    std::vector<std::vector<G4_BB*>> immPostDoms;
-
-    void updateImmPostDom();
 };
 }
 #endif
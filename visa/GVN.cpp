@@ -0,0 +1,698 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+
+#include "GVN.h"
+#include "Timer.h"
+#include <algorithm>
+
+using namespace vISA;
+
+//
+// Gather the number of definitions and all source uses of every root declare,
+// and exclude declares that are referenced in ways GVN does not model.
+//
+void GVN::collectDefUse()
+{
+    dclInfo.clear();
+    dclInfo.resize(kernel.Declares.size());
+
+    for (auto dcl : kernel.Declares)
+    {
+        if (dcl->getAliasDeclare())
+        {
+            dclInfo[dcl->getRootDeclare()->getDeclId()].hasAliases = true;
+        }
+    }
+
+    auto getInfo = [this](G4_Declare* dcl) -> DclInfo&
+    {
+        return dclInfo[dcl->getRootDeclare()->getDeclId()];
+    };
+
+    for (auto bb : kernel.fg.BBs)
+    {
+        for (auto inst : *bb)
+        {
+            // pseudo kill and lifetime markers must stay attached to their own variable
+            bool excludeAll = inst->isPseudoKill() || inst->isLifeTimeEnd() ||
+                inst->isIntrinsic() || inst->opcode() == G4_pseudo_fcall ||
+                inst->opcode() == G4_pseudo_fret;
+
+            G4_DstRegRegion* dst = inst->getDst();
+            if (dst && !dst->isNullReg() && dst->getTopDcl())
+            {
+                DclInfo& info = getInfo(dst->getTopDcl());
+                info.numDefs++;
+                info.def = inst;
+                if (excludeAll || dst->getRegAccess() != Direct)
+                {
+                    info.excluded = true;
+                }
+                if (info.defBB && info.defBB != bb)
+                {
+                    info.multiBBDefs = true;
+                }
+                info.defBB = bb;
+            }
+
+            // flags are also defined by condition modifiers
+            G4_CondMod* condMod = inst->getCondMod();
+            if (condMod && condMod->getTopDcl())
+            {
+                DclInfo& info = getInfo(condMod->getTopDcl());
+                info.numDefs++;
+                info.def = inst;
+                if (excludeAll)
+                {
+                    info.excluded = true;
+                }
+            }
+
+            for (int i = 0; i < G4_MAX_SRCS; i++)
+            {
+                G4_Operand* src = inst->getSrc(i);
+                if (!src)
+                {
+                    continue;
+                }
+                if (src->isAddrExp())
+                {
+                    getInfo(src->asAddrExp()->getRegVar()->getDeclare()).excluded = true;
+                    continue;
+                }
+                G4_Declare* topDcl = src->getTopDcl();
+                if (!topDcl)
+                {
+                    continue;
+                }
+                DclInfo& info = getInfo(topDcl);
+                if (excludeAll || !src->isSrcRegRegion() ||
+                    src->asSrcRegRegion()->getRegAccess() != Direct)
+                {
+                    info.excluded = true;
+                    continue;
+                }
+                info.uses.push_back(std::make_pair(inst, (unsigned int) i));
+            }
+
+            if (inst->isSend() && inst->getMsgDesc())
+            {
+                // bti/sti are referenced from the message descriptor as well
+                G4_Operand* descOpnds[2] = { inst->getMsgDesc()->getBti(), inst->getMsgDesc()->getSti() };
+                for (auto opnd : descOpnds)
+                {
+                    if (opnd && opnd->getTopDcl())
+                    {
+                        getInfo(opnd->getTopDcl()).excluded = true;
+                    }
+                }
+            }
+        }
+    }
+}
+
+//
+// The dst of inst is a full definition of a variable that has no other definitions.
+//
+bool GVN::isSSALikeDst(G4_INST* inst)
+{
+    G4_DstRegRegion* dst = inst->getDst();
+    if (!dst || dst->isNullReg() || dst->getRegAccess() != Direct ||
+        !dst->getBase()->isRegVar())
+    {
+        return false;
+    }
+
+    G4_Declare* dcl = dst->getTopDcl();
+    if (!dcl || dcl->getAliasDeclare())
+    {
+        return false;
+    }
+
+    const DclInfo& info = dclInfo[dcl->getDeclId()];
+    if (info.numDefs != 1 || info.excluded || info.hasAliases)
+    {
+        return false;
+    }
+
+    if (dcl->getRegFile() != G4_GRF || dcl->getAddressed() || dcl->isInput() ||
+        dcl->isOutput() || dcl->getRegVar()->isPhyRegAssigned())
+    {
+        return false;
+    }
+
+    // the whole variable is written
+    return dst->getRegOff() == 0 && dst->getSubRegOff() == 0 && dst->getHorzStride() == 1 &&
+        inst->getExecSize() * G4_Type_Table[dst->getType()].byteSize == dcl->getByteSize();
+}
+
+//
+// dcl may be numbered as a whole after all of its definitions in one BB are seen.
+//
+bool GVN::isPiecewiseVar(G4_Declare* dcl) const
+{
+    const DclInfo& info = dclInfo[dcl->getDeclId()];
+    if (info.numDefs < 2 || info.multiBBDefs || info.excluded || info.hasAliases)
+    {
+        return false;
+    }
+    return dcl->getRegFile() == G4_GRF && !dcl->getAddressed() && !dcl->isInput() &&
+        !dcl->isOutput() && !dcl->getRegVar()->isPhyRegAssigned();
+}
+
+//
+// inst is an unconditional NoMask write of part of a piecewise variable.
+//
+bool GVN::isPiecewiseDef(G4_INST* inst) const
+{
+    G4_DstRegRegion* dst = inst->getDst();
+    return isCandidateOpcode(inst) && !inst->getPredicate() && !inst->getCondMod() &&
+        inst->isWriteEnableInst() && dst->getRegAccess() == Direct &&
+        dst->getBase()->isRegVar() && !dst->getTopDcl()->getAliasDeclare();
+}
+
+bool GVN::isCandidateOpcode(G4_INST* inst) const
+{
+    if (inst->getImplAccSrc() || inst->getImplAccDst() || inst->hasACCOpnd())
+    {
+        return false;
+    }
+
+    switch (inst->opcode())
+    {
+    case G4_mov:
+    case G4_add:
+    case G4_mul:
+    case G4_and:
+    case G4_or:
+    case G4_xor:
+    case G4_not:
+    case G4_shl:
+    case G4_shr:
+    case G4_asr:
+    case G4_avg:
+    case G4_frc:
+    case G4_rndd:
+    case G4_rndu:
+    case G4_rnde:
+    case G4_rndz:
+    case G4_lzd:
+    case G4_fbh:
+    case G4_fbl:
+    case G4_cbit:
+    case G4_bfrev:
+    case G4_bfe:
+    case G4_bfi1:
+    case G4_bfi2:
+    case G4_mad:
+    case G4_pseudo_mad:
+    case G4_math:
+        return true;
+    default:
+        return false;
+    }
+}
+
+//
+// Append the value of src to key. Returns false if src can not be value numbered.
+//
+bool GVN::getSrcKey(G4_Operand* src, Key& key)
+{
+    if (src->isImm())
+    {
+        key.push_back(1);
+        key.push_back(src->getType());
+        key.push_back(src->asImm()->getImm());
+        return true;
+    }
+
+    if (!src->isSrcRegRegion())
+    {
+        return false;
+    }
+
+    G4_SrcRegRegion* srcRgn = src->asSrcRegRegion();
+    if (srcRgn->getRegAccess() != Direct || !srcRgn->getBase()->isRegVar() ||
+        srcRgn->isAreg())
+    {
+        return false;
+    }
+
+    G4_Declare* topDcl = srcRgn->getTopDcl();
+    if (!topDcl)
+    {
+        return false;
+    }
+    uint32_t aliasOffset = 0;
+    G4_Declare* rootDcl = topDcl->getRootDeclare(aliasOffset);
+    const DclInfo& info = dclInfo[rootDcl->getDeclId()];
+    if (!rootDcl->useGRF() || rootDcl->getAddressed() || info.excluded)
+    {
+        return false;
+    }
+
+    // The value read is the same wherever the variable is never written in the kernel,
+    // or written once by a definition that dominates the read.
+    if (info.numDefs > 1 || (info.numDefs == 1 && !info.available))
+    {
+        return false;
+    }
+
+    RegionDesc* rd = srcRgn->getRegion();
+    key.push_back(2);
+    key.push_back(rootDcl->getDeclId());
+    key.push_back(aliasOffset);
+    key.push_back(srcRgn->getRegOff());
+    key.push_back(srcRgn->getSubRegOff());
+    key.push_back(srcRgn->getType());
+    key.push_back(srcRgn->getModifier());
+    key.push_back(rd->vertStride);
+    key.push_back(rd->width);
+    key.push_back(rd->horzStride);
+    return true;
+}
+
+//
+// Append the predicate to key. Returns false if the flag it reads can not be value numbered.
+//
+bool GVN::getPredKey(G4_Predicate* pred, Key& key)
+{
+    G4_Declare* topDcl = pred->getTopDcl();
+    if (!topDcl)
+    {
+        return false;
+    }
+    uint32_t aliasOffset = 0;
+    G4_Declare* rootDcl = topDcl->getRootDeclare(aliasOffset);
+    const DclInfo& info = dclInfo[rootDcl->getDeclId()];
+    if (info.excluded || rootDcl->getRegVar()->isPhyRegAssigned())
+    {
+        return false;
+    }
+    if (info.numDefs > 1 || (info.numDefs == 1 && !info.available))
+    {
+        return false;
+    }
+
+    key.push_back(3);
+    key.push_back(rootDcl->getDeclId());
+    key.push_back(aliasOffset);
+    key.push_back(pred->getSubRegOff());
+    key.push_back(pred->getState());
+    key.push_back(pred->getControl());
+    key.push_back(pred->getAlign16PredicateControl());
+    return true;
+}
+
+bool GVN::computeKey(G4_INST* inst, Key& key)
+{
+    key.clear();
+    key.push_back(inst->opcode());
+    key.push_back(inst->isMath() ? inst->asMathInst()->getMathCtrl() : 0);
+    key.push_back(inst->getExecSize());
+    key.push_back(inst->getMaskOffset());
+    key.push_back(inst->getDst()->getType());
+    key.push_back(inst->getSaturate());
+
+    int numSrc = inst->getNumSrc();
+    std::vector<Key> srcKeys(numSrc);
+    for (int i = 0; i < numSrc; i++)
+    {
+        G4_Operand* src = inst->getSrc(i);
+        if (!src || !getSrcKey(src, srcKeys[i]))
+        {
+            return false;
+        }
+    }
+
+    switch (inst->opcode())
+    {
+    case G4_add:
+    case G4_mul:
+    case G4_and:
+    case G4_or:
+    case G4_xor:
+    case G4_avg:
+        // commutative, use a canonical operand order
+        if (numSrc == 2 && srcKeys[1] < srcKeys[0])
+        {
+            std::swap(srcKeys[0], srcKeys[1]);
+        }
+        break;
+    default:
+        break;
+    }
+
+    key.push_back(numSrc);
+    for (auto& srcKey : srcKeys)
+    {
+        key.insert(key.end(), srcKey.begin(), srcKey.end());
+    }
+    return true;
+}
+
+//
+// The leader's dst holds the value of inst for every channel inst may write.
+//
+bool GVN::canReuse(G4_INST* leader, G4_BB* leaderBB, G4_INST* inst, G4_BB* bb) const
+{
+    if (leader->isWriteEnableInst())
+    {
+        // all channels are written
+        return true;
+    }
+    if (inst->isWriteEnableInst())
+    {
+        return false;
+    }
+    if (leaderBB == bb)
+    {
+        // same channel mask
+        return leader->getMaskOption() == inst->getMaskOption();
+    }
+    // all dispatched channels executed the leader
+    return !leaderBB->isInSimdFlow();
+}
+
+bool GVN::canReplaceUses(G4_Declare* from, G4_Declare* to) const
+{
+    if (from->getElemType() != to->getElemType() ||
+        from->getTotalElems() != to->getTotalElems())
+    {
+        return false;
+    }
+    if (from->getAlign() != Either && to->getAlign() != Either &&
+        from->getAlign() != to->getAlign())
+    {
+        return false;
+    }
+    return true;
+}
+
+void GVN::replaceUses(G4_Declare* from, G4_Declare* to)
+{
+    if (to->getAlign() == Either)
+    {
+        to->setAlign(from->getAlign());
+    }
+    if (to->getSubRegAlign() < from->getSubRegAlign())
+    {
+        to->setSubRegAlign(from->getSubRegAlign());
+    }
+    to->setIsRefInSendDcl(from->getIsRefInSendDcl());
+
+    DclInfo& fromInfo = dclInfo[from->getDeclId()];
+    DclInfo& toInfo = dclInfo[to->getDeclId()];
+    for (auto& use : fromInfo.uses)
+    {
+        G4_INST* useInst = use.first;
+        G4_SrcRegRegion* src = useInst->getSrc(use.second)->asSrcRegRegion();
+        MUST_BE_TRUE(src->getTopDcl() == from, "unexpected use in GVN");
+        G4_SrcRegRegion* newSrc = builder.createSrcRegRegion(src->getModifier(), Direct,
+            to->getRegVar(), src->getRegOff(), src->getSubRegOff(), src->getRegion(), src->getType());
+        useInst->setSrc(newSrc, use.second);
+        toInfo.uses.push_back(use);
+    }
+    fromInfo.uses.clear();
+    fromInfo.excluded = true;
+}
+
+const std::pair<G4_INST*, G4_BB*>* GVN::findLeader(const Key& key) const
+{
+    auto iter = valueTable.find(key);
+    if (iter == valueTable.end() || iter->second.empty())
+    {
+        return nullptr;
+    }
+    return &iter->second.back();
+}
+
+//
+// Delete every definition of the piecewise variable dcl in bb and rewrite its
+// uses to leaderDcl, which holds the same value.
+//
+void GVN::removePiecewiseDefs(G4_BB* bb, G4_Declare* dcl, G4_BB* leaderBB, G4_Declare* leaderDcl)
+{
+    replaceUses(dcl, leaderDcl);
+
+    // the uses are not transferred to the leader's definitions
+    for (auto defIt : dclInfo[leaderDcl->getDeclId()].piecewiseDefs)
+    {
+        kernel.fg.globalOpndHT.addGlobalOpnd((*defIt)->getDst());
+    }
+
+    DclInfo& info = dclInfo[dcl->getDeclId()];
+    for (auto defIt : info.piecewiseDefs)
+    {
+        G4_INST* def = *defIt;
+        def->removeAllUses();
+        def->removeAllDefs();
+        bb->erase(defIt);
+        numInstsRemoved++;
+        if (leaderBB != bb)
+        {
+            numCrossBBRemoved++;
+        }
+    }
+    info.piecewiseDefs.clear();
+}
+
+void GVN::processBB(G4_BB* bb, std::vector<const Key*>& scopeKeys, std::vector<G4_Declare*>& scopeDefs)
+{
+    Key key;
+    Key predKey;
+    for (auto it = bb->begin(); it != bb->end();)
+    {
+        G4_INST* inst = *it;
+        G4_DstRegRegion* dst = inst->getDst();
+        G4_Declare* dstDcl = dst && !dst->isNullReg() && dst->getTopDcl() ?
+            dst->getTopDcl()->getRootDeclare() : nullptr;
+
+        // a piecewise variable read before all of its definitions can not be replaced
+        for (int i = 0; i < G4_MAX_SRCS; i++)
+        {
+            G4_Operand* src = inst->getSrc(i);
+            if (src && src->isSrcRegRegion() && src->getTopDcl())
+            {
+                DclInfo& info = dclInfo[src->getTopDcl()->getRootDeclare()->getDeclId()];
+                if (info.numDefs > 1 && info.piecewiseDefs.size() < info.numDefs)
+                {
+                    info.piecewiseValid = false;
+                }
+            }
+        }
+
+        if (dstDcl && isPiecewiseVar(dstDcl))
+        {
+            DclInfo& info = dclInfo[dstDcl->getDeclId()];
+            info.piecewiseDefs.push_back(it);
+            if (info.piecewiseValid && isPiecewiseDef(inst) && computeKey(inst, key))
+            {
+                if (info.piecewiseKey.empty())
+                {
+                    info.piecewiseKey.push_back(-1);
+                }
+                info.piecewiseKey.push_back(dst->getRegOff());
+                info.piecewiseKey.push_back(dst->getSubRegOff());
+                info.piecewiseKey.push_back(dst->getHorzStride());
+                info.piecewiseKey.insert(info.piecewiseKey.end(), key.begin(), key.end());
+            }
+            else
+            {
+                info.piecewiseValid = false;
+            }
+
+            if (info.piecewiseValid && info.piecewiseDefs.size() == info.numDefs)
+            {
+                auto entry = valueTable.emplace(info.piecewiseKey, std::vector<std::pair<G4_INST*, G4_BB*>>());
+                auto& leaders = entry.first->second;
+                if (!leaders.empty())
+                {
+                    G4_BB* leaderBB = leaders.back().second;
+                    G4_Declare* leaderDcl = leaders.back().first->getDst()->getTopDcl();
+                    if (canReplaceUses(dstDcl, leaderDcl))
+                    {
+                        // all definitions are NoMask, so every channel of the leader is written
+                        ++it;
+                        removePiecewiseDefs(bb, dstDcl, leaderBB, leaderDcl);
+                        continue;
+                    }
+                }
+                leaders.push_back(std::make_pair(inst, bb));
+                scopeKeys.push_back(&entry.first->first);
+            }
+        }
+
+        G4_Predicate* pred = inst->getPredicate();
+        if (isSSALikeDst(inst) && isCandidateOpcode(inst) && computeKey(inst, key))
+        {
+            // A predicated instruction is numbered with its predicate. It may also
+            // reuse an unpredicated value, which covers every channel it writes.
+            bool numbered = true;
+            if (pred)
+            {
+                predKey = key;
+                numbered = getPredKey(pred, predKey);
+            }
+            const Key& instKey = pred ? predKey : key;
+
+            if (numbered)
+            {
+                const std::pair<G4_INST*, G4_BB*>* leaderEntry = findLeader(instKey);
+                if (!leaderEntry && pred)
+                {
+                    leaderEntry = findLeader(key);
+                }
+
+                // the flag written by a condition modifier is not tracked, so keep the instruction
+                if (leaderEntry && !inst->getCondMod())
+                {
+                    G4_INST* leader = leaderEntry->first;
+                    G4_BB* leaderBB = leaderEntry->second;
+                    G4_Declare* leaderDcl = leader->getDst()->getTopDcl();
+                    if (canReuse(leader, leaderBB, inst, bb) && canReplaceUses(dstDcl, leaderDcl))
+                    {
+                        replaceUses(dstDcl, leaderDcl);
+                        if (kernel.fg.globalOpndHT.isOpndGlobal(dst))
+                        {
+                            kernel.fg.globalOpndHT.addGlobalOpnd(leader->getDst());
+                        }
+                        if (leaderBB == bb)
+                        {
+                            inst->transferUse(leader, true);
+                        }
+                        else
+                        {
+                            // cross-BB uses are not tracked by local def-use
+                            kernel.fg.globalOpndHT.addGlobalOpnd(leader->getDst());
+                            inst->removeAllUses();
+                            numCrossBBRemoved++;
+                        }
+                        inst->removeAllDefs();
+                        it = bb->erase(it);
+                        numInstsRemoved++;
+                        continue;
+                    }
+                }
+
+                auto entry = valueTable.emplace(instKey, std::vector<std::pair<G4_INST*, G4_BB*>>());
+                entry.first->second.push_back(std::make_pair(inst, bb));
+                scopeKeys.push_back(&entry.first->first);
+            }
+        }
+
+        if (dstDcl && dclInfo[dstDcl->getDeclId()].numDefs == 1)
+        {
+            dclInfo[dstDcl->getDeclId()].available = true;
+            scopeDefs.push_back(dstDcl);
+        }
+        G4_CondMod* condMod = inst->getCondMod();
+        if (condMod && condMod->getTopDcl())
+        {
+            G4_Declare* flagDcl = condMod->getTopDcl()->getRootDeclare();
+            if (dclInfo[flagDcl->getDeclId()].numDefs == 1)
+            {
+                dclInfo[flagDcl->getDeclId()].available = true;
+                scopeDefs.push_back(flagDcl);
+            }
+        }
+        ++it;
+    }
+}
+
+void GVN::run()
+{
+    if (kernel.fg.getHasStackCalls() || kernel.fg.getIsStackCallFunc())
+    {
+        // stack call arguments and return values are defined implicitly
+        return;
+    }
+
+    collectDefUse();
+
+    DomTree& domTree = kernel.fg.getDomTree();
+    std::vector<std::vector<G4_BB*>> children(kernel.fg.getNumBB());
+    std::vector<G4_BB*> roots;
+    for (auto bb : kernel.fg.BBs)
+    {
+        if (!domTree.isReachable(bb))
+        {
+            continue;
+        }
+        G4_BB* idom = domTree.getIDom(bb);
+        if (idom)
+        {
+            children[idom->getId()].push_back(bb);
+        }
+        else
+        {
+            roots.push_back(bb);
+        }
+    }
+
+    // Pre-order walk of the dominator tree. Values and definitions made
+    // available by a block are dropped once its subtree is done.
+    struct ScopeEntry
+    {
+        G4_BB* bb;
+        size_t childIdx;
+        size_t numKeys;
+        size_t numDefs;
+    };
+    std::vector<const Key*> scopeKeys;
+    std::vector<G4_Declare*> scopeDefs;
+    std::vector<ScopeEntry> stack;
+    for (auto root : roots)
+    {
+        stack.push_back({ root, 0, scopeKeys.size(), scopeDefs.size() });
+        processBB(root, scopeKeys, scopeDefs);
+        while (!stack.empty())
+        {
+            ScopeEntry& top = stack.back();
+            auto& succs = children[top.bb->getId()];
+            if (top.childIdx < succs.size())
+            {
+                G4_BB* child = succs[top.childIdx++];
+                stack.push_back({ child, 0, scopeKeys.size(), scopeDefs.size() });
+                processBB(child, scopeKeys, scopeDefs);
+                continue;
+            }
+
+            while (scopeKeys.size() > top.numKeys)
+            {
+                valueTable[*scopeKeys.back()].pop_back();
+                scopeKeys.pop_back();
+            }
+            while (scopeDefs.size() > top.numDefs)
+            {
+                dclInfo[scopeDefs.back()->getDeclId()].available = false;
+                scopeDefs.pop_back();
+            }
+            stack.pop_back();
+        }
+    }
+    valueTable.clear();
+}
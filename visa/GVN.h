@@ -0,0 +1,133 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+#ifndef _G4_GVN_H_
+#define _G4_GVN_H_
+
+#include "FlowGraph.h"
+#include "BuildIR.h"
+#include <unordered_map>
+#include <vector>
+
+namespace vISA
+{
+//
+// Dominator-tree scoped global value numbering on G4 IR.
+//
+// G4 IR is not in SSA form, so GVN only considers values held by variables
+// that behave like SSA values: root GRF declares with exactly one definition
+// that writes the whole variable, are not address-taken, aliased, input or
+// output, and are not referenced by pseudo kill/lifetime instructions. Source
+// operands may additionally read variables that are never defined in the
+// kernel (r0, kernel arguments, ...), or single-definition variables whose
+// definition dominates the read.
+//
+// When the value computed by an instruction is already available in a
+// variable defined by a dominating instruction, all uses of the redundant
+// variable are rewritten to the dominating one and the instruction is deleted.
+// A value computed under a SIMD control-flow mask is only reused by
+// instructions that are guaranteed to run with a subset of its channels.
+//
+// Predicated instructions are numbered together with their predicate, which
+// must read a flag that is defined at most once and whose definition
+// dominates the instruction. They reuse a value computed under the same
+// predicate or an unpredicated one. Instructions with a condition modifier
+// may provide a value but are never deleted, as their flag result is not
+// tracked. Accumulator instructions are never numbered.
+//
+// Variables written piecewise by several NoMask definitions in a single block,
+// typically message headers, are numbered as a whole once their last
+// definition is seen, provided that no instruction reads them before that.
+// All definitions of a redundant variable are deleted together.
+//
+class GVN
+{
+public:
+    GVN(G4_Kernel& k, IR_Builder& b) : kernel(k), builder(b) {}
+
+    void run();
+
+    unsigned int getNumInstsRemoved() const { return numInstsRemoved; }
+    unsigned int getNumCrossBBRemoved() const { return numCrossBBRemoved; }
+
+private:
+    typedef std::vector<int64_t> Key;
+
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const
+        {
+            size_t h = key.size();
+            for (auto v : key)
+            {
+                h ^= std::hash<int64_t>()(v) + 0x9e3779b9 + (h << 6) + (h >> 2);
+            }
+            return h;
+        }
+    };
+
+    struct DclInfo
+    {
+        unsigned int numDefs = 0;
+        G4_INST* def = nullptr;
+        bool hasAliases = false;
+        // can not be value numbered, e.g. referenced by pseudo kill
+        bool excluded = false;
+        // the single def has been visited on the current dominator tree path
+        bool available = false;
+        std::vector<std::pair<G4_INST*, unsigned int>> uses;    // (inst, src index)
+        // state of a variable with several definitions in a single BB
+        G4_BB* defBB = nullptr;
+        bool multiBBDefs = false;
+        bool piecewiseValid = true;
+        std::vector<INST_LIST_ITER> piecewiseDefs;  // definitions seen so far
+        Key piecewiseKey;
+    };
+
+    G4_Kernel& kernel;
+    IR_Builder& builder;
+    std::vector<DclInfo> dclInfo;       // indexed by root declare id
+    // value -> (defining inst, BB) on the current dominator tree path, innermost last
+    std::unordered_map<Key, std::vector<std::pair<G4_INST*, G4_BB*>>, KeyHash> valueTable;
+    unsigned int numInstsRemoved = 0;
+    unsigned int numCrossBBRemoved = 0;
+
+    void collectDefUse();
+    bool isSSALikeDst(G4_INST* inst);
+    bool isCandidateOpcode(G4_INST* inst) const;
+    bool computeKey(G4_INST* inst, Key& key);
+    bool getSrcKey(G4_Operand* src, Key& key);
+    bool getPredKey(G4_Predicate* pred, Key& key);
+    bool isPiecewiseVar(G4_Declare* dcl) const;
+    bool isPiecewiseDef(G4_INST* inst) const;
+    const std::pair<G4_INST*, G4_BB*>* findLeader(const Key& key) const;
+    bool canReuse(G4_INST* leader, G4_BB* leaderBB, G4_INST* inst, G4_BB* bb) const;
+    bool canReplaceUses(G4_Declare* from, G4_Declare* to) const;
+    void replaceUses(G4_Declare* from, G4_Declare* to);
+    void removePiecewiseDefs(G4_BB* bb, G4_Declare* dcl, G4_BB* leaderBB, G4_Declare* leaderDcl);
+    void processBB(G4_BB* bb, std::vector<const Key*>& scopeKeys, std::vector<G4_Declare*>& scopeDefs);
+};
+}
+#endif
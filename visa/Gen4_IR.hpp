@@ -108,8 +108,7 @@ namespace vISA
 
         pointer allocate(size_type n, const void * = 0)
         {
-            T* t = (T*)mem_manager_ptr->alloc(n * sizeof(T));
-            return t;
+            return mem_manager_ptr->allocAligned<T>(n);
         }
 
         void deallocate(void* p, size_type)
@@ -41,6 +41,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Rematerialization.h"
 #include "RPE.h"
 #include "Optimizer.h"
+#include "HWConformity.h"
 #include <cmath>  // sqrt
 
 using namespace std;
@@ -99,6 +100,11 @@ static const unsigned IN_LOOP_REFERENCE_COUNT_FACTOR = 4;
 #define BANK_CONFLICT_SIMD8_OVERHEAD_CYCLE     1
 #define BANK_CONFLICT_SIMD16_OVERHEAD_CYCLE    2
 #define INTERNAL_CONFLICT_RATIO_HEURISTIC 0.25
+#define BANK_CONFLICT_HEURISTIC_LOOP_INST 0.1
+#define BANK_CONFLICT_REPAIR_MAX_CANDIDATES 32
+#define ACC_RA_REG_PRESSURE_RATIO 0.85
+#define ACC_RA_LOOP_REG_PRESSURE_RATIO 0.75
+#define LINEAR_SCAN_MAX_EVICTIONS 8
 
 
 Interference::Interference(LivenessAnalysis* l, LiveRange**& lr, unsigned n, unsigned ns, unsigned nm,
@@ -1021,6 +1027,8 @@ bool BankConflictPass::setupBankConflictsForKernel(G4_Kernel& kernel, bool doLoc
     unsigned int internalConflict = 0;
     unsigned int instNumInKernel = 0;
     unsigned int sendInstNumInKernel = 0;
+    unsigned int threeSourceInstNumInLoops = 0;
+    unsigned int instNumInLoops = 0;
 
     for (BB_LIST_ITER it = kernel.fg.BBs.begin();
         it != kernel.fg.BBs.end();
@@ -1050,6 +1058,12 @@ bool BankConflictPass::setupBankConflictsForKernel(G4_Kernel& kernel, bool doLoc
 
         if (threeSourceInstNum)
         {
+            if (bb->getNestLevel())
+            {
+                threeSourceInstNumInLoops += threeSourceInstNum;
+                instNumInLoops += (uint32_t)bb->size();
+            }
+
             instNum = (uint32_t)bb->size() * loopNestLevel * BANK_CONFLICT_HEURISTIC_LOOP_ITERATION;
             threeSourceInstNum = threeSourceInstNum * loopNestLevel * BANK_CONFLICT_HEURISTIC_LOOP_ITERATION;
             sendInstNum = sendInstNum * loopNestLevel * BANK_CONFLICT_HEURISTIC_LOOP_ITERATION;
@@ -1062,8 +1076,14 @@ bool BankConflictPass::setupBankConflictsForKernel(G4_Kernel& kernel, bool doLoc
         }
     }
 
+    // Loops dense in three source instructions are worth biasing for
+    // even if such instructions are rare in rest of kernel.
+    bool threeSourceLoops = threeSourceInstNumInLoops &&
+        (float)threeSourceInstNumInLoops / instNumInLoops >= BANK_CONFLICT_HEURISTIC_LOOP_INST;
+
     if (!threeSourceInstNumInKernel ||
-        (float)threeSourceInstNumInKernel / instNumInKernel < BANK_CONFLICT_HEURISTIC_INST)
+        ((float)threeSourceInstNumInKernel / instNumInKernel < BANK_CONFLICT_HEURISTIC_INST &&
+         !threeSourceLoops))
     {
         return false;
     }
@@ -1094,6 +1114,406 @@ bool BankConflictPass::setupBankConflictsForKernel(G4_Kernel& kernel, bool doLoc
     return true;
 }
 
+LiveRange* BankConflictPass::getSrcLiveRange(G4_Operand* src, GraphColor& coloring)
+{
+    if (!src || !src->isSrcRegRegion() || src->isAccReg() ||
+        !src->getBase()->isRegVar())
+    {
+        return nullptr;
+    }
+
+    G4_Declare* dcl = src->getTopDcl();
+    if (!dcl || dcl->getRegFile() != G4_GRF ||
+        !dcl->getRegVar()->isRegAllocPartaker())
+    {
+        return nullptr;
+    }
+
+    return coloring.getLiveRanges()[dcl->getRegVar()->getId()];
+}
+
+bool BankConflictPass::getSrcGRF(G4_Operand* src, GraphColor& coloring, unsigned int& reg)
+{
+    if (!src || !src->isSrcRegRegion() || src->isAccReg() ||
+        !src->getBase()->isRegVar())
+    {
+        return false;
+    }
+
+    G4_Declare* dcl = src->getTopDcl();
+    if (!dcl)
+    {
+        return false;
+    }
+
+    // Use tentative assignment of live-range if register is not confirmed yet
+    G4_VarBase* phyReg = dcl->getRegVar()->getPhyReg();
+    unsigned int subRegOff = dcl->getRegVar()->getPhyRegOff();
+    LiveRange* lr = getSrcLiveRange(src, coloring);
+    if (!phyReg && lr)
+    {
+        phyReg = lr->getPhyReg();
+        subRegOff = lr->getPhyRegOff();
+    }
+
+    if (!phyReg || !phyReg->isGreg())
+    {
+        return false;
+    }
+
+    reg = phyReg->asGreg()->getRegNum() +
+        (subRegOff * G4_Type_Table[dcl->getElemType()].byteSize + src->getLeftBound()) / G4_GRF_REG_NBYTES;
+
+    return true;
+}
+
+bool BankConflictPass::hasAssignedConflict(G4_INST* inst, GraphColor& coloring)
+{
+    unsigned int regNum[3];
+    for (int i = 0; i < 3; i++)
+    {
+        if (!getSrcGRF(inst->getSrc(i), coloring, regNum[i]))
+        {
+            return false;
+        }
+    }
+
+    return gra.kernel.fg.builder->isBankConflict(regNum);
+}
+
+unsigned int BankConflictPass::getConflictCost(LiveRange* lr1, LiveRange* lr2, GraphColor& coloring)
+{
+    // Sum of loop weighted conflicts of three source instructions
+    // referencing either live-range.
+    unsigned int cost = 0;
+    std::unordered_set<G4_INST*> visited;
+    for (auto lr : { lr1, lr2 })
+    {
+        auto refIt = threeSrcRefs.find(lr);
+        if (refIt == threeSrcRefs.end())
+        {
+            continue;
+        }
+
+        for (auto inst : (*refIt).second)
+        {
+            if (visited.insert(inst).second &&
+                hasAssignedConflict(inst, coloring))
+            {
+                cost += threeSrcWeight[inst];
+            }
+        }
+    }
+
+    return cost;
+}
+
+bool BankConflictPass::getGRFSpan(LiveRange* lr, unsigned int& start, unsigned int& numRows)
+{
+    G4_VarBase* phyReg = lr->getPhyReg();
+    unsigned int subRegOff = lr->getPhyRegOff();
+    if (!phyReg)
+    {
+        phyReg = lr->getVar()->getPhyReg();
+        subRegOff = lr->getVar()->getPhyRegOff();
+    }
+
+    if (!phyReg || !phyReg->isGreg())
+    {
+        return false;
+    }
+
+    G4_Declare* dcl = lr->getDcl();
+    start = phyReg->asGreg()->getRegNum();
+    numRows = (subRegOff * G4_Type_Table[dcl->getElemType()].byteSize + dcl->getByteSize() - 1) / G4_GRF_REG_NBYTES + 1;
+
+    return true;
+}
+
+bool BankConflictPass::canSwapRegs(LiveRange* lr)
+{
+    if (!lr || lr->getRegKind() != G4_GRF ||
+        !lr->getPhyReg() || !lr->getPhyReg()->isGreg())
+    {
+        return false;
+    }
+
+    // Pre-assigned, split and specially constrained ranges keep their registers
+    G4_Declare* dcl = lr->getDcl();
+    return !lr->getVar()->getPhyReg() &&
+        !lr->getEOTSrc() && !lr->isRetIp() && !lr->getIsPseudoNode() &&
+        !lr->getIsPartialDcl() && !lr->getIsSplittedDcl() &&
+        !dcl->getAddressed() && !dcl->isInput() && !dcl->isOutput() &&
+        !dcl->isSpilled();
+}
+
+bool BankConflictPass::isLegalSwap(LiveRange* lr1, LiveRange* lr2, GraphColor& coloring)
+{
+    unsigned int start1 = 0, numRows1 = 0, start2 = 0, numRows2 = 0;
+    if (!getGRFSpan(lr1, start1, numRows1) ||
+        !getGRFSpan(lr2, start2, numRows2) ||
+        numRows1 != numRows2)
+    {
+        return false;
+    }
+
+    auto isAligned = [](G4_Align align, unsigned int from, unsigned int to)
+    {
+        switch (align)
+        {
+        case Either:
+            return true;
+        case Even:
+        case Odd:
+            return (from & 0x1) == (to & 0x1);
+        default:
+            return (from & 0x3) == (to & 0x3);
+        }
+    };
+
+    if (!isAligned(lr1->getVar()->getAlignment(), start1, start2) ||
+        !isAligned(lr2->getVar()->getAlignment(), start2, start1))
+    {
+        return false;
+    }
+
+    auto isForbidden = [this](LiveRange* lr, unsigned int start, unsigned int numRows)
+    {
+        const bool* forbidden = lr->getForbidden();
+        for (unsigned int i = start; i < start + numRows; i++)
+        {
+            if (fixedGRFs[i] || (forbidden && forbidden[i]))
+            {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    if (isForbidden(lr1, start2, numRows1) ||
+        isForbidden(lr2, start1, numRows2))
+    {
+        return false;
+    }
+
+    // No neighbor of a range may occupy GRFs it moves in to. Ranges that
+    // were allowed to share registers with it stay legal as they do not
+    // interfere.
+    Interference* intf = coloring.getIntf();
+    LiveRange** lrs = coloring.getLiveRanges();
+    auto overlapsNeighbor = [&](LiveRange* lr, LiveRange* other, unsigned int start, unsigned int numRows)
+    {
+        for (auto id : intf->getSparseIntfForVar(lr->getVar()->getId()))
+        {
+            LiveRange* neighbor = lrs[id];
+            unsigned int neighborStart = 0, neighborRows = 0;
+            if (neighbor == other ||
+                !getGRFSpan(neighbor, neighborStart, neighborRows))
+            {
+                continue;
+            }
+
+            if (neighborStart < start + numRows &&
+                start < neighborStart + neighborRows)
+            {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    return !overlapsNeighbor(lr1, lr2, start2, numRows1) &&
+        !overlapsNeighbor(lr2, lr1, start1, numRows2);
+}
+
+void BankConflictPass::swapRegs(LiveRange* lr1, LiveRange* lr2)
+{
+    // Exchange GRFs, each range keeps its sub-register offset
+    G4_VarBase* phyReg1 = lr1->getPhyReg();
+    unsigned int subRegOff1 = lr1->getPhyRegOff();
+    lr1->setPhyReg(lr2->getPhyReg(), subRegOff1);
+    lr2->setPhyReg(phyReg1, lr2->getPhyRegOff());
+}
+
+unsigned int BankConflictPass::countBankConflicts(GraphColor& coloring)
+{
+    unsigned int numConflicts = 0;
+    for (auto bb : gra.kernel.fg.BBs)
+    {
+        for (auto inst : *bb)
+        {
+            if (inst->getNumSrc() == 3 && !inst->isSend() &&
+                hasAssignedConflict(inst, coloring))
+            {
+                numConflicts++;
+            }
+        }
+    }
+
+    return numConflicts;
+}
+
+//
+// Post-RA repair of bank conflicts left over by biased assignment. For each
+// three source instruction whose srcs still collide, hottest first, look for
+// a live-range of same size whose GRFs can be exchanged with those of one of
+// the srcs. Exchange is done only if it is legal per interference graph,
+// alignment and forbidden registers and lowers loop weighted conflicts of
+// all instructions referencing either range.
+//
+void BankConflictPass::repairBankConflicts(GraphColor& coloring, LivenessAnalysis& liveness)
+{
+    G4_Kernel& kernel = gra.kernel;
+    LiveRange** lrs = coloring.getLiveRanges();
+
+    // GRFs held by variables that do not take part in RA
+    fixedGRFs.assign(kernel.getNumRegTotal(), false);
+    for (auto dcl : kernel.Declares)
+    {
+        G4_RegVar* var = dcl->getRegVar();
+        if (dcl->getAliasDeclare() || var->isRegAllocPartaker() ||
+            !var->getPhyReg() || !var->getPhyReg()->isGreg())
+        {
+            continue;
+        }
+
+        unsigned int start = var->getPhyReg()->asGreg()->getRegNum();
+        unsigned int numRows = (var->getPhyRegOff() * G4_Type_Table[dcl->getElemType()].byteSize +
+            dcl->getByteSize() - 1) / G4_GRF_REG_NBYTES + 1;
+        for (unsigned int i = start; i < start + numRows && i < fixedGRFs.size(); i++)
+        {
+            fixedGRFs[i] = true;
+        }
+    }
+
+    threeSrcRefs.clear();
+    threeSrcWeight.clear();
+    std::vector<G4_INST*> conflicts;
+    for (auto bb : kernel.fg.BBs)
+    {
+        unsigned int weight = GlobalRA::getRefCount(bb->getNestLevel());
+        for (auto inst : *bb)
+        {
+            if (inst->getNumSrc() != 3 || inst->isSend())
+            {
+                continue;
+            }
+
+            threeSrcWeight[inst] = weight;
+            for (int i = 0; i < 3; i++)
+            {
+                LiveRange* lr = getSrcLiveRange(inst->getSrc(i), coloring);
+                if (lr)
+                {
+                    auto& refs = threeSrcRefs[lr];
+                    if (refs.empty() || refs.back() != inst)
+                    {
+                        refs.push_back(inst);
+                    }
+                }
+            }
+
+            if (hasAssignedConflict(inst, coloring))
+            {
+                conflicts.push_back(inst);
+            }
+        }
+    }
+
+    unsigned int numConflictsBefore = countBankConflicts(coloring);
+    unsigned int numSwaps = 0;
+
+    std::stable_sort(conflicts.begin(), conflicts.end(),
+        [this](G4_INST* inst1, G4_INST* inst2) { return threeSrcWeight[inst1] > threeSrcWeight[inst2]; });
+
+    std::vector<LiveRange*> candidates;
+    for (unsigned int i = 0, numVar = liveness.getNumSelectedVar(); i < numVar; i++)
+    {
+        if (canSwapRegs(lrs[i]))
+        {
+            candidates.push_back(lrs[i]);
+        }
+    }
+
+    for (auto inst : conflicts)
+    {
+        // May have been fixed by an earlier swap
+        if (!hasAssignedConflict(inst, coloring))
+        {
+            continue;
+        }
+
+        bool repaired = false;
+        for (int i = 0; i < 3 && !repaired; i++)
+        {
+            LiveRange* lr = getSrcLiveRange(inst->getSrc(i), coloring);
+            unsigned int start = 0, numRows = 0;
+            if (!canSwapRegs(lr) || !getGRFSpan(lr, start, numRows))
+            {
+                continue;
+            }
+
+            unsigned int numTried = 0;
+            for (auto candidate : candidates)
+            {
+                unsigned int candidateStart = 0, candidateRows = 0;
+                if (candidate == lr ||
+                    !getGRFSpan(candidate, candidateStart, candidateRows) ||
+                    candidateRows != numRows)
+                {
+                    continue;
+                }
+
+                // Every candidate evaluated below counts against the limit,
+                // whether or not it passes the filter.
+                if (numTried++ >= BANK_CONFLICT_REPAIR_MAX_CANDIDATES)
+                {
+                    break;
+                }
+
+                // Cheap filter first, swap must fix current instruction and
+                // reduce overall conflicts.
+                unsigned int costBefore = getConflictCost(lr, candidate, coloring);
+                swapRegs(lr, candidate);
+                bool fixed = !hasAssignedConflict(inst, coloring);
+                unsigned int costAfter = getConflictCost(lr, candidate, coloring);
+                swapRegs(lr, candidate);
+
+                if (!fixed || costAfter >= costBefore)
+                {
+                    continue;
+                }
+
+                if (isLegalSwap(lr, candidate, coloring))
+                {
+                    swapRegs(lr, candidate);
+                    numSwaps++;
+                    repaired = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    unsigned int numConflictsAfter = countBankConflicts(coloring);
+
+    if (kernel.getOption(vISA_RATrace))
+    {
+        std::cout << "\t--bank conflict repair: " << numConflictsBefore << " -> " << numConflictsAfter <<
+            " conflicts, " << numSwaps << " swaps\n";
+    }
+
+    if (kernel.getOption(vISA_OptReport))
+    {
+        std::ofstream optreport;
+        getOptReportStream(optreport, kernel.getOptions());
+        optreport << "===== Bank conflict repair =====" << std::endl;
+        optreport << "Kernel " << kernel.getName() << ": " << numConflictsBefore <<
+            " conflicts before repair, " << numConflictsAfter << " after (" << numSwaps << " register swaps)" << std::endl;
+        closeOptReportStream(optreport);
+    }
+}
+
 void GlobalRA::emitFGWithLiveness(LivenessAnalysis& liveAnalysis)
 {
     for (BB_LIST_ITER it = kernel.fg.BBs.begin();
@@ -5146,6 +5566,56 @@ void GraphColor::computeSpillCosts(bool useSplitLLRHeuristic)
     std::vector <LiveRange *> addressSensitiveVars;
     float maxNormalCost = 0.0f;
 
+    // Loop nest level of the deepest loop header each live range is live
+    // into, and of its deepest reference. A range that is live through a
+    // deeper loop than any of its references can be spilled without putting
+    // spill code in that loop, so it is made proportionally cheaper to spill.
+    std::vector<unsigned char> liveNestLevel, refNestLevel;
+    if (m_options->getOption(vISA_ConsiderLoopInfoInRA) &&
+        !builder.kernel.fg.naturalLoops.empty())
+    {
+        liveNestLevel.resize(numVar, 0);
+        refNestLevel.resize(numVar, 0);
+        for (auto&& loop : builder.kernel.fg.naturalLoops)
+        {
+            G4_BB* header = loop.first.second;
+            for (unsigned i = 0; i < numVar; i++)
+            {
+                if (liveAnalysis.isLiveAtEntry(header, i))
+                {
+                    liveNestLevel[i] = std::max(liveNestLevel[i], header->getNestLevel());
+                }
+            }
+        }
+
+        auto updateRefNestLevel = [&](G4_Operand* opnd, unsigned char nestLevel)
+        {
+            if (opnd && opnd->getBase() && opnd->getBase()->isRegAllocPartaker())
+            {
+                unsigned id = opnd->getBase()->asRegVar()->getId();
+                if (id < numVar)
+                {
+                    refNestLevel[id] = std::max(refNestLevel[id], nestLevel);
+                }
+            }
+        };
+        for (auto bb : builder.kernel.fg.BBs)
+        {
+            if (bb->getNestLevel() == 0)
+            {
+                continue;
+            }
+            for (auto inst : *bb)
+            {
+                updateRefNestLevel(inst->getDst(), bb->getNestLevel());
+                for (int j = 0; j < G4_MAX_SRCS; j++)
+                {
+                    updateRefNestLevel(inst->getSrc(j), bb->getNestLevel());
+                }
+            }
+        }
+    }
+
     for (unsigned i = 0; i < numVar; i++)
     {
         G4_Declare* dcl = lrs[i]->getDcl();
@@ -5229,6 +5699,11 @@ void GraphColor::computeSpillCosts(bool useSplitLLRHeuristic)
                     lrs[i]->getDegree() : 1.0f*lrs[i]->getRefCount()*lrs[i]->getRefCount() / (lrs[i]->getDegree() + 1);
             }
 
+            if (!liveNestLevel.empty() && liveNestLevel[i] > refNestLevel[i])
+            {
+                spillCost /= GlobalRA::getRefCount(liveNestLevel[i] - refNestLevel[i]);
+            }
+
             lrs[i]->setSpillCost(spillCost);
 
             // Track address sensitive live range.
@@ -6038,12 +6513,54 @@ void GlobalRA::determineSpillRegSize(unsigned& spillRegSize, unsigned& indrSpill
 }
 
 
-bool GraphColor::regAlloc(bool doBankConflictReduction,
-    bool highInternalConflict,
-    bool reserveSpillReg, unsigned& spillRegSize, unsigned& indrSpillRegSize,
-    RPE* rpe)
+void GraphColor::setupSubRegAlignment()
 {
-    
+    for (unsigned i = 0; i < numVar; i++)
+    {
+        G4_Declare* dcl = lrs[i]->getDcl();
+
+        if (dcl->getSubRegAlign() == Any &&
+            !dcl->getIsPartialDcl())
+        {
+            //
+            // multi-row, subreg alignment = 16 words
+            //
+            if (dcl->getNumRows() > 1)
+            {
+                lrs[i]->getVar()->setSubRegAlignment(Sixteen_Word);
+            }
+            //
+            // single-row
+            //
+            else
+            {
+                if (lrs[i]->getVar()->getSubRegAlignment() == Any)
+                {
+                    //
+                    // set up Odd word or Even word sub reg alignment
+                    //
+                    unsigned nbytes = dcl->getNumElems()* G4_Type_Table[dcl->getElemType()].byteSize;
+                    unsigned nwords = nbytes / G4_WSIZE + nbytes%G4_WSIZE;
+                    if (nwords >= 2 && lrs[i]->getRegKind() == G4_GRF)
+                    {
+                        lrs[i]->getVar()->setSubRegAlignment(Even_Word);
+                    }
+                    else
+                    {
+                        lrs[i]->getVar()->setSubRegAlignment(Any);
+                    }
+                }
+            }
+        }
+    }
+}
+
+bool GraphColor::regAlloc(bool doBankConflictReduction,
+    bool highInternalConflict,
+    bool reserveSpillReg, unsigned& spillRegSize, unsigned& indrSpillRegSize,
+    RPE* rpe)
+{
+    
     bool useSplitLLRHeuristic = false;
 
     if (builder.getOption(vISA_RATrace))
@@ -6120,44 +6637,7 @@ bool GraphColor::regAlloc(bool doBankConflictReduction,
     //
     // Set up the sub-reg alignment from declare information
     //
-    for (unsigned i = 0; i < numVar; i++)
-    {
-        G4_Declare* dcl = lrs[i]->getDcl();
-
-        if (dcl->getSubRegAlign() == Any &&
-            !dcl->getIsPartialDcl())
-        {
-            //
-            // multi-row, subreg alignment = 16 words
-            //
-            if (dcl->getNumRows() > 1)
-            {
-                lrs[i]->getVar()->setSubRegAlignment(Sixteen_Word);
-            }
-            //
-            // single-row
-            //
-            else
-            {
-                if (lrs[i]->getVar()->getSubRegAlignment() == Any)
-                {
-                    //
-                    // set up Odd word or Even word sub reg alignment
-                    //
-                    unsigned nbytes = dcl->getNumElems()* G4_Type_Table[dcl->getElemType()].byteSize;
-                    unsigned nwords = nbytes / G4_WSIZE + nbytes%G4_WSIZE;
-                    if (nwords >= 2 && lrs[i]->getRegKind() == G4_GRF)
-                    {
-                        lrs[i]->getVar()->setSubRegAlignment(Even_Word);
-                    }
-                    else
-                    {
-                        lrs[i]->getVar()->setSubRegAlignment(Any);
-                    }
-                }
-            }
-        }
-    }
+    setupSubRegAlignment();
     //
     // assign registers for GRFs/MRFs, GRFs are first attempted to be assigned using round-robin and if it fails
     // then we retry using a first-fit heuristic; for MRFs we always use the round-robin heuristic
@@ -6235,6 +6715,372 @@ bool GraphColor::regAlloc(bool doBankConflictReduction,
     return (requireSpillCode() == false);
 }
 
+//
+// Compute a single conservative interval [start, end] per live range over the
+// linear instruction order. A range live into or out of a BB covers the whole
+// BB, so every point where it is live (including around loop back-edges)
+// falls inside its interval. Endpoints are inclusive: a range whose last use
+// is at an instruction overlaps any range defined by that same instruction.
+// Reference counts and EOT/return-ip attributes normally set up during
+// interference construction are computed here as well.
+//
+void GraphColor::computeLiveIntervals(std::vector<unsigned int>& start, std::vector<unsigned int>& end)
+{
+    start.assign(numVar, UINT_MAX);
+    end.assign(numVar, 0);
+
+    auto extend = [&](unsigned int id, unsigned int pos)
+    {
+        start[id] = std::min(start[id], pos);
+        end[id] = std::max(end[id], pos);
+    };
+
+    auto extendLive = [&](const BitSet& liveSet, const BitSet& defSet, unsigned int pos)
+    {
+        for (unsigned int elt = 0; elt * NUM_BITS_PER_ELT < numVar; elt++)
+        {
+            BITSET_ARRAY_TYPE live = liveSet.getElt(elt) & defSet.getElt(elt);
+            for (unsigned int bit = 0; live != 0; bit++, live >>= 1)
+            {
+                if (live & 1)
+                {
+                    unsigned int id = elt * NUM_BITS_PER_ELT + bit;
+                    if (lrs[id]->getIsPartialDcl())
+                    {
+                        id = lrs[id]->getParentLRID();
+                    }
+                    extend(id, pos);
+                }
+            }
+        }
+    };
+
+    auto getLRId = [this](G4_Operand* opnd, unsigned int& id)
+    {
+        if (!opnd || !opnd->getBase() || !opnd->getBase()->isRegAllocPartaker())
+        {
+            return false;
+        }
+        id = opnd->getBase()->asRegVar()->getId();
+        if (lrs[id]->getIsPartialDcl())
+        {
+            id = lrs[id]->getParentLRID();
+        }
+        return true;
+    };
+
+    bool considerLoop = builder.getOption(vISA_ConsiderLoopInfoInRA);
+    unsigned int pos = 0;
+    for (auto bb : kernel.fg.BBs)
+    {
+        unsigned int bbStart = pos;
+        unsigned int bbEnd = bb->empty() ? pos : pos + (unsigned int)bb->size() - 1;
+        unsigned int bbId = bb->getId();
+        extendLive(liveAnalysis.use_in[bbId], liveAnalysis.def_in[bbId], bbStart);
+        extendLive(liveAnalysis.use_out[bbId], liveAnalysis.def_out[bbId], bbEnd);
+
+        unsigned int refCount = GlobalRA::getRefCount(considerLoop ? bb->getNestLevel() : 0);
+        pos = bbEnd;
+        for (auto it = bb->rbegin(), itEnd = bb->rend(); it != itEnd; ++it, --pos)
+        {
+            G4_INST* inst = *it;
+            unsigned int id = 0;
+
+            if (getLRId(inst->getDst(), id))
+            {
+                extend(id, pos);
+                if (!inst->isPseudoKill() && !inst->isLifeTimeEnd())
+                {
+                    lrs[id]->setRefCount(lrs[id]->getRefCount() + refCount);
+                }
+                if (inst->getDst()->getRegAccess() == Direct)
+                {
+                    lrs[id]->checkForInfiniteSpillCost(bb, it);
+                }
+            }
+
+            for (unsigned int i = 0; i < G4_MAX_SRCS; i++)
+            {
+                G4_Operand* src = inst->getSrc(i);
+                if (!src || !src->isSrcRegRegion() || !getLRId(src, id))
+                {
+                    continue;
+                }
+                extend(id, pos);
+                lrs[id]->setRefCount(lrs[id]->getRefCount() + refCount);
+
+                if (inst->isEOT())
+                {
+                    lrs[id]->setEOTSrc();
+                    if (builder.hasEOTGRFBinding())
+                    {
+                        lrs[id]->markForbidden(0, kernel.getOptions()->getuInt32Option(vISA_TotalGRFNum) - 16);
+                    }
+                }
+                if (inst->isReturn())
+                {
+                    lrs[id]->setRetIp();
+                }
+            }
+        }
+        pos = bb->empty() ? bbStart : bbEnd + 1;
+    }
+
+    // Indirectly accessed ranges are conservatively live everywhere, as
+    // their uses through address registers are not visible here.
+    unsigned int lastPos = pos == 0 ? 0 : pos - 1;
+    for (unsigned int i = 0; i < numVar; i++)
+    {
+        if (liveAnalysis.isAddressSensitive(i) && !lrs[i]->getIsPartialDcl())
+        {
+            extend(i, 0);
+            extend(i, lastPos);
+        }
+    }
+}
+
+//
+// Linear-scan GRF assignment over the intervals computed above. Compile time
+// is roughly linear in the number of ranges as no interference graph is
+// built, at the cost of allocation quality: intervals have no holes and no
+// bank conflict reduction is done. When no register is free, the cheapest
+// active ranges (by references per interval length) are evicted if that
+// frees enough space, otherwise the current range spills.
+//
+bool GraphColor::linearScanRegAlloc(bool reserveSpillReg, unsigned& spillRegSize, unsigned& indrSpillRegSize)
+{
+    MUST_BE_TRUE(liveAnalysis.livenessClass(G4_GRF), "linear scan RA only handles GRF");
+
+    if (builder.getOption(vISA_RATrace))
+    {
+        std::cout << "\t--# variables: " << liveAnalysis.getNumSelectedVar() << "\n";
+        std::cout << "\t--linear scan\n";
+    }
+
+    unsigned reserveSpillSize = 0;
+    if (reserveSpillReg)
+    {
+        gra.determineSpillRegSize(spillRegSize, indrSpillRegSize);
+        reserveSpillSize = spillRegSize + indrSpillRegSize;
+        MUST_BE_TRUE(reserveSpillSize < getOptions()->getuInt32Option(vISA_TotalGRFNum), "Invalid reserveSpillSize in fail-safe RA!");
+        totalGRFRegCount -= reserveSpillSize;
+    }
+
+    createLiveRanges(reserveSpillSize);
+    for (unsigned i = 0; i < numVar; i++)
+    {
+        if (lrs[i]->getVar()->getPhyReg())
+        {
+            lrs[i]->setPhyReg(lrs[i]->getVar()->getPhyReg(), lrs[i]->getVar()->getPhyRegOff());
+        }
+    }
+
+    std::vector<unsigned int> start, end;
+    computeLiveIntervals(start, end);
+
+    startTimer(TIMER_COLORING);
+    computeSpillCosts(false);
+    setupSubRegAlignment();
+
+    // Ranges with a fixed register only block their registers; all others
+    // are assigned in order of increasing start.
+    std::vector<unsigned int> order, fixed, unreferenced;
+    for (unsigned i = 0; i < numVar; i++)
+    {
+        LiveRange* lr = lrs[i];
+        if (lr->getIsPartialDcl() || lr->getVar()->isSpilled())
+        {
+            continue;
+        }
+        if (lr->getPhyReg())
+        {
+            if (start[i] != UINT_MAX)
+            {
+                fixed.push_back(i);
+            }
+        }
+        else if (start[i] == UINT_MAX)
+        {
+            unreferenced.push_back(i);
+        }
+        else
+        {
+            order.push_back(i);
+        }
+    }
+    auto byStart = [&start](unsigned int a, unsigned int b)
+    {
+        return start[a] < start[b] || (start[a] == start[b] && a < b);
+    };
+    std::sort(order.begin(), order.end(), byStart);
+    std::sort(fixed.begin(), fixed.end(), byStart);
+
+    // Spill weight: infinite-cost ranges never spill and address sensitive
+    // ranges only spill after all normal ones, as in graph coloring.
+    auto cheaperToSpill = [&](unsigned int a, unsigned int b)
+    {
+        auto rank = [&](unsigned int id)
+        {
+            return lrs[id]->getSpillCost() == MAXSPILLCOST ? 2 :
+                (liveAnalysis.isAddressSensitive(id) ? 1 : 0);
+        };
+        int rankA = rank(a), rankB = rank(b);
+        if (rankA != rankB)
+        {
+            return rankA < rankB;
+        }
+        float weightA = (float)lrs[a]->getRefCount() / (end[a] - start[a] + 1);
+        float weightB = (float)lrs[b]->getRefCount() / (end[b] - start[b] + 1);
+        return weightA < weightB;
+    };
+
+    unsigned startARFReg = 0;
+    unsigned startFLAGReg = 0;
+    unsigned startGRFReg = 0;
+    unsigned bank1_start = 0;
+    unsigned bank1_end = 0;
+    unsigned bank2_start = totalGRFRegCount - 1;
+    unsigned bank2_end = totalGRFRegCount - 1;
+    unsigned int totalGRFNum = getOptions()->getuInt32Option(vISA_TotalGRFNum);
+    bool* availableGregs = (bool *)mem.alloc(sizeof(bool)* totalGRFNum);
+    uint16_t* availableSubRegs = (uint16_t *)mem.alloc(sizeof(uint16_t)* totalGRFNum);
+    bool* availableAddrs = (bool *)mem.alloc(sizeof(bool)* getNumAddrRegisters());
+    bool* availableFlags = (bool *)mem.alloc(sizeof(bool)* getNumFlagRegisters());
+    uint8_t* weakEdgeUsage = (uint8_t*)mem.alloc(sizeof(uint8_t)*totalGRFNum);
+    unsigned maxGRFCanBeUsed = totalGRFRegCount;
+    PhyRegUsageParms parms(gra, lrs, G4_GRF, maxGRFCanBeUsed, startARFReg, startFLAGReg, startGRFReg, bank1_start, bank1_end, bank2_start, bank2_end,
+        false, availableGregs, availableSubRegs, availableAddrs, availableFlags, weakEdgeUsage);
+    bool noIndirForceSpills = builder.getOption(vISA_NoIndirectForceSpills);
+
+    // Fixed ranges overlapping the current one: those started already are
+    // swept along in fixedActive, those starting within it are found from
+    // nextFixed onwards.
+    std::vector<unsigned int> active, fixedActive;
+    size_t nextFixed = 0;
+    auto tryAssign = [&](unsigned int id, const std::vector<unsigned int>& evicted)
+    {
+        LiveRange* lr = lrs[id];
+        if (lr->getDcl()->getNumRows() > totalGRFNum)
+        {
+            return false;
+        }
+
+        PhyRegUsage regUsage(parms);
+        for (auto a : active)
+        {
+            if (std::find(evicted.begin(), evicted.end(), a) == evicted.end())
+            {
+                regUsage.updateRegUsage(lrs[a]);
+            }
+        }
+        for (auto f : fixedActive)
+        {
+            regUsage.updateRegUsage(lrs[f]);
+        }
+        for (size_t i = nextFixed; i < fixed.size() && start[fixed[i]] <= end[id]; i++)
+        {
+            regUsage.updateRegUsage(lrs[fixed[i]]);
+        }
+        return regUsage.assignRegs(false, lr, lr->getForbidden(),
+            lr->getVar()->getAlignment(), lr->getVar()->getSubRegAlignment(), FIRST_FIT, lr->getSpillCost());
+    };
+
+    for (auto id : order)
+    {
+        LiveRange* lr = lrs[id];
+
+        // expire ranges that ended before this one starts
+        active.erase(std::remove_if(active.begin(), active.end(),
+            [&](unsigned int a) { return end[a] < start[id]; }), active.end());
+        fixedActive.erase(std::remove_if(fixedActive.begin(), fixedActive.end(),
+            [&](unsigned int f) { return end[f] < start[id]; }), fixedActive.end());
+        for (; nextFixed < fixed.size() && start[fixed[nextFixed]] <= start[id]; nextFixed++)
+        {
+            if (end[fixed[nextFixed]] >= start[id])
+            {
+                fixedActive.push_back(fixed[nextFixed]);
+            }
+        }
+
+        if (forceSpill &&
+            !(noIndirForceSpills && liveAnalysis.isAddressSensitive(id)) &&
+            lr->getRefCount() != 0 &&
+            lr->getSpillCost() != MAXSPILLCOST)
+        {
+            spilledLRs.push_back(lr);
+            continue;
+        }
+
+        std::vector<unsigned int> evicted;
+        if (tryAssign(id, evicted))
+        {
+            active.push_back(id);
+            continue;
+        }
+
+        // Try to make room by evicting active ranges cheaper than this one.
+        std::vector<unsigned int> candidates;
+        for (auto a : active)
+        {
+            if (cheaperToSpill(a, id))
+            {
+                candidates.push_back(a);
+            }
+        }
+        std::sort(candidates.begin(), candidates.end(), cheaperToSpill);
+        if (candidates.size() > LINEAR_SCAN_MAX_EVICTIONS)
+        {
+            candidates.resize(LINEAR_SCAN_MAX_EVICTIONS);
+        }
+
+        bool assigned = false;
+        for (auto victim : candidates)
+        {
+            evicted.push_back(victim);
+            if (tryAssign(id, evicted))
+            {
+                assigned = true;
+                break;
+            }
+        }
+
+        if (assigned)
+        {
+            for (auto victim : evicted)
+            {
+                lrs[victim]->resetPhyReg();
+                spilledLRs.push_back(lrs[victim]);
+            }
+            active.erase(std::remove_if(active.begin(), active.end(),
+                [&](unsigned int a) { return std::find(evicted.begin(), evicted.end(), a) != evicted.end(); }),
+                active.end());
+            active.push_back(id);
+        }
+        else
+        {
+            spilledLRs.push_back(lr);
+        }
+    }
+
+    // Ranges without any reference interfere with nothing.
+    for (auto id : unreferenced)
+    {
+        LiveRange* lr = lrs[id];
+        PhyRegUsage regUsage(parms);
+        if (lr->getDcl()->getNumRows() > totalGRFNum ||
+            !regUsage.assignRegs(false, lr, lr->getForbidden(),
+                lr->getVar()->getAlignment(), lr->getVar()->getSubRegAlignment(), FIRST_FIT, lr->getSpillCost()))
+        {
+            spilledLRs.push_back(lr);
+        }
+    }
+
+    kernel.setRAType(RA_Type::LINEAR_SCAN_RA);
+
+    stopTimer(TIMER_COLORING);
+    return (requireSpillCode() == false);
+}
+
 void GraphColor::confirmRegisterAssignments()
 {
     for (unsigned i = 0; i < numVar; i++)
@@ -8684,6 +9530,207 @@ bool VarSplit::canDoGlobalSplit(IR_Builder& builder, G4_Kernel &kernel, uint32_t
     return false;
 }
 
+// Copy srcDcl to dstDcl in front of insertPos. dstDcl is killed first so the
+// copy is seen as a full definition.
+void VarSplit::insertLoopSplitCopy(IR_Builder& builder, G4_Declare* dstDcl, G4_Declare* srcDcl, G4_BB* bb, INST_LIST_ITER insertPos)
+{
+    auto killDst = builder.createDstRegRegion(Direct, dstDcl->getRegVar(), 0, 0, 1, Type_UD);
+    G4_INST* kill = builder.createInternalInst(nullptr, G4_pseudo_kill, nullptr, false, 1,
+        killDst, nullptr, nullptr, InstOpt_WriteEnable);
+    bb->insert(insertPos, kill);
+
+    unsigned int numRows = srcDcl->getByteSize() / G4_GRF_REG_NBYTES;
+    for (unsigned int row = 0; row < numRows;)
+    {
+        unsigned int rowsToCopy = (numRows - row) >= 2 ? 2 : 1;
+        unsigned char execSize = (unsigned char)(rowsToCopy * G4_GRF_REG_NBYTES / G4_Type_Table[Type_UD].byteSize);
+        auto dst = builder.createDstRegRegion(Direct, dstDcl->getRegVar(), (short)row, 0, 1, Type_UD);
+        auto src = builder.createSrcRegRegion(Mod_src_undef, Direct, srcDcl->getRegVar(), (short)row, 0,
+            builder.getRegionStride1(), Type_UD);
+        G4_INST* mov = builder.createInternalInst(nullptr, G4_mov, nullptr, false, execSize,
+            dst, src, nullptr, InstOpt_WriteEnable);
+        bb->insert(insertPos, mov);
+        row += rowsToCopy;
+    }
+}
+
+//
+// Split spilled live ranges around loops they are live across but not
+// referenced in. For such a variable V and loop L, V is copied to a new
+// variable in L's preheader and copied back at each exit of L where V is
+// live, i.e.,
+//
+//      preheader:  V' = V                  V is no longer live in L. V' is
+//      L:          ... (no ref to V)  =>   live across L with no references,
+//      exit:       V = V'                  so spilling it places the spill
+//                                          and fill outside of L.
+//
+// Only loops with a unique preheader and exits whose predecessors are all in
+// the loop are handled, and each variable is split around its outermost such
+// loop. Returns true if the IR changed.
+//
+bool VarSplit::loopSplit(IR_Builder& builder, const LivenessAnalysis& liveAnalysis, const LIVERANGE_LIST& spilledLRs)
+{
+    if (kernel.fg.naturalLoops.empty() || kernel.fg.getHasStackCalls() || kernel.fg.getIsStackCallFunc())
+    {
+        return false;
+    }
+
+    // Root GRF variables that are safe to copy as a whole
+    std::set<G4_Declare*> candidates;
+    for (auto lr : spilledLRs)
+    {
+        G4_RegVar* var = lr->getVar();
+        G4_Declare* dcl = lr->getDcl();
+        if (var->isRegVarTransient() || var->isRegVarTmp() || dcl->getAliasDeclare() ||
+            dcl->getRegFile() != G4_GRF || dcl->getAddressed() || dcl->isInput() || dcl->isOutput() ||
+            dcl->isDoNotSpill() || dcl->getIsSplittedDcl() || dcl->getIsPartialDcl() ||
+            dcl->getByteSize() % G4_GRF_REG_NBYTES != 0 ||
+            liveAnalysis.isAddressSensitive(var->getId()))
+        {
+            continue;
+        }
+        candidates.insert(dcl);
+    }
+    for (auto dcl : kernel.Declares)
+    {
+        if (dcl->getAliasDeclare())
+        {
+            candidates.erase(dcl->getRootDeclare());
+        }
+    }
+    if (candidates.empty())
+    {
+        return false;
+    }
+
+    // Outermost loops first
+    std::vector<std::pair<FlowGraph::Edge, const FlowGraph::Blocks*>> loops;
+    for (auto&& loop : kernel.fg.naturalLoops)
+    {
+        loops.push_back(std::make_pair(loop.first, &loop.second));
+    }
+    std::stable_sort(loops.begin(), loops.end(),
+        [](const std::pair<FlowGraph::Edge, const FlowGraph::Blocks*>& l1,
+            const std::pair<FlowGraph::Edge, const FlowGraph::Blocks*>& l2)
+    {
+        return l1.second->size() > l2.second->size();
+    });
+
+    bool changed = false;
+    std::set<G4_Declare*> splitDcls;
+    for (auto&& loop : loops)
+    {
+        G4_BB* header = loop.first.second;
+        const FlowGraph::Blocks& body = *loop.second;
+
+        G4_BB* preheader = nullptr;
+        bool canSplit = true;
+        for (auto pred : header->Preds)
+        {
+            if (body.find(pred) == body.end())
+            {
+                canSplit &= preheader == nullptr;
+                preheader = pred;
+            }
+        }
+        canSplit &= preheader != nullptr;
+
+        std::set<G4_BB*> exits;
+        std::set<G4_Declare*> refs;
+        auto addRef = [&refs](G4_Operand* opnd)
+        {
+            if (opnd && opnd->getTopDcl())
+            {
+                refs.insert(opnd->getTopDcl()->getRootDeclare());
+            }
+        };
+        for (auto bb : body)
+        {
+            if (!canSplit)
+            {
+                break;
+            }
+            if (bb->isEndWithCall() || bb->isEndWithFCall())
+            {
+                // callee references are not visible here
+                canSplit = false;
+                break;
+            }
+            for (auto succ : bb->Succs)
+            {
+                if (body.find(succ) == body.end())
+                {
+                    for (auto pred : succ->Preds)
+                    {
+                        canSplit &= body.find(pred) != body.end();
+                    }
+                    exits.insert(succ);
+                }
+            }
+            for (auto inst : *bb)
+            {
+                addRef(inst->getDst());
+                for (int i = 0; i < G4_MAX_SRCS; i++)
+                {
+                    addRef(inst->getSrc(i));
+                }
+                if (inst->isSend() && inst->getMsgDesc())
+                {
+                    addRef(inst->getMsgDesc()->getBti());
+                    addRef(inst->getMsgDesc()->getSti());
+                }
+            }
+        }
+
+        if (!canSplit || exits.empty())
+        {
+            continue;
+        }
+
+        for (auto dcl : candidates)
+        {
+            unsigned int id = dcl->getRegVar()->getId();
+            if (splitDcls.count(dcl) || refs.count(dcl) ||
+                !liveAnalysis.isLiveAtEntry(header, id))
+            {
+                continue;
+            }
+
+            const char* name = builder.getNameString(builder.mem, 32, "%s_LOOPSPLIT", dcl->getName());
+            G4_Declare* splitDcl = builder.createDeclareNoLookup(name, G4_GRF, G4_GRF_REG_NBYTES / G4_Type_Table[Type_UD].byteSize,
+                (unsigned short)(dcl->getByteSize() / G4_GRF_REG_NBYTES), Type_UD);
+
+            // copy to the split variable before leaving the preheader
+            auto preheaderPos = preheader->end();
+            if (!preheader->empty() && preheader->back()->isFlowControl())
+            {
+                preheaderPos--;
+            }
+            insertLoopSplitCopy(builder, splitDcl, dcl, preheader, preheaderPos);
+
+            for (auto exitBB : exits)
+            {
+                if (!liveAnalysis.isLiveAtEntry(exitBB, id))
+                {
+                    continue;
+                }
+                auto exitPos = exitBB->begin();
+                while (exitPos != exitBB->end() && ((*exitPos)->isLabel() || (*exitPos)->opcode() == G4_join))
+                {
+                    exitPos++;
+                }
+                insertLoopSplitCopy(builder, dcl, splitDcl, exitBB, exitPos);
+            }
+
+            splitDcls.insert(dcl);
+            changed = true;
+        }
+    }
+
+    return changed;
+}
+
 void VarSplit::globalSplit(IR_Builder& builder, G4_Kernel &kernel)
 {
     typedef std::list<std::tuple<G4_BB*, G4_Operand*, int, unsigned, INST_LIST_ITER>> SPLIT_OPERANDS;
@@ -9439,6 +10486,70 @@ bool GlobalRA::hybridRA(bool doBankConflictReduction, bool highInternalConflict,
     return true;
 }
 
+//
+// Relieve GRF pressure by assigning short-lived intermediates of mul/add/mac
+// chains to the accumulators. Only BBs whose pressure is close to the GRF
+// budget are considered; candidates and legality come from HWConformity's
+// acc substitution. Returns true if any GRF def was replaced with acc.
+//
+bool GlobalRA::accRegAlloc(RPE& rpe)
+{
+    if (!builder.doAccSub() || !builder.getOption(vISA_accSubstitution))
+    {
+        return false;
+    }
+
+    unsigned int numGRF = kernel.getNumRegTotal();
+    std::vector<G4_BB*> hotBBs;
+    for (auto bb : kernel.fg.BBs)
+    {
+        // reduction loops are where acc relief pays off most, so be more
+        // aggressive there
+        float ratio = bb->getNestLevel() > 0 ? ACC_RA_LOOP_REG_PRESSURE_RATIO : ACC_RA_REG_PRESSURE_RATIO;
+        unsigned int threshold = (unsigned int)(numGRF * ratio);
+        for (auto inst : *bb)
+        {
+            if (rpe.getRegisterPressure(inst) >= threshold)
+            {
+                hotBBs.push_back(bb);
+                break;
+            }
+        }
+    }
+
+    if (hotBBs.empty())
+    {
+        return false;
+    }
+
+    // acc substitution relies on up-to-date local def-use chains
+    kernel.fg.globalOpndHT.clearHashTable();
+    for (auto bb : kernel.fg.BBs)
+    {
+        for (auto inst : *bb)
+        {
+            inst->clearDef();
+            inst->clearUse();
+        }
+    }
+    kernel.fg.localDataFlowAnalysis();
+
+    vISA::Mem_Manager mem(1024);
+    HWConformity hwConf(builder, kernel, mem);
+    for (auto bb : hotBBs)
+    {
+        hwConf.accSubstitution(bb);
+    }
+
+    if (builder.getOption(vISA_RATrace))
+    {
+        std::cout << "\t--acc sub defs: " << hwConf.getNumAccSubDef() <<
+            ", uses: " << hwConf.getNumAccSubUse() << " in " << hotBBs.size() << " BBs\n";
+    }
+
+    return hwConf.getNumAccSubDef() > 0;
+}
+
 //
 // graph coloring entry point.  returns nonzero if RA fails
 //
@@ -9524,7 +10635,23 @@ int GlobalRA::coloringRegAlloc()
     bool useScratchMsgForSpill = builder.getOption(vISA_UseScratchMsgForSpills) &&
         globalScratchOffset < SCRATCH_MSG_LIMIT * 0.6 && !hasStackCall;
 
-    bool enableSpillSpaceCompression = builder.getOption(vISA_SpillSpaceCompression);
+    // Linear scan bounds compile time on huge kernels at the cost of code
+    // quality. It does not model stack call save/restore.
+    bool useLinearScan = false;
+    if (!hasStackCall && !isReRAPass())
+    {
+        unsigned int linearScanThreshold = builder.getOptions()->getuInt32Option(vISA_LinearScanRAThreshold);
+        unsigned int numInst = 0;
+        for (auto bb : kernel.fg.BBs)
+        {
+            numInst += (unsigned int)bb->size();
+        }
+        useLinearScan = builder.getOption(vISA_LinearScanRA) ||
+            (linearScanThreshold != 0 && numInst >= linearScanThreshold);
+    }
+
+    // spill slot sharing needs the interference graph
+    bool enableSpillSpaceCompression = builder.getOption(vISA_SpillSpaceCompression) && !useLinearScan;
 
     uint32_t nextSpillOffset = 0;
     uint32_t scratchOffset = 0;
@@ -9535,6 +10662,8 @@ int GlobalRA::coloringRegAlloc()
     unsigned failSafeRAIteration = builder.getOption(vISA_FastSpill) ? 1 : FAIL_SAFE_RA_LIMIT;
 
     bool rematDone = false;
+    unsigned int spillRematRounds = 0;
+    bool accRADone = false;
     VarSplit splitPass(*this);
     while (iterationNo < maxRAIterations)
     {
@@ -9556,7 +10685,7 @@ int GlobalRA::coloringRegAlloc()
         markGraphBlockLocalVars(false);
         
         //Do variable splitting in each iteration
-        if (builder.getOption(vISA_LocalDeclareSplitInGlobalRA))
+        if (builder.getOption(vISA_LocalDeclareSplitInGlobalRA) && !useLinearScan)
         {
             if (builder.getOption(vISA_RATrace))
             {
@@ -9572,7 +10701,8 @@ int GlobalRA::coloringRegAlloc()
         }
 
         if (builder.getOption(vISA_LocalBankConflictReduction) &&
-            builder.hasBankCollision())
+            builder.hasBankCollision() &&
+            !useLinearScan)
         {
             bool reduceBCInRR = false;
             bool reduceBCInTAandFF = false;
@@ -9622,7 +10752,9 @@ int GlobalRA::coloringRegAlloc()
 
             unsigned spillRegSize = 0;
             unsigned indrSpillRegSize = 0;
-            bool isColoringGood = coloring.regAlloc(doBankConflictReduction, highInternalConflict, reserveSpillReg, spillRegSize, indrSpillRegSize, &rpe);
+            bool isColoringGood = useLinearScan ?
+                coloring.linearScanRegAlloc(reserveSpillReg, spillRegSize, indrSpillRegSize) :
+                coloring.regAlloc(doBankConflictReduction, highInternalConflict, reserveSpillReg, spillRegSize, indrSpillRegSize, &rpe);
             if (isColoringGood == false)
             {
                 if (isReRAPass())
@@ -9639,10 +10771,12 @@ int GlobalRA::coloringRegAlloc()
                     (kernel.getOption(vISA_ForceRemat) || runRemat);
                 bool rematChange = false;
                 bool globalSplitChange = false;
+                bool rematInThisIter = false;
 
                 if (!rematDone &&
                     rematOff)
                 {
+                    rematInThisIter = true;
                     if (builder.getOption(vISA_RATrace))
                     {
                         std::cout << "\t--rematerialize\n";
@@ -9688,19 +10822,73 @@ int GlobalRA::coloringRegAlloc()
                     globalSplitChange = true;
                 }
 
+                // Short-lived mul/add/mac intermediates can live in acc
+                // instead of GRF; try this once before splitting or spilling.
+                bool accChange = false;
+                if (!accRADone &&
+                    kernel.getSimdSize() >= 16 &&
+                    !kernel.getOption(vISA_Debug))
+                {
+                    if (builder.getOption(vISA_RATrace))
+                    {
+                        std::cout << "\t--assign accumulators\n";
+                    }
+                    accChange = accRegAlloc(rpe);
+                    accRADone = true;
+                }
+
+                bool loopSplitChange = false;
+                if (iterationNo == 0 &&
+                    !splitPass.didLoopSplit &&
+                    builder.getOption(vISA_LoopSplit))
+                {
+                    if (builder.getOption(vISA_RATrace))
+                    {
+                        std::cout << "\t--split around loops\n";
+                    }
+                    loopSplitChange = splitPass.loopSplit(builder, liveAnalysis, coloring.getSpilledLiveRanges());
+                    splitPass.didLoopSplit = true;
+                }
+
                 if (iterationNo == 0 &&
-                    (rematChange || globalSplitChange))
+                    (rematChange || globalSplitChange || loopSplitChange))
                 {
                     continue;
                 }
 
+                // acc assignment runs once, so re-coloring after it cannot loop
+                if (accChange)
+                {
+                    continue;
+                }
+
+                // Before inserting spill code, try recomputing spilled ranges
+                // whose defs are cheaper to remat than to fill at each use.
+                if (rematDone &&
+                    !rematInThisIter &&
+                    spillRematRounds < MAX_SPILL_REMAT_ROUNDS)
+                {
+                    if (builder.getOption(vISA_RATrace))
+                    {
+                        std::cout << "\t--rematerialize spilled ranges\n";
+                    }
+                    Rematerialization spillRemat(kernel, liveAnalysis, coloring, rpe, true);
+                    spillRemat.run();
+                    spillRematRounds++;
+
+                    if (spillRemat.getChangesMade())
+                    {
+                        continue;
+                    }
+                }
+
                 //Calculate the spill caused by send to decide if global splitting is required or not
                 for (auto spilled : coloring.getSpilledLiveRanges())
                 {
                     GRFSpillFillCount += spilled->getRefCount();
                 }
 
-                if (builder.getOption(vISA_OptReport) && iterationNo == 0)
+                if (builder.getOption(vISA_OptReport) && iterationNo == 0 && !useLinearScan)
                 {
                     // Dump out interference graph information of spill candidates
                     reportSpillInfo(liveAnalysis, coloring);
@@ -9813,6 +11001,16 @@ int GlobalRA::coloringRegAlloc()
             // RA successfully allocates regs
             if (isColoringGood == true || reserveSpillReg)
             {
+                if (isColoringGood &&
+                    !reserveSpillReg &&
+                    !hasStackCall &&
+                    !useLinearScan &&
+                    builder.getOption(vISA_BankConflictRepair) &&
+                    builder.hasBankCollision())
+                {
+                    bc.repairBankConflicts(coloring, liveAnalysis);
+                }
+
                 coloring.confirmRegisterAssignments();
 
                 if (hasStackCall)
@@ -9842,13 +11040,16 @@ int GlobalRA::coloringRegAlloc()
                     case RA_Type::GRAPH_COLORING_FF_RA:
                         kernel.setRAType(RA_Type::GRAPH_COLORING_SPILL_FF_RA);
                         break;
+                    case RA_Type::LINEAR_SCAN_RA:
+                        kernel.setRAType(RA_Type::LINEAR_SCAN_SPILL_RA);
+                        break;
                     default:
                         assert(0);
                         break;
                     }
                 }
 
-                if (verifyAugmentation)
+                if (verifyAugmentation && !useLinearScan)
                 {
                     assignRegForAliasDcl();
                     computePhyReg();
@@ -46,11 +46,21 @@ namespace vISA
     const float MAXSPILLCOST = (std::numeric_limits<float>::max());
     const float MINSPILLCOST = -(std::numeric_limits<float>::max());
 
+    class GraphColor;
+    class LiveRange;
+
     class BankConflictPass
     {
     private:
         GlobalRA& gra;
 
+        // Weighted three source instructions referencing each live-range.
+        // Used by post-RA repair to evaluate register swaps.
+        std::unordered_map<LiveRange*, std::vector<G4_INST*>> threeSrcRefs;
+        std::unordered_map<G4_INST*, unsigned int> threeSrcWeight;
+        // GRFs held by variables not taking part in RA
+        std::vector<bool> fixedGRFs;
+
         BankConflict setupBankAccordingToSiblingOperand(BankConflict assignedBank, unsigned int offset, bool oneGRFBank);
         bool hasInternalConflict2Srcs(BankConflict*srcBC);
         void setupBankConflictsForDecls(G4_Declare* dcl_1, G4_Declare* dcl_2, unsigned int offset1, unsigned int offset2,
@@ -68,11 +78,21 @@ namespace vISA
         void getBanks(G4_INST* inst, BankConflict *srcBC, G4_Declare **dcls, G4_Declare **opndDcls, unsigned int *offset);
         void getPrevBanks(G4_INST* inst, BankConflict *srcBC, G4_Declare **dcls, G4_Declare **opndDcls, unsigned int *offset);
 
-
+        LiveRange* getSrcLiveRange(G4_Operand* src, GraphColor& coloring);
+        bool getSrcGRF(G4_Operand* src, GraphColor& coloring, unsigned int& reg);
+        bool hasAssignedConflict(G4_INST* inst, GraphColor& coloring);
+        unsigned int getConflictCost(LiveRange* lr1, LiveRange* lr2, GraphColor& coloring);
+        bool getGRFSpan(LiveRange* lr, unsigned int& start, unsigned int& numRows);
+        bool canSwapRegs(LiveRange* lr);
+        bool isLegalSwap(LiveRange* lr1, LiveRange* lr2, GraphColor& coloring);
+        void swapRegs(LiveRange* lr1, LiveRange* lr2);
 
     public:
         bool setupBankConflictsForKernel(G4_Kernel& kernel, bool doLocalRR, bool &threeSourceCandidate, unsigned int numRegLRA, bool &highInternalConflict);
 
+        unsigned int countBankConflicts(GraphColor& coloring);
+        void repairBankConflicts(GraphColor& coloring, LivenessAnalysis& liveness);
+
         BankConflictPass(GlobalRA& g) : gra(g)
         {
 
@@ -711,6 +731,8 @@ namespace vISA
         void relaxNeighborDegreeGRF(LiveRange* lr);
         void relaxNeighborDegreeARF(LiveRange* lr);
         bool assignColors(ColorHeuristic heuristicGRF, bool doBankConflict, bool highInternalConflict);
+        void setupSubRegAlignment();
+        void computeLiveIntervals(std::vector<unsigned int>& start, std::vector<unsigned int>& end);
 
         void clearSpillAddrLocSignature()
         {
@@ -731,6 +753,7 @@ namespace vISA
             bool doBankConflictReduction,
             bool highInternalConflict,
             bool reserveSpillReg, unsigned& spillRegSize, unsigned& indrSpillRegSize, RPE* rpe);
+        bool linearScanRegAlloc(bool reserveSpillReg, unsigned& spillRegSize, unsigned& indrSpillRegSize);
         bool requireSpillCode() { return !spilledLRs.empty(); }
         Interference * getIntf() { return &intf; }
         void createLiveRanges(unsigned reserveSpillSize = 0);
@@ -1271,6 +1294,7 @@ namespace vISA
         G4_Imm* createMsgDesc(unsigned owordSize, bool writeType, bool isSplitSend);
         void addrRegAlloc();
         void flagRegAlloc();
+        bool accRegAlloc(RPE& rpe);
         bool hybridRA(bool doBankConflictReduction, bool highInternalConflict, LocalRA& lra);
         void assignRegForAliasDcl();
         void removeSplitDecl();
@@ -1303,14 +1327,17 @@ namespace vISA
         void createSubDcls(G4_Kernel& kernel, G4_Declare* oldDcl, std::vector<G4_Declare*> &splitDclList);
         void insertMovesToTemp(IR_Builder& builder, G4_Declare* oldDcl, G4_Operand *dstOpnd, G4_BB* bb, INST_LIST_ITER instIter, std::vector<G4_Declare*> &splitDclList);
         void insertMovesFromTemp(G4_Kernel& kernel, G4_Declare* oldDcl, int index, G4_Operand *srcOpnd, int pos, G4_BB* bb, INST_LIST_ITER instIter, std::vector<G4_Declare*> &splitDclList);
+        void insertLoopSplitCopy(IR_Builder& builder, G4_Declare* dstDcl, G4_Declare* srcDcl, G4_BB* bb, INST_LIST_ITER insertPos);
 
     public:
         bool didLocalSplit = false;
         bool didGlobalSplit = false;
+        bool didLoopSplit = false;
 
         void localSplit(IR_Builder& builder, G4_BB* bb);
         void globalSplit(IR_Builder& builder, G4_Kernel &kernel);
         bool canDoGlobalSplit(IR_Builder& builder, G4_Kernel &kernel, uint32_t instNum, uint32_t spillRefCount, uint32_t sendSpillRefCount);
+        bool loopSplit(IR_Builder& builder, const LivenessAnalysis& liveAnalysis, const LIVERANGE_LIST& spilledLRs);
 
         VarSplit(GlobalRA& g) : kernel(g.kernel), gra(g)
         {
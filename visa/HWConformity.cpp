@@ -4839,16 +4839,27 @@ void HWConformity::accSubstitution(G4_BB* bb)
 
         if (inst->defAcc())
         {
-            // skip ahead till its single use
-            // we should only have single def/use acc at this point, so any use would 
-            // kill the def
-            auto iter = instIter;
-            auto useIter = std::find_if(++iter, instEnd, [](G4_INST* inst) { return inst->useAcc(); });
+            // skip ahead till its last use, i.e., the last acc use before acc is
+            // redefined. The def may have several uses if acc was already
+            // substituted (e.g., by GlobalRA::accRegAlloc()), so the first use
+            // does not kill it
+            auto useIter = instEnd;
+            for (auto iter = std::next(instIter); iter != instEnd; ++iter)
+            {
+                if ((*iter)->useAcc())
+                {
+                    useIter = iter;
+                }
+                if ((*iter)->defAcc())
+                {
+                    break;
+                }
+            }
             if (useIter == instEnd)
             {
                 return;
             }
-            instIter = --useIter; // start at the use inst next time 
+            instIter = --useIter; // start at the last use inst next time
             continue;
         }
 
@@ -4874,7 +4885,7 @@ void HWConformity::accSubstitution(G4_BB* bb)
         for (int instId = inst->getLocalId() + 1; instId != lastUseId; ++subIter, ++instId)
         {
             G4_INST* anInst = *subIter;
-            if (anInst->useAcc() || anInst->mayExpandToAccMacro())
+            if (anInst->useAcc() || anInst->defAcc() || anInst->mayExpandToAccMacro())
             {
                 canDoAccSub = false;
                 break;
@@ -5783,196 +5794,372 @@ void HWConformity::fixSelCsel(INST_LIST_ITER it, G4_BB* bb)
     }
 }
 
-void HWConformity::conformBB( BB_LIST_ITER it)
+static bool isBDW(IR_Builder&)
 {
-    G4_BB *bb = *it;
-    INST_LIST_ITER i = bb->begin(), iEnd = bb->end();
-    INST_LIST_ITER next_iter = i;
-    for ( ; i != iEnd; i = next_iter )
+    return getGenxPlatform() == GENX_BDW;
+}
+
+static bool lacksVxHFloat64b(IR_Builder& builder)
+{
+    return !builder.hasVxHFloat64b();
+}
+
+static bool lacks64bitRegioning(IR_Builder& builder)
+{
+    return builder.no64bitRegioning();
+}
+
+// The order of this table is significant: it is the order in which the
+// fixes are called for each instruction, and later fixes may assume the
+// operands have already been legalized by earlier ones.
+const HWConformity::ConformityFix HWConformity::conformityFixes[] =
+{
+    // do this early since otherwise the moves inserted by other fixes may still
+    // inherit bad regions from the original inst
+    { "SrcRegion", nullptr, IC_ANY, 0, &HWConformity::applySrcRegion },
+    { "Mov", nullptr, IC_MOV, 0, &HWConformity::applyMov },
+    { "OpndType", nullptr, IC_ANY, 0, &HWConformity::applyOpndType },
+    { "SelCsel", nullptr, IC_SEL, 0, &HWConformity::applySelCsel },
+    { "HFMath", nullptr, IC_MATH, 0, &HWConformity::applyHFMath },
+    { "3Src", nullptr, IC_3SRC, 0, &HWConformity::apply3Src },
+    { "Math", nullptr, IC_MATH, 0, &HWConformity::applyMath },
+    { "Mul", nullptr, IC_MUL, 0, &HWConformity::applyMul },
+    { "Mulh", nullptr, IC_MULH, 0, &HWConformity::applyMulh },
+    { "IndirectOpnd", nullptr, IC_ANY, OF_INDIRECT, &HWConformity::applyIndirectOpnd },
+    { "Compare", nullptr, IC_CMP, 0, &HWConformity::applyCompare },
+    { "Acc", nullptr, IC_ANY, OF_ACC, &HWConformity::applyAcc },
+    { "ScalarDstHstride", nullptr, IC_ANY, 0, &HWConformity::applyScalarDstHstride },
+    { "Plane", nullptr, IC_PLANE, 0, &HWConformity::applyPlane },
+    { "Line", nullptr, IC_LINE, 0, &HWConformity::applyLine },
+    { "Rotate", nullptr, IC_ROTATE, 0, &HWConformity::applyRotate },
+    { "VxHFloat64b", lacksVxHFloat64b, IC_ANY, OF_INDIRECT, &HWConformity::applyVxHFloat64b },
+    // CHV/BXT specific checks for 64b datatypes (dw*dw mul is treated as 64b)
+    { "64bRegioning", lacks64bitRegioning, IC_ANY, 0, &HWConformity::apply64bRegioning },
+    { "Imm64", nullptr, IC_ANY, OF_IMM64, &HWConformity::applyImm64 },
+    // FIXME: may be better to call fixDstAlign instead
+    { "PackedHFConversions", isBDW, IC_ANY, OF_HF_DST, &HWConformity::applyPackedHFConversions },
+};
+
+uint32_t HWConformity::getInstClass(G4_INST* inst)
+{
+    uint32_t instClass = 0;
+    switch (inst->opcode())
     {
-        // by default we skip the newly inserted instructions as we assume they are already HW conformed
-        // if a check may produce new instructions that violate HW rules, it must adjust the next_iter
-        // to point to them
-        ++next_iter;
-        G4_INST *inst = *i;
-        G4_opcode opcode = inst->opcode();
-        if (opcode == G4_nop || opcode == G4_label)
+    case G4_mov:
+        instClass |= IC_MOV;
+        break;
+    case G4_sel:
+    case G4_csel:
+        instClass |= IC_SEL;
+        break;
+    case G4_mul:
+        instClass |= IC_MUL;
+        break;
+    case G4_mulh:
+        instClass |= IC_MULH;
+        break;
+    case G4_cmp:
+    case G4_cmpn:
+        instClass |= IC_CMP;
+        break;
+    case G4_pln:
+        instClass |= IC_PLANE;
+        break;
+    case G4_line:
+        instClass |= IC_LINE;
+        break;
+    case G4_rol:
+    case G4_ror:
+        instClass |= IC_ROTATE;
+        break;
+    default:
+        break;
+    }
+    if (inst->isMath())
+    {
+        instClass |= IC_MATH;
+    }
+    if (inst->getNumSrc() == 3)
+    {
+        instClass |= IC_3SRC;
+    }
+    return instClass != 0 ? instClass : (uint32_t)IC_OTHER;
+}
+
+uint32_t HWConformity::getOpndFeatures(G4_INST* inst)
+{
+    uint32_t features = 0;
+    G4_DstRegRegion* dst = inst->getDst();
+    if (dst)
+    {
+        if (dst->getRegAccess() != Direct)
         {
-            continue;
+            features |= OF_INDIRECT;
         }
-
-        // do this early since otherwise the moves inserted by other passes may still
-        // inherit bad regions from the original inst
-        fixSrcRegion(inst);
-
-        bool changed = fixMov(i, bb);
-        if (changed)
+        if (dst->isAccReg())
+        {
+            features |= OF_ACC;
+        }
+        if (G4_Type_Table[dst->getType()].byteSize == 8)
+        {
+            features |= OF_64BIT;
+        }
+        if (dst->getType() == Type_HF)
         {
-            next_iter = i;
-            next_iter++;
+            features |= OF_HF_DST;
         }
+    }
 
-        fixOpndType(i, bb);
+    if (inst->opcode() == G4_mach || inst->hasImplicitAccSrc())
+    {
+        features |= OF_ACC;
+    }
 
-        fixSelCsel(i, bb);
+    for (int i = 0; i < G4_MAX_SRCS; i++)
+    {
+        G4_Operand* src = inst->getSrc(i);
+        if (!src)
+        {
+            continue;
+        }
+        if (src->isSrcRegRegion() && src->asSrcRegRegion()->getRegAccess() != Direct)
+        {
+            features |= OF_INDIRECT;
+        }
+        if (src->isAccReg())
+        {
+            features |= OF_ACC;
+        }
+        if (G4_Type_Table[src->getType()].byteSize == 8)
+        {
+            features |= src->isImm() ? (OF_64BIT | OF_IMM64) : OF_64BIT;
+        }
+    }
+    return features;
+}
 
-        if (inst->getExecSize() == 16)
+void HWConformity::initConformityFixes()
+{
+    activeFixes.clear();
+    for (const ConformityFix& fix : conformityFixes)
+    {
+        if (!fix.appliesToPlatform || fix.appliesToPlatform(builder))
         {
-            if (inst->opcode() == G4_math               &&
-                inst->getDst()->getType() == Type_HF    &&
-                inst->getSrc(0)->getType() == Type_HF &&
-                (!inst->getSrc(1) || inst->getSrc(1)->getType() == Type_HF))
-            {
-                // split pure HF math to simd8
-                evenlySplitInst(i, bb);
-            }
+            activeFixes.push_back(&fix);
         }
-        fix3SrcInst(i, bb);
+    }
+}
 
-        G4_Operand *dst = inst->getDst();
+HWConformity::ConformityResult HWConformity::applySrcRegion(INST_LIST_ITER& it, G4_BB* bb)
+{
+    fixSrcRegion(*it);
+    return CR_NONE;
+}
 
-#ifdef _DEBUG
-        verifyG4Kernel(kernel, Optimizer::PI_HWConformityChk, false);
-#endif
+HWConformity::ConformityResult HWConformity::applyMov(INST_LIST_ITER& it, G4_BB* bb)
+{
+    return fixMov(it, bb) ? CR_NEW_INSTS : CR_NONE;
+}
 
-        if (inst->isMath())
-        {
-            if( fixMathInst( i, bb ) )
-            {
-                // check the newly added insts later
-                next_iter = i;
-                next_iter++;
-            }
-        }
+HWConformity::ConformityResult HWConformity::applyOpndType(INST_LIST_ITER& it, G4_BB* bb)
+{
+    fixOpndType(it, bb);
+    return CR_NONE;
+}
 
-        inst = *i;
+HWConformity::ConformityResult HWConformity::applySelCsel(INST_LIST_ITER& it, G4_BB* bb)
+{
+    fixSelCsel(it, bb);
+    return CR_NONE;
+}
 
-#ifdef _DEBUG
-        verifyG4Kernel(kernel, Optimizer::PI_HWConformityChk, false);
-#endif
+HWConformity::ConformityResult HWConformity::applyHFMath(INST_LIST_ITER& it, G4_BB* bb)
+{
+    G4_INST* inst = *it;
+    if (inst->getExecSize() == 16 &&
+        inst->getDst()->getType() == Type_HF &&
+        inst->getSrc(0)->getType() == Type_HF &&
+        (!inst->getSrc(1) || inst->getSrc(1)->getType() == Type_HF))
+    {
+        // split pure HF math to simd8
+        evenlySplitInst(it, bb);
+    }
+    return CR_NONE;
+}
 
-        if( inst->opcode() == G4_mul )
-        {
-            if( fixMULInst( i, bb ) )
-            {
-                // inserted mach and mov
-                // check the newly added insts later ( MUL, MACH, MOV )
-                next_iter = i;
-                next_iter++;
-            }
-        }
+HWConformity::ConformityResult HWConformity::apply3Src(INST_LIST_ITER& it, G4_BB* bb)
+{
+    fix3SrcInst(it, bb);
+    return CR_NONE;
+}
 
-#ifdef _DEBUG
-        verifyG4Kernel(kernel, Optimizer::PI_HWConformityChk, false);
-#endif
+HWConformity::ConformityResult HWConformity::applyMath(INST_LIST_ITER& it, G4_BB* bb)
+{
+    // check the newly added insts later
+    return fixMathInst(it, bb) ? CR_NEW_INSTS : CR_NONE;
+}
 
-        if( inst->opcode() == G4_mulh )
-        {
-            fixMULHInst( i, bb );
-            // inserted mul before
-            // check the newly added MUL inst
-            i--;
-            next_iter = i;
-            continue;
-        }
+HWConformity::ConformityResult HWConformity::applyMul(INST_LIST_ITER& it, G4_BB* bb)
+{
+    // inserted mach and mov
+    // check the newly added insts later ( MUL, MACH, MOV )
+    return fixMULInst(it, bb) ? CR_NEW_INSTS : CR_NONE;
+}
 
-#ifdef _DEBUG
-        verifyG4Kernel(kernel, Optimizer::PI_HWConformityChk, false);
-#endif
+HWConformity::ConformityResult HWConformity::applyMulh(INST_LIST_ITER& it, G4_BB* bb)
+{
+    fixMULHInst(it, bb);
+    // inserted mul before
+    // check the newly added MUL inst
+    it--;
+    return CR_RESTART;
+}
 
-        // HW check #6: indirect operand spilling
-        fixIndirectOpnd( i, bb );
+HWConformity::ConformityResult HWConformity::applyIndirectOpnd(INST_LIST_ITER& it, G4_BB* bb)
+{
+    // HW check #6: indirect operand spilling
+    fixIndirectOpnd(it, bb);
+    return CR_NONE;
+}
 
-#ifdef _DEBUG
-        verifyG4Kernel(kernel, Optimizer::PI_HWConformityChk, false);
-#endif
-        // HW check #8: unsigned dst with execution type F
-        /* If the execution type is F and the destination type if either UD, UW
-         * or UB and the detination is not saturated, then we need to add an
-         * intermediate type conversion to D.
-         */
-        inst = *i;
-        opcode = inst->opcode();
+HWConformity::ConformityResult HWConformity::applyCompare(INST_LIST_ITER& it, G4_BB* bb)
+{
+    G4_INST* inst = *it;
+    G4_DstRegRegion* dst = inst->getDst();
+    int dst_elsize = 0;
+    bool null_dst = !dst || inst->hasNULLDst();
+    if (!null_dst)
+    {
+        dst_elsize = dst->isPredicate() ? G4_Type_Table[Type_UW].byteSize : G4_Type_Table[dst->getType()].byteSize;
+    }
+    int extypesize;
+    G4_Type extype = inst->getOpExecType(extypesize);
+    fixCompareInst(it, bb, extype, dst_elsize);
+    return CR_NONE;
+}
 
-        if (opcode == G4_cmp || opcode == G4_cmpn)
-        {
-            dst = inst->getDst();
-            int dst_elsize = 0;
-            bool null_dst = !dst || inst->hasNULLDst();
-            if (!null_dst)
-            {
-                dst_elsize = dst->isPredicate() ? G4_Type_Table[Type_UW].byteSize : G4_Type_Table[dst->getType()].byteSize;
-            }
-            int extypesize;
-            G4_Type extype = inst->getOpExecType( extypesize );
-            fixCompareInst( i, bb, extype, dst_elsize );
-        }
-        dst = inst->getDst();
+HWConformity::ConformityResult HWConformity::applyAcc(INST_LIST_ITER& it, G4_BB* bb)
+{
+    return fixAcc(it, bb) ? CR_NEW_INSTS : CR_NONE;
+}
 
-#ifdef _DEBUG
-        verifyG4Kernel(kernel, Optimizer::PI_HWConformityChk, false);
-#endif
-        if (fixAcc(i, bb))
-        {
-            next_iter = i;
-            next_iter++;
-        }
+HWConformity::ConformityResult HWConformity::applyScalarDstHstride(INST_LIST_ITER& it, G4_BB* bb)
+{
+    G4_INST* inst = *it;
+    G4_DstRegRegion* dst = inst->getDst();
+    G4_Type extype = inst->getExecType2();
+    int extypesize = G4_Type_Table[extype].byteSize;
+    int dst_elsize = 0;
+    if (dst)
+    {
+        dst_elsize = G4_Type_Table[dst->getType()].byteSize;
+    }
 
-#ifdef _DEBUG
-        verifyG4Kernel(kernel, Optimizer::PI_HWConformityChk, false);
-#endif
+    if (dst                         &&
+        inst->getExecSize() == 1    &&
+        dst_elsize < extypesize     &&
+        !IS_VTYPE(extype)           &&
+        !inst->isMixedMode())
+    {
+        fixDstHstride(it, extypesize);
+    }
+    return CR_NONE;
+}
 
-        {
-            dst = inst->getDst();
-            G4_Type extype = inst->getExecType2();
-            int extypesize = G4_Type_Table[extype].byteSize;
-            int dst_elsize = 0;
-            if (dst)
-            {
-                dst_elsize = G4_Type_Table[dst->getType()].byteSize;
-            }
+HWConformity::ConformityResult HWConformity::applyPlane(INST_LIST_ITER& it, G4_BB* bb)
+{
+    return fixPlaneInst(it, bb) ? CR_DELETED : CR_NONE;
+}
 
-            if (dst                         &&
-                inst->getExecSize() == 1    &&
-                dst_elsize < extypesize     &&
-                !IS_VTYPE(extype)           &&
-                !inst->isMixedMode())
-            {
-                fixDstHstride( i, extypesize );
-            }
-        }
+HWConformity::ConformityResult HWConformity::applyLine(INST_LIST_ITER& it, G4_BB* bb)
+{
+    fixLine(it, bb);
+    return CR_NONE;
+}
 
-#ifdef _DEBUG
-        verifyG4Kernel(kernel, Optimizer::PI_HWConformityChk, false);
-#endif
+HWConformity::ConformityResult HWConformity::applyRotate(INST_LIST_ITER& it, G4_BB* bb)
+{
+    fixRotate(it, bb);
+    return CR_NONE;
+}
+
+HWConformity::ConformityResult HWConformity::applyVxHFloat64b(INST_LIST_ITER& it, G4_BB* bb)
+{
+    fixVxHFloat64b(it, bb);
+    return CR_NONE;
+}
+
+HWConformity::ConformityResult HWConformity::apply64bRegioning(INST_LIST_ITER& it, G4_BB* bb)
+{
+    fix64bInst(it, bb);
+    return CR_NONE;
+}
 
-        bool planeDeleted = fixPlaneInst(i, bb);
-        if (planeDeleted)
+HWConformity::ConformityResult HWConformity::applyImm64(INST_LIST_ITER& it, G4_BB* bb)
+{
+    // fixed immediates for DF4 in fixImm64()
+    fixImm64(it, bb);
+    return CR_NONE;
+}
+
+HWConformity::ConformityResult HWConformity::applyPackedHFConversions(INST_LIST_ITER& it, G4_BB* bb)
+{
+    fixPackedHFConversions(it, bb);
+    return CR_NONE;
+}
+
+void HWConformity::conformBB( BB_LIST_ITER it)
+{
+    G4_BB *bb = *it;
+    INST_LIST_ITER i = bb->begin(), iEnd = bb->end();
+    INST_LIST_ITER next_iter = i;
+    for ( ; i != iEnd; i = next_iter )
+    {
+        // by default we skip the newly inserted instructions as we assume they are already HW conformed
+        // if a check may produce new instructions that violate HW rules, it must adjust the next_iter
+        // to point to them
+        ++next_iter;
+        G4_INST *inst = *i;
+        G4_opcode opcode = inst->opcode();
+        if (opcode == G4_nop || opcode == G4_label)
         {
             continue;
         }
 
-        fixLine(i, bb);
-        fixRotate(i, bb);
-
-        if (!builder.hasVxHFloat64b())
+        // The instruction class and operand features are recomputed only
+        // after a fix actually ran, since skipped fixes cannot change them.
+        uint32_t instClass = getInstClass(inst);
+        uint32_t features = getOpndFeatures(inst);
+        for (const ConformityFix* fix : activeFixes)
         {
-            fixVxHFloat64b(i, bb);
-        }
+            if ((fix->instClasses & instClass) == 0 ||
+                (fix->opndFeatures != 0 && (fix->opndFeatures & features) == 0))
+            {
+                continue;
+            }
 
-        // CHV/BXT specific checks for 64b datatypes
-        fix64bInst( i, bb);
+            ConformityResult result = (this->*(fix->apply))(i, bb);
 
 #ifdef _DEBUG
-        verifyG4Kernel(kernel, Optimizer::PI_HWConformityChk, false);
+            verifyG4Kernel(kernel, Optimizer::PI_HWConformityChk, false);
 #endif
-        fixImm64( i, bb ); // fixed immediates for DF4 in fixImm64()
-
+            if (result == CR_NEW_INSTS)
+            {
+                next_iter = i;
+                next_iter++;
+            }
+            else if (result == CR_RESTART)
+            {
+                next_iter = i;
+                break;
+            }
+            else if (result == CR_DELETED)
+            {
+                break;
+            }
 
-        // FIXME: may be better to call fixDstAlign instead
-        if (getGenxPlatform() == GENX_BDW)
-        {
-            fixPackedHFConversions(i, bb);
+            instClass = getInstClass(*i);
+            features = getOpndFeatures(*i);
         }
     }
 }
@@ -6078,6 +6265,8 @@ void HWConformity::chkHWConformity()
 {
     fixDataLayout();
 
+    initConformityFixes();
+
     for (BB_LIST_ITER it = kernel.fg.BBs.begin(); it != kernel.fg.BBs.end();it++)
     {
 #ifdef _DEBUG
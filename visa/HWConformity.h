@@ -33,6 +33,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Common_ISA_util.h"
 
 #include <map>
+#include <vector>
 
 struct AccInterval;
 
@@ -209,6 +210,87 @@ namespace vISA
 
         void fixVxHFloat64b(INST_LIST_ITER it, G4_BB* bb);
 
+        // Dispatch table for the per-instruction fixes run by conformBB(). Each entry
+        // wraps one of the existing fix* routines and records the instruction classes
+        // and operand features for which it can change anything, and optionally the
+        // platforms it is needed on. The legality checks themselves stay in the fix*
+        // routines; the table only decides which of them are called for an instruction.
+        // It is not a declarative region/type/alignment legality description, and
+        // the fixes still run one after another, so a fix may still insert a mov that
+        // a later fix then rewrites.
+        enum ConformityInstClass
+        {
+            IC_MOV = 0x1,
+            IC_SEL = 0x2,
+            IC_MATH = 0x4,
+            IC_MUL = 0x8,
+            IC_MULH = 0x10,
+            IC_CMP = 0x20,
+            IC_3SRC = 0x40,
+            IC_PLANE = 0x80,
+            IC_LINE = 0x100,
+            IC_ROTATE = 0x200,
+            IC_OTHER = 0x400,
+            IC_ANY = 0x7FF
+        };
+
+        enum ConformityOpndFeature
+        {
+            OF_INDIRECT = 0x1,   // dst or a source uses indirect addressing
+            OF_ACC = 0x2,        // explicit or implicit acc dst/source, or mach
+            OF_IMM64 = 0x4,      // 64-bit immediate source
+            OF_64BIT = 0x8,      // dst or a source has a 64-bit type
+            OF_HF_DST = 0x10     // dst has HF type
+        };
+
+        enum ConformityResult
+        {
+            CR_NONE,        // nothing to re-check
+            CR_NEW_INSTS,   // instructions were inserted after the current one and must be checked
+            CR_RESTART,     // the iterator was moved back; restart checking from it
+            CR_DELETED      // the current instruction was removed
+        };
+
+        struct ConformityFix
+        {
+            const char* name;
+            // nullptr if the fix is needed on all platforms
+            bool (*appliesToPlatform)(IR_Builder& builder);
+            uint32_t instClasses;
+            // 0 if the fix is called regardless of operand features
+            uint32_t opndFeatures;
+            ConformityResult (HWConformity::*apply)(INST_LIST_ITER& it, G4_BB* bb);
+        };
+
+        static const ConformityFix conformityFixes[];
+        // entries of conformityFixes[] needed on the current platform, in order
+        std::vector<const ConformityFix*> activeFixes;
+
+        static uint32_t getInstClass(G4_INST* inst);
+        static uint32_t getOpndFeatures(G4_INST* inst);
+        void initConformityFixes();
+
+        ConformityResult applySrcRegion(INST_LIST_ITER& it, G4_BB* bb);
+        ConformityResult applyMov(INST_LIST_ITER& it, G4_BB* bb);
+        ConformityResult applyOpndType(INST_LIST_ITER& it, G4_BB* bb);
+        ConformityResult applySelCsel(INST_LIST_ITER& it, G4_BB* bb);
+        ConformityResult applyHFMath(INST_LIST_ITER& it, G4_BB* bb);
+        ConformityResult apply3Src(INST_LIST_ITER& it, G4_BB* bb);
+        ConformityResult applyMath(INST_LIST_ITER& it, G4_BB* bb);
+        ConformityResult applyMul(INST_LIST_ITER& it, G4_BB* bb);
+        ConformityResult applyMulh(INST_LIST_ITER& it, G4_BB* bb);
+        ConformityResult applyIndirectOpnd(INST_LIST_ITER& it, G4_BB* bb);
+        ConformityResult applyCompare(INST_LIST_ITER& it, G4_BB* bb);
+        ConformityResult applyAcc(INST_LIST_ITER& it, G4_BB* bb);
+        ConformityResult applyScalarDstHstride(INST_LIST_ITER& it, G4_BB* bb);
+        ConformityResult applyPlane(INST_LIST_ITER& it, G4_BB* bb);
+        ConformityResult applyLine(INST_LIST_ITER& it, G4_BB* bb);
+        ConformityResult applyRotate(INST_LIST_ITER& it, G4_BB* bb);
+        ConformityResult applyVxHFloat64b(INST_LIST_ITER& it, G4_BB* bb);
+        ConformityResult apply64bRegioning(INST_LIST_ITER& it, G4_BB* bb);
+        ConformityResult applyImm64(INST_LIST_ITER& it, G4_BB* bb);
+        ConformityResult applyPackedHFConversions(INST_LIST_ITER& it, G4_BB* bb);
+
     public:
         HWConformity(IR_Builder& b, G4_Kernel &k, vISA::Mem_Manager& m) :
             builder(b), kernel(k), mem(m)
@@ -2,6 +2,10 @@
 #include "../GraphColor.h"
 #include <iostream>
 #include <functional>
+#include <climits>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 using namespace vISA;
 using namespace std;
@@ -12,6 +16,7 @@ static const unsigned PRESSURE_REDUCTION_MIN_BENEFIT = 5;
 static const unsigned PRESSURE_REDUCTION_THRESHOLD = 110;
 static const unsigned PRESSURE_REDUCTION_THRESHOLD_SIMD32 = 120;
 static const unsigned LATENCY_PRESSURE_THRESHOLD = 100;
+static const unsigned PARALLEL_STRATEGY_BLOCK_SIZE = 64;
 
 namespace {
 
@@ -389,6 +394,49 @@ struct RegisterPressure
     }
 };
 
+// Return the root declare of a direct register operand, or nullptr.
+static G4_Declare* getRootDcl(G4_Operand* opnd)
+{
+    if (!opnd || (!opnd->isSrcRegRegion() && !opnd->isDstRegRegion()))
+        return nullptr;
+    if (!opnd->getBase() || !opnd->getBase()->isRegVar())
+        return nullptr;
+    return opnd->getTopDcl();
+}
+
+// Estimate the cycles to issue the instructions in order, each one waiting
+// for the latency of the values it reads. The variables in readyAt become
+// available at the given cycle.
+static unsigned estimateInOrderCycles(const LatencyTable& LT,
+    const std::vector<G4_INST*>& insts,
+    const std::unordered_map<G4_Declare*, unsigned>& readyAt)
+{
+    std::unordered_map<G4_Declare*, unsigned> ready(readyAt);
+    unsigned cycle = 0;
+    for (auto inst : insts)
+    {
+        if (inst->isLabel() || inst->isPseudoKill() || inst->isLifeTimeEnd() ||
+            inst->isPseudoUse())
+        {
+            continue;
+        }
+
+        unsigned start = cycle;
+        for (int i = 0, numSrc = inst->getNumSrc(); i < numSrc; ++i)
+        {
+            auto it = ready.find(getRootDcl(inst->getSrc(i)));
+            if (it != ready.end())
+                start = std::max(start, it->second);
+        }
+
+        LatencyTable::Latency L = LT.getLatency(inst);
+        if (G4_Declare* dcl = getRootDcl(inst->getDst()))
+            ready[dcl] = start + L.getLatencyOnly();
+        cycle = start + L.getOccupancyOnly();
+    }
+    return cycle;
+}
+
 struct SchedConfig
 {
     enum {
@@ -396,17 +444,20 @@ struct SchedConfig
         MASK_LATENCY      = 1U << 1,
         MASK_SETHI_ULLMAN = 1U << 2,
         MASK_CLUSTTERING  = 1U << 3,
+        MASK_MULTI_STRATEGY = 1U << 4,
     };
     unsigned Dump : 1;
     unsigned UseLatency : 1;
     unsigned UseSethiUllman : 1;
     unsigned DoClustering : 1;
+    unsigned MultiStrategy : 1;
 
     explicit SchedConfig(unsigned Config)
         : Dump((Config & MASK_DUMP) != 0)
         , UseLatency((Config & MASK_LATENCY) != 0)
         , UseSethiUllman((Config & MASK_SETHI_ULLMAN) != 0)
         , DoClustering((Config & MASK_CLUSTTERING) != 0)
+        , MultiStrategy((Config & MASK_MULTI_STRATEGY) != 0)
     {
     }
 };
@@ -457,6 +508,19 @@ public:
     // Commit this scheduling if it reduces register pressure.
     bool commitIfBeneficial(unsigned &MaxRPE, bool IsTopDown);
 
+    // Return the schedule in program order, or an empty list if it does
+    // not cover the whole block.
+    void getOrder(std::vector<G4_INST*>& Order, bool IsTopDown) const
+    {
+        Order.clear();
+        if (schedule.size() != getBB()->size())
+            return;
+        if (IsTopDown)
+            Order.assign(schedule.begin(), schedule.end());
+        else
+            Order.assign(schedule.rbegin(), schedule.rend());
+    }
+
 private:
     void SethiUllmanScheduling();
     void LatencyScheduling();
@@ -494,6 +558,196 @@ static unsigned getLatencyHidingThreshold(Options *m_options)
     return unsigned(LATENCY_PRESSURE_THRESHOLD * Ratio);
 }
 
+namespace {
+
+// Strategies tried on each block in multi-strategy mode.
+enum SchedStrategy {
+    STRATEGY_SETHI_ULLMAN,           // bottom-up, for register pressure
+    STRATEGY_SETHI_ULLMAN_CLUSTERED, // bottom-up with clustering
+    STRATEGY_LATENCY,                // top-down, for latency
+    STRATEGY_NUM
+};
+
+struct StrategyResult {
+    std::vector<G4_INST*> Order;
+    unsigned Pressure = 0;
+    unsigned Cycles = 0;
+};
+
+// Helper threads running the extra strategies of large blocks. They are
+// started on the first such block and kept until the kernel is scheduled,
+// so thread start-up is paid once per kernel instead of once per block.
+class StrategyWorkers {
+public:
+    ~StrategyWorkers()
+    {
+        {
+            std::lock_guard<std::mutex> L(Lock);
+            Exiting = true;
+        }
+        WorkReady.notify_all();
+        for (auto& T : Threads)
+            T.join();
+    }
+
+    void post(std::function<void()> Job)
+    {
+        {
+            std::lock_guard<std::mutex> L(Lock);
+            if (Threads.empty()) {
+                for (unsigned i = 1; i < STRATEGY_NUM; ++i)
+                    Threads.emplace_back(&StrategyWorkers::workerLoop, this);
+            }
+            Queue.push_back(std::move(Job));
+            ++Pending;
+        }
+        WorkReady.notify_one();
+    }
+
+    // Wait until every posted job has finished.
+    void wait()
+    {
+        std::unique_lock<std::mutex> L(Lock);
+        WorkDone.wait(L, [this] { return Pending == 0; });
+    }
+
+private:
+    void workerLoop()
+    {
+        std::unique_lock<std::mutex> L(Lock);
+        for (;;) {
+            WorkReady.wait(L, [this] { return Exiting || !Queue.empty(); });
+            if (Queue.empty())
+                return;
+            std::function<void()> Job = std::move(Queue.back());
+            Queue.pop_back();
+            L.unlock();
+            Job();
+            L.lock();
+            if (--Pending == 0)
+                WorkDone.notify_all();
+        }
+    }
+
+    std::vector<std::thread> Threads;
+    std::mutex Lock;
+    std::condition_variable WorkReady;
+    std::condition_variable WorkDone;
+    std::vector<std::function<void()>> Queue;
+    unsigned Pending = 0;
+    bool Exiting = false;
+};
+
+} // namespace
+
+// Schedule BB with the given strategy on its own dependence graph. The
+// block itself is not modified, so strategies may run concurrently.
+static void runStrategy(G4_Kernel& kernel, G4_BB* bb, RegisterPressure& rp,
+                        SchedConfig config, SchedStrategy Strategy,
+                        preDDD* ddd, StrategyResult& Result)
+{
+    Mem_Manager localMem(4096);
+    preDDD localDDD(localMem, kernel, bb);
+    if (!ddd) {
+        ddd = &localDDD;
+        ddd->buildGraph();
+    }
+
+    config.DoClustering = Strategy == STRATEGY_SETHI_ULLMAN_CLUSTERED;
+    BB_Scheduler S(kernel, *ddd, rp, config);
+    if (Strategy == STRATEGY_LATENCY) {
+        S.scheduleBlockForLatency();
+        S.getOrder(Result.Order, /*IsTopDown*/ true);
+    } else {
+        S.scheduleBlockForPressure();
+        S.getOrder(Result.Order, /*IsTopDown*/ false);
+    }
+}
+
+// Run all strategies on a block, score each schedule with the register
+// pressure estimate and the static cycle estimate, and commit the best
+// one. A schedule within the latency hiding threshold with fewer cycles
+// is preferred; when no schedule fits, the one with the lowest pressure
+// wins. Large blocks run the extra strategies on Workers when given.
+static bool scheduleWithStrategies(G4_Kernel& kernel, G4_BB* bb, Mem_Manager& mem,
+                                   RegisterPressure& rp, SchedConfig config,
+                                   unsigned& MaxPressure, StrategyWorkers* Workers)
+{
+    StrategyResult Results[STRATEGY_NUM];
+
+    // The first graph is built on this thread, which also computes the
+    // operand bounds cached in the IR before other threads read them.
+    preDDD ddd(mem, kernel, bb);
+    ddd.buildGraph();
+
+    if (Workers && bb->size() >= PARALLEL_STRATEGY_BLOCK_SIZE) {
+        for (unsigned i = 1; i < STRATEGY_NUM; ++i) {
+            StrategyResult* Result = &Results[i];
+            Workers->post([&kernel, bb, &rp, config, i, Result]() {
+                runStrategy(kernel, bb, rp, config, SchedStrategy(i), nullptr,
+                            *Result);
+            });
+        }
+        runStrategy(kernel, bb, rp, config, SchedStrategy(0), &ddd, Results[0]);
+        Workers->wait();
+    } else {
+        for (unsigned i = 0; i < STRATEGY_NUM; ++i) {
+            runStrategy(kernel, bb, rp, config, SchedStrategy(i),
+                        i == 0 ? &ddd : nullptr, Results[i]);
+        }
+    }
+
+    LatencyTable LT(kernel.getOptions());
+    unsigned Threshold = getLatencyHidingThreshold(kernel.getOptions());
+    auto isBetter = [=](const StrategyResult& A, const StrategyResult& B) {
+        bool FitsA = A.Pressure <= Threshold;
+        bool FitsB = B.Pressure <= Threshold;
+        if (FitsA != FitsB)
+            return FitsA;
+        if (FitsA)
+            return A.Cycles < B.Cycles ||
+                   (A.Cycles == B.Cycles && A.Pressure < B.Pressure);
+        return A.Pressure < B.Pressure ||
+               (A.Pressure == B.Pressure && A.Cycles < B.Cycles);
+    };
+
+    INST_LIST& CurInsts = bb->getInstList();
+    StrategyResult Original;
+    Original.Order.assign(CurInsts.begin(), CurInsts.end());
+    Original.Pressure = MaxPressure;
+    Original.Cycles = estimateInOrderCycles(LT, Original.Order,
+        std::unordered_map<G4_Declare*, unsigned>());
+
+    const StrategyResult* Best = &Original;
+    bool Reordered = false;
+    for (auto& R : Results) {
+        if (R.Order.empty() ||
+            std::equal(R.Order.begin(), R.Order.end(), Original.Order.begin()))
+            continue;
+
+        // Pressure is estimated on the block itself.
+        CurInsts.clear();
+        CurInsts.insert(CurInsts.end(), R.Order.begin(), R.Order.end());
+        rp.recompute(bb);
+        Reordered = true;
+        R.Pressure = rp.getPressure(bb);
+        R.Cycles = estimateInOrderCycles(LT, R.Order,
+            std::unordered_map<G4_Declare*, unsigned>());
+        SCHED_DUMP(std::cerr << "strategy " << (&R - Results) << ": pressure "
+                             << R.Pressure << ", cycles " << R.Cycles << "\n");
+        if (isBetter(R, *Best))
+            Best = &R;
+    }
+
+    if (Reordered) {
+        CurInsts.clear();
+        CurInsts.insert(CurInsts.end(), Best->Order.begin(), Best->Order.end());
+        rp.recompute(bb);
+    }
+    MaxPressure = Best->Pressure;
+    return Best != &Original;
+}
+
 preRA_Scheduler::preRA_Scheduler(G4_Kernel& k, Mem_Manager& m, RPE* rpe)
     : kernel(k)
     , mem(m)
@@ -520,7 +774,17 @@ bool preRA_Scheduler::run()
     RegisterPressure rp(kernel, mem, rpe);
     bool Changed = false;
 
+    // Dependence graphs only live while their block is scheduled; keep them
+    // in a pool whose arenas are reused across BBs.
+    Mem_Manager bbMem(4096);
+
+    // Shared by all blocks of the kernel, see scheduleWithStrategies().
+    StrategyWorkers Workers;
+    bool UseWorkers = config.MultiStrategy &&
+                      std::thread::hardware_concurrency() > 1;
+
     for (auto bb : kernel.fg.BBs) {
+        bbMem.reset();
         if (bb->size() < SMALL_BLOCK_SIZE || bb->size() > LARGE_BLOCK_SIZE) {
             SCHED_DUMP(std::cerr << "Skip block with instructions "
                 << bb->size() << "\n");
@@ -528,13 +792,23 @@ bool preRA_Scheduler::run()
         }
 
         unsigned MaxPressure = rp.getPressure(bb);
+        if (config.MultiStrategy) {
+            SCHED_DUMP(rp.dump(bb, "Before scheduling, "));
+            if (scheduleWithStrategies(kernel, bb, bbMem, rp, config, MaxPressure,
+                                       UseWorkers ? &Workers : nullptr)) {
+                SCHED_DUMP(rp.dump(bb, "After multi-strategy scheduling, "));
+                Changed = true;
+            }
+            continue;
+        }
+
         if (MaxPressure <= Threshold && !config.UseLatency) {
             SCHED_DUMP(std::cerr << "Skip block with rp " << MaxPressure << "\n");
             continue;
         }
 
         SCHED_DUMP(rp.dump(bb, "Before scheduling, "));
-        preDDD ddd(mem, kernel, bb);
+        preDDD ddd(bbMem, kernel, bb);
         BB_Scheduler S(kernel, ddd, rp, config);
 
         auto tryRPReduction = [=]() {
@@ -1460,16 +1734,21 @@ bool LatencyQueue::compare(preNode* N1, preNode* N2)
     return N2->getID() > N1->getID();
 }
 
-// Find the edge with smallest ID.
-static G4_INST* minElt(const std::vector<preEdge>& Elts)
+// Find the edge with smallest position in the schedule.
+static G4_INST* minElt(const std::vector<preEdge>& Elts,
+                       const std::unordered_map<G4_INST*, unsigned>& Pos)
 {
     assert(!Elts.empty());
     if (Elts.size() == 1)
         return Elts.front().getNode()->getInst();
-    auto Cmp = [](const preEdge& E1, const preEdge& E2) {
+    auto getPos = [&Pos](G4_INST* Inst) {
+        auto I = Pos.find(Inst);
+        return I == Pos.end() ? UINT_MAX : I->second;
+    };
+    auto Cmp = [&getPos](const preEdge& E1, const preEdge& E2) {
         G4_INST* Inst1 = E1.getNode()->getInst();
         G4_INST* Inst2 = E2.getNode()->getInst();
-        return Inst1 && Inst2 && Inst1->getLocalId() < Inst2->getLocalId();
+        return Inst1 && Inst2 && getPos(Inst1) < getPos(Inst2);
     };
     auto E = std::min_element(Elts.begin(), Elts.end(), Cmp);
     return E->getNode()->getInst();
@@ -1482,15 +1761,18 @@ static G4_INST* minElt(const std::vector<preEdge>& Elts)
 // [p1 A1 A2 p2 A4 A3].
 void BB_Scheduler::relocatePseudoKills()
 {
-    // Reset local id after scheduling and build the location map.
+    // Number instructions in the schedule and build the location map.
     // Multiple pseudo-kills may be placed before a single instruction.
+    // Local ids are not updated, as several strategies may be scheduling
+    // the same block concurrently.
     std::unordered_map<G4_INST*, std::vector<G4_INST *>> LocMap;
-    int i = 0;
-    for (auto Inst : schedule) { Inst->setLocalId(i++); }
+    std::unordered_map<G4_INST*, unsigned> SchedPos;
+    unsigned i = 0;
+    for (auto Inst : schedule) { SchedPos[Inst] = i++; }
     for (auto N : ddd.getNodes()) {
         G4_INST* Inst = N->getInst();
         if (Inst && Inst->isPseudoKill()) {
-            G4_INST* Pos = minElt(N->Succs);
+            G4_INST* Pos = minElt(N->Succs, SchedPos);
             LocMap[Pos].push_back(Inst);
         }
     }
@@ -2093,3 +2375,680 @@ void preDDD::dumpDagDot()
     ofile << "}\n";
     ofile.close();
 }
+
+//
+// Software pipelining
+//
+namespace {
+
+// Maximum number of instructions moved with a pipelined send.
+static const unsigned MAX_PIPELINE_SLICE_SIZE = 16;
+
+// A read-only send issued one iteration ahead, with the instructions
+// computing its payload.
+struct PipelineCandidate
+{
+    G4_INST* send;
+    // The send and its payload slice in body order.
+    std::vector<G4_INST*> insts;
+};
+
+// Analysis and transformation of a single loop.
+class LoopPipeliner
+{
+    G4_Kernel& kernel;
+    G4_BB* loop;
+    G4_BB* preheader;
+
+    struct DclRefs
+    {
+        std::vector<G4_INST*> defs;
+        std::vector<G4_INST*> uses;
+        std::vector<G4_INST*> kills;
+        // Referenced by an instruction we do not model, e.g. lifetime.end.
+        bool other = false;
+    };
+
+    // Position of each instruction in the loop body.
+    std::unordered_map<G4_INST*, unsigned> position;
+    std::unordered_map<G4_Declare*, DclRefs> refs;
+
+public:
+    LoopPipeliner(G4_Kernel& k, G4_BB* bb, G4_BB* ph)
+        : kernel(k), loop(bb), preheader(ph)
+    {
+    }
+
+    G4_BB* getLoop() const { return loop; }
+
+    // Return the preheader if bb is a single-block loop we can pipeline.
+    static G4_BB* getPreheader(G4_BB* bb);
+
+    // Scan the loop body. Returns false if the loop has references we
+    // cannot reason about.
+    bool collectRefs();
+
+    void findCandidates(const RegisterPressure& rp,
+        std::vector<PipelineCandidate>& candidates);
+
+    // Drop candidates whose slice results are used outside the moved set.
+    void pruneCandidates(std::vector<PipelineCandidate>& candidates);
+
+    void transform(const std::vector<PipelineCandidate>& candidates);
+
+    unsigned estimateII(const LatencyTable& LT,
+        const std::vector<PipelineCandidate>& candidates) const;
+
+private:
+    bool isWholeSingleDef(G4_INST* inst) const;
+    bool isSafeToSpeculate(G4_INST* send) const;
+    bool isSliceOpcode(G4_INST* inst) const;
+    bool buildSlice(G4_INST* send, const RegisterPressure& rp,
+        std::vector<G4_INST*>& slice) const;
+    unsigned estimateCycles(const LatencyTable& LT,
+        const std::unordered_set<G4_INST*>& skip,
+        const std::unordered_map<G4_Declare*, unsigned>& readyAt) const;
+    G4_INST* cloneInst(G4_INST* inst) const;
+};
+
+G4_BB* LoopPipeliner::getPreheader(G4_BB* bb)
+{
+    if (bb->getBBType() != G4_BB_NONE_TYPE || bb->empty() ||
+        !bb->back()->isFlowControl() || bb->Preds.size() != 2 ||
+        std::find(bb->Succs.begin(), bb->Succs.end(), bb) == bb->Succs.end())
+    {
+        return nullptr;
+    }
+
+    G4_BB* ph = bb->Preds.front() == bb ? bb->Preds.back() : bb->Preds.front();
+    if (ph == bb || ph->Succs.size() != 1 || ph->getBBType() != G4_BB_NONE_TYPE)
+    {
+        return nullptr;
+    }
+
+    // The prologue is inserted at the end of the preheader, before an
+    // unconditional jump if there is one.
+    if (!ph->empty() && ph->back()->isFlowControl() &&
+        (ph->back()->opcode() != G4_jmpi || ph->back()->getPredicate()))
+    {
+        return nullptr;
+    }
+    return ph;
+}
+
+bool LoopPipeliner::collectRefs()
+{
+    unsigned pos = 0;
+    for (auto inst : *loop)
+    {
+        position[inst] = pos++;
+
+        if (inst->isLabel())
+            continue;
+
+        // Only the back edge branch may change the execution mask.
+        if (inst->isFlowControl() && inst != loop->back())
+            return false;
+
+        if (inst->isWait() || inst->isFence() || inst->isEOT() ||
+            (inst->isSend() && (inst->getMsgDesc()->isBarrierMsg() ||
+                                inst->getMsgDesc()->isThreadMessage())))
+        {
+            return false;
+        }
+
+        if (inst->isPseudoKill())
+        {
+            if (G4_Declare* dcl = getRootDcl(inst->getDst()))
+                refs[dcl].kills.push_back(inst);
+            continue;
+        }
+
+        bool modeled = !inst->isLifeTimeEnd() && !inst->isPseudoUse();
+
+        G4_DstRegRegion* dst = inst->getDst();
+        if (dst && !dst->isNullReg())
+        {
+            if (dst->getRegAccess() != Direct)
+                return false;
+            if (G4_Declare* dcl = getRootDcl(dst))
+            {
+                if (modeled)
+                    refs[dcl].defs.push_back(inst);
+                else
+                    refs[dcl].other = true;
+            }
+        }
+
+        for (int i = 0, numSrc = inst->getNumSrc(); i < numSrc; ++i)
+        {
+            G4_Operand* src = inst->getSrc(i);
+            if (!src || !src->isSrcRegRegion())
+                continue;
+            if (src->asSrcRegRegion()->getRegAccess() != Direct)
+                return false;
+            if (G4_Declare* dcl = getRootDcl(src))
+            {
+                DclRefs& R = refs[dcl];
+                if (!modeled)
+                    R.other = true;
+                else if (R.uses.empty() || R.uses.back() != inst)
+                    R.uses.push_back(inst);
+            }
+        }
+    }
+
+    return true;
+}
+
+// The instruction is the only definition of its GRF variable in the loop,
+// and writes the whole variable.
+bool LoopPipeliner::isWholeSingleDef(G4_INST* inst) const
+{
+    G4_DstRegRegion* dst = inst->getDst();
+    G4_Declare* dcl = getRootDcl(dst);
+    if (!dcl || dst->getRegAccess() != Direct)
+        return false;
+
+    if (dcl->getRegFile() != G4_GRF || dcl->getAddressed() || dcl->isInput() ||
+        dcl->isOutput() || dcl->getRegVar()->isPhyRegAssigned())
+    {
+        return false;
+    }
+
+    auto it = refs.find(dcl);
+    if (it == refs.end() || it->second.defs.size() != 1 || it->second.other)
+        return false;
+
+    if (dst->getRegOff() != 0 || dst->getSubRegOff() != 0)
+        return false;
+
+    if (inst->isSend())
+    {
+        return inst->getMsgDesc()->ResponseLength() * G4_GRF_REG_NBYTES >=
+            dcl->getByteSize();
+    }
+
+    return dst->getHorzStride() == 1 &&
+        inst->getExecSize() * G4_Type_Table[dst->getType()].byteSize ==
+        dcl->getByteSize();
+}
+
+// The send is issued once more than the original loop, on the last
+// iteration, with the payload of the iteration that is never executed.
+// Only reads through a binding table surface, for which out-of-bounds
+// accesses return zero, may be issued speculatively.
+bool LoopPipeliner::isSafeToSpeculate(G4_INST* send) const
+{
+    G4_SendMsgDescriptor* msgDesc = send->getMsgDesc();
+    if (!msgDesc || !msgDesc->isDataPortRead() || msgDesc->isDataPortWrite() ||
+        msgDesc->isAtomicMessage() || msgDesc->isSLMMessage() ||
+        msgDesc->isScratchRW() || msgDesc->isEOTInst())
+    {
+        return false;
+    }
+
+    switch (msgDesc->getFuncId())
+    {
+    case SFID_SAMPLER:
+    case SFID_DP_CC:
+        break;
+    case SFID_DP_DC:
+        break;
+    case SFID_DP_DC1:
+        switch (msgDesc->getMessageType())
+        {
+        case DC1_A64_SCATTERED_READ:
+        case DC1_A64_UNTYPED_SURFACE_READ:
+        case DC1_A64_BLOCK_READ:
+            return false;
+        default:
+            break;
+        }
+        break;
+    case SFID_DP_DC2:
+        switch (msgDesc->getMessageType())
+        {
+        case DC2_A64_SCATTERED_READ:
+        case DC2_A64_UNTYPED_SURFACE_READ:
+            return false;
+        default:
+            break;
+        }
+        break;
+    default:
+        return false;
+    }
+
+    // Stateless (0xFF, 0xFD), SLM (0xFE) and bindless surfaces are not
+    // bounds checked.
+    G4_Operand* bti = msgDesc->getBti();
+    if (!bti || !bti->isImm() || bti->asImm()->getInt() >= 0xF0)
+        return false;
+
+    // The descriptors must not be computed in the loop.
+    if (!send->getMsgDescOperand()->isImm())
+        return false;
+    if (send->isSplitSend() && send->getSrc(3) && !send->getSrc(3)->isImm())
+        return false;
+
+    return send->getPredicate() == nullptr;
+}
+
+bool LoopPipeliner::isSliceOpcode(G4_INST* inst) const
+{
+    if (inst->isSend() || inst->isFlowControl() || inst->isIntrinsic() ||
+        inst->isPseudoKill() || inst->isLifeTimeEnd() || inst->isPseudoUse() ||
+        inst->isLabel() || inst->getPredicate() || inst->getCondMod() ||
+        inst->getImplAccSrc() || inst->getImplAccDst() || inst->hasACCOpnd())
+    {
+        return false;
+    }
+
+    for (int i = 0, numSrc = inst->getNumSrc(); i < numSrc; ++i)
+    {
+        G4_Operand* src = inst->getSrc(i);
+        if (src && src->isSrcRegRegion() && !getRootDcl(src) &&
+            !src->asSrcRegRegion()->isNullReg())
+        {
+            // physical or architecture registers.
+            return false;
+        }
+    }
+
+    return inst->getNumSrc() <= 3;
+}
+
+// Collect the instructions computing the payload of send that must be
+// moved with it. A source defined earlier in the body holds the current
+// iteration's value and its definition is moved as well; a source defined
+// later in the body (or not at all) already holds the next iteration's value
+// at the end of the body.
+bool LoopPipeliner::buildSlice(G4_INST* send, const RegisterPressure& rp,
+    std::vector<G4_INST*>& slice) const
+{
+    std::vector<G4_INST*> worklist(1, send);
+    std::unordered_set<G4_INST*> inSlice;
+    inSlice.insert(send);
+
+    while (!worklist.empty())
+    {
+        G4_INST* inst = worklist.back();
+        worklist.pop_back();
+        unsigned instPos = position.at(inst);
+
+        for (int i = 0, numSrc = inst->getNumSrc(); i < numSrc; ++i)
+        {
+            G4_Declare* dcl = getRootDcl(inst->getSrc(i));
+            if (!dcl)
+                continue;
+
+            auto it = refs.find(dcl);
+            if (it == refs.end())
+                continue;
+            const DclRefs& R = it->second;
+
+            unsigned numEarlierDefs = 0;
+            for (auto def : R.defs)
+            {
+                if (position.at(def) < instPos)
+                    numEarlierDefs++;
+            }
+            if (numEarlierDefs == 0)
+                continue;
+
+            G4_INST* def = R.defs.front();
+            if (R.defs.size() != 1 || !isSliceOpcode(def) || !isWholeSingleDef(def) ||
+                rp.isLiveOut(loop, dcl))
+            {
+                return false;
+            }
+
+            if (inSlice.insert(def).second)
+            {
+                if (inSlice.size() > MAX_PIPELINE_SLICE_SIZE)
+                    return false;
+                worklist.push_back(def);
+            }
+        }
+    }
+
+    slice.assign(inSlice.begin(), inSlice.end());
+    std::sort(slice.begin(), slice.end(), [&](G4_INST* a, G4_INST* b) {
+        return position.at(a) < position.at(b);
+    });
+    return true;
+}
+
+void LoopPipeliner::findCandidates(const RegisterPressure& rp,
+    std::vector<PipelineCandidate>& candidates)
+{
+    bool seenWrite = false;
+    for (auto inst : *loop)
+    {
+        if (!inst->isSend())
+            continue;
+
+        // Issuing a load ahead moves it above any memory write earlier in
+        // the same iteration.
+        G4_SendMsgDescriptor* msgDesc = inst->getMsgDesc();
+        if (!msgDesc->isDataPortRead() || msgDesc->isDataPortWrite() ||
+            msgDesc->isAtomicMessage())
+        {
+            seenWrite = true;
+            continue;
+        }
+        if (seenWrite || !isSafeToSpeculate(inst) || !isWholeSingleDef(inst))
+            continue;
+
+        // The loaded value must be dead at the loop exit and not carried
+        // around the back edge.
+        G4_Declare* dcl = getRootDcl(inst->getDst());
+        if (rp.isLiveOut(loop, dcl))
+            continue;
+        unsigned sendPos = position[inst];
+        bool usedBefore = false;
+        for (auto use : refs[dcl].uses)
+        {
+            usedBefore |= position[use] <= sendPos;
+        }
+        if (usedBefore)
+            continue;
+
+        PipelineCandidate C;
+        C.send = inst;
+        if (buildSlice(inst, rp, C.insts))
+            candidates.push_back(C);
+    }
+}
+
+void LoopPipeliner::pruneCandidates(std::vector<PipelineCandidate>& candidates)
+{
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        std::unordered_set<G4_INST*> moved;
+        for (auto& C : candidates)
+            moved.insert(C.insts.begin(), C.insts.end());
+
+        for (auto it = candidates.begin(); it != candidates.end(); ++it)
+        {
+            bool ok = true;
+            for (auto inst : it->insts)
+            {
+                if (inst == it->send)
+                    continue;
+                for (auto use : refs[getRootDcl(inst->getDst())].uses)
+                {
+                    ok &= moved.count(use) != 0;
+                }
+            }
+
+            // A slice must not read the result of another moved instruction
+            // defined later in the body.
+            for (auto inst : it->insts)
+            {
+                for (int i = 0, numSrc = inst->getNumSrc(); i < numSrc; ++i)
+                {
+                    G4_Declare* dcl = getRootDcl(inst->getSrc(i));
+                    if (!dcl || refs[dcl].defs.size() != 1)
+                        continue;
+                    G4_INST* def = refs[dcl].defs.front();
+                    ok &= !moved.count(def) ||
+                        std::find(it->insts.begin(), it->insts.end(), def) != it->insts.end();
+                }
+            }
+
+            if (!ok)
+            {
+                candidates.erase(it);
+                changed = true;
+                break;
+            }
+        }
+    }
+}
+
+G4_INST* LoopPipeliner::cloneInst(G4_INST* inst) const
+{
+    IR_Builder& builder = *kernel.fg.builder;
+    G4_INST* newInst = nullptr;
+    if (inst->isSend())
+    {
+        G4_SendMsgDescriptor* msgDesc = inst->getMsgDesc();
+        G4_SendMsgDescriptor* newMsgDesc = builder.createSendMsgDesc(msgDesc->getDesc(),
+            msgDesc->getExtendedDesc(), msgDesc->isDataPortRead(), msgDesc->isDataPortWrite(),
+            builder.duplicateOperand(msgDesc->getBti()), builder.duplicateOperand(msgDesc->getSti()));
+        if (inst->isSplitSend())
+        {
+            newInst = builder.createSplitSendInst(nullptr, inst->opcode(), inst->getExecSize(),
+                builder.duplicateOperand(inst->getDst()),
+                builder.duplicateOperand(inst->getSrc(0))->asSrcRegRegion(),
+                builder.duplicateOperand(inst->getSrc(1))->asSrcRegRegion(),
+                builder.duplicateOperand(inst->getMsgDescOperand()), inst->getOption(),
+                newMsgDesc, builder.duplicateOperand(inst->getSrc(3)), inst->getLineNo());
+        }
+        else
+        {
+            newInst = builder.createSendInst(nullptr, inst->opcode(), inst->getExecSize(),
+                builder.duplicateOperand(inst->getDst()),
+                builder.duplicateOperand(inst->getSrc(0))->asSrcRegRegion(), nullptr,
+                builder.duplicateOperand(inst->getMsgDescOperand()), inst->getOption(),
+                newMsgDesc, inst->getLineNo());
+        }
+        // Not part of the instruction stream being translated.
+        builder.instList.pop_back();
+    }
+    else if (inst->isMath())
+    {
+        newInst = builder.createMathInst(nullptr, inst->getSaturate(), inst->getExecSize(),
+            builder.duplicateOperand(inst->getDst()), builder.duplicateOperand(inst->getSrc(0)),
+            builder.duplicateOperand(inst->getSrc(1)), inst->asMathInst()->getMathCtrl(),
+            inst->getOption());
+        builder.instList.pop_back();
+    }
+    else
+    {
+        newInst = builder.createInternalInst(nullptr, inst->opcode(), nullptr, inst->getSaturate(),
+            inst->getExecSize(), builder.duplicateOperand(inst->getDst()),
+            builder.duplicateOperand(inst->getSrc(0)), builder.duplicateOperand(inst->getSrc(1)),
+            builder.duplicateOperand(inst->getSrc(2)), inst->getOption());
+    }
+
+    newInst->setLineNo(inst->getLineNo());
+    newInst->setCISAOff(inst->getCISAOff());
+    return newInst;
+}
+
+void LoopPipeliner::transform(const std::vector<PipelineCandidate>& candidates)
+{
+    std::vector<G4_INST*> moved;
+    std::unordered_set<G4_Declare*> movedDcls;
+    for (auto& C : candidates)
+    {
+        for (auto inst : C.insts)
+        {
+            if (std::find(moved.begin(), moved.end(), inst) == moved.end())
+                moved.push_back(inst);
+        }
+    }
+    std::sort(moved.begin(), moved.end(), [&](G4_INST* a, G4_INST* b) {
+        return position[a] < position[b];
+    });
+
+    // Prologue: compute the first iteration's loads in the preheader.
+    INST_LIST_ITER insertPt = preheader->end();
+    if (!preheader->empty() && preheader->back()->isFlowControl())
+        --insertPt;
+    for (auto inst : moved)
+    {
+        preheader->insert(insertPt, cloneInst(inst));
+        movedDcls.insert(getRootDcl(inst->getDst()));
+    }
+
+    // Kernel: issue the next iteration's loads at the end of the body. The
+    // moved variables are now live around the back edge, so their pseudo
+    // kills are removed.
+    std::unordered_set<G4_INST*> toMove(moved.begin(), moved.end());
+    for (auto dcl : movedDcls)
+    {
+        for (auto kill : refs[dcl].kills)
+            toMove.insert(kill);
+    }
+    for (auto it = loop->begin(); it != loop->end();)
+    {
+        if (toMove.count(*it))
+            it = loop->erase(it);
+        else
+            ++it;
+    }
+
+    INST_LIST_ITER backEdge = std::prev(loop->end());
+    for (auto inst : moved)
+    {
+        // The in-block def-use links no longer describe the new order.
+        inst->removeAllDefs();
+        inst->removeAllUses();
+        kernel.fg.globalOpndHT.addGlobalOpnd(inst->getDst());
+        loop->insert(backEdge, inst);
+    }
+}
+
+// Estimate the cycles of the loop body, leaving out the instructions in
+// skip.
+unsigned LoopPipeliner::estimateCycles(const LatencyTable& LT,
+    const std::unordered_set<G4_INST*>& skip,
+    const std::unordered_map<G4_Declare*, unsigned>& readyAt) const
+{
+    std::vector<G4_INST*> insts;
+    for (auto inst : *loop)
+    {
+        if (!skip.count(inst))
+            insts.push_back(inst);
+    }
+    return estimateInOrderCycles(LT, insts, readyAt);
+}
+
+// Estimate the initiation interval of the loop with the given candidates
+// issued one iteration ahead. Without candidates this is the length of
+// one iteration.
+unsigned LoopPipeliner::estimateII(const LatencyTable& LT,
+    const std::vector<PipelineCandidate>& candidates) const
+{
+    std::unordered_set<G4_INST*> skip;
+    unsigned movedCycles = 0;
+    for (auto& C : candidates)
+    {
+        for (auto inst : C.insts)
+        {
+            if (skip.insert(inst).second)
+                movedCycles += LT.getLatency(inst).getOccupancyOnly();
+        }
+    }
+
+    // A value loaded at the end of the previous iteration is ready after
+    // its latency minus the cycles of one iteration.
+    auto cyclesForII = [&](unsigned II) {
+        std::unordered_map<G4_Declare*, unsigned> readyAt;
+        for (auto& C : candidates)
+        {
+            unsigned latency = LT.getLatency(C.send).getLatencyOnly();
+            readyAt[getRootDcl(C.send->getDst())] = latency > II ? latency - II : 0;
+        }
+        return estimateCycles(LT, skip, readyAt) + movedCycles;
+    };
+
+    unsigned hi = cyclesForII(0);
+    if (candidates.empty())
+        return hi;
+
+    // The smallest II that can accommodate one iteration.
+    unsigned lo = 1;
+    while (lo < hi)
+    {
+        unsigned mid = lo + (hi - lo) / 2;
+        if (cyclesForII(mid) <= mid)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+    return hi;
+}
+
+} // namespace
+
+SWPipeliner::SWPipeliner(G4_Kernel& k, Mem_Manager& m)
+    : kernel(k)
+    , mem(m)
+    , m_options(kernel.getOptions())
+{
+}
+
+bool SWPipeliner::run()
+{
+    std::vector<LoopPipeliner> loops;
+    for (auto bb : kernel.fg.BBs)
+    {
+        if (G4_BB* ph = LoopPipeliner::getPreheader(bb))
+        {
+            LoopPipeliner LP(kernel, bb, ph);
+            if (LP.collectRefs())
+                loops.push_back(LP);
+        }
+    }
+
+    if (loops.empty())
+        return false;
+
+    RegisterPressure rp(kernel, mem, nullptr);
+    LatencyTable LT(m_options);
+    unsigned budget = getLatencyHidingThreshold(m_options);
+    bool Changed = false;
+
+    for (auto& LP : loops)
+    {
+        std::vector<PipelineCandidate> candidates;
+        LP.findCandidates(rp, candidates);
+        LP.pruneCandidates(candidates);
+        if (candidates.empty())
+            continue;
+
+        LoopResult R;
+        R.bbId = LP.getLoop()->getId();
+        R.pressure = rp.getPressure(LP.getLoop());
+        R.budget = budget;
+        R.origII = LP.estimateII(LT, std::vector<PipelineCandidate>());
+
+        // Each pipelined value stays live for the whole loop body.
+        auto extraPressure = [](const std::vector<PipelineCandidate>& Cs) {
+            unsigned extra = 0;
+            for (auto& C : Cs)
+                extra += C.send->getDst()->getTopDcl()->getNumRows();
+            return extra;
+        };
+
+        R.extraPressure = extraPressure(candidates);
+        while (!candidates.empty() && R.pressure + extraPressure(candidates) > budget)
+        {
+            candidates.pop_back();
+            LP.pruneCandidates(candidates);
+        }
+
+        R.numPipelined = (unsigned)candidates.size();
+        R.newII = candidates.empty() ? R.origII : LP.estimateII(LT, candidates);
+        if (!candidates.empty() && R.newII < R.origII)
+        {
+            LP.transform(candidates);
+            Changed = true;
+        }
+        else
+        {
+            R.numPipelined = 0;
+            R.newII = R.origII;
+        }
+        results.push_back(R);
+    }
+
+    return Changed;
+}
@@ -0,0 +1,76 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+
+#include "LatencyTable.h"
+
+using namespace vISA;
+
+//
+// The latency model is generated from SKL_latencies.def into
+// constexpr lookups (a chain of conditionals per kind, see LatencyModel.inc),
+// which are only evaluated by the compiler to build the opcode/math/SFID
+// indexed arrays below. Entries missing from the .def file fall back to ADD for
+// regular instructions, INV for math and SFID_NUM for sends.
+//
+namespace {
+    typedef LatencyTable::Latency Latency;
+    typedef LatencyTable::Data Data;
+
+    // Compile-time integer sequence 0, 1, ..., N-1
+    template <unsigned... Is> struct IndexSeq { };
+    template <unsigned N, unsigned... Is>
+    struct MakeIndexSeq : MakeIndexSeq<N - 1, N - 1, Is...> { };
+    template <unsigned... Is>
+    struct MakeIndexSeq<0, Is...> { typedef IndexSeq<Is...> type; };
+
+#define LATENCY_MODEL SKLLatencies
+#define LATENCY_MODEL_DEF "SKL_latencies.def"
+#include "LatencyModel.inc"
+
+    template <class P, unsigned... I, unsigned... M, unsigned... S>
+    constexpr Data makeData(IndexSeq<I...>, IndexSeq<M...>, IndexSeq<S...>) {
+        return Data{
+            { P::inst(G4_opcode(I))... },
+            { P::math(G4_MathOp(M))... },
+            { P::send(CISA_SHARED_FUNCTION_ID(S))... },
+            P::mulIntegerExtraLatency() };
+    }
+
+    template <class P>
+    constexpr Data makeData() {
+        return makeData<P>(MakeIndexSeq<G4_NUM_OPCODE>::type(),
+            MakeIndexSeq<MATH_RSQRTM + 1>::type(),
+            MakeIndexSeq<SFID_NUM + 1>::type());
+    }
+
+    constexpr Data SKLData = makeData<SKLLatencies>();
+}
+
+const LatencyTable::Data& LatencyTable::getData()
+{
+    // Only SKL has measured numbers, so every platform is scheduled with them.
+    return SKLData;
+}
@@ -7,12 +7,12 @@ namespace vISA
     class LatencyTable {
     public:
         struct Latency {
-            Latency(uint32_t EL, uint32_t ND, uint32_t UM)
-                : latency(EL), occupancy(ND), occupancyMultiplier(UM) { ; }
-            Latency(uint32_t EL, uint32_t ND)
-                : latency(EL), occupancy(ND), occupancyMultiplier(1) { ; }
-            Latency(void)
-                : latency(0), occupancy(0), occupancyMultiplier(1) { ; }
+            constexpr Latency(uint32_t EL, uint32_t ND, uint32_t UM)
+                : latency(EL), occupancy(ND), occupancyMultiplier(UM) { }
+            constexpr Latency(uint32_t EL, uint32_t ND)
+                : latency(EL), occupancy(ND), occupancyMultiplier(1) { }
+            constexpr Latency(void)
+                : latency(0), occupancy(0), occupancyMultiplier(1) { }
             uint32_t getSum(void) const {
                 return latency + occupancy * occupancyMultiplier;
             };
@@ -27,36 +27,25 @@ namespace vISA
             uint32_t occupancy;
             uint32_t occupancyMultiplier;
         };
+
+        // Latency model, built at compile time from SKL_latencies.def and
+        // indexed by opcode, math function and SFID. See LatencyTable.cpp.
+        struct Data {
+            Latency inst[G4_NUM_OPCODE];
+            Latency math[MATH_RSQRTM + 1];
+            Latency send[SFID_NUM + 1];
+            uint32_t mulIntegerExtraLatency;
+        };
+
+        // Returns the model; only SKL numbers exist, and all platforms use them
+        static const Data& getData();
+
     private:
         const Options *m_options;
-        std::map<G4_opcode, Latency> InstLatTable;
-        std::map<G4_MathOp, Latency> MathLatTable;
-        std::map<CISA_SHARED_FUNCTION_ID, Latency> SendLatTable;
+        const Data& data;
     public:
-        LatencyTable(const Options *options) : m_options(options) {
-#undef DEF_INSTR_LATENCY
-#undef DEF_MATH_LATENCY
-#undef DEF_SEND_LATENCY
-#define DEF_INSTR_LATENCY(OP, LAT, DEL) InstLatTable[OP] = {LAT, DEL};
-#define DEF_MATH_LATENCY(...)
-#define DEF_SEND_LATENCY(...)
-#include "SKL_latencies.def"
-
-#undef DEF_INSTR_LATENCY
-#undef DEF_MATH_LATENCY
-#undef DEF_SEND_LATENCY
-#define DEF_INSTR_LATENCY(...)
-#define DEF_MATH_LATENCY(OP, LAT, DEL) MathLatTable[OP] = {LAT, DEL};
-#define DEF_SEND_LATENCY(...)
-#include "SKL_latencies.def"
-
-#undef DEF_INSTR_LATENCY
-#undef DEF_MATH_LATENCY
-#undef DEF_SEND_LATENCY
-#define DEF_INSTR_LATENCY(...)
-#define DEF_MATH_LATENCY(...)
-#define DEF_SEND_LATENCY(OP, LAT, DEL) SendLatTable[OP] = {LAT, DEL};
-#include "SKL_latencies.def"
+        LatencyTable(const Options *options)
+            : m_options(options), data(getData()) {
         }
 
         Latency getLatency(G4_INST *inst) const {
@@ -73,16 +62,18 @@ namespace vISA
             // 1. MATH
             if (inst->isMath()) {
                 G4_MathOp mop = inst->asMathInst()->getMathCtrl();
-                latency = MathLatTable.at(mop).latency;
-                occupancy = MathLatTable.at(mop).occupancy;
+                assert(mop <= MATH_RSQRTM);
+                latency = data.math[mop].latency;
+                occupancy = data.math[mop].occupancy;
             }
             // 2. SEND
             else if (inst->isSend()) {
                 G4_SendMsgDescriptor *msgDesc = inst->getMsgDesc();
                 assert(msgDesc);
                 CISA_SHARED_FUNCTION_ID sfid = msgDesc->getFuncId();
-                latency = SendLatTable.at(sfid).latency;
-                occupancy = SendLatTable.at(sfid).occupancy;
+                assert(sfid <= SFID_NUM);
+                latency = data.send[sfid].latency;
+                occupancy = data.send[sfid].occupancy;
                 // Force latency. FIXME: is this correct?
                 uint32_t forceLatency
                     = m_options->getuInt32Option(vISA_UnifiedSendCycle);
@@ -111,23 +102,16 @@ namespace vISA
                     if (IS_TYPE_INT(dstType)
                         && IS_DTYPE(src1Type)
                         && IS_DTYPE(src2Type)) {
-                        extraLatency = MUL_INTEGER_EXTRA_LATENCY;
+                        extraLatency = data.mulIntegerExtraLatency;
                     }
-                    assert(InstLatTable.count(opcode));
-                    latency = InstLatTable.at(opcode).latency + extraLatency;
-                    occupancy = InstLatTable.at(opcode).occupancy;
+                    latency = data.inst[opcode].latency + extraLatency;
+                    occupancy = data.inst[opcode].occupancy;
                     break;
                 }
                 default:
-                    auto it = InstLatTable.find(opcode);
-                    // If opcode not defined, use the values for ADD
-                    if (it == InstLatTable.end()) {
-                        latency = InstLatTable.at(G4_add).latency;
-                        occupancy = InstLatTable.at(G4_add).occupancy;
-                    } else {
-                        latency = it->second.latency;
-                        occupancy = it->second.occupancy;
-                    }
+                    // Opcodes not defined in the table use the values for ADD
+                    latency = data.inst[opcode].latency;
+                    occupancy = data.inst[opcode].occupancy;
                     break;
                 }
             }
@@ -59,6 +59,11 @@ static bool operandOverlap(G4_Operand* opnd1, G4_Operand* opnd2)
 void LocalScheduler::localScheduling()
 {
     DEBUG_VERBOSE("[Scheduling]: Starting...");
+    if (fg.builder->getOption(vISA_MergeFallThroughBBs))
+    {
+        // schedule each fall-through chain as one block
+        fg.mergeFallThroughChains();
+    }
     BB_LIST_ITER ib(fg.BBs.begin()), bend(fg.BBs.end());
     MUST_BE_TRUE(ib != bend, ERROR_SCHEDULER);
 
@@ -67,24 +72,28 @@ void LocalScheduler::localScheduling()
 
     CM_BB_INFO* bbInfo = (CM_BB_INFO *)mem.alloc(fg.BBs.size() * sizeof(CM_BB_INFO));
     memset(bbInfo, 0, fg.BBs.size() * sizeof(CM_BB_INFO));
+    unsigned* bbBankConflicts = (unsigned *)mem.alloc(fg.BBs.size() * sizeof(unsigned));
+    memset(bbBankConflicts, 0, fg.BBs.size() * sizeof(unsigned));
     int i = 0;
 
     const Options *m_options = fg.builder->getOptions();
     LatencyTable LT(m_options);
 
+    // mem pool for each BB, its arenas are reused across BBs
+    Mem_Manager bbMem(4096);
+
+    unsigned int schedulerWindowSize = m_options->getuInt32Option(vISA_SchedulerWindowSize);
 
     for (; ib != bend; ++ib)
     {
         unsigned int instCountBefore = (uint32_t)(*ib)->size();
-        // mem pool for each BB
-        Mem_Manager bbMem(4096);
+        bbMem.reset();
 
         if (instCountBefore < SCH_THRESHOLD)
         {
             continue;
         }
 
-        unsigned int schedulerWindowSize = m_options->getuInt32Option(vISA_SchedulerWindowSize);
         if (schedulerWindowSize > 0 && instCountBefore > schedulerWindowSize)
         {
             // If BB has a lot of instructions then when recursively
@@ -131,12 +140,14 @@ void LocalScheduler::localScheduling()
             bbInfo[i].staticCycle = schedule.sequentialCycle;
             bbInfo[i].sendStallCycle = schedule.sendStallCycle;
             bbInfo[i].loopNestLevel = (*ib)->getNestLevel();
+            bbBankConflicts[i] = (*ib)->countBankConflicts();
         }
 
         i++;
     }
     FINALIZER_INFO* jitInfo = fg.builder->getJitInfo();
     jitInfo->BBInfo = bbInfo;
+    jitInfo->BBNumBankConflicts = bbBankConflicts;
     jitInfo->BBNum = i;
 }
 
@@ -352,6 +352,39 @@ private:
     Options* m_options;
 };
 
+// Software pipelining of innermost single-block loops.
+//
+// Read-only sends whose payload only depends on loop-invariant or
+// loop-carried values are issued one iteration ahead: the loads for the
+// first iteration are cloned into the preheader, and the loads (together
+// with the instructions computing their payload) are moved to the end of
+// the loop body, so that their latency overlaps with the next iteration's
+// computation. Each loop's candidates are limited by a register pressure
+// budget; loops that cannot afford any of them are left unchanged.
+class SWPipeliner {
+public:
+    struct LoopResult {
+        unsigned bbId;
+        unsigned numPipelined;  // number of sends issued one iteration ahead
+        unsigned origII;        // estimated cycles per iteration before
+        unsigned newII;         // estimated cycles per iteration after
+        unsigned pressure;      // max register pressure of the loop in GRFs
+        unsigned extraPressure; // GRFs requested by all candidates
+        unsigned budget;        // register pressure budget in GRFs
+    };
+
+    SWPipeliner(G4_Kernel& k, Mem_Manager& m);
+    bool run();
+
+    const std::vector<LoopResult>& getResults() const { return results; }
+
+private:
+    G4_Kernel& kernel;
+    Mem_Manager& mem;
+    Options* m_options;
+    std::vector<LoopResult> results;
+};
+
 } // namespace vISA
 
 #endif // _LOCALSCHEDULER_H_
@@ -26,8 +26,6 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 // An arena based memory manager implementation.
 
-// NOTE: Object requiring dword alignment is NOT supported.
-
 #include "Mem_Manager.h"
 using namespace vISA;
 Mem_Manager::Mem_Manager(size_t defaultArenaSize)
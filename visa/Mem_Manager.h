@@ -26,7 +26,8 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 // An arena based memory manager implementation.
 
-// NOTE: Object requiring dword alignment is NOT supported.
+// NOTE: alloc(size) returns dword aligned memory; use alloc(size, align) or
+// allocAligned<T>() for objects with stricter alignment requirements.
 
 #ifndef _MEM_MANAGER_H_
 #define _MEM_MANAGER_H_
@@ -45,6 +46,30 @@ namespace vISA
             return _arenaManager.AllocDataSpace(size);
         }
 
+        // align must be a power of two.
+        void* alloc(size_t size, size_t align)
+        {
+            return _arenaManager.AllocDataSpace(size, align);
+        }
+
+        template <typename T>
+        T* allocAligned(size_t count = 1)
+        {
+            return (T*)_arenaManager.AllocDataSpace(count * sizeof(T), alignof(T));
+        }
+
+        // Drop all allocations while keeping the arenas for reuse. Every
+        // pointer previously returned by this manager becomes invalid.
+        void reset()
+        {
+            _arenaManager.Reset();
+        }
+
+        const ArenaStats& getStats() const
+        {
+            return _arenaManager.GetStats();
+        }
+
     private:
 
         vISA::ArenaManager _arenaManager;
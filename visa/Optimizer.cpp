@@ -32,6 +32,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "G4Verifier.h"
 #include <map>
 #include "LVN.h"
+#include "GVN.h"
 #include "ifcvt.h"
 #include <random>
 #include <chrono>
@@ -79,6 +80,60 @@ void Optimizer::LVN()
     }
 }
 
+void Optimizer::GVN()
+{
+    // Remove computations that are fully redundant with a computation in a
+    // dominating block. This complements LVN, which runs after HW conformity
+    // and only looks at a single BB.
+    ::GVN gvn(kernel, builder);
+    gvn.run();
+
+    if (kernel.getOption(vISA_OptReport))
+    {
+        std::ofstream optreport;
+        getOptReportStream(optreport, kernel.getOptions());
+        optreport << "===== GVN =====" << std::endl;
+        optreport << "Number of instructions removed: " << gvn.getNumInstsRemoved() << std::endl;
+        optreport << "Number of instructions removed across BBs: " << gvn.getNumCrossBBRemoved() << std::endl << std::endl;
+        closeOptReportStream(optreport);
+    }
+}
+
+void Optimizer::softwarePipeline()
+{
+    SWPipeliner swp(kernel, mem);
+    swp.run();
+
+    if (kernel.getOption(vISA_OptReport))
+    {
+        std::ofstream optreport;
+        getOptReportStream(optreport, kernel.getOptions());
+        optreport << "===== Software Pipelining =====" << std::endl;
+        for (auto& R : swp.getResults())
+        {
+            optreport << "BB" << R.bbId << ": ";
+            if (R.numPipelined > 0)
+            {
+                optreport << R.numPipelined << " send(s) issued one iteration ahead, estimated II "
+                    << R.origII << " -> " << R.newII << " cycles" << std::endl;
+            }
+            else if (R.pressure + R.extraPressure > R.budget)
+            {
+                optreport << "not pipelined, register pressure " << R.pressure << " + "
+                    << R.extraPressure << " exceeds budget " << R.budget
+                    << ", estimated II " << R.origII << " cycles" << std::endl;
+            }
+            else
+            {
+                optreport << "not pipelined, no improvement over estimated II "
+                    << R.origII << " cycles" << std::endl;
+            }
+        }
+        optreport << std::endl;
+        closeOptReportStream(optreport);
+    }
+}
+
 // helper functions
 
 static int getDstSubReg( G4_DstRegRegion *dst )
@@ -594,6 +649,7 @@ void Optimizer::initOptimizations()
     INITIALIZE_PASS(cselPeepHoleOpt,         vISA_enableCSEL,              TIMER_OPTIMIZER);
     INITIALIZE_PASS(optimizeLogicOperation,  vISA_EnableAlways,            TIMER_OPTIMIZER);
     INITIALIZE_PASS(HWConformityChk,         vISA_EnableAlways,            TIMER_HW_CONFORMITY);
+    INITIALIZE_PASS(softwarePipeline,        vISA_SoftwarePipelining,      TIMER_PRERA_SCHEDULING);
     INITIALIZE_PASS(preRA_Schedule,          vISA_preRA_Schedule,          TIMER_PRERA_SCHEDULING);
     INITIALIZE_PASS(regAlloc,                vISA_EnableAlways,            TIMER_TOTAL_RA);
     INITIALIZE_PASS(removeLifetimeOps,       vISA_EnableAlways,            TIMER_MISC_OPTS);
@@ -615,6 +671,7 @@ void Optimizer::initOptimizations()
     INITIALIZE_PASS(mergeScalarInst,         vISA_MergeScalar,             TIMER_OPTIMIZER);
     INITIALIZE_PASS(lowerMadSequence,        vISA_EnableMACOpt,            TIMER_OPTIMIZER);
     INITIALIZE_PASS(LVN,                     vISA_LVN,                     TIMER_OPTIMIZER);
+    INITIALIZE_PASS(GVN,                     vISA_GVN,                     TIMER_GVN);
     INITIALIZE_PASS(ifCvt,                   vISA_ifCvt,                   TIMER_OPTIMIZER);
     INITIALIZE_PASS(dumpPayload,             vISA_dumpPayload,             TIMER_MISC_OPTS);
     INITIALIZE_PASS(normalizeRegion,         vISA_EnableAlways,            TIMER_MISC_OPTS);
@@ -1117,6 +1174,9 @@ int Optimizer::optimization()
     // Dead code elimination
     runPass(PI_dce);
 
+    // Global Value Numbering
+    runPass(PI_GVN);
+
     // HW conformity check
     runPass(PI_HWConformityChk);
 
@@ -1127,6 +1187,9 @@ int Optimizer::optimization()
 
     runPass(PI_insertFenceBeforeEOT);
 
+    // Issue loads of innermost loops one iteration ahead
+    runPass(PI_softwarePipeline);
+
     // PreRA scheduling
     runPass(PI_preRA_Schedule);
 
@@ -9878,7 +9941,23 @@ void Optimizer::lowerMadSequence()
 
 void Optimizer::ifCvt()
 {
-    runIfCvt(fg);
+    std::vector<IfCvtResult> converted;
+    runIfCvt(fg, converted);
+
+    if (kernel.getOption(vISA_OptReport))
+    {
+        std::ofstream optreport;
+        getOptReportStream(optreport, kernel.getOptions());
+        optreport << "===== If-Conversion =====" << std::endl;
+        for (auto& R : converted)
+        {
+            optreport << "BB" << R.headId << ": nesting level " << R.nestLevel
+                << ", estimated cost " << R.cost
+                << (R.inLoop ? " (in loop)" : "") << std::endl;
+        }
+        optreport << "Number of regions converted: " << converted.size() << std::endl << std::endl;
+        closeOptReportStream(optreport);
+    }
 }
 
 
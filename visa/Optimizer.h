@@ -177,6 +177,7 @@ class Optimizer
     void removeEmptyBlocks() { fg.removeEmptyBlocks(); }
     void reassignBlockIDs() { fg.reassignBlockIDs(); }
     void evalAddrExp() { kernel.evalAddrExp(); }
+    void softwarePipeline();
     void preRA_Schedule()
     {
         preRA_Scheduler Sched(kernel, mem, /*rpe*/ nullptr);
@@ -191,6 +192,8 @@ class Optimizer
 
     void LVN();
 
+    void GVN();
+
     void ifCvt();
 
     void ifCvtFCCall();
@@ -292,6 +295,7 @@ public:
         PI_cselPeepHoleOpt,
         PI_optimizeLogicOperation,
         PI_HWConformityChk,            // always
+        PI_softwarePipeline,
         PI_preRA_Schedule,
         PI_regAlloc,                   // always
         PI_NoDD,
@@ -313,6 +317,7 @@ public:
         PI_mergeScalarInst,
         PI_lowerMadSequence,
         PI_LVN,
+        PI_GVN,
         PI_ifCvt,
         PI_normalizeRegion,            // always
         PI_dumpPayload,
@@ -181,11 +181,15 @@ bool Options::parseOptions(int argc, const char* argv[])
         m_vISAOptions.setBool(vISA_LVN, false);
         m_vISAOptions.setBool(vISA_LocalRARoundRobin, false);
         m_vISAOptions.setBool(vISA_LocalBankConflictReduction, false);
+        m_vISAOptions.setBool(vISA_BankConflictRepair, false);
         m_vISAOptions.setBool(vISA_RoundRobin, false);
         m_vISAOptions.setBool(vISA_SpiltLLR, false);
         m_vISAOptions.setBool(vISA_preRA_Schedule, false);
         m_vISAOptions.setBool(vISA_Debug, true);
     }
+    if (m_vISAOptions.isArgSetByUser(vISA_InMemoryJIT)) {
+        m_vISAOptions.setBool(vISA_NoVerifyvISA, true);
+    }
     if (m_vISAOptions.isArgSetByUser(vISA_Stepping)) {
         const char *stepping = m_vISAOptions.getCstr(vISA_Stepping);
         if (stepping == nullptr)
@@ -223,6 +227,7 @@ bool Options::parseOptions(int argc, const char* argv[])
     if (m_vISAOptions.isArgSetByUser(vISA_ReservedGRFNum)) {
         if (m_vISAOptions.getUint32(vISA_ReservedGRFNum)) {
             m_vISAOptions.setBool(vISA_LocalBankConflictReduction, false);
+            m_vISAOptions.setBool(vISA_BankConflictRepair, false);
         }
     }
 
@@ -379,7 +379,7 @@ LivenessAnalysis::LivenessAnalysis(
         unsigned char kind,
         bool verifyRA,
         bool forceRun) :
-        numVarId(0), numSplitVar(0), numSplitStartID(0), numUnassignedVarId(0), numAddrId(0), selectedRF(kind), m(4096),
+        numVarId(0), numSplitVar(0), numSplitStartID(0), numUnassignedVarId(0), numAddrId(0), selectedRF(kind), m(4096), footprintMem(4096),
 		fg(g.kernel.fg), pointsToAnalysis(g.pointsToAnalysis), gra(g)
 {
 	//
@@ -2303,7 +2303,7 @@ void LivenessAnalysis::computeGenKillandPseudoKill(G4_BB* bb,
                     unsigned int bitsetSize = (dstrgn->isFlag()) ? topdcl->getNumberFlagElements() : topdcl->getByteSize();
 
                     BitSet* newBitSet;
-                    newBitSet = new (m) BitSet(bitsetSize, false);
+                    newBitSet = new (footprintMem) BitSet(bitsetSize, false);
 
                     auto it = neverDefinedRows.find(topdcl);
                     if (it != neverDefinedRows.end())
@@ -2414,7 +2414,7 @@ void LivenessAnalysis::computeGenKillandPseudoKill(G4_BB* bb,
                         unsigned int bitsetSize = (src->asSrcRegRegion()->isFlag()) ? topdcl->getNumberFlagElements() : topdcl->getByteSize();
 
                         BitSet* newBitSet;
-                        newBitSet = new (m) BitSet(bitsetSize, false);
+                        newBitSet = new (footprintMem) BitSet(bitsetSize, false);
 
                         auto it = neverDefinedRows.find(topdcl);
                         if (it != neverDefinedRows.end())
@@ -2503,7 +2503,7 @@ void LivenessAnalysis::computeGenKillandPseudoKill(G4_BB* bb,
                         unsigned int bitsetSize = topdcl->getNumberFlagElements();
 
                         BitSet* newBitSet;
-                        newBitSet = new (m) BitSet(bitsetSize, false);
+                        newBitSet = new (footprintMem) BitSet(bitsetSize, false);
                         toDelete.push(newBitSet);
                         pair<BitSet*, INST_LIST_RITER> second(newBitSet, bb->rbegin());
                         footprints[id] = newBitSet;
@@ -2563,7 +2563,7 @@ void LivenessAnalysis::computeGenKillandPseudoKill(G4_BB* bb,
                     unsigned int bitsetSize = topdcl->getNumberFlagElements();
 
                     BitSet* newBitSet;
-                    newBitSet = new (m) BitSet(bitsetSize, false);
+                    newBitSet = new (footprintMem) BitSet(bitsetSize, false);
                     toDelete.push(newBitSet);
                     pair<BitSet*, INST_LIST_RITER> second(newBitSet, bb->rbegin());
                     footprints[id] = newBitSet;
@@ -2728,6 +2728,7 @@ void LivenessAnalysis::computeGenKillandPseudoKill(G4_BB* bb,
         toDelete.top()->~BitSet();
         toDelete.pop();
     }
+    footprintMem.reset();
 }
 
 //
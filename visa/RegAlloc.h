@@ -405,6 +405,8 @@ class LivenessAnalysis
     std::map<G4_Declare*, BitSet*> neverDefinedRows;
 
     vISA::Mem_Manager m;
+    // per-BB footprints of computeGenKillandPseudoKill(), reset after each BB
+    vISA::Mem_Manager footprintMem;
 
     void computeGenKill(G4_BB* bb,
         BitSet& def_out,
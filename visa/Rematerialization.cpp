@@ -431,7 +431,7 @@ namespace vISA
         return true;
     }
 
-    bool Rematerialization::canRematerialize(G4_SrcRegRegion* src, G4_BB* bb, const Reference*& ref, INST_LIST_ITER instIter)
+    bool Rematerialization::canRematerialize(G4_SrcRegRegion* src, G4_BB* bb, const Reference*& ref, INST_LIST_ITER instIter, RematChain& chain)
     {
         // op1 (8) A   B   C
         // ...
@@ -463,6 +463,10 @@ namespace vISA
         if (src->getAccRegSel() != ACC_UNDEFINED)
             return false;
 
+        bool srcDclSpilled = isRangeSpilled(topdcl);
+        if (spilledOnly && !srcDclSpilled)
+            return false;
+
         // Lookup defs of src in program
         auto opIt = operations.find(topdcl);
         if (opIt == operations.end())
@@ -474,8 +478,9 @@ namespace vISA
         if (!uniqueDef)
             return false;
 
-        // Def has a lot of uses so we will need lots of remat to make this profitable
-        if (refs.numUses > MAX_USES_REMAT)
+        // Def has a lot of uses so we will need lots of remat to make this profitable.
+        // For spilled ranges, cost model below decides instead.
+        if (!srcDclSpilled && refs.numUses > MAX_USES_REMAT)
             return false;
 
         if (uniqueDef->first->getPredicate() ||
@@ -498,21 +503,22 @@ namespace vISA
         if (origOpLexId > srcLexId)
             return false;
 
-        // Def-use must be far away
-        if ((srcLexId - origOpLexId) < MIN_DEF_USE_DISTANCE)
+        bool immOnlyDef = isImmOnlyOp(uniqueDefInst);
+        bool addrComputation = isAddrComputation(uniqueDefInst);
+
+        // Def-use must be far away. Spilled range is filled before use
+        // irrespective of distance.
+        if (!srcDclSpilled && !immOnlyDef &&
+            (srcLexId - origOpLexId) < MIN_DEF_USE_DISTANCE)
             return false;
 
         if (!inSameSubroutine(bb, uniqueDefBB))
             return false;
 
-#if 0
-        // idom currently not computed
-
         // Def must be in a dominating BB
         auto defDomsUse = doms.dominates(uniqueDefBB, bb);
         if (!defDomsUse)
             return false;
-#endif
 
         // If uniqueDefBB is not under SIMD CF, current BB is under SIMD CF
         // then we can remat only if def has NoMask option set.
@@ -525,24 +531,27 @@ namespace vISA
 
         // Check whether they are in a loop. If yes, they should be in same loop.
         bool uniqueDefOutsideLoop = false;
-        bool srcDclSpilled = isRangeSpilled(topdcl);
         bool inSameLoop = areInSameLoop(uniqueDefBB, bb, uniqueDefOutsideLoop);
         bool onlyUseInLoop = uniqueDefOutsideLoop && !inSameLoop;
         bool doNumRematCheck = false;
 
         // Decide whether it is profitable to push def inside loop before each use
-        if (onlyUseInLoop && !srcDclSpilled)
+        if (onlyUseInLoop && !srcDclSpilled && !immOnlyDef)
         {
             // If topdcl does not interfere with other spilled
             // range then skip remating this operation.
-            // Be less aggressive if this is SIMD8 since we run the
-            // chance of perf penalty with this.
-            if (kernel.getSimdSize() == 8 ||
-                rematCandidates[topdcl->getRegVar()->getId()] == false ||
+            if (rematCandidates[topdcl->getRegVar()->getId()] == false ||
                 rpe.getRegisterPressure(srcInst) < rematLoopRegPressure)
                 return false;
 
-            if (getNumRematsInLoop() > 0)
+            // Be less aggressive if this is SIMD8 since we run the
+            // chance of perf penalty with this. Loop invariant address
+            // computations are exempt as they cost a single integer
+            // op in loop and their srcs are required to be live below.
+            if (kernel.getSimdSize() == 8 && !addrComputation)
+                return false;
+
+            if (getNumRematsInLoop() > 0 && !addrComputation)
             {
                 // Restrict non-SIMD1 remats to a low percent of loop instructions.
                 float loopInstToTotalInstRatio = (float)getNumRematsInLoop() / (float)loopInstsBeforeRemat*100.0f;
@@ -561,7 +570,7 @@ namespace vISA
                 // allow remat if op1 dst dcl is marked spilled.
                 // Because that means a load will  be inserted in the 
                 // loop and remat might be more efficient here.
-                if (!srcDclSpilled)
+                if (!srcDclSpilled && !immOnlyDef && !addrComputation)
                 {
                     // If src dcl is not spilled, check whether all
                     // src opnds of defInst have been remat'd atleast once.
@@ -580,7 +589,7 @@ namespace vISA
             // single use within the loop then remat
             // can be done as it doesnt contribute to
             // increase in inst count.
-            if (!srcDclSpilled && refs.numUses > 1)
+            if (!srcDclSpilled && !immOnlyDef && refs.numUses > 1)
                 return false;
         }
 
@@ -751,6 +760,7 @@ namespace vISA
             }
         }
 
+        unsigned int chainCost = 0;
         if (anySrcNotLive)
         {
             // Apply cost heuristic. It may be profitable to extend
@@ -761,6 +771,23 @@ namespace vISA
                 {
                     G4_SrcRegRegion* srcRgn = uniqueDefInst->getSrc(i)->asSrcRegRegion();
 
+                    // Recompute src along with def if its own def is a
+                    // cheap ALU op whose srcs are live at use.
+                    auto chainDef = findChainDef(srcRgn, uniqueDef, bb, srcLexId);
+                    if (chainDef)
+                    {
+                        chain.push_back(std::make_pair(i, chainDef));
+                        chainCost += getInstCost(chainDef->first);
+                        continue;
+                    }
+
+                    if (onlyUseInLoop && addrComputation && !srcDclSpilled)
+                    {
+                        // Address computation is remat'd in loop only
+                        // if it doesnt extend any range into the loop.
+                        return false;
+                    }
+
                     if (srcRgn->getTopDcl()->getNumElems() > 1)
                     {
                         // Extending non-scalar operands can be expensive
@@ -781,10 +808,197 @@ namespace vISA
             return false;
         }
 
+        if (srcDclSpilled &&
+            isSpillCheaper(refs, uniqueDefInst, chainCost, bb))
+        {
+            return false;
+        }
+
+        return true;
+    }
+
+    unsigned int Rematerialization::getInstCost(G4_INST* inst)
+    {
+        if (inst->isSend())
+            return cFillCost;
+
+        if (inst->isMath())
+            return cMathCost;
+
+        // Ops writing more than 2 GRFs are split in to multiple instructions
+        auto dst = inst->getDst();
+        if (dst && (dst->getRightBound() - dst->getLeftBound() + 1) > 2u * G4_GRF_REG_NBYTES)
+            return 2;
+
+        return 1;
+    }
+
+    bool Rematerialization::isSpillCheaper(const References& refs, G4_INST* defInst, unsigned int chainCost, G4_BB* useBB)
+    {
+        // Spilled range is written to memory once per def and filled
+        // once per use. Remat recomputes def and its chained defs before
+        // each use instead. Both costs are scaled by loop nesting as
+        // spill/fill/remat code executes once per iteration.
+        unsigned int useWeight = GlobalRA::getRefCount(useBB->getNestLevel());
+        unsigned int spillCost = refs.numUses * cFillCost * useWeight;
+        for (auto&& d : refs.def)
+        {
+            spillCost += cSpillCost * GlobalRA::getRefCount(d.second->getNestLevel());
+        }
+
+        unsigned int rematCost = refs.numUses * (getInstCost(defInst) + chainCost) * useWeight;
+
+        return spillCost <= rematCost;
+    }
+
+    const Reference* Rematerialization::findChainDef(G4_SrcRegRegion* src, const Reference* def, G4_BB* useBB, unsigned int useLexId)
+    {
+        // src is a non-live src opnd of def. Return unique def of src if
+        // it is a cheap ALU op that can be recomputed just before def's
+        // remat in useBB without extending any other live-range:
+        //
+        // op0 (8) B   X   Y    <-- chain def, X and Y live at use
+        // op1 (8) A   B   C    <-- def
+        // ...
+        // op2 (8) D   A   E    <-- use
+        auto srcDcl = src->getTopDcl();
+        if (!srcDcl || srcDcl->getAddressed() || srcDcl->getRegVar()->getPhyReg())
+            return nullptr;
+
+        auto opIt = operations.find(srcDcl);
+        if (opIt == operations.end())
+            return nullptr;
+
+        auto chainDef = findUniqueDef((*opIt).second, src);
+        if (!chainDef)
+            return nullptr;
+
+        auto chainInst = chainDef->first;
+        auto chainBB = chainDef->second;
+
+        if (!isCheapALUOp(chainInst) ||
+            chainInst->getLexicalId() > def->first->getLexicalId())
+            return nullptr;
+
+        if (!inSameSubroutine(useBB, chainBB) ||
+            !doms.dominates(chainBB, def->second))
+            return nullptr;
+
+        bool chainOutsideLoop = false;
+        if (!areInSameLoop(chainBB, def->second, chainOutsideLoop))
+            return nullptr;
+
+        if (!chainBB->isInSimdFlow() &&
+            useBB->isInSimdFlow() &&
+            !chainInst->isWriteEnableInst())
+            return nullptr;
+
+        for (unsigned int i = 0; i < G4_MAX_SRCS; i++)
+        {
+            auto srcOpnd = chainInst->getSrc(i);
+            if (!srcOpnd || srcOpnd->isImm() || srcOpnd->isNullReg())
+                continue;
+
+            if (!srcOpnd->isSrcRegRegion() ||
+                !srcOpnd->getBase()->isRegVar())
+                return nullptr;
+
+            auto srcOpndRgn = srcOpnd->asSrcRegRegion();
+            auto srcOpndTopDcl = srcOpndRgn->getTopDcl();
+            if (!srcOpndTopDcl || srcOpndTopDcl->getAddressed() ||
+                srcOpndRgn->getAccRegSel() != ACC_UNDEFINED)
+                return nullptr;
+
+            if ((srcOpndTopDcl->getRegFile() &
+                (G4_RegFileKind::G4_GRF | G4_RegFileKind::G4_INPUT)) == 0x0)
+                return nullptr;
+
+            if (srcOpndRgn->getBase()->asRegVar()->getPhyReg() &&
+                !srcOpndTopDcl->isInput())
+                return nullptr;
+
+            auto srcOpIt = operations.find(srcOpndTopDcl);
+            if (srcOpIt == operations.end())
+                return nullptr;
+
+            auto&& srcOpndRefs = (*srcOpIt).second;
+            if (srcOpndTopDcl->isInput())
+            {
+                if (srcOpndRefs.def.size() > 0)
+                    return nullptr;
+            }
+            else if (!findUniqueDef(srcOpndRefs, srcOpndRgn))
+            {
+                return nullptr;
+            }
+
+            // Only a single level of chaining is done so srcs of
+            // chained def must be live at use.
+            if (!liveness.isLiveAtExit(useBB, srcOpndTopDcl->getRegVar()->getId()) &&
+                srcOpndRefs.lastUseLexId < useLexId)
+                return nullptr;
+        }
+
+        return chainDef;
+    }
+
+    bool Rematerialization::canReuseRemat(const RematValue& rematValue, G4_BB* bb, G4_INST* inst)
+    {
+        if (inst->getLexicalId() < rematValue.lastLexId)
+            return false;
+
+        unsigned int distance = inst->getLexicalId() - rematValue.lastLexId;
+        if (rematValue.bb == bb)
+            return distance <= MAX_LOCAL_REMAT_REUSE_DISTANCE;
+
+        // Remat'd value may be reused in other BB along dominator path
+        // as long as it doesnt cross loop or subroutine boundaries.
+        if (distance > MAX_GLOBAL_REMAT_REUSE_DISTANCE)
+            return false;
+
+        if (!inSameSubroutine(bb, rematValue.bb) ||
+            !doms.dominates(rematValue.bb, bb))
+            return false;
+
+        bool rematOutsideLoop = false;
+        if (!areInSameLoop(rematValue.bb, bb, rematOutsideLoop))
+            return false;
+
+        // Under SIMD CF, remat'd value may not be written for all
+        // channels enabled at current use.
+        if ((rematValue.bb->isInSimdFlow() || bb->isInSimdFlow()) &&
+            !rematValue.inst->isWriteEnableInst())
+            return false;
+
         return true;
     }
 
-    G4_SrcRegRegion* Rematerialization::rematerialize(G4_SrcRegRegion* src, G4_BB* bb, const Reference* uniqueDef, std::list<G4_INST*>& newInst, G4_INST*& cacheInst)
+    G4_INST* Rematerialization::duplicateOp(G4_INST* dstInst, G4_DstRegRegion* newDst)
+    {
+        G4_INST* dupOp = nullptr;
+
+        if (dstInst->isMath())
+        {
+            dupOp = kernel.fg.builder->createMathInst(dstInst->getPredicate(), dstInst->getSaturate(), dstInst->getExecSize(),
+                newDst, kernel.fg.builder->duplicateOperand(dstInst->getSrc(0)), kernel.fg.builder->duplicateOperand(dstInst->getSrc(1)),
+                dstInst->asMathInst()->getMathCtrl(), dstInst->getOption());
+        }
+        else
+        {
+            dupOp = kernel.fg.builder->createInternalInst(dstInst->getPredicate(), dstInst->opcode(), dstInst->getCondMod(),
+                dstInst->getSaturate(), dstInst->getExecSize(), newDst, kernel.fg.builder->duplicateOperand(dstInst->getSrc(0)),
+                kernel.fg.builder->duplicateOperand(dstInst->getSrc(1)), kernel.fg.builder->duplicateOperand(dstInst->getSrc(2)),
+                dstInst->getOption());
+        }
+
+        dupOp->setLineNo(dstInst->getLineNo());
+        dupOp->setCISAOff(dstInst->getCISAOff());
+
+        return dupOp;
+    }
+
+    G4_SrcRegRegion* Rematerialization::rematerialize(G4_SrcRegRegion* src, G4_BB* bb, const Reference* uniqueDef, const RematChain& chain,
+        std::list<G4_INST*>& newInst, G4_INST*& cacheInst)
     {
         // op1 (8) A   B   C
         // ...
@@ -814,31 +1028,50 @@ namespace vISA
 
         if (!isSampler)
         {
-            unsigned int diffBound = dst->getRightBound() - (dst->getRegOff() * G4_GRF_REG_NBYTES);
-            unsigned numElems = (diffBound + 1) / G4_Type_Table[dst->getType()].byteSize;
-            auto newTemp = kernel.fg.builder->createTempVar(numElems, dst->getType(), dst->getTopDcl()->getAlign(),
-                dst->getTopDcl()->getSubRegAlign(), "REMAT_");
-            G4_DstRegRegion* newDst = kernel.fg.builder->createDstRegRegion(Direct, newTemp->getRegVar(), 0,
-                (dst->getLeftBound() % G4_GRF_REG_NBYTES) / G4_Type_Table[dst->getType()].byteSize,
-                dst->getHorzStride(), dst->getType());
-            G4_INST* dupOp = nullptr;
-
-            if (dstInst->isMath())
+            auto createRematDst = [&](G4_DstRegRegion* dst, G4_Declare*& newTemp)
             {
-                dupOp = kernel.fg.builder->createMathInst(dstInst->getPredicate(), dstInst->getSaturate(), dstInst->getExecSize(),
-                    newDst, kernel.fg.builder->duplicateOperand(dstInst->getSrc(0)), kernel.fg.builder->duplicateOperand(dstInst->getSrc(1)),
-                    dstInst->asMathInst()->getMathCtrl(), dstInst->getOption());
-            }
-            else
+                unsigned int diffBound = dst->getRightBound() - (dst->getRegOff() * G4_GRF_REG_NBYTES);
+                unsigned numElems = (diffBound + 1) / G4_Type_Table[dst->getType()].byteSize;
+                newTemp = kernel.fg.builder->createTempVar(numElems, dst->getType(), dst->getTopDcl()->getAlign(),
+                    dst->getTopDcl()->getSubRegAlign(), "REMAT_");
+                return kernel.fg.builder->createDstRegRegion(Direct, newTemp->getRegVar(), 0,
+                    (dst->getLeftBound() % G4_GRF_REG_NBYTES) / G4_Type_Table[dst->getType()].byteSize,
+                    dst->getHorzStride(), dst->getType());
+            };
+
+            // Recompute chained defs first so remat'd op can read them
+            // instead of extending their original ranges.
+            std::vector<std::pair<unsigned int, G4_Declare*>> chainTemps;
+            for (auto&& c : chain)
             {
-                dupOp = kernel.fg.builder->createInternalInst(dstInst->getPredicate(), dstInst->opcode(), dstInst->getCondMod(),
-                    dstInst->getSaturate(), dstInst->getExecSize(), newDst, kernel.fg.builder->duplicateOperand(dstInst->getSrc(0)),
-                    kernel.fg.builder->duplicateOperand(dstInst->getSrc(1)), kernel.fg.builder->duplicateOperand(dstInst->getSrc(2)),
-                    dstInst->getOption());
+                auto chainInst = c.second->first;
+                for (unsigned int i = 0; i < G4_MAX_SRCS; i++)
+                {
+                    G4_Operand* chainSrc = chainInst->getSrc(i);
+                    if (chainSrc &&
+                        chainSrc->isSrcRegRegion())
+                    {
+                        incNumRemat(chainSrc->asSrcRegRegion()->getTopDcl());
+                    }
+                }
+
+                G4_Declare* chainTemp = nullptr;
+                G4_DstRegRegion* chainDst = createRematDst(chainInst->getDst(), chainTemp);
+                newInst.push_back(duplicateOp(chainInst, chainDst));
+                chainTemps.push_back(std::make_pair(c.first, chainTemp));
             }
 
-            dupOp->setLineNo(dstInst->getLineNo());
-            dupOp->setCISAOff(dstInst->getCISAOff());
+            G4_Declare* newTemp = nullptr;
+            G4_DstRegRegion* newDst = createRematDst(dst, newTemp);
+            G4_INST* dupOp = duplicateOp(dstInst, newDst);
+
+            for (unsigned int i = 0; i != chain.size(); i++)
+            {
+                unsigned int srcNum = chainTemps[i].first;
+                auto chainSrc = createSrcRgn(dstInst->getSrc(srcNum)->asSrcRegRegion(),
+                    chain[i].second->first->getDst(), chainTemps[i].second);
+                dupOp->setSrc(chainSrc, srcNum);
+            }
 
             rematSrc = createSrcRgn(src, dst, newTemp);
 
@@ -1011,6 +1244,11 @@ namespace vISA
 
         auto firstProgInst = kernel.fg.BBs.front()->getFirstInst();
 
+        // Store cache of rematerialized operations so nearby instructions,
+        // in same BB or in BBs dominated by it, can reuse them.
+        // <Unique def, <Remat'd def, BB, Lexical id of last ref>>
+        std::map<const Reference*, RematValue> rematValues;
+
         for (auto bb : kernel.fg.BBs)
         {
             if (kernel.getOptions()->getTarget() == VISATarget::VISA_3D)
@@ -1019,10 +1257,6 @@ namespace vISA
                 // For IGC, assume cr0 is reset at each BB entry
                 cr0DefBB = false;
             }
-            // Store cache of rematerialized operations so nearby instructions
-            // can reuse them.
-            // <Unique def, <Remat'd def, Lexical id of last ref>>
-            std::map<const Reference*, std::pair<G4_INST*, unsigned int>> rematValues;
             for (auto instIt = bb->begin();
                 instIt != bb->end();
                 instIt++)
@@ -1045,7 +1279,7 @@ namespace vISA
                         auto srcTopDcl = src->getTopDcl();
                         if (srcTopDcl && srcTopDcl->getRegVar()->isRegAllocPartaker() &&
                             (isRangeSpilled(srcTopDcl) ||
-                            rematCandidates[srcTopDcl->getRegVar()->getId()] == true))
+                            (!spilledOnly && rematCandidates[srcTopDcl->getRegVar()->getId()] == true)))
                         {
                             // Run remat for spilled src opnd even if
                             // register pressure is low.
@@ -1057,6 +1291,9 @@ namespace vISA
 
                 if (!runRemat)
                 {
+                    if (spilledOnly)
+                        continue;
+
                     auto regPressure = rpe.getRegisterPressure(inst);
 
                     if (regPressure < rematRegPressure)
@@ -1075,30 +1312,30 @@ namespace vISA
                     {
                         const Reference* uniqueDef = nullptr;
                         G4_SrcRegRegion* rematSrc = nullptr;
+                        RematChain chain;
 
-                        bool canRemat = canRematerialize(src->asSrcRegRegion(), bb, uniqueDef, instIt);
+                        bool canRemat = canRematerialize(src->asSrcRegRegion(), bb, uniqueDef, instIt, chain);
                         if (canRemat)
                         {
                             bool reUseRemat = false;
                             auto prevRematIt = rematValues.find(uniqueDef);
                             if (prevRematIt != rematValues.end())
                             {
-                                if ((inst->getLexicalId() - (*prevRematIt).second.second) <=
-                                    MAX_LOCAL_REMAT_REUSE_DISTANCE)
+                                if (canReuseRemat((*prevRematIt).second, bb, inst))
                                 {
                                     reUseRemat = true;
                                     rematSrc = createSrcRgn(src->asSrcRegRegion(), uniqueDef->first->getDst(),
-                                        (*prevRematIt).second.first->getDst()->getTopDcl());
+                                        (*prevRematIt).second.inst->getDst()->getTopDcl());
 
                                     reduceNumUses(src->getTopDcl());
 
 #if 0
                                     printf("Reusing rematerialized value %s in src%d of $%d from %s\n",
                                         src->getTopDcl()->getName(), opnd, inst->getCISAOff(),
-                                        (*prevRematIt).second.first->getDst()->getTopDcl()->getName());
+                                        (*prevRematIt).second.inst->getDst()->getTopDcl()->getName());
 #endif
+                                    (*prevRematIt).second.lastLexId = inst->getLexicalId();
                                 }
-                                (*prevRematIt).second.second = inst->getLexicalId();
                             }
 
                             if (!reUseRemat)
@@ -1109,14 +1346,15 @@ namespace vISA
 #endif
                                 std::list<G4_INST*> newInsts;
                                 G4_INST* cacheInst = nullptr;
-                                rematSrc = rematerialize(src->asSrcRegRegion(), bb, uniqueDef, newInsts, cacheInst);
+                                rematSrc = rematerialize(src->asSrcRegRegion(), bb, uniqueDef, chain, newInsts, cacheInst);
                                 while (!newInsts.empty())
                                 {
                                     bb->insert(instIt, newInsts.front());
                                     newInsts.pop_front();
                                 }
 
-                                rematValues.insert(std::make_pair(uniqueDef, std::make_pair(cacheInst, src->getInst()->getLexicalId())));
+                                RematValue rematValue = { cacheInst, bb, src->getInst()->getLexicalId() };
+                                rematValues[uniqueDef] = rematValue;
 
                                 reduceNumUses(src->getTopDcl());
 
@@ -1139,46 +1377,4 @@ namespace vISA
 
         //unsigned int after = getNumSamplers(kernel);
     }
-
-    void Dominators::computeDominators()
-    {
-        // Compute all doms for given bb.
-        // Flowgraph already has idoms for each bb.
-        for (auto&& bb : fg.BBs)
-        {
-            std::pair<G4_BB*, std::set<G4_BB*>> domBB;
-            domBB.first = bb;
-            auto idom = bb->getIDom();
-            while (idom)
-            {
-                domBB.second.insert(bb->getIDom());
-                idom = idom->getIDom();
-            }
-        }
-    }
-    bool Dominators::dominates(G4_BB* def, G4_BB* use)
-    {
-        auto dIt = dom.find(use);
-        if (dIt == dom.end())
-            return false;
-
-        auto bbIt = dIt->second.find(def);
-        if (bbIt == dIt->second.end())
-            return false;
-
-        return true;
-    }
-
-    void Dominators::dump()
-    {
-        for (auto&& bb : dom)
-        {
-            printf("BB%d:", bb.first->getId());
-            for (auto&& d : bb.second)
-            {
-                printf("BB%d, ", d->getId());
-            }
-            printf("\n\n");
-        }
-    }
 }
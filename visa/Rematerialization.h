@@ -44,6 +44,13 @@ namespace vISA
 // Distance in instructions to reuse rematted value in BB
 #define MAX_LOCAL_REMAT_REUSE_DISTANCE 40
 
+// Distance in instructions to reuse rematted value in a BB dominated
+// by the BB holding the rematted value
+#define MAX_GLOBAL_REMAT_REUSE_DISTANCE 120
+
+// Number of extra remat rounds run on spilled ranges from RA spill loop
+#define MAX_SPILL_REMAT_ROUNDS 2
+
     typedef std::pair<G4_INST*, G4_BB*> Reference;
     class References
     {
@@ -70,24 +77,16 @@ namespace vISA
         std::unordered_set<unsigned int> rowsUsed;
     };
 
-    class Dominators
-    {
-    private:
-        std::map<G4_BB*, std::set<G4_BB*>> dom;
-
-        FlowGraph& fg;
+    // Defs of non-live src operands of a remat candidate that are
+    // recomputed along with it. Each entry is <src opnd #, unique def>.
+    typedef std::vector<std::pair<unsigned int, const Reference*>> RematChain;
 
-    public:
-        Dominators(FlowGraph& f) : fg(f)
-        {
-            computeDominators();
-        }
-
-        // Store dominator information in data structure above for easy querying.
-        // Flow graph stores immediate doms of each BB.s
-        void computeDominators();
-        bool dominates(G4_BB*, G4_BB*);
-        void dump();
+    // Remat'd value available for reuse by later uses of same def
+    struct RematValue
+    {
+        G4_INST* inst;
+        G4_BB* bb;
+        unsigned int lastLexId;
     };
 
     class Rematerialization
@@ -96,7 +95,7 @@ namespace vISA
         G4_Kernel& kernel;
         LivenessAnalysis& liveness;
         GraphColor& coloring;
-        Dominators doms;
+        DomTree& doms;
         G4_Declare* samplerHeader = nullptr;
         unsigned int numRematsInLoop = 0;
         bool IRChanged = false;
@@ -108,6 +107,15 @@ namespace vISA
         const unsigned int cRematLoopRegPressure128GRF = 85;
         const unsigned int cRematRegPressure128GRF = 120;
 
+        // Relative costs used to decide whether recomputing a spilled
+        // range is cheaper than filling it at each use.
+        const unsigned int cFillCost = 10;
+        const unsigned int cSpillCost = 8;
+        const unsigned int cMathCost = 4;
+
+        // Only remat spilled ranges. Set when invoked from RA spill loop.
+        bool spilledOnly = false;
+
         unsigned int rematLoopRegPressure = 0;
         unsigned int rematRegPressure = 0;
 
@@ -131,8 +139,13 @@ namespace vISA
         void populateRefs();
         void populateSamplerHeaderMap();
         void deLVNSamplers(G4_BB*);
-        bool canRematerialize(G4_SrcRegRegion*, G4_BB*, const Reference*&, INST_LIST_ITER instIter);
-        G4_SrcRegRegion* rematerialize(G4_SrcRegRegion*, G4_BB*, const Reference*, std::list<G4_INST*>&, G4_INST*&);
+        bool canRematerialize(G4_SrcRegRegion*, G4_BB*, const Reference*&, INST_LIST_ITER instIter, RematChain&);
+        G4_SrcRegRegion* rematerialize(G4_SrcRegRegion*, G4_BB*, const Reference*, const RematChain&, std::list<G4_INST*>&, G4_INST*&);
+        G4_INST* duplicateOp(G4_INST*, G4_DstRegRegion*);
+        const Reference* findChainDef(G4_SrcRegRegion*, const Reference*, G4_BB*, unsigned int);
+        bool canReuseRemat(const RematValue&, G4_BB*, G4_INST*);
+        bool isSpillCheaper(const References&, G4_INST*, unsigned int, G4_BB*);
+        unsigned int getInstCost(G4_INST*);
         G4_SrcRegRegion* createSrcRgn(G4_SrcRegRegion*, G4_DstRegRegion*, G4_Declare*);
         const Reference* findUniqueDef(References&, G4_SrcRegRegion*);
         bool areInSameLoop(G4_BB*, G4_BB*, bool&);
@@ -200,6 +213,54 @@ namespace vISA
             return true;
         }
 
+        // Cheap ALU ops that can be recomputed as part of a remat chain
+        bool isCheapALUOp(G4_INST* inst)
+        {
+            switch (inst->opcode())
+            {
+            case G4_mov:
+            case G4_add:
+            case G4_mul:
+            case G4_shl:
+            case G4_shr:
+            case G4_asr:
+            case G4_and:
+            case G4_or:
+            case G4_xor:
+            case G4_not:
+                return !inst->getPredicate() && !inst->getCondMod() &&
+                    isRematCandidateOp(inst);
+            default:
+                return false;
+            }
+        }
+
+        // Integer computation of the kind used to form addresses and
+        // surface offsets, eg add/shl/mul of live values and immediates.
+        bool isAddrComputation(G4_INST* inst)
+        {
+            auto dst = inst->getDst();
+            return isCheapALUOp(inst) && dst && IS_TYPE_INT(dst->getType()) &&
+                inst->opcode() != G4_xor && inst->opcode() != G4_not;
+        }
+
+        // Def whose srcs are all immediates, eg header and surface state
+        // setup. Recomputing such defs never extends any live-range.
+        bool isImmOnlyOp(G4_INST* inst)
+        {
+            if (inst->isSend() || inst->isMath() || !isCheapALUOp(inst))
+                return false;
+
+            for (int i = 0; i < inst->getNumSrc(); i++)
+            {
+                auto src = inst->getSrc(i);
+                if (src && !src->isImm())
+                    return false;
+            }
+
+            return true;
+        }
+
         void cleanRedundantSamplerHeaders();
 
         unsigned int getNumRematsInLoop() { return numRematsInLoop; }
@@ -207,8 +268,8 @@ namespace vISA
         bool inSameSubroutine(G4_BB*, G4_BB*);
 
     public:
-        Rematerialization(G4_Kernel& k, LivenessAnalysis& l, GraphColor& c, RPE& r) :
-            kernel(k), liveness(l), coloring(c), doms(k.fg), rpe(r)
+        Rematerialization(G4_Kernel& k, LivenessAnalysis& l, GraphColor& c, RPE& r, bool onlySpilled = false) :
+            kernel(k), liveness(l), coloring(c), doms(k.fg.getDomTree()), rpe(r), spilledOnly(onlySpilled)
         {
             unsigned int numGRFs = k.getOptions()->getuInt32Option(vISA_TotalGRFNum);
             rematLoopRegPressure = numGRFs - (128 - cRematLoopRegPressure128GRF);
@@ -27,6 +27,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "SendFusion.h"
 #include "BuildIR.h"
 #include "Gen4_IR.hpp"
+#include "GraphColor.h"
 
 #include <map>
 #include <algorithm>
@@ -45,9 +46,19 @@ namespace vISA
             // SEND_FUSION_MAX_SPAN, it will not be fused.
             SEND_FUSION_MAX_SPAN = 40,
 
+            // The span used instead of SEND_FUSION_MAX_SPAN when register
+            // pressure at the first send is low, or when fusion would push
+            // it over the number of GRFs.
+            SEND_FUSION_MAX_SPAN_LOW_RP = 80,
+            SEND_FUSION_MAX_SPAN_HIGH_RP = 16,
+
 			// Control how many instructions except send itself need to
 			// be moved in order to move two sends together for fusion.
-			SEND_FUSION_MAX_INST_TOBEMOVED = 4
+			SEND_FUSION_MAX_INST_TOBEMOVED = 4,
+
+            // Upper bound of the above when register pressure is low
+            // (size of InstToBeSinked[]/InstToBeHoisted[]).
+            SEND_FUSION_MAX_INST_TOBEMOVED_LOW_RP = 8
         };
 
         FlowGraph* CFG;
@@ -72,8 +83,30 @@ namespace vISA
 		// to be moved (so the size has +1).
 		int numToBeSinked;
 		int numToBeHoisted;
-		G4_INST* InstToBeSinked [SEND_FUSION_MAX_INST_TOBEMOVED+1];
-		G4_INST* InstToBeHoisted[SEND_FUSION_MAX_INST_TOBEMOVED+1];
+		G4_INST* InstToBeSinked [SEND_FUSION_MAX_INST_TOBEMOVED_LOW_RP+1];
+		G4_INST* InstToBeHoisted[SEND_FUSION_MAX_INST_TOBEMOVED_LOW_RP+1];
+
+        // Fusion window for the pair being processed, set by
+        // setFusionWindow() from the register pressure at the first send.
+        int MaxSpan;
+        int MaxInstToBeMoved;
+
+        // Register pressure estimate, computed on the first fusible pair.
+        PointsToAnalysis* P2A;
+        GlobalRA* GRA;
+        LivenessAnalysis* Liveness;
+        RPE* RPEstimate;
+
+        // Instructions moved by hoistAcrossFallThrough(), from HoistedFirst
+        // up to the send HoistedSend, the BB they were moved from and the
+        // operands they define.
+        G4_BB* HoistedFrom;
+        G4_INST* HoistedFirst;
+        G4_INST* HoistedSend;
+        std::vector<G4_Operand*> HoistedDefs;
+
+        void initRegPressure();
+        void setFusionWindow(G4_INST* Send0);
 
 		//
 		// For Both doSink() and doHoist(), all instructions to be moved
@@ -131,6 +164,9 @@ namespace vISA
         uint32_t getFuncCtrlWithSimd16(G4_SendMsgDescriptor* Desc);
         void simplifyMsg(INST_LIST_ITER SendIter);
         bool isAtomicCandidate(G4_SendMsgDescriptor* msgDesc);
+        bool isSamplerLDCandidate(G4_SendMsgDescriptor* msgDesc);
+        bool isA64ReadCandidate(G4_INST* Send);
+        bool isReadOnlySend(G4_INST* Send);
 
 		bool WAce0Read;
 
@@ -143,12 +179,37 @@ namespace vISA
               CurrBB(nullptr),
               DMaskUD(nullptr),
               FlagDefPerBB(nullptr),
+              MaxSpan(SEND_FUSION_MAX_SPAN),
+              MaxInstToBeMoved(SEND_FUSION_MAX_INST_TOBEMOVED),
+              P2A(nullptr),
+              GRA(nullptr),
+              Liveness(nullptr),
+              RPEstimate(nullptr),
+              HoistedFrom(nullptr),
+              HoistedFirst(nullptr),
+              HoistedSend(nullptr),
 			  WAce0Read(false)
         {
 			WAce0Read = VISA_WA_CHECK(Builder->getPWaTable(), Wa_1406950495) ;
             initDMaskModInfo();
         }
 
+        ~SendFusion()
+        {
+            delete RPEstimate;
+            delete Liveness;
+            delete GRA;
+            delete P2A;
+        }
+
+        // Move the instructions of Succ up to its first send into Pred if that
+        // send may be fused with the last send of Pred. Return true if moved.
+        bool hoistAcrossFallThrough(G4_BB* Pred, G4_BB* Succ);
+        // Called after run(Pred) following a successful hoistAcrossFallThrough().
+        // Keep the moved instructions in Pred if their send has been fused,
+        // otherwise move them back. Return true if kept.
+        bool finishHoist(G4_BB* Pred);
+
         bool run(G4_BB* BB);
 	};
 }
@@ -196,8 +257,21 @@ uint32_t SendFusion::getFuncCtrlWithSimd16(G4_SendMsgDescriptor* Desc)
             // bit12: SM2R
             FC = ((FC & ~0x1000) | (MDC_SM2R_SIMD16 << 12));
             break;
+        case DC1_A64_SCATTERED_READ:
+            // bit12: SM2
+            FC = ((FC & ~0x1000) | (MDC_SM2_SIMD16 << 12));
+            break;
+        case DC1_A64_UNTYPED_SURFACE_READ:
+            // bit13-12: SM3
+            FC = ((FC & ~0x3000) | (MDC_SM3_SIMD16 << 12));
+            break;
         }
     }
+    else if (funcID == SFID_SAMPLER)
+    {
+        // bit18-17: SIMD Mode (SIMD8 = 1, SIMD16 = 2)
+        FC = ((FC & ~0x60000) | (2 << 17));
+    }
     else if (funcID == SFID_DP_DC2)
     {
         switch (msgType)
@@ -291,9 +365,71 @@ bool SendFusion::isAtomicCandidate(G4_SendMsgDescriptor* msgDesc)
     // Need to check if it is packed half integer/float ?
 }
 
-// We will do send fusion for a few messages. Those messages all
-// have DW-sized address for each lane, thus address payload is
-// 1 GRF for exec_size=8 (no A64 messages for now).
+// Sampler LD (SIMD8, 32-bit payload and return) has one GRF per
+// parameter and per returned channel, the same layout as the untyped
+// read. Its SIMD16 form interleaves them in the same way.
+bool SendFusion::isSamplerLDCandidate(G4_SendMsgDescriptor* msgDesc)
+{
+    if (!msgDesc->isSampler())
+    {
+        return false;
+    }
+
+    uint32_t desc = msgDesc->getDesc();
+    uint32_t samplerMsgType = (desc >> 12) & 0x1F;
+    uint32_t simdMode = (desc >> 17) & 0x3;
+    bool halfInput = (desc & (1 << 29)) != 0;
+    bool halfReturn = (desc & (1 << 30)) != 0;
+    return samplerMsgType == VISA_3D_LD && simdMode == 1 &&
+           !halfInput && !halfReturn && msgDesc->ResponseLength() > 0;
+}
+
+// A64 reads have a 64-bit address per lane, thus 2 GRFs of address
+// payload for exec_size=8. Only the form whose address payloads can
+// be concatenated with a split send is handled (see doFusion()).
+bool SendFusion::isA64ReadCandidate(G4_INST* Send)
+{
+    G4_SendMsgDescriptor* msgDesc = Send->getMsgDesc();
+    if (msgDesc->getFuncId() != SFID_DP_DC1 ||
+        Send->isSplitSend() || Send->getExecSize() != 8 ||
+        msgDesc->MessageLength() != 2 || msgDesc->ResponseLength() == 0)
+    {
+        return false;
+    }
+
+    uint32_t FC = msgDesc->getFuncCtrl();
+    switch (msgDesc->getMessageType())
+    {
+    default:
+        return false;
+    case DC1_A64_UNTYPED_SURFACE_READ:
+        return true;
+    case DC1_A64_SCATTERED_READ:
+    {
+        // Response must be DW per lane per block.
+        uint32_t blockSize = (FC >> MSG_BLOCK_SIZE_OFFSET) & 0x3;
+        uint32_t numBlocks = (FC >> MSG_BLOCK_NUMBER_OFFSET) & 0x3;
+        return blockSize == SVM_BLOCK_TYPE_DWORD ||
+               (blockSize == SVM_BLOCK_TYPE_BYTE && numBlocks != SVM_BLOCK_NUM_8);
+    }
+    }
+}
+
+// Return true if Send only reads memory. Such sends may be skipped
+// over when looking for a send to fuse with a read.
+bool SendFusion::isReadOnlySend(G4_INST* Send)
+{
+    G4_SendMsgDescriptor* msgDesc = Send->getMsgDesc();
+    return (msgDesc->isHDC() || msgDesc->isSampler()) &&
+           msgDesc->isDataPortRead() && !msgDesc->isDataPortWrite() &&
+           !msgDesc->isEOTInst() && !msgDesc->isScratchRW() &&
+           !(msgDesc->isHDC() && msgDesc->isAtomicMessage());
+}
+
+// We will do send fusion for a few messages. Most of them have
+// DW-sized address for each lane, thus address payload is 1 GRF
+// for exec_size=8. A64 reads (2 GRFs of address) and sampler LD
+// are handled as well for exec_size=8.
 //
 // The optimization is performed for the following cases:
 //    1) [(w)] send(8) + send(8) --> (W&flag) send(16), and
@@ -339,7 +475,14 @@ bool SendFusion::simplifyAndCheckCandidate(INST_LIST_ITER Iter)
     }
 
     G4_SendMsgDescriptor* msgDesc = I->getMsgDesc();
-    if (!msgDesc->isHDC() || msgDesc->isHeaderPresent() || msgDesc->getSti() != nullptr)
+    if (!(msgDesc->isHDC() || msgDesc->isSampler()) ||
+        msgDesc->isHeaderPresent() || msgDesc->getSti() != nullptr)
+    {
+        return false;
+    }
+
+    // Sampler messages are simd8 only (no simd1|2|4 form).
+    if (msgDesc->isSampler() && I->getExecSize() != 8)
     {
         return false;
     }
@@ -438,6 +581,14 @@ bool SendFusion::simplifyAndCheckCandidate(INST_LIST_ITER Iter)
         return true;
     }
 
+    if (msgDesc->isSampler()) {
+        return isSamplerLDCandidate(msgDesc);
+    }
+
+    if (isA64ReadCandidate(I)) {
+        return true;
+    }
+
     uint32_t funcID = msgDesc->getFuncId();
     uint32_t msgType = msgDesc->getMessageType();
     if (funcID == SFID_DP_DC)
@@ -678,6 +829,56 @@ bool SendFusion::canFusion(INST_LIST_ITER IT0, INST_LIST_ITER IT1)
     return fusion;
 }
 
+void SendFusion::initRegPressure()
+{
+    G4_Kernel& kernel = *CFG->getKernel();
+    P2A = new PointsToAnalysis(kernel.Declares, CFG->getNumBB());
+    P2A->doPointsToAnalysis(*CFG);
+    GRA = new GlobalRA(kernel, Builder->phyregpool, *P2A);
+    // To properly track liveness for partially-written local variables.
+    GRA->markGraphBlockLocalVars(/*doLocalRA*/false);
+    Liveness = new LivenessAnalysis(*GRA, G4_GRF | G4_ADDRESS | G4_INPUT | G4_FLAG);
+    Liveness->computeLiveness(true);
+    RPEstimate = new RPE(*GRA, Liveness);
+    RPEstimate->run();
+}
+
+// Set MaxSpan and MaxInstToBeMoved for fusing Send0 with a later send.
+// The fused send needs new payload and response variables, and moving
+// more instructions makes more values live across the fused send.
+// Thus, allow a wider window when register pressure at Send0 is low,
+// and a narrower one when fusion would push it over the available GRFs.
+// Register pressure is computed once, before any fusion is done, thus
+// it is an estimate for pairs that come after the first fusion.
+void SendFusion::setFusionWindow(G4_INST* Send0)
+{
+    if (RPEstimate == nullptr)
+    {
+        initRegPressure();
+    }
+
+    G4_SendMsgDescriptor* desc = Send0->getMsgDesc();
+    uint32_t numGRF = Builder->getOptions()->getuInt32Option(vISA_TotalGRFNum);
+    uint32_t pressure = RPEstimate->getRegisterPressure(Send0);
+    uint32_t fusedRegs = 2 * (desc->MessageLength() + desc->extMessageLength() +
+                              desc->ResponseLength());
+    if (pressure + fusedRegs >= numGRF)
+    {
+        MaxSpan = SEND_FUSION_MAX_SPAN_HIGH_RP;
+        MaxInstToBeMoved = SEND_FUSION_MAX_INST_TOBEMOVED / 2;
+    }
+    else if (pressure * 2 < numGRF)
+    {
+        MaxSpan = SEND_FUSION_MAX_SPAN_LOW_RP;
+        MaxInstToBeMoved = SEND_FUSION_MAX_INST_TOBEMOVED_LOW_RP;
+    }
+    else
+    {
+        MaxSpan = SEND_FUSION_MAX_SPAN;
+        MaxInstToBeMoved = SEND_FUSION_MAX_INST_TOBEMOVED;
+    }
+}
+
 // canMoveOver() : common function used for sink and hoist.
 //   Check if StartIT can sink to EndIT (right before EndIT) :  isForward == true.
 //   Check if EndIT can hoist to StartIT (right after StartIT) : isForward == false.
@@ -702,7 +903,7 @@ bool SendFusion::canMoveOver(
     int lid_last = Inst_last->getLocalId();
     assert(lid_first <= lid_last && "Wrong inst position to sink to!");
     int span = lid_last - lid_first;
-    if (span >= SEND_FUSION_MAX_SPAN) {
+    if (span >= MaxSpan) {
         return false;
     }
 
@@ -738,7 +939,7 @@ bool SendFusion::canMoveOver(
 
 		   if (!movable)
 		   {
-			   if (numToBeMoved <= SEND_FUSION_MAX_INST_TOBEMOVED &&
+			   if (numToBeMoved <= MaxInstToBeMoved &&
 				   !tmp->isWARdep(destSend) &&
 				   !tmp->isWAWdep(destSend) &&
 				   !tmp->isRAWdep(destSend))
@@ -1348,7 +1549,9 @@ void SendFusion::doFusion(
 	//           <O1>
 
     // Special case of two reads whose payloads can be concatenated using split send.
-    if (!isSplitSend && ExecSize == 8 && rspLen > 0 && (msgLen == 1))
+    // The address payload is 1 GRF, or 2 GRFs for A64 messages.
+    uint32_t addrLen = isA64ReadCandidate(I0) ? 2 : 1;
+    if (!isSplitSend && ExecSize == 8 && rspLen > 0 && (msgLen == addrLen))
     {
         G4_SendMsgDescriptor* newDesc = Builder->createSendMsgDesc(
             newFC, newRspLen, msgLen, 
@@ -1484,6 +1687,150 @@ void SendFusion::doFusion(
 }
 
 
+// Move the instructions of Succ, up to and including its first send, to
+// the end of Pred, if that send can be fused with the last send of Pred.
+// Pred must fall through to Succ and be its only predecessor, so that the
+// move does not change the program's semantics. run(Pred) will then try to
+// fuse the two sends as if they were in the same BB, and finishHoist()
+// moves the instructions back if it did not.
+bool SendFusion::hoistAcrossFallThrough(G4_BB* Pred, G4_BB* Succ)
+{
+    if (Succ == nullptr ||
+        Pred->Succs.size() != 1 || Pred->Succs.front() != Succ ||
+        Succ->Preds.size() != 1 || Succ->Preds.front() != Pred ||
+        Pred->getBBType() != G4_BB_NONE_TYPE ||
+        Succ->getBBType() != G4_BB_NONE_TYPE ||
+        Pred->empty() || Pred->back()->isFlowControl() ||
+        LastSR0ModInstPerBB.count(Pred) || LastSR0ModInstPerBB.count(Succ))
+    {
+        return false;
+    }
+
+    // The last send of Pred must be a candidate.
+    CurrBB = Pred;
+    Pred->resetLocalId();
+    int distance = 0;
+    INST_LIST_ITER II0 = Pred->end();
+    for (INST_LIST_ITER IT = Pred->end(); IT != Pred->begin(); ++distance)
+    {
+        --IT;
+        if ((*IT)->isSend() || (*IT)->isFence() || (*IT)->isOptBarrier() ||
+            (*IT)->isLabel())
+        {
+            II0 = IT;
+            break;
+        }
+    }
+    if (II0 == Pred->end() || !(*II0)->isSend() ||
+        !simplifyAndCheckCandidate(II0))
+    {
+        return false;
+    }
+    G4_INST* inst0 = *II0;
+
+    // Look for the send in Succ to fuse with inst0. Only plain
+    // instructions may appear before it.
+    CurrBB = Succ;
+    Succ->resetLocalId();
+    INST_LIST_ITER FirstIT = Succ->begin();
+    if (FirstIT != Succ->end() && (*FirstIT)->isLabel())
+    {
+        ++FirstIT;
+    }
+    INST_LIST_ITER II1 = Succ->end();
+    for (INST_LIST_ITER IT = FirstIT, IE = Succ->end();
+         IT != IE && distance < SEND_FUSION_MAX_SPAN; ++IT, ++distance)
+    {
+        G4_INST* tmp = *IT;
+        if (tmp->isLabel() || tmp->isFlowControl() || tmp->isFence() ||
+            tmp->isOptBarrier())
+        {
+            break;
+        }
+        if (tmp->isSend())
+        {
+            if (tmp->opcode() == inst0->opcode() &&
+                tmp->getExecSize() == inst0->getExecSize() &&
+                simplifyAndCheckCandidate(IT))
+            {
+                II1 = IT;
+            }
+            break;
+        }
+    }
+    if (II1 == Succ->end())
+    {
+        return false;
+    }
+
+    // canFusion() expects both sends in the same BB. As Pred falls
+    // through to Succ, a temporary list with both sends is equivalent.
+    INST_LIST pair;
+    pair.push_back(inst0);
+    pair.push_back(*II1);
+    if (!canFusion(pair.begin(), std::next(pair.begin())))
+    {
+        return false;
+    }
+
+    HoistedFrom = Succ;
+    HoistedFirst = *FirstIT;
+    HoistedSend = *II1;
+    HoistedDefs.clear();
+    ++II1;
+    for (INST_LIST_ITER IT = FirstIT; IT != II1; ++IT)
+    {
+        G4_INST* tmp = *IT;
+        if (tmp->getDst())
+        {
+            HoistedDefs.push_back(tmp->getOperand(Opnd_dst));
+        }
+        if (tmp->getCondMod())
+        {
+            HoistedDefs.push_back(tmp->getOperand(Opnd_condMod));
+        }
+    }
+    Pred->splice(Pred->end(), Succ, FirstIT, II1);
+    return true;
+}
+
+bool SendFusion::finishHoist(G4_BB* Pred)
+{
+    G4_BB* Succ = HoistedFrom;
+    HoistedFrom = nullptr;
+
+    if (Pred->back() == HoistedSend)
+    {
+        // Not fused. Nothing after the hoisted send has been touched, so the
+        // moved instructions are still at the end of Pred.
+        INST_LIST_ITER FirstIT = Pred->end();
+        do
+        {
+            --FirstIT;
+        } while (*FirstIT != HoistedFirst && FirstIT != Pred->begin());
+        MUST_BE_TRUE(*FirstIT == HoistedFirst, "hoisted instructions not found");
+
+        INST_LIST_ITER InsertPos = Succ->begin();
+        if (InsertPos != Succ->end() && (*InsertPos)->isLabel())
+        {
+            ++InsertPos;
+        }
+        Succ->splice(InsertPos, Pred, FirstIT, Pred->end());
+        return false;
+    }
+
+    // Values defined by the moved instructions are now live from
+    // Pred into Succ. Mark them global so that local optimizations,
+    // which only look within a BB, don't treat them as local.
+    for (G4_Operand* opnd : HoistedDefs)
+    {
+        CFG->globalOpndHT.addGlobalOpnd(opnd);
+    }
+    Pred->setSendInBB(true);
+    changed = true;
+    return true;
+}
+
 bool SendFusion::run(G4_BB* BB)
 {
     // Prepare for processing this BB
@@ -1492,7 +1839,8 @@ bool SendFusion::run(G4_BB* BB)
     CurrBB->resetLocalId();
 
     // Found two candidate sends:
-    //    1. next to each (no other sends in between), and
+    //    1. next to each other, or only separated by other reads
+    //       if the first one is a read, and
     //    2. both have the same message descriptor.
     INST_LIST_ITER II0 = CurrBB->begin();
     INST_LIST_ITER IE = CurrBB->end();
@@ -1507,12 +1855,23 @@ bool SendFusion::run(G4_BB* BB)
             continue;
         }
 
+        // Reads can be reordered with other reads. Thus, if inst0 is a read,
+        // other reads (candidates or not) in between are skipped. The first
+        // candidate skipped is where searching for the next pair starts.
+        bool isRead0 = isReadOnlySend(inst0);
+        G4_INST* skipped = nullptr;
+
         G4_INST* inst1 = nullptr;
         INST_LIST_ITER II1 = II0;
         ++II1;
         while(II1 != IE)
         {
             G4_INST* tmp = *II1;
+            if (tmp->getLocalId() - inst0->getLocalId() >= SEND_FUSION_MAX_SPAN_LOW_RP)
+            {
+                break;
+            }
+
             if (simplifyAndCheckCandidate(II1))
             {
                 // possible 2nd send to be fused
@@ -1523,7 +1882,17 @@ bool SendFusion::run(G4_BB* BB)
                     {
                         // Found
                         inst1 = tmp;
+                        break;
+                    }
+                }
+
+                if (isRead0 && isReadOnlySend(tmp))
+                {
+                    if (skipped == nullptr) {
+                        skipped = tmp;
                     }
+                    ++II1;
+                    continue;
                 }
 
                 // If found (inst1 != null), exit the inner loop to start fusing;
@@ -1535,7 +1904,8 @@ bool SendFusion::run(G4_BB* BB)
             }
 
             ++II1;
-            if (tmp->isSend() || tmp->isFence() || tmp->isOptBarrier())
+            if ((tmp->isSend() && !(isRead0 && isReadOnlySend(tmp))) ||
+                tmp->isFence() || tmp->isOptBarrier())
             {
                 // Don't try to fusion two sends that are separated
                 // by other memory/barrier instructions.
@@ -1545,13 +1915,15 @@ bool SendFusion::run(G4_BB* BB)
 
         if (inst1 == nullptr) {
             // No inst1 found b/w II0 and II1.
-            // Start finding the next candidate from II1
-            II0 = II1;
+            // Start finding the next candidate from the first skipped
+            // candidate, or from II1 if none.
+            II0 = skipped ? std::find(std::next(II0), II1, skipped) : II1;
             continue;
         }
-  
+
         // At this point, inst0 and inst1 are the pair that can be fused.
         // Now, check if they can be moved to the same position.
+        setFusionWindow(inst0);
         bool sinkable = canSink(II0, II1);
 		bool hoistable = false;
 		if (!sinkable || numToBeSinked > 1)
@@ -1564,7 +1936,7 @@ bool SendFusion::run(G4_BB* BB)
 		}
         if (!sinkable && !hoistable)
 		{   // Neither sinkable nor hoistable, looking for next candidates.
-            II0 = II1;
+            II0 = skipped ? std::find(std::next(II0), II1, skipped) : II1;
             continue;
         }
 
@@ -1576,6 +1948,13 @@ bool SendFusion::run(G4_BB* BB)
         doFusion(II0, II1, sinkable);
 
         changed = true;
+        if (skipped)
+        {
+            // doFusion() inserted instructions before the skipped send and
+            // might have moved it. Renumber so that spans stay valid.
+            CurrBB->resetLocalId();
+            next_II = std::find(CurrBB->begin(), IE, skipped);
+        }
         II0 = next_II;
     }
 
@@ -1604,9 +1983,15 @@ bool vISA::doSendFusion(FlowGraph* aCFG, Mem_Manager* aMMgr)
     for (BB_LIST_ITER BI = aCFG->BBs.begin(), BE = aCFG->BBs.end(); BI != BE; ++BI)
     {
         G4_BB* BB = *BI;
+        BB_LIST_ITER NextBI = std::next(BI);
+        bool hoisted = NextBI != BE &&
+            sendFusion.hoistAcrossFallThrough(BB, *NextBI);
 	    if (sendFusion.run(BB)) {
             change = true;
         }
+        if (hoisted && sendFusion.finishHoist(BB)) {
+            change = true;
+        }
     }
 	return change;
 }
@@ -313,13 +313,8 @@ bool CoalesceSpillFills::fillHeuristic(std::list<INST_LIST_ITER>& coalesceableFi
     std::list<INST_LIST_ITER>& instList, const std::list<INST_LIST_ITER>& origInstList,
     unsigned int& min, unsigned int& max)
 {
-#if 0
     std::bitset<8> bits(0);
-    MUST_BE_TRUE(cMaxFillPayloadSize == 8, "Handle other max fill payload size");
-#else
-    std::bitset<4> bits(0);
-    MUST_BE_TRUE(cMaxFillPayloadSize == 4, "Handle other max fill payload size");
-#endif
+    MUST_BE_TRUE(maxFillPayloadSize <= 8, "Handle other max fill payload size");
 
 	if (coalesceableFills.size() <= 1)
 	{
@@ -343,9 +338,6 @@ bool CoalesceSpillFills::fillHeuristic(std::list<INST_LIST_ITER>& coalesceableFi
             return false;
         }
 
-        for (auto i = scratchOffset; i < (scratchOffset + scratchSize); i++)
-            bits.set(i - scratchOffset);
-
         if (min > scratchOffset)
             min = scratchOffset;
 
@@ -409,7 +401,6 @@ bool CoalesceSpillFills::fillHeuristic(std::list<INST_LIST_ITER>& coalesceableFi
         }
     }
 
-#if 0
     for (auto f : coalesceableFills)
     {
         unsigned int scratchOffset, scratchSize;
@@ -418,7 +409,6 @@ bool CoalesceSpillFills::fillHeuristic(std::list<INST_LIST_ITER>& coalesceableFi
         for (auto i = scratchOffset; i < (scratchOffset + scratchSize); i++)
             bits.set(i - min);
     }
-#endif
 
     if (max - min <= 3)
     {
@@ -438,6 +428,16 @@ bool CoalesceSpillFills::fillHeuristic(std::list<INST_LIST_ITER>& coalesceableFi
             return false;
         }
     }
+    else
+    {
+        // Will emit 8GRF read. Dont read more unused rows than used ones,
+        // and dont read past the end of spill memory.
+        if (bits.count() < 4 ||
+            (min + 8) * G4_GRF_REG_NBYTES > spill.getNextScratchOffset())
+        {
+            return false;
+        }
+    }
 
     return true;
 }
@@ -501,22 +501,22 @@ void CoalesceSpillFills::sendsInRange(std::list<INST_LIST_ITER>& instList,
 
             // Check whether min/max can be extended
             if (scratchOffset <= min &&
-                (min - scratchOffset) <= (cMaxFillPayloadSize - 1) &&
-                (max - scratchOffset) <= (cMaxFillPayloadSize - 1))
+                (min - scratchOffset) <= (maxPayloadSize - 1) &&
+                (max - scratchOffset) <= (maxPayloadSize - 1))
             {
                 // This instruction can be coalesced
                 min = scratchOffset;
                 if (max < lastScratchOffset)
                     max = lastScratchOffset;
 
-                //MUST_BE_TRUE(max - min <= (cMaxFillPayloadSize - 1), "Unexpected fills coalesced. (max - min) is out of bounds - 1");
+                //MUST_BE_TRUE(max - min <= (maxPayloadSize - 1), "Unexpected fills coalesced. (max - min) is out of bounds - 1");
 
                 coalescable.push_back(*iter);
                 iter = instList.erase(iter);
             }
             else if (scratchOffset >= max &&
-                (lastScratchOffset - min) <= (cMaxFillPayloadSize - 1) &&
-                (lastScratchOffset - max) <= (cMaxFillPayloadSize - 1))
+                (lastScratchOffset - min) <= (maxPayloadSize - 1) &&
+                (lastScratchOffset - max) <= (maxPayloadSize - 1))
             {
                 max = lastScratchOffset;
 
@@ -671,7 +671,7 @@ void CoalesceSpillFills::keepConsecutiveSpills(std::list<INST_LIST_ITER>& instLi
     while (allowed.size() > 1)
     {
         unsigned int slots = maxOffset - minOffset + 1;
-        if (slots == 2 || slots == 4)
+        if (slots == 2 || slots == 4 || slots == 8)
         {
             // Insert coalescable spills in order of appearance
             for (auto origInst : origInstList)
@@ -741,7 +741,7 @@ INST_LIST_ITER CoalesceSpillFills::analyzeSpillCoalescing(std::list<INST_LIST_IT
     unsigned int min, max;
     G4_InstOption mask;
     bool useNoMask;
-    keepConsecutiveSpills(instList, coalesceableSpills, cMaxSpillPayloadSize, min, max, useNoMask, mask);
+    keepConsecutiveSpills(instList, coalesceableSpills, maxSpillPayloadSize, min, max, useNoMask, mask);
 
 #if 0
     printf("Start -- \n");
@@ -811,9 +811,18 @@ INST_LIST_ITER CoalesceSpillFills::analyzeFillCoalescing(std::list<INST_LIST_ITE
     std::list<INST_LIST_ITER> coalesceableFills;
     auto origInstList = instList;
     unsigned int min, max;
-    sendsInRange(instList, coalesceableFills, cMaxFillPayloadSize, min, max);
+    sendsInRange(instList, coalesceableFills, maxFillPayloadSize, min, max);
 
     bool heuristic = fillHeuristic(coalesceableFills, instList, origInstList, min, max);
+    if (!heuristic && maxFillPayloadSize > cMaxFillPayloadSize)
+    {
+        // Retry with a narrower message
+        coalesceableFills.clear();
+        instList = origInstList;
+        sendsInRange(instList, coalesceableFills, cMaxFillPayloadSize, min, max);
+        heuristic = fillHeuristic(coalesceableFills, instList, origInstList, min, max);
+    }
+
     if (!heuristic)
     {
         coalesceableFills.clear();
@@ -1051,6 +1060,7 @@ void CoalesceSpillFills::fills()
         std::list<INST_LIST_ITER> spills;
         INST_LIST_ITER startIter = bb->begin();
         unsigned int w = 0;
+        const unsigned int windowSize = getWindowSize(bb, fillWindowSizeThreshold);
         for (auto instIter = startIter;
             instIter != endIter;)
         {
@@ -1090,16 +1100,16 @@ void CoalesceSpillFills::fills()
                 rpe.getRegisterPressure(inst) > fillWindowSizeThreshold)
             {
                 // High register pressure region so reduce window size to 3
-                w = (cWindowSize - w > 3) ? cWindowSize - 3 : w;
+                w = (windowSize - w > 3) ? windowSize - 3 : w;
             }
 
-            if (w == cWindowSize || inst == bb->back())
+            if (w == windowSize || inst == bb->back())
             {
                 if (fillsToCoalesce.size() > 1)
                 {
                     instIter = analyzeFillCoalescing(fillsToCoalesce, startIter, instIter, bb);
                 }
-                else if (w == cWindowSize)
+                else if (w == windowSize)
                 {
                     startIter = instIter;
                 }
@@ -1143,6 +1153,22 @@ void CoalesceSpillFills::fills()
     }
 }
 
+// Coalescing window for bb. Coalescing may span the whole BB when the BB
+// does not reach the register pressure threshold. Otherwise fall back to a
+// small window since coalesced ranges are live longer.
+unsigned int CoalesceSpillFills::getWindowSize(G4_BB* bb, unsigned int threshold)
+{
+    for (auto inst : *bb)
+    {
+        if (rpe.getRegisterPressure(inst) > threshold)
+        {
+            return cWindowSize;
+        }
+    }
+
+    return std::max(cWindowSize, (unsigned int)bb->size());
+}
+
 void CoalesceSpillFills::populateSendDstDcl()
 {
     // Find and store all G4_Declares that are dest in sends
@@ -1191,6 +1217,7 @@ void CoalesceSpillFills::spills()
         std::list<INST_LIST_ITER> spillsToCoalesce;
         INST_LIST_ITER startIter = bb->begin();
         unsigned int w = 0;
+        const unsigned int windowSize = getWindowSize(bb, spillWindowSizeThreshold);
         for (auto instIter = startIter;
             instIter != endIter;)
         {
@@ -1265,13 +1292,30 @@ void CoalesceSpillFills::spills()
                 }
             }
 
+            if (!earlyCoalesce && spillsToCoalesce.size() > 0 &&
+                !(inst->isSend() && inst->getMsgDesc()->isScratchWrite()) &&
+                inst->getDst() && inst->getDst()->getTopDcl())
+            {
+                // Spills are sunk to the last coalesced spill, so stop at a
+                // redefinition of a spilled variable.
+                auto dstTopDcl = inst->getDst()->getTopDcl();
+                for (auto coalIt : spillsToCoalesce)
+                {
+                    if ((*coalIt)->getSrc(1)->getTopDcl() == dstTopDcl)
+                    {
+                        earlyCoalesce = true;
+                        break;
+                    }
+                }
+            }
+
             if (spillsToCoalesce.size() > 0 &&
                 rpe.getRegisterPressure(inst) > spillWindowSizeThreshold)
             {
                 if (!allSpillsSameVar(spillsToCoalesce))
                 {
                     // High register pressure region so reduce window size to 3
-                    w = (cWindowSize - w > 3) ? cWindowSize - 3 : w;
+                    w = (windowSize - w > 3) ? windowSize - 3 : w;
                 }
                 else
                 {
@@ -1282,14 +1326,14 @@ void CoalesceSpillFills::spills()
                 }
             }
 
-            if (w == cWindowSize || inst == bb->back() ||
+            if (w == windowSize || inst == bb->back() ||
                 earlyCoalesce)
             {
                 if (spillsToCoalesce.size() > 1)
                 {
                     instIter = analyzeSpillCoalescing(spillsToCoalesce, startIter, instIter, bb);
                 }
-                else if (w == cWindowSize)
+                else if (w == windowSize)
                 {
                     startIter = instIter;
                 }
@@ -57,6 +57,11 @@ namespace vISA
         unsigned int fillWindowSizeThreshold = 0;
         unsigned int spillWindowSizeThreshold = 0;
 
+        // Widest scratch block message, in GRFs. 8 GRF block messages
+        // need SKL+, older platforms are limited to cMax*PayloadSize.
+        unsigned int maxFillPayloadSize = 0;
+        unsigned int maxSpillPayloadSize = 0;
+
         // <Old fill declare*, std::pair<Coalesced Decl*, Row Off>>
         // This data structure is used to replaced old spill/fill operands
         // with coalesced operands with correct offset.
@@ -100,6 +105,7 @@ namespace vISA
         void spillFillCleanup();
         void removeRedundantWrites();
         void computeAddressTakenDcls();
+        unsigned int getWindowSize(G4_BB*, unsigned int);
 
     public:
         CoalesceSpillFills(G4_Kernel& k, LivenessAnalysis& l, GraphColor& g,
@@ -110,6 +116,10 @@ namespace vISA
             fillWindowSizeThreshold = numGRFs - (128 - cFillWindowThreshold128GRF);
             spillWindowSizeThreshold = numGRFs - (128 - cSpillWindowThreshold128GRF);
 
+            bool useHWordBlock8 = getGenxPlatform() >= GENX_SKL;
+            maxFillPayloadSize = useHWordBlock8 ? 8 : cMaxFillPayloadSize;
+            maxSpillPayloadSize = useHWordBlock8 ? 8 : cMaxSpillPayloadSize;
+
             iterationNo = iterNo;
 
             computeAddressTakenDcls();
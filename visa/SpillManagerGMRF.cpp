@@ -568,6 +568,166 @@ SpillManagerGMRF::calculateSpillDisp (
 	return regVarLocDisp;
 }
 
+// Pre-assign spill memory to the spilled live ranges so that ranges that are
+// co-live and spilled/filled close to each other get adjacent slots. Slots are
+// otherwise handed out in the order of the first spill/fill code inserted,
+// which rarely gives CoalesceSpillFills neighboring offsets to merge.
+//
+// Affinity between two spilled ranges is the number of times they are
+// referenced within a few instructions of each other in the same BB, counted
+// only for ranges whose spill memory lifetimes interfere (ranges that do not
+// interfere may share memory anyway). Ranges are then chained greedily along
+// the heaviest affinity edges and assigned memory chain by chain.
+
+void SpillManagerGMRF::layoutSpillSlots(G4_Kernel* kernel)
+{
+    const unsigned int affinityWindow = 8;
+
+    std::vector<G4_RegVar*> candidates;
+    std::map<G4_RegVar*, unsigned int> candidateIdx;
+    for (auto lr : spilledLRs_)
+    {
+        G4_RegVar* var = lr->getVar();
+        if (!shouldSpillRegister(var) || var->isRegVarTransient() || var->isAliased() ||
+            var->getId() >= varIdCount_ || var->getDisp() != UINT_MAX ||
+            getRFType(var) != G4_GRF || lvInfo_->isAddressSensitive(var->getId()))
+        {
+            continue;
+        }
+        candidateIdx[var] = (unsigned int) candidates.size();
+        candidates.push_back(var);
+    }
+
+    if (candidates.size() < 2)
+    {
+        return;
+    }
+
+    std::vector<unsigned int> refCount(candidates.size(), 0);
+    std::map<std::pair<unsigned int, unsigned int>, unsigned int> affinity;
+    auto addRef = [&](G4_Operand* opnd, unsigned int pos,
+        std::list<std::pair<unsigned int, unsigned int>>& recent)
+    {
+        if (!opnd || !opnd->getBase() || !opnd->getBase()->isRegVar())
+        {
+            return;
+        }
+        auto it = candidateIdx.find(getReprRegVar(opnd->getBase()->asRegVar()));
+        if (it == candidateIdx.end())
+        {
+            return;
+        }
+        unsigned int idx = it->second;
+        refCount[idx]++;
+        for (auto r = recent.begin(); r != recent.end();)
+        {
+            if (pos - r->second > affinityWindow)
+            {
+                r = recent.erase(r);
+                continue;
+            }
+            if (r->first != idx &&
+                spillMemLifetimeInterfere(candidates[idx]->getId(), candidates[r->first]->getId()))
+            {
+                affinity[std::make_pair(std::min(idx, r->first), std::max(idx, r->first))]++;
+            }
+            ++r;
+        }
+        recent.remove_if([idx](const std::pair<unsigned int, unsigned int>& r) { return r.first == idx; });
+        recent.push_back(std::make_pair(idx, pos));
+    };
+
+    for (auto bb : kernel->fg.BBs)
+    {
+        // (candidate, position) of recently referenced spilled ranges
+        std::list<std::pair<unsigned int, unsigned int>> recent;
+        unsigned int pos = 0;
+        for (auto inst : *bb)
+        {
+            for (unsigned int i = 0; i < G4_MAX_SRCS; i++)
+            {
+                G4_Operand* src = inst->getSrc(i);
+                if (src && src->isSrcRegRegion())
+                {
+                    addRef(src, pos, recent);
+                }
+            }
+            addRef(inst->getDst(), pos, recent);
+            pos++;
+        }
+    }
+
+    // Greedily merge chains along the heaviest edges; a chain can only be
+    // extended at either end.
+    typedef std::pair<std::pair<unsigned int, unsigned int>, unsigned int> AffinityEdge;
+    std::vector<AffinityEdge> edges(affinity.begin(), affinity.end());
+    std::stable_sort(edges.begin(), edges.end(),
+        [](const AffinityEdge& e1, const AffinityEdge& e2) { return e1.second > e2.second; });
+
+    std::vector<std::list<unsigned int>> chains(candidates.size());
+    std::vector<unsigned int> chainOf(candidates.size());
+    for (unsigned int i = 0; i < candidates.size(); i++)
+    {
+        chains[i].push_back(i);
+        chainOf[i] = i;
+    }
+
+    for (auto& edge : edges)
+    {
+        unsigned int a = edge.first.first, b = edge.first.second;
+        unsigned int ca = chainOf[a], cb = chainOf[b];
+        if (ca == cb)
+        {
+            continue;
+        }
+        std::list<unsigned int>& chainA = chains[ca];
+        std::list<unsigned int>& chainB = chains[cb];
+        if (chainA.back() != a && chainA.front() == a)
+        {
+            chainA.reverse();
+        }
+        if (chainB.front() != b && chainB.back() == b)
+        {
+            chainB.reverse();
+        }
+        if (chainA.back() != a || chainB.front() != b)
+        {
+            continue;
+        }
+        for (auto i : chainB)
+        {
+            chainOf[i] = ca;
+        }
+        chainA.splice(chainA.end(), chainB);
+    }
+
+    // Chains with more references are placed first, which keeps them at low
+    // offsets where they are more likely to be reused across iterations.
+    std::vector<unsigned int> order;
+    std::vector<unsigned int> chainRefs(candidates.size(), 0);
+    for (unsigned int i = 0; i < candidates.size(); i++)
+    {
+        if (!chains[i].empty())
+        {
+            order.push_back(i);
+            for (auto j : chains[i])
+            {
+                chainRefs[i] += refCount[j];
+            }
+        }
+    }
+    std::stable_sort(order.begin(), order.end(),
+        [&chainRefs](unsigned int c1, unsigned int c2) { return chainRefs[c1] > chainRefs[c2]; });
+
+    for (auto c : order)
+    {
+        for (auto i : chains[c])
+        {
+            getDisp(candidates[i]);
+        }
+    }
+}
+
 // Get the spill/fill displacement of the segment containing the region.
 // A segment is the smallest dword or oword aligned portion of memory
 // containing the destination or source operand that can be read or saved.
@@ -4175,6 +4335,11 @@ SpillManagerGMRF::insertSpillFillCode (
 		}
 	}
 
+    if (!canDoSLMSpill() && builder_->getOption(vISA_SpillSlotLayout))
+    {
+        layoutSpillSlots(kernel);
+    }
+
 	// Handle address taken spills
 	bool success = handleAddrTakenSpills( kernel, pointsToAnalysis );
 
@@ -341,6 +341,8 @@ private:
 		G4_RegVar * lRange
 	) const;
 
+    void layoutSpillSlots(G4_Kernel* kernel);
+
 	template <class REGION_TYPE>
 	unsigned
 	getMsgType (
@@ -131,6 +131,7 @@ void resetPerKernel()
     {
         if (i == TIMER_TOTAL                            ||
             i == TIMER_BUILDER                          ||
+            i == TIMER_CISA_EMIT                        ||
             i == TIMER_VISA_BUILDER_APPEND_INST         ||
             i == TIMER_VISA_BUILDER_CREATE_VAR          ||
             i == TIMER_VISA_BUILDER_CREATE_OPND         ||
@@ -230,6 +231,30 @@ double getTimerUS(unsigned int idx)
     return (timers[idx].ticks * 1000000) / (double)proc_freq.QuadPart;
 }
 
+const char* getTimerName(unsigned int idx)
+{
+    // the per-thread names are only set once initTimer() runs on that thread
+    return idx < TIMER_NUM_TIMERS ? timerNames[idx] : NULL;
+}
+
+void saveTimers(TimerSnapshot& snapshot)
+{
+    for (int i = 0; i < TIMER_NUM_TIMERS; i++)
+    {
+        snapshot.time[i] = timers[i].time;
+        snapshot.ticks[i] = timers[i].ticks;
+    }
+}
+
+void mergeTimers(const TimerSnapshot& snapshot)
+{
+    for (int i = 0; i < TIMER_NUM_TIMERS; i++)
+    {
+        timers[i].time += snapshot.time[i];
+        timers[i].ticks += snapshot.ticks[i];
+    }
+}
+
 void dumpAllTimers(const char *asmFileName, bool outputTime)
 {
     // This generates output like this:
@@ -57,6 +57,7 @@ void dumpAllTimers(const char *asmFileName, bool outputTime = false);
 void dumpEncoderStats(Options *opt, std::string &asmName);
 void resetPerKernel();
 double getTimerUS(unsigned idx);
+const char* getTimerName(unsigned idx);
 
 #define DEF_TIMER(ENUM, DESCR) ENUM,
 typedef enum TIMERS
@@ -66,5 +67,16 @@ typedef enum TIMERS
 } TIMERS;
 #undef DEF_TIMER
 
+// Accumulated timer values of one thread. Timers are thread-local, so a
+// thread that compiles on behalf of another hands its times back with
+// saveTimers() and the owning thread adds them in with mergeTimers().
+struct TimerSnapshot
+{
+    double time[TIMER_NUM_TIMERS];
+    int64_t ticks[TIMER_NUM_TIMERS];
+};
+void saveTimers(TimerSnapshot& snapshot);
+void mergeTimers(const TimerSnapshot& snapshot);
+
 #endif
 
@@ -24,6 +24,9 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 ======================= end_copyright_notice ==================================*/
 
+#include <algorithm>
+#include <map>
+#include <set>
 #include <tuple>
 
 #include "ifcvt.h"
@@ -41,8 +44,18 @@ using namespace vISA;
 
 namespace {
 
-    const unsigned FullyConvertibleMaxInsts = 5;
-    const unsigned PartialConvertibleMaxInsts = 3;
+    // Limits (exclusive) on the estimated cost of a branch to be predicated.
+    // The cost is roughly the number of instructions issued, see
+    // getInstCost(). Inside loops, the branch overhead is paid on every
+    // iteration, thus larger branches are still profitable to predicate.
+    const unsigned FullyConvertibleMaxCost = 5;
+    const unsigned LoopFullyConvertibleMaxCost = 9;
+    const unsigned PartialConvertibleMaxCost = 3;
+
+    // Limits (exclusive) on the estimated cost of both branches together,
+    // including the flag combining needed by nested regions.
+    const unsigned FullyConvertibleMaxRegionCost = 9;
+    const unsigned LoopFullyConvertibleMaxRegionCost = 13;
 
     enum IfConvertKind {
         FullConvert,
@@ -84,44 +97,92 @@ namespace {
         G4_BB *succIf;
         G4_BB *succElse;
         G4_BB *tail;
+        unsigned cost;
 
         IfConvertible(IfConvertKind k, G4_Predicate *p, G4_BB *h,
-                      G4_BB *s0, G4_BB *s1, G4_BB *t)
-            : kind(k), pred(p), head(h), succIf(s0), succElse(s1), tail(t) {}
+                      G4_BB *s0, G4_BB *s1, G4_BB *t, unsigned c)
+            : kind(k), pred(p), head(h), succIf(s0), succElse(s1), tail(t),
+              cost(c) {}
     };
 
-    // Trivial if-conversion.
+    // If-conversion of innermost if/else regions. Once converted, a region
+    // becomes straight-line code in its head, so that the enclosing region
+    // becomes innermost and may be converted in turn.
     class IfConverter {
         FlowGraph &fg;
 
+        /// BBs emptied by conversion. They are left in the CFG, only passing
+        /// control through, and removed later by removeEmptyBlocks().
+        std::set<G4_BB *> emptied;
+
+        /// Nesting level of converted regions, keyed by their head.
+        std::map<G4_BB *, unsigned> nestLevel;
+
+        /// Flag sub-registers live into each BB, as a mask of flag keys (see
+        /// getFlagKey()). Recomputed by analyze().
+        std::map<G4_BB *, unsigned> flagLiveIn;
+
+        std::vector<IfCvtResult> &results;
+
+        /// getSuccs/getPreds - Get successors/predecessors of the given BB,
+        /// looking through emptied BBs.
+        void addSuccs(G4_BB *BB, std::vector<G4_BB *> &succs) const {
+            for (auto *S : BB->Succs) {
+                if (emptied.count(S))
+                    addSuccs(S, succs);
+                else if (std::find(succs.begin(), succs.end(), S) == succs.end())
+                    succs.push_back(S);
+            }
+        }
+        std::vector<G4_BB *> getSuccs(G4_BB *BB) const {
+            std::vector<G4_BB *> succs;
+            addSuccs(BB, succs);
+            return succs;
+        }
+        void addPreds(G4_BB *BB, std::vector<G4_BB *> &preds) const {
+            for (auto *P : BB->Preds) {
+                if (emptied.count(P))
+                    addPreds(P, preds);
+                else if (std::find(preds.begin(), preds.end(), P) == preds.end())
+                    preds.push_back(P);
+            }
+        }
+        std::vector<G4_BB *> getPreds(G4_BB *BB) const {
+            std::vector<G4_BB *> preds;
+            addPreds(BB, preds);
+            return preds;
+        }
+
         /// getSinglePredecessor - Get the single predecessor or null
         /// otherwise.
         G4_BB *getSinglePredecessor(G4_BB *BB, G4_BB *If) const {
-            if (BB->Preds.size() != 1) {
-                if (BB->Preds.size() == 2) {
-                    if (BB->Preds.front() == If)
-                        return BB->Preds.back();
-                    if (BB->Preds.back() == If)
-                        return BB->Preds.front();
+            std::vector<G4_BB *> preds = getPreds(BB);
+            if (preds.size() != 1) {
+                if (preds.size() == 2) {
+                    if (preds.front() == If)
+                        return preds.back();
+                    if (preds.back() == If)
+                        return preds.front();
                 }
                 return nullptr;
             }
-            return BB->Preds.front();
+            return preds.front();
         }
 
         /// getSingleSuccessor - Get the single successor or null
         /// otherwise.
         G4_BB *getSingleSuccessor(G4_BB *BB, G4_BB *Else) const {
-            if (BB->Succs.size() != 1) {
-                if (BB->Succs.size() == 2) {
-                    if (BB->Succs.front() == Else)
-                        return BB->Succs.back();
-                    if (BB->Succs.back() == Else)
-                        return BB->Succs.front();
+            std::vector<G4_BB *> succs = getSuccs(BB);
+            if (succs.size() != 1) {
+                if (succs.size() == 2) {
+                    if (succs.front() == Else)
+                        return succs.back();
+                    if (succs.back() == Else)
+                        return succs.front();
                 }
                 return nullptr;
             }
-            return BB->Succs.front();
+            return succs.front();
         }
 
         /// getEMaskBits() -
@@ -194,17 +255,18 @@ namespace {
                     return std::make_tuple(nullptr, nullptr, nullptr, nullptr);
 
                 // Skip if there's no exactly 2 successors.
-                if (BB->Succs.size() != 2)
+                if (getSuccs(BB).size() != 2)
                     return std::make_tuple(nullptr, nullptr, nullptr, nullptr);
             }
 
-            ASSERT_USER(BB->Succs.size() == 2,
+            std::vector<G4_BB *> succs = getSuccs(BB);
+            ASSERT_USER(succs.size() == 2,
                         "'if' should have exactly two successors!");
             ASSERT_USER(last->getPredicate(),
                         "'if' or 'goto' should be conditional!");
 
-            G4_BB *s0 = BB->Succs.front();  // if-block
-            G4_BB *s1 = BB->Succs.back();   // else-block
+            G4_BB *s0 = succs.front();  // if-block
+            G4_BB *s1 = succs.back();   // else-block
 
             G4_BB *t0 = getSingleSuccessor(s0, s1);
             if (!t0) {
@@ -265,6 +327,15 @@ namespace {
                 return false;
             }
 
+            return isPredictableOp(I, ifInst, false);
+        }
+
+        /// isPredictableOp - Check whether the opcode and emask of 'I' allow
+        /// it to be predicated using the predicate from 'ifInst', ignoring
+        /// its own predicate and condition modifier. Compares are allowed
+        /// only if 'allowCompare' is set (see getPredictableCost()).
+        bool isPredictableOp(G4_INST *I, G4_INST *ifInst,
+                             bool allowCompare) const {
             G4_opcode op = I->opcode();
             switch (G4_Inst_Table[op].instType) {
             case InstTypeMov:
@@ -284,6 +355,9 @@ namespace {
             case InstTypeVector:
                 break;
             case InstTypeCompare:
+                if (allowCompare && (op == G4_cmp || op == G4_cmpn))
+                    break;
+                return false;
             case InstTypeFlow:
             case InstTypeMask:
             case InstTypeMisc:
@@ -368,10 +442,185 @@ namespace {
             return true;
         }
 
-        /// getPredictableInsts - Return the total number of instructions if
-        /// all instruction in the given BB is predictable. Otherwise, return
-        /// 0.
-        unsigned getPredictableInsts(G4_BB *BB, G4_INST *ifInst) const {
+        /// getFlagKey - Return the physical flag sub-register (0 for f0.0,
+        /// 1 for f0.1, 2 for f1.0 and 3 for f1.1) of the given flag operand,
+        /// or -1 if it's not known (e.g. not assigned yet).
+        int getFlagKey(G4_VarBase *base, unsigned short subRegOff) const {
+            if (!base || !base->isRegVar())
+                return -1;
+            G4_RegVar *var = base->asRegVar();
+            G4_VarBase *phyReg = var->getPhyReg();
+            if (!phyReg || !phyReg->isAreg())
+                return -1;
+            unsigned sub = (var->getPhyRegOff() + subRegOff) & 1;
+            switch (static_cast<G4_Areg *>(phyReg)->getArchRegType()) {
+            case AREG_F0:
+                return int(sub);
+            case AREG_F1:
+                return int(2 + sub);
+            default:
+                return -1;
+            }
+        }
+
+        /// mayRefFlag - Check whether the flag operand may overlap the flag
+        /// register (f0 or f1) of the given key.
+        bool mayRefFlag(G4_VarBase *base, unsigned short subRegOff,
+                        int key) const {
+            int k = getFlagKey(base, subRegOff);
+            return k < 0 || key < 0 || (k >> 1) == (key >> 1);
+        }
+
+        /// getFlagMask - Return the mask of flag keys the given flag operand
+        /// may refer to. A 'wide' operand covers both sub-registers.
+        unsigned getFlagMask(G4_VarBase *base, unsigned short subRegOff,
+                             bool wide) const {
+            int key = getFlagKey(base, subRegOff);
+            if (key < 0)
+                return 0xF;
+            return wide ? (0x3 << (key & ~1)) : (1 << key);
+        }
+
+        /// getFlagDefMask - Return the mask of flag keys 'I' may write.
+        unsigned getFlagDefMask(G4_INST *I) const {
+            unsigned mask = 0;
+            G4_CondMod *mod = I->getCondMod();
+            if (mod && mod->getBase())
+                mask |= getFlagMask(mod->getBase(), mod->getSubRegOff(),
+                                    I->getExecSize() > 16);
+            G4_DstRegRegion *dst = I->getDst();
+            if (dst && dst->isFlag())
+                mask |= getFlagMask(dst->getBase(), dst->getSubRegOff(),
+                                    G4_Type_Table[dst->getType()].byteSize > 2);
+            return mask;
+        }
+
+        /// getFlagUseMask - Return the mask of flag keys 'I' may read.
+        unsigned getFlagUseMask(G4_INST *I) const {
+            unsigned mask = 0;
+            if (G4_Predicate *pred = I->getPredicate())
+                mask |= getFlagMask(pred->getBase(), pred->getSubRegOff(),
+                                    I->getExecSize() > 16);
+            for (int i = 0, e = I->getNumSrc(); i < e; ++i) {
+                G4_Operand *src = I->getSrc(i);
+                if (src && src->isSrcRegRegion() && src->isFlag())
+                    mask |= getFlagMask(
+                        src->getBase(), src->asSrcRegRegion()->getSubRegOff(),
+                        G4_Type_Table[src->getType()].byteSize > 2);
+            }
+            return mask;
+        }
+
+        /// definesFlag - Check whether 'I' may write the flag sub-register
+        /// of the given key.
+        bool definesFlag(G4_INST *I, int key) const {
+            return key < 0 ? getFlagDefMask(I) != 0
+                           : (getFlagDefMask(I) & (1 << key)) != 0;
+        }
+
+        /// readsFlag - Check whether 'I' may read the flag register of the
+        /// given key other than through its predicate.
+        bool readsFlag(G4_INST *I, int key) const {
+            for (int i = 0, e = I->getNumSrc(); i < e; ++i) {
+                G4_Operand *src = I->getSrc(i);
+                if (src && src->isSrcRegRegion() && src->isFlag() &&
+                    mayRefFlag(src->getBase(),
+                               src->asSrcRegRegion()->getSubRegOff(), key))
+                    return true;
+            }
+            return false;
+        }
+
+        /// computeFlagLiveIn - Compute flagLiveIn. Only unpredicated writes
+        /// of a known flag sub-register kill it.
+        void computeFlagLiveIn() {
+            std::map<G4_BB *, unsigned> uses, defs;
+            for (auto *BB : fg.BBs) {
+                unsigned use = 0, def = 0;
+                for (auto *I : *BB) {
+                    use |= getFlagUseMask(I) & ~def;
+                    unsigned written = getFlagDefMask(I);
+                    if (!I->getPredicate() && written != 0xF)
+                        def |= written;
+                }
+                uses[BB] = use;
+                defs[BB] = def;
+            }
+
+            flagLiveIn.clear();
+            bool changed = true;
+            while (changed) {
+                changed = false;
+                for (auto BI = fg.BBs.rbegin(), BE = fg.BBs.rend(); BI != BE;
+                     ++BI) {
+                    G4_BB *BB = *BI;
+                    unsigned liveOut = 0;
+                    for (auto *S : BB->Succs)
+                        liveOut |= flagLiveIn[S];
+                    unsigned liveIn = uses[BB] | (liveOut & ~defs[BB]);
+                    if (liveIn != flagLiveIn[BB]) {
+                        flagLiveIn[BB] = liveIn;
+                        changed = true;
+                    }
+                }
+            }
+        }
+
+        /// isLocalFlag - Check whether the flag register of the given key is
+        /// dead at the entry of 't', the tail of the region made of 's0' and
+        /// 's1', and is referenced in the region only as the predicate or
+        /// the condition modifier of an instruction.
+        bool isLocalFlag(int key, G4_BB *s0, G4_BB *s1, G4_BB *t) const {
+            auto LI = flagLiveIn.find(t);
+            if (!t || LI == flagLiveIn.end() || (LI->second & (1 << key)))
+                return false;
+            for (G4_BB *BB : { s0, s1 }) {
+                if (!BB)
+                    continue;
+                for (auto *I : *BB) {
+                    G4_DstRegRegion *dst = I->getDst();
+                    if (readsFlag(I, key) ||
+                        (dst && dst->isFlag() &&
+                         mayRefFlag(dst->getBase(), dst->getSubRegOff(), key)))
+                        return false;
+                }
+            }
+            return true;
+        }
+
+        /// getInstCost - Estimated cost of 'I' once predicated, i.e. the
+        /// number of instructions issued for it. Instructions writing more
+        /// than 2 GRFs (e.g. SIMD16 64-bit) are split into two.
+        unsigned getInstCost(G4_INST *I) const {
+            G4_DstRegRegion *dst = I->getDst();
+            if (!dst || dst->isNullReg())
+                return 1;
+            unsigned bytes = I->getExecSize() * dst->getExecTypeSize();
+            return bytes > 2 * G4_GRF_REG_NBYTES ? 2 : 1;
+        }
+
+        /// getPredictableCost - Return the estimated cost of predicating
+        /// all instructions in the given BB if all of them are predictable.
+        /// Otherwise, return 0.
+        ///
+        /// Besides instructions predictable on their own, this accepts the
+        /// code left by converting a nested region, i.e.
+        ///
+        ///     cmp.f1 ...            <-- unpredicated compare
+        ///     (f1) ...              <-- predicated by the inner region
+        ///
+        /// The compare is predicated as any other instruction. Before the
+        /// first of its users, and again wherever its users switch between
+        /// (f1) and (~f1), its flag is combined with the outer predicate
+        /// (f1 &= f0 or f1 |= ~f0, see combineInnerFlag()), so that they are
+        /// only enabled in channels enabled by both. No flag is available
+        /// after RA to hold the combined predicate, thus this requires the
+        /// inner flag to be dead after the region (see isLocalFlag()). The
+        /// flags used that way are returned in 'innerFlags' (a mask of flag
+        /// keys) and the number of combining instructions in 'numCombines'.
+        unsigned getPredictableCost(G4_BB *BB, G4_INST *ifInst,
+                                    unsigned &innerFlags,
+                                    unsigned &numCombines) const {
             ASSERT_USER(ifInst->opcode() == G4_if ||
                         ifInst->opcode() == G4_goto,
                         "Either 'if' or 'goto' is expected!");
@@ -379,6 +628,15 @@ namespace {
             bool isGoto = (ifInst->opcode() == G4_goto);
             unsigned sum = 0;
 
+            G4_Predicate *ifPred = ifInst->getPredicate();
+            int outerKey = getFlagKey(ifPred->getBase(), ifPred->getSubRegOff());
+            // The state each inner flag was last used with since its last
+            // definition in BB, or PredState_undef if it's not defined yet
+            // or not used since then.
+            bool defined[4] = { false, false, false, false };
+            G4_PredState useState[4] = { PredState_undef, PredState_undef,
+                                         PredState_undef, PredState_undef };
+
             for (auto *I : *BB) {
                 G4_opcode op = I->opcode();
                 // Ignore G4_label
@@ -414,10 +672,41 @@ namespace {
                         continue;
                     }
                 }
-                if (!isPredictable(I, ifInst)) {
+
+                // Predicating the instructions after one that changes the
+                // 'if' predicate would use the wrong predicate.
+                if (definesFlag(I, outerKey))
+                    return 0;
+
+                G4_Predicate *pred = I->getPredicate();
+                G4_CondMod *mod = I->getCondMod();
+                if (pred) {
+                    // Predicated by a converted inner region.
+                    int key = getFlagKey(pred->getBase(), pred->getSubRegOff());
+                    if (key < 0 || !defined[key] || mod ||
+                        pred->getControl() != PRED_DEFAULT ||
+                        ifInst->getExecSize() > 16 ||
+                        !isPredictableOp(I, ifInst, false))
+                        return 0;
+                    G4_PredState state =
+                        pred->getState() == PredState_Minus ? PredState_Minus
+                                                            : PredState_Plus;
+                    if (useState[key] != state) {
+                        useState[key] = state;
+                        ++numCombines;
+                    }
+                } else if (mod) {
+                    // Compare of a converted inner region.
+                    int key = getFlagKey(mod->getBase(), mod->getSubRegOff());
+                    if (key < 0 || !isPredictableOp(I, ifInst, true))
+                        return 0;
+                    defined[key] = true;
+                    useState[key] = PredState_undef;
+                    innerFlags |= 1 << key;
+                } else if (!isPredictable(I, ifInst)) {
                     return 0;
                 }
-                ++sum;
+                sum += getInstCost(I);
             }
 
             return sum;
@@ -463,22 +752,92 @@ namespace {
             BB->push_back(inst);
         }
 
+        /// combineInnerFlag - 'I' is predicated by the flag of a converted
+        /// inner region, and 'outer' is the predicate its compare got when
+        /// moved into 'head'. Combine that flag with 'outer' before 'pos', so
+        /// that 'I' stays disabled where the enclosing region is. E.g., for
+        /// the 'if' side predicated by f0,
+        ///
+        ///     (f1) ...   needs   (W) and (1) f1.0 f1.0 f0.0
+        ///    (~f1) ...   needs   (W) or  (1) f1.0 f1.0 ~f0.0
+        ///
+        /// Either one may be applied on the result of the other, so the
+        /// users of both states may follow each other as long as a combine
+        /// is inserted wherever the state changes.
+        void combineInnerFlag(G4_BB *head, INST_LIST_ITER pos, G4_INST *I,
+                              G4_Predicate *outer) const {
+            G4_Predicate *use = I->getPredicate();
+            IR_Builder *IRB = fg.builder;
+            bool isAnd = use->getState() != PredState_Minus;
+            bool notOuter = (outer->getState() == PredState_Minus) == isAnd;
+            G4_DstRegRegion *dst = IRB->createDstRegRegion(
+                Direct, use->getBase(), 0, use->getSubRegOff(), 1, Type_UW);
+            G4_SrcRegRegion *src0 = IRB->createSrcRegRegion(
+                Mod_src_undef, Direct, use->getBase(), 0, use->getSubRegOff(),
+                IRB->getRegionScalar(), Type_UW);
+            G4_SrcRegRegion *src1 = IRB->createSrcRegRegion(
+                notOuter ? Mod_Not : Mod_src_undef, Direct, outer->getBase(), 0,
+                outer->getSubRegOff(), IRB->getRegionScalar(), Type_UW);
+            G4_INST *inst =
+                IRB->createInternalInst(nullptr, isAnd ? G4_and : G4_or, nullptr,
+                                        false, 1, dst, src0, src1,
+                                        InstOpt_WriteEnable);
+            head->insert(pos, inst);
+        }
+
+        /// InnerFlags - The state of the flags of converted inner regions
+        /// while their instructions are moved into the head, indexed by flag
+        /// key. 'outer' is the predicate the compare defining the flag got,
+        /// and 'state' the state the flag was last combined for.
+        struct InnerFlags {
+            G4_Predicate *outer[4] = { nullptr, nullptr, nullptr, nullptr };
+            G4_PredState state[4] = { PredState_undef, PredState_undef,
+                                      PredState_undef, PredState_undef };
+        };
+
+        /// moveToHead - Move 'I', just predicated by the enclosing region if
+        /// needed, into 'head' before 'pos', combining the flags of converted
+        /// inner regions as described in getPredictableCost().
+        void moveToHead(G4_BB *head, INST_LIST_ITER pos, G4_INST *I,
+                        bool predicated, InnerFlags &inner) const {
+            G4_Predicate *pred = I->getPredicate();
+            G4_CondMod *mod = I->getCondMod();
+            if (predicated && mod) {
+                int key = getFlagKey(mod->getBase(), mod->getSubRegOff());
+                if (key >= 0) {
+                    inner.outer[key] = pred;
+                    inner.state[key] = PredState_undef;
+                }
+            } else if (!predicated && pred) {
+                int key = getFlagKey(pred->getBase(), pred->getSubRegOff());
+                G4_PredState state = pred->getState() == PredState_Minus
+                                         ? PredState_Minus : PredState_Plus;
+                if (key >= 0 && inner.outer[key] && inner.state[key] != state) {
+                    combineInnerFlag(head, pos, I, inner.outer[key]);
+                    inner.state[key] = state;
+                }
+            }
+            head->insert(pos, I);
+        }
+
         void fullConvert(IfConvertible &);
         void partialConvert(IfConvertible &);
 
     public:
-        IfConverter(FlowGraph &g) : fg(g) {}
+        IfConverter(FlowGraph &g, std::vector<IfCvtResult> &r)
+            : fg(g), results(r) {}
 
         void analyze(std::vector<IfConvertible> &);
 
-        void convert(IfConvertible &IC) {
+        /// convert - Return true if the region is converted.
+        bool convert(IfConvertible &IC) {
             switch (IC.kind) {
             case FullConvert:
                 fullConvert(IC);
-                break;
+                return true;
             default:
                 partialConvert(IC);
-                break;
+                return false;
             }
         }
     };
@@ -486,6 +845,8 @@ namespace {
 } // End anonymous namespace
 
 void IfConverter::analyze(std::vector<IfConvertible> &list) {
+    computeFlagLiveIn();
+
     for (auto *BB : fg.BBs) {
         G4_INST *ifInst;
         G4_BB *s0, *s1, *t;
@@ -498,27 +859,44 @@ void IfConverter::analyze(std::vector<IfConvertible> &list) {
 
         G4_Predicate *pred = ifInst->getPredicate();
 
-        unsigned n0 = getPredictableInsts(s0, ifInst);
-        unsigned n1 = s1 ? getPredictableInsts(s1, ifInst) : 0;
+        unsigned innerFlags = 0;
+        unsigned numCombines = 0;
+        unsigned n0 = getPredictableCost(s0, ifInst, innerFlags, numCombines);
+        unsigned n1 = s1 ? getPredictableCost(s1, ifInst, innerFlags, numCombines) : 0;
+
+        // Regions nested in it must have been converted with flags local
+        // to it, as their flags will be combined with its predicate.
+        for (int key = 0; key < 4 && (n0 > 0 || n1 > 0); ++key) {
+            if ((innerFlags & (1 << key)) && !isLocalFlag(key, s0, s1, t)) {
+                n0 = n1 = 0;
+            }
+        }
+
+        bool inLoop = BB->getNestLevel() > 0;
+        unsigned maxCost =
+            inLoop ? LoopFullyConvertibleMaxCost : FullyConvertibleMaxCost;
+        unsigned maxRegionCost = inLoop ? LoopFullyConvertibleMaxRegionCost
+                                        : FullyConvertibleMaxRegionCost;
+        unsigned cost = n0 + n1 + numCombines;
 
         if (s0 && s1) {
-            if (((n0 > 0) && (n0 < FullyConvertibleMaxInsts)) &&
-                ((n1 > 0) && (n1 < FullyConvertibleMaxInsts))) {
+            if (((n0 > 0) && (n0 < maxCost)) &&
+                ((n1 > 0) && (n1 < maxCost)) && cost < maxRegionCost) {
                 // Both 'if' and 'else' are profitable to be if-converted.
                 list.push_back(
-                    IfConvertible(FullConvert, pred, BB, s0, s1, t));
-            } else if ((n0 > 0) && (n0 < PartialConvertibleMaxInsts)) {
+                    IfConvertible(FullConvert, pred, BB, s0, s1, t, cost));
+            } else if ((n0 > 0) && (n0 < PartialConvertibleMaxCost)) {
                 // Only 'if' is profitable to be converted.
                 list.push_back(
-                    IfConvertible(PartialIfConvert, pred, BB, s0, s1, t));
-            } else if ((n1 > 0) && (n1 < PartialConvertibleMaxInsts)) {
+                    IfConvertible(PartialIfConvert, pred, BB, s0, s1, t, n0));
+            } else if ((n1 > 0) && (n1 < PartialConvertibleMaxCost)) {
                 // Only 'else' is profitable to be converted.
                 list.push_back(
-                    IfConvertible(PartialElseConvert, pred, BB, s0, s1, t));
+                    IfConvertible(PartialElseConvert, pred, BB, s0, s1, t, n1));
             }
-        } else if ((n0 > 0) && (n0 < FullyConvertibleMaxInsts)) {
+        } else if ((n0 > 0) && (n0 < maxCost) && cost < maxRegionCost) {
             list.push_back(
-                IfConvertible(FullConvert, pred, BB, s0, nullptr, t));
+                IfConvertible(FullConvert, pred, BB, s0, nullptr, t, cost));
         }
     }
 }
@@ -542,6 +920,10 @@ void IfConverter::fullConvert(IfConvertible &IC) {
     G4_BB *s0 = IC.succIf;
     G4_BB *s1 = IC.succElse;
 
+    // Skip tail merging if tail has other incoming edge(s). Check it before
+    // emptying 's0' and 's1', which would make them invisible.
+    bool mergeTail = (getPreds(tail).size() == 2);
+
     INST_LIST_ITER pos = std::prev(head->end());
     G4_opcode op = (*pos)->opcode();
     ASSERT_USER(op == G4_if || op == G4_goto,
@@ -551,6 +933,7 @@ void IfConverter::fullConvert(IfConvertible &IC) {
     // forward goto's behavior is platform dependent
     bool needReversePredicateForGoto = (isGoto && fg.builder->gotoJumpOnTrue());
     // Merge predicated 'if' into header.
+    InnerFlags inner;
     for (/* EMPTY */; !s0->empty(); s0->pop_front()) {
         auto I = s0->front();
         G4_opcode op = I->opcode();
@@ -566,9 +949,11 @@ void IfConverter::fullConvert(IfConvertible &IC) {
                 continue;
         }
         /* Predicate instructions if it's not goto-style or it's not
-         * neither goto nor its flag clearing instruction */
-        if (!isGoto ||
-            !(op == G4_goto || isFlagClearingFollowedByGoto(I, s0))) {
+         * neither goto nor its flag clearing instruction. Instructions
+         * predicated by a converted inner region keep their predicate. */
+        bool predicated = !I->getPredicate() && (!isGoto ||
+            !(op == G4_goto || isFlagClearingFollowedByGoto(I, s0)));
+        if (predicated) {
             // Negative predicate instructions if needed.
             if (needReversePredicateForGoto) {
                 G4_Predicate *negPred = fg.builder->createPredicate(pred);
@@ -578,13 +963,15 @@ void IfConverter::fullConvert(IfConvertible &IC) {
                 I->setPredicate(fg.builder->createPredicate(pred));
             }
         }
-        head->insert(pos, I);
+        moveToHead(head, pos, I, predicated, inner);
     }
     markEmptyBB(fg.builder, s0);
+    emptied.insert(s0);
     // Merge predicated 'else' into header.
     if (s1) {
         // Reverse the flag controling whether the predicate needs reversing.
         needReversePredicateForGoto = !needReversePredicateForGoto;
+        inner = InnerFlags();
         for (/* EMPTY */; !s1->empty(); s1->pop_front()) {
             auto I = s1->front();
             G4_opcode op = I->opcode();
@@ -593,9 +980,11 @@ void IfConverter::fullConvert(IfConvertible &IC) {
             if (op == G4_join)
                 continue;
             /* Predicate instructions if it's not goto-style or it's not
-             * neither goto nor its flag clearing instruction */
-            if (!isGoto ||
-                !(op == G4_goto || isFlagClearingFollowedByGoto(I, s1))) {
+             * neither goto nor its flag clearing instruction. Instructions
+             * predicated by a converted inner region keep their predicate. */
+            bool predicated = !I->getPredicate() && (!isGoto ||
+                !(op == G4_goto || isFlagClearingFollowedByGoto(I, s1)));
+            if (predicated) {
                 // Negative predicate instructions if needed.
                 if (needReversePredicateForGoto) {
                     G4_Predicate *negPred = fg.builder->createPredicate(pred);
@@ -605,16 +994,27 @@ void IfConverter::fullConvert(IfConvertible &IC) {
                     I->setPredicate(fg.builder->createPredicate(pred));
                 }
             }
-            head->insert(pos, I);
+            moveToHead(head, pos, I, predicated, inner);
         }
         markEmptyBB(fg.builder, s1);
+        emptied.insert(s1);
     }
 
+    // Record the region for the opt report.
+    unsigned level = 1;
+    for (G4_BB *S : { s0, s1 }) {
+        auto LI = nestLevel.find(S);
+        if (S && LI != nestLevel.end())
+            level = std::max(level, LI->second + 1);
+    }
+    nestLevel[head] = level;
+    IfCvtResult R = { head->getId(), IC.cost, level, head->getNestLevel() > 0 };
+    results.push_back(R);
+
     // Remove 'if' instruction in head.
     head->erase(pos);
 
-    // Skip tail merging if tail has other incoming edge(s).
-    if (tail->Preds.size() != 2)
+    if (!mergeTail)
         return;
 
     // Remove 'label' and 'endif'/'join' instructions in tail.
@@ -628,23 +1028,33 @@ void IfConverter::fullConvert(IfConvertible &IC) {
     // Merge head and tail to get more code scheduling chance.
     head->splice(head->end(), tail);
     markEmptyBB(fg.builder, tail);
+    emptied.insert(tail);
 }
 
 void IfConverter::partialConvert(IfConvertible &IC) {
     // TODO: Add partial if-conversion support.
 }
 
-void runIfCvt(FlowGraph &fg) {
-    IfConverter converter(fg);
-
-    std::vector<IfConvertible> ifList;
-    converter.analyze(ifList);
-
-    // FIXME: The convertible 'if's are traversed with assumption that BBs are
-    // already ordered in topological order so that, once we merge head & tail
-    // blocks, we won't break the remaining convertible 'if's to be converted.
-    for (auto II = ifList.rbegin(), IE = ifList.rend(); II != IE; ++II) {
-        converter.convert(*II);
+void runIfCvt(FlowGraph &fg, std::vector<IfCvtResult> &results) {
+    IfConverter converter(fg, results);
+
+    // Converting a region may make the one enclosing it innermost. Repeat
+    // until no more region is converted.
+    bool changed = true;
+    while (changed) {
+        changed = false;
+
+        std::vector<IfConvertible> ifList;
+        converter.analyze(ifList);
+
+        // FIXME: The convertible 'if's are traversed with assumption that BBs
+        // are already ordered in topological order so that, once we merge
+        // head & tail blocks, we won't break the remaining convertible 'if's
+        // to be converted.
+        for (auto II = ifList.rbegin(), IE = ifList.rend(); II != IE; ++II) {
+            if (converter.convert(*II))
+                changed = true;
+        }
     }
 
     // Run additional transforms from 'sel' to 'mov' if one of the source
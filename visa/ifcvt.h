@@ -29,7 +29,15 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "FlowGraph.h"
 
-void runIfCvt(vISA::FlowGraph &);
+// A region converted by runIfCvt(), for the opt report.
+struct IfCvtResult {
+    unsigned headId;    // id of the BB the region is converted into
+    unsigned cost;      // estimated cost of the predicated instructions
+    unsigned nestLevel; // 1 for an innermost region, 2 for one enclosing it...
+    bool inLoop;
+};
+
+void runIfCvt(vISA::FlowGraph &, std::vector<IfCvtResult> &);
 
 #endif // __IFCVT_H__
 
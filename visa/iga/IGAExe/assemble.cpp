@@ -65,6 +65,9 @@ bool assemble(
     setOptBit(aopts.syntax_opts,
         IGA_SYNTAX_OPT_EXTENSIONS,
         opts.syntaxExts);
+    setOptBit(aopts.syntax_opts,
+        IGA_SYNTAX_OPT_PARALLEL,
+        opts.parallel);
 
     try {
         auto r = ctx.assembleFromString(inpText, aopts);
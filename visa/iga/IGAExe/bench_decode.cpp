@@ -0,0 +1,115 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+#include "iga_main.hpp"
+#include "Backend/GED/Interface.hpp"
+#include "Backend/Native/Interface.hpp"
+
+#include <chrono>
+#include <iomanip>
+
+// decodes the kernel repeatedly for at least a second;
+// returns the instructions decoded per second (or a negative value on error)
+static double timeDecoder(
+    const iga::Model &model,
+    const iga::DecoderOpts &dopts,
+    bool useNative,
+    const std::vector<unsigned char> &bits,
+    size_t instsPerPass)
+{
+    typedef std::chrono::high_resolution_clock clock;
+    auto start = clock::now();
+    size_t passes = 0;
+    double elapsed = 0.0;
+    do {
+        iga::ErrorHandler eh;
+        iga::Kernel *k = useNative ?
+            iga::native::Decode(model, dopts, eh, bits.data(), bits.size()) :
+            iga::ged::Decode(model, dopts, eh, bits.data(), bits.size());
+        if (k == nullptr) {
+            return -1.0;
+        }
+        delete k;
+        passes++;
+        elapsed = std::chrono::duration<double>(clock::now() - start).count();
+    } while (elapsed < 1.0);
+    return (double)(passes * instsPerPass) / elapsed;
+}
+
+bool benchmarkDecode(const Opts &baseOpts)
+{
+    if (baseOpts.platform == IGA_GEN_INVALID) {
+        fatalExitWithMessage("iga: -Xbench-decode requires platform (-p)");
+    }
+    if (baseOpts.inputFiles.empty()) {
+        fatalExitWithMessage("iga: -Xbench-decode requires an input file");
+    }
+    const iga::Model *model =
+        iga::Model::LookupModel(static_cast<iga::Platform>(baseOpts.platform));
+    if (model == nullptr) {
+        fatalExitWithMessage("iga: -Xbench-decode: unsupported platform");
+    }
+    iga::DecoderOpts dopts(baseOpts.numericLabels);
+
+    bool hasError = false;
+    for (const auto &inpFile : baseOpts.inputFiles) {
+        std::vector<unsigned char> bits;
+        readBinaryFile(inpFile.c_str(), bits);
+
+        size_t insts = 0;
+        for (size_t pc = 0; pc + 4 <= bits.size(); insts++) {
+            pc += ((const iga::MInst *)&bits[pc])->isCompact() ? 8 : 16;
+        }
+        if (insts == 0) {
+            std::cerr << inpFile << ": empty kernel\n";
+            hasError = true;
+            continue;
+        }
+
+        std::cout << inpFile << ": " << insts << " instructions\n";
+        double ged = timeDecoder(*model, dopts, false, bits, insts);
+        if (ged < 0.0) {
+            std::cerr << inpFile << ": GED failed to decode the kernel\n";
+            hasError = true;
+            continue;
+        }
+        std::cout << "  GED:    " <<
+            std::fixed << std::setprecision(0) << ged << " insts/s\n";
+        if (!iga::native::IsDecodeSupported(*model, dopts)) {
+            std::cout << "  native: unsupported on this platform\n";
+            continue;
+        }
+        double nat = timeDecoder(*model, dopts, true, bits, insts);
+        if (nat < 0.0) {
+            std::cerr << inpFile << ": native decoder failed\n";
+            hasError = true;
+            continue;
+        }
+        std::cout << "  native: " <<
+            std::fixed << std::setprecision(0) << nat << " insts/s (" <<
+            std::setprecision(2) << nat / ged << "x)\n";
+    }
+    return hasError;
+}
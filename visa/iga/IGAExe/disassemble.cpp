@@ -56,6 +56,12 @@ bool disassemble(
     setOptBit(dopts.decoder_opts,
         IGA_DECODING_OPT_NATIVE,
         opts.useNativeEncoder);
+    setOptBit(dopts.decoder_opts,
+        IGA_DECODING_OPT_NATIVE_VERIFY,
+        opts.verifyNativeDecoder);
+    setOptBit(dopts.decoder_opts,
+        IGA_DECODING_OPT_PARALLEL,
+        opts.parallel);
     try {
         auto r = ctx.disassembleToString(inp.data(), inp.size(), dopts);
         for (auto &w : r.warnings) {
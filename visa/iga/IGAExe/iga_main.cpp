@@ -273,6 +273,17 @@ extern "C" int iga_main(int argc, const char **argv)
         "the compacted form does not exist.",
         opts::OptAttrs::ALLOW_UNSET,
         baseOpts.autoCompact);
+    xGrp.defineFlag(
+        "bench-decode",
+        nullptr,
+        "benchmark decoder throughput",
+        "This mode decodes each input kernel binary repeatedly with GED "
+        "and with the native decoder and reports instructions decoded per "
+        "second (decoding only; nothing is formatted).  -p is required.",
+        opts::OptAttrs::ALLOW_UNSET,
+        [] (const char *, const opts::ErrorHandler &, Opts &baseOpts) {
+            baseOpts.mode = Opts::Mode::XBDEC;
+        });
     xGrp.defineFlag(
         "dcmp",
         nullptr,
@@ -331,6 +342,14 @@ extern "C" int iga_main(int argc, const char **argv)
         "",
         opts::OptAttrs::ALLOW_UNSET,
         baseOpts.useNativeEncoder);
+    xGrp.defineFlag(
+        "native-verify",
+        nullptr,
+        "verify the native decoder against GED",
+        "With -Xnative, also decodes each instruction with GED and warns "
+        "where the two decoders differ",
+        opts::OptAttrs::ALLOW_UNSET,
+        baseOpts.verifyNativeDecoder);
     xGrp.defineFlag(
         "no-autocompact",
         nullptr,
@@ -349,6 +368,14 @@ extern "C" int iga_main(int argc, const char **argv)
         [] (const char *cinp, const opts::ErrorHandler &, Opts &baseOpts) {
             baseOpts.printLdSt = false;
         });
+    xGrp.defineFlag(
+        "parallel",
+        nullptr,
+        "parses, decodes, and formats large kernels on several threads",
+        "Text is split at label definitions and binaries at instruction "
+          "boundaries; the output is the same as without this option",
+        opts::OptAttrs::ALLOW_UNSET,
+        baseOpts.parallel);
     xGrp.defineFlag(
         "syntax-exts",
         nullptr,
@@ -356,6 +383,43 @@ extern "C" int iga_main(int argc, const char **argv)
         "",
         opts::OptAttrs::ALLOW_UNSET,
         baseOpts.syntaxExts);
+    xGrp.defineFlag(
+        "perf",
+        nullptr,
+        "statically estimates kernel performance",
+        "Decodes each input (assembling it first if it is text) and "
+        "estimates per-block cycles, send stall exposure, register bank "
+        "conflicts and register dependency stalls from a latency model.  "
+        "Only SKL latencies are available, so other platforms are "
+        "estimated with them; the report names the model used.  The "
+        "hottest blocks (weighted by loop depth) are reported; no device "
+        "is needed.",
+        opts::OptAttrs::ALLOW_UNSET,
+        [] (const char *, const opts::ErrorHandler &, Opts &baseOpts) {
+            baseOpts.mode = Opts::Mode::XPERF;
+        });
+    xGrp.defineOpt(
+        "perf-blocks",
+        nullptr,
+        "INT",
+        "the number of hottest blocks -Xperf reports",
+        "0 reports every block; the default is 10",
+        opts::OptAttrs::ALLOW_UNSET,
+        [] (const char *inp, const opts::ErrorHandler &err, Opts &baseOpts) {
+            char *end = nullptr;
+            long n = strtol(inp, &end, 10);
+            if (end == inp || *end || n < 0) {
+                err("invalid -Xperf-blocks value");
+            }
+            baseOpts.perfMaxBlocks = (uint32_t)n;
+        });
+    xGrp.defineFlag(
+        "perf-json",
+        nullptr,
+        "emits the -Xperf report as JSON",
+        nullptr,
+        opts::OptAttrs::ALLOW_UNSET,
+        baseOpts.perfJson);
     xGrp.defineFlag(
         "print-hex-floats",
         nullptr,
@@ -457,6 +521,8 @@ extern "C" int iga_main(int argc, const char **argv)
         hasError |= decodeInstructionFields(baseOpts);
     } else if (baseOpts.mode == Opts::XDCMP) {
         hasError |= debugCompaction(baseOpts);
+    } else if (baseOpts.mode == Opts::XBDEC) {
+        hasError |= benchmarkDecode(baseOpts);
     } else {
         if (baseOpts.inputFiles.empty()) {
             fatalExitWithMessage("at least one file required");
@@ -475,6 +541,8 @@ extern "C" int iga_main(int argc, const char **argv)
                     hasError |= !disassemble(opts, ctx, inpFile);
                 } else if (opts.mode == Opts::ASM) {
                     hasError |= !assemble(opts, ctx, inpFile);
+                } else if (opts.mode == Opts::XPERF) {
+                    hasError |= !analyzePerformance(opts, ctx, inpFile);
                 } else {
                     fatalExitWithMessage(
                         "%s: mode (-a or -d) must be specified for this file",
@@ -52,8 +52,10 @@ struct Opts {
     // XLST = -Xlist-ops (list ops for a given platform)
     // XIFS = -Xifs (decode fields)
     // XDCMP = -Xdcmp (debug compaction)
+    // XBDEC = -Xbench-decode (decoder throughput)
+    // XPERF = -Xperf (static performance analysis)
     // AUTO = operate based on input (see inferPlatformAndMode below)
-    enum Mode {ASM, DIS, XLST, XIFS, XDCMP, AUTO};
+    enum Mode {ASM, DIS, XLST, XIFS, XDCMP, XBDEC, XPERF, AUTO};
 
     std::vector<std::string> inputFiles;             // .empty() means stdin
     std::string outputFile;                          // "" means stdout
@@ -68,6 +70,10 @@ struct Opts {
     bool autosetDepInfo      = false;                // -Xauto-deps
     bool syntaxExts          = false;                // -Xsyntax-exts
     bool useNativeEncoder    = false;                // -Xnative
+    bool verifyNativeDecoder = false;                // -Xnative-verify
+    bool parallel            = false;                // -Xparallel
+    bool perfJson            = false;                // -Xperf-json
+    uint32_t perfMaxBlocks   = 10;                   // -Xperf-blocks=...
 
     bool printBits           = false;                // -Xprint-bits
     bool printDeps           = false;                // -Xprint-deps
@@ -95,6 +101,12 @@ bool decodeInstructionFields(
     const Opts &baseOpts); // -Xifs in decode_fields.cpp
 bool debugCompaction(
     Opts opts); // -Xdcmp in decode_fields.cpp
+bool benchmarkDecode(
+    const Opts &opts); // -Xbench-decode in bench_decode.cpp
+bool analyzePerformance(
+    const Opts &opts,
+    igax::Context &ctx,
+    const std::string &inpFile); // -Xperf in perf.cpp
 bool listOps(
     const Opts &opts,
     const std::string &opmn); // -Xlist-ops: list_ops.cpp
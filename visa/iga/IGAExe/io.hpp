@@ -87,6 +87,17 @@ static std::string readTextStream(
 {
     std::string s;
     is.clear();
+    // size the buffer up front when the stream is seekable (i.e. a file)
+    // so large listings aren't grown a page at a time
+    std::streampos start = is.tellg();
+    if (start != std::streampos(-1) && is.seekg(0, std::ios::end)) {
+        std::streampos end = is.tellg();
+        if (end != std::streampos(-1) && end > start) {
+            s.reserve((size_t)(end - start));
+        }
+        is.seekg(start);
+    }
+    is.clear();
     s.append(std::istreambuf_iterator<char>(is),
              std::istreambuf_iterator<char>());
     if (!is.good()) {
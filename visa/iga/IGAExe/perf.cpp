@@ -0,0 +1,74 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+#include "iga_main.hpp"
+
+bool analyzePerformance(
+    const Opts &opts, igax::Context &ctx, const std::string &inpFile)
+{
+    // text inputs (by extension) are assembled first
+    Opts inferred = opts;
+    inferred.mode = Opts::Mode::AUTO;
+    inferPlatformAndMode(inpFile, inferred);
+
+    std::vector<unsigned char> bits;
+    if (inferred.mode == Opts::Mode::ASM) {
+        std::string inpText = readTextFile(inpFile.c_str());
+        igax::Bits asmBits;
+        if (!assemble(opts, ctx, inpFile, inpText, asmBits)) {
+            return false;
+        }
+        bits.assign(asmBits.begin(), asmBits.end());
+    } else {
+        readBinaryFile(inpFile.c_str(), bits);
+    }
+
+    iga_perf_options_t popts = IGA_PERF_OPTIONS_INIT();
+    popts.max_blocks = opts.perfMaxBlocks;
+    setOptBit(popts.perf_opts,
+        IGA_PERF_OPT_JSON,
+        opts.perfJson);
+    setOptBit(popts.decoder_opts,
+        IGA_DECODING_OPT_NATIVE,
+        opts.useNativeEncoder);
+    try {
+        auto r = ctx.analyzePerformance(bits.data(), bits.size(), popts);
+        for (auto &w : r.warnings) {
+            emitWarningToStderr(w, bits);
+        }
+        writeText(opts, r.value);
+        return true;
+    } catch (const igax::DisassembleError &err) {
+        for (auto &e : err.errors) {
+            emitErrorToStderr(e, bits);
+        }
+        if (err.errors.empty()) {
+            err.emit(std::cerr);
+        }
+    } catch (const igax::Error &err) {
+        err.emit(std::cerr);
+    }
+    return false;
+}
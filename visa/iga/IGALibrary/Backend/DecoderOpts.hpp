@@ -30,9 +30,16 @@ namespace iga
 struct DecoderOpts
 {
     bool useNumericLabels;
+    // the native decoder also decodes with GED and reports differences
+    bool verifyNative;
+    // the number of threads large kernels are decoded with (0 or 1 decodes
+    // on the calling thread only)
+    unsigned parallelism;
 
     DecoderOpts(bool _useNumericLabels = false)
         : useNumericLabels(_useNumericLabels)
+        , verifyNative(false)
+        , parallelism(0)
     {
     }
 };
@@ -32,14 +32,20 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../../IR/IRChecker.hpp"
 #include "../../asserts.hpp"
 
-#include <sstream>
+#include <algorithm>
 #include <cstring>
+#include <exception>
+#include <sstream>
+#include <thread>
 
 // Used to label expressions that need to be removed once GED is fixed
 #define GED_WORKAROUND(X) (X)
 
 using namespace ::iga;
 
+// the least number of bytes worth decoding on a separate thread
+static const size_t PARALLEL_DECODE_MIN_CHUNK = 16*1024;
+
 DEFINE_GED_SOURCE_ACCESSORS_01(GED_ADDR_MODE, AddrMode)
 
 DEFINE_GED_SOURCE_ACCESSORS_012(GED_REG_FILE, RegFile)
@@ -101,12 +107,45 @@ DecoderBase::DecoderBase(const Model &model, ErrorHandler &errHandler) :
     GEDBitProcessor(model,errHandler),
     m_kernel(nullptr),
     m_gedModel(IGAToGEDTranslation::lowerPlatform(model.platform)),
-    m_opSpec(nullptr)
+    m_opSpec(nullptr),
+    m_verifyNative(false),
+    m_nativeDecoded(false),
+    m_gedDecoded(true),
+    m_currBytesLeft(0),
+    m_parallelism(0)
 {
     IGA_ASSERT(m_gedModel != GED_MODEL_INVALID, "invalid GED model");
 }
 
 
+void DecoderBase::enableNativeDecoding(bool verify)
+{
+    if (native::FieldDecoder::isSupported(m_model.platform)) {
+        m_nativeDecoder.reset(new native::FieldDecoder(m_model));
+    }
+    m_verifyNative = verify;
+}
+
+
+void DecoderBase::ensureGedDecoded()
+{
+    if (m_gedDecoded) {
+        return;
+    }
+    m_gedDecoded = true;
+    memset(&m_currGedInst, 0, sizeof(m_currGedInst));
+    GED_RETURN_VALUE status = GED_DecodeIns(
+        m_gedModel,
+        (const unsigned char *)m_binary + currentPc(),
+        (uint32_t)m_currBytesLeft,
+        &m_currGedInst);
+    if (status != GED_RETURN_VALUE_SUCCESS) {
+        // the native decoder accepted bits GED won't
+        fatal("GED error decoding instruction");
+    }
+}
+
+
 Kernel *DecoderBase::decodeKernelBlocks(
     const void *binary,
     size_t binarySize)
@@ -146,11 +185,20 @@ Kernel *DecoderBase::decodeKernel(
     // insts.reserve(binarySize / 8 + 1);
 
     // Pass 1. decode them all into Instruction objects
-    decodeInstructions(
-        *kernel,
-        binary,
-        binarySize,
-        insts);
+    if (m_parallelism > 1 && binarySize >= 2*PARALLEL_DECODE_MIN_CHUNK) {
+        decodeInstructionsParallel(
+            *kernel,
+            binary,
+            binarySize,
+            insts);
+    } else {
+        decodeInstructions(
+            *kernel,
+            binary,
+            binarySize,
+            0,
+            insts);
+    }
 
     if (numericLabels) {
         Block *block = kernel->createBlock();
@@ -207,9 +255,11 @@ void DecoderBase::decodeInstructions(
     Kernel &kernel,
     const void *binaryStart,
     size_t binarySize,
+    int32_t startPc,
     InstList &insts)
 {
     restart();
+    setPc(startPc);
     uint32_t nextId = 1;
     const unsigned char *binary = (const unsigned char *)binaryStart;
 
@@ -229,9 +279,29 @@ void DecoderBase::decodeInstructions(
             warning("unexpected padding at end of kernel");
             break;
         }
-        memset(&m_currGedInst, 0, sizeof(m_currGedInst));
-        GED_RETURN_VALUE status =
-            GED_DecodeIns(m_gedModel, binary, (uint32_t)binarySize, &m_currGedInst);
+        // the native decoder handles most uncompacted instructions;
+        // otherwise (or if it can't) decode the instruction with GED
+        const OpSpec *nativeOs = nullptr;
+        if (m_nativeDecoder && iLen == UNCOMPACTED_SIZE) {
+            nativeOs = m_nativeDecoder->decode(
+                *(const MInst *)binary, m_nativeFields);
+        }
+        m_currBytesLeft = bytesLeft;
+        m_nativeDecoded = nativeOs != nullptr;
+        GED_RETURN_VALUE status = GED_RETURN_VALUE_SUCCESS;
+        if (nativeOs && !m_verifyNative) {
+            m_gedDecoded = false;
+        } else {
+            m_gedDecoded = true;
+            memset(&m_currGedInst, 0, sizeof(m_currGedInst));
+            status = GED_DecodeIns(
+                m_gedModel, binary, (uint32_t)binarySize, &m_currGedInst);
+            if (nativeOs && status != GED_RETURN_VALUE_SUCCESS) {
+                warning("native decoder decoded an instruction GED rejects");
+                nativeOs = nullptr;
+                m_nativeDecoded = false;
+            }
+        }
         Instruction *inst = nullptr;
         if (status == GED_RETURN_VALUE_NO_COMPACT_FORM) {
             error("error decoding instruction (no compacted form)");
@@ -249,7 +319,16 @@ void DecoderBase::decodeInstructions(
                 binary,
                 iLen);
         } else {
-            Op op = GEDToIGATranslation::translate(GED_GetOpcode(&m_currGedInst));
+            Op op = nativeOs ? nativeOs->op :
+                GEDToIGATranslation::translate(GED_GetOpcode(&m_currGedInst));
+            if (nativeOs && m_verifyNative) {
+                Op gedOp = GEDToIGATranslation::translate(
+                    GED_GetOpcode(&m_currGedInst));
+                if (gedOp != op) {
+                    warning("native decoder mismatch on opcode");
+                    op = gedOp;
+                }
+            }
             m_opSpec = decodeOpSpec(op);
             if (m_opSpec->op == Op::INVALID) {
                 // figure out if we failed to resolve the primary op
@@ -301,6 +380,104 @@ void DecoderBase::decodeInstructions(
 
 }
 
+// Pass 1 on several threads.  Jump targets are PC-relative in pass 1 and
+// instructions decode independently, so the only shared state is the
+// kernel's memory manager (which isn't thread-safe).  Each chunk decodes
+// into its own kernel and the instructions are copied out in PC order,
+// which keeps the instruction ids and diagnostics identical to a serial
+// decode.
+void DecoderBase::decodeInstructionsParallel(
+    Kernel &kernel,
+    const void *binary,
+    size_t binarySize,
+    InstList &insts)
+{
+    const unsigned char *bytes = (const unsigned char *)binary;
+
+    // the compaction control bit gives each instruction's size, so the
+    // chunk boundaries can be found without decoding anything
+    size_t chunkSize = std::max(
+        binarySize / m_parallelism, PARALLEL_DECODE_MIN_CHUNK);
+    std::vector<size_t> chunkStarts(1, 0);
+    size_t off = 0;
+    while (off + 4 <= binarySize) {
+        if (off - chunkStarts.back() >= chunkSize) {
+            chunkStarts.push_back(off);
+        }
+        uint32_t dw0;
+        memcpy(&dw0, bytes + off, sizeof(dw0));
+        off += ((dw0 >> COMPACTION_CONTROL) & 1) != 0 ?
+            COMPACTED_SIZE : UNCOMPACTED_SIZE;
+    }
+    chunkStarts.push_back(binarySize);
+
+    struct ChunkDecode {
+        std::unique_ptr<Kernel> kernel;
+        ErrorHandler            errors;
+        InstList                insts;
+        std::exception_ptr      failure;
+    };
+    size_t numChunks = chunkStarts.size() - 1;
+    std::vector<ChunkDecode> chunks(numChunks);
+    auto decodeChunk = [&](size_t i) {
+        ChunkDecode &c = chunks[i];
+        try {
+            c.kernel.reset(new Kernel(m_model));
+            DecoderBase decoder(m_model, c.errors);
+            if (m_nativeDecoder) {
+                decoder.enableNativeDecoding(m_verifyNative);
+            }
+            decoder.m_binary = binary;
+            decoder.decodeInstructions(
+                *c.kernel,
+                bytes + chunkStarts[i],
+                chunkStarts[i + 1] - chunkStarts[i],
+                (int32_t)chunkStarts[i],
+                c.insts);
+        } catch (...) {
+            c.failure = std::current_exception();
+        }
+    };
+    // the first chunk decodes on this thread directly into the kernel
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < numChunks; i++) {
+        workers.emplace_back(decodeChunk, i);
+    }
+    decodeInstructions(
+        kernel,
+        binary,
+        chunkStarts[1],
+        0,
+        insts);
+    for (auto &w : workers) {
+        w.join();
+    }
+
+    for (size_t i = 1; i < numChunks; i++) {
+        ChunkDecode &c = chunks[i];
+        if (c.failure) {
+            std::rethrow_exception(c.failure);
+        }
+        for (const auto &d : c.errors.getErrors()) {
+            errorHandler().reportError(d.at, d.message);
+        }
+        for (const auto &d : c.errors.getWarnings()) {
+            errorHandler().reportWarning(d.at, d.message);
+        }
+        // the chunk kernel's memory is freed with it
+        for (Instruction *inst : c.insts) {
+            Instruction *copy =
+                new (&kernel.getMemManager()) Instruction(*inst);
+            inst->~Instruction();
+            insts.emplace_back(copy);
+        }
+    }
+    int id = 1;
+    for (Instruction *inst : insts) {
+        inst->setID(id++);
+    }
+}
+
 void DecoderBase::decodeNextInstructionEpilog(Instruction *inst)
 {
 }
@@ -1169,7 +1346,8 @@ Instruction *DecoderBase::decodeBranchInstruction(Kernel& kernel)
         } else {
             GED_DECODE_RAW(int32_t, jip, JIP);
             // jmpi is stored post-increment; normalize it to pre-increment
-            jip += GED_InsSize(&m_currGedInst);
+            jip += getBitField(COMPACTION_CONTROL, 1) != 0 ?
+                COMPACTED_SIZE : UNCOMPACTED_SIZE;
             Type dataType = Type::INVALID;
             if (m_model.supportsSrc1CtrlFlow()) {
                 dataType = decodeSrcType<SourceIndex::SRC1>();
@@ -1873,7 +2051,7 @@ void DecoderBase::decodeOptions(Instruction *inst)
         }
     }
 
-    if (GED_IsCompact(&m_currGedInst)) {
+    if (getBitField(COMPACTION_CONTROL, 1) != 0) {
         inst->addInstOpt(InstOpt::COMPACTED);
     }
 }
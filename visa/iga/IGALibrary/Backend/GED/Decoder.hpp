@@ -29,8 +29,11 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "DecoderCommon.hpp"
 #include "GEDBitProcessor.hpp"
 #include "GEDToIGATranslation.hpp"
+#include "../Native/FieldDecoder.hpp"
 #include "ged.h"
 
+#include <memory>
+
 namespace iga
 {
     struct FlagRegInfo {
@@ -58,6 +61,18 @@ namespace iga
             const void *binary,
             size_t binarySize);
 
+        // Decodes the fields of uncompacted instructions with the native
+        // table-driven decoder (Native/FieldDecoder.hpp) and only decodes
+        // with GED the instructions (and fields) that decoder can't handle.
+        // With 'verify' set, the fields are also decoded with GED and
+        // compared; any difference is reported as a warning and the GED
+        // value is used.
+        void enableNativeDecoding(bool verify);
+
+        // Decodes large kernels on up to 'threads' threads
+        // (see decodeInstructionsParallel); 0 or 1 decodes on the calling
+        // thread only.
+        void setParallelism(unsigned threads) { m_parallelism = threads; }
 
     private:
         Kernel *decodeKernel(
@@ -66,7 +81,17 @@ namespace iga
             bool numericLabels);
 
         // pass 1 decodes instructions with numeric labels
+        // ('binary' points to the instruction at 'startPc')
         void decodeInstructions(
+            Kernel &kernel,
+            const void *binary,
+            size_t binarySize,
+            int32_t startPc,
+            InstList &insts);
+        // pass 1 on several threads: splits the kernel into chunks at
+        // instruction boundaries and decodes each chunk into its own kernel
+        // with its own decoder; the instructions are then moved into 'kernel'
+        void decodeInstructionsParallel(
             Kernel &kernel,
             const void *binary,
             size_t binarySize,
@@ -321,9 +346,35 @@ namespace iga
         const OpSpec                 *m_opSpec;
         const void                   *m_binary;
 
+        // native decoding (see enableNativeDecoding)
+        std::unique_ptr<native::FieldDecoder>
+                                      m_nativeDecoder;
+        bool                          m_verifyNative;
+        native::DecodedFields         m_nativeFields;
+        // the native decoder handled the current instruction; its GED
+        // state (m_currGedInst) is then decoded lazily
+        bool                          m_nativeDecoded;
+        bool                          m_gedDecoded;
+        int32_t                       m_currBytesLeft;
+        // see setParallelism
+        unsigned                      m_parallelism;
+
         // for GED workarounds: grab specific bits from the current instruction
         uint32_t getBitField(int ix, int len) const;
 
+        // decodes the current instruction with GED (if it hasn't been yet)
+        void ensureGedDecoded();
+
+        // Used by the GED_DECODE macros to read a field: the natively
+        // decoded value if there is one, otherwise GED's.
+        template <typename Getter>
+        auto decodeField(
+            GED_INS_FIELD field,
+            const char *fieldName,
+            Getter gedGet,
+            GED_RETURN_VALUE &status)
+            -> decltype(gedGet(nullptr, nullptr));
+
         // helper for inserting instructions for decode errors
         Instruction *createErrorInstruction(
             Kernel &kernel,
@@ -339,6 +390,51 @@ namespace iga
     }; // end class Decoder
 
 
+    // maps a GED field to the native decoder's field (or -1)
+    static inline int nativeFieldIndex(GED_INS_FIELD field)
+    {
+        switch (field) {
+#define IGA_NATIVE_FIELD_CASE(F) \
+        case GED_INS_FIELD_ ## F: return (int)native::DecodedField::F;
+        IGA_NATIVE_DECODED_FIELDS(IGA_NATIVE_FIELD_CASE)
+#undef IGA_NATIVE_FIELD_CASE
+        default: return -1;
+        }
+    }
+
+    template <typename Getter>
+    auto DecoderBase::decodeField(
+        GED_INS_FIELD field,
+        const char *fieldName,
+        Getter gedGet,
+        GED_RETURN_VALUE &status)
+        -> decltype(gedGet(nullptr, nullptr))
+    {
+        typedef decltype(gedGet(nullptr, nullptr)) T;
+        int nf = m_nativeDecoded ? nativeFieldIndex(field) : -1;
+        if (nf >= 0 && m_nativeFields.has((native::DecodedField)nf)) {
+            T val = static_cast<T>(
+                m_nativeFields.get((native::DecodedField)nf));
+            if (!m_verifyNative) {
+                status = GED_RETURN_VALUE_SUCCESS;
+                return val;
+            }
+            ensureGedDecoded();
+            T gedVal = gedGet(&m_currGedInst, &status);
+            if (status != GED_RETURN_VALUE_SUCCESS) {
+                warning("native decoder decoded %s (GED rejects it)",
+                    fieldName);
+            } else if (gedVal != val) {
+                warning("native decoder mismatch on %s: "
+                    "0x%llx (native) vs 0x%llx (GED)", fieldName,
+                    (unsigned long long)val, (unsigned long long)gedVal);
+            }
+            return gedVal;
+        }
+        ensureGedDecoded();
+        return gedGet(&m_currGedInst, &status);
+    }
+
 
 } //end: namespace iga*
 
@@ -35,7 +35,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
           std::cout << "FIELD: " << #FIELD << std::endl; \
           GED_PrintFieldBitLocation(&m_currGedInst, GED_INS_FIELD_ ## FIELD); \
       } \
-      DST = TRANS(GED_Get ## FIELD(&m_currGedInst, &_status)); \
+      DST = TRANS(decodeField(GED_INS_FIELD_ ## FIELD, #FIELD, &GED_Get ## FIELD, _status)); \
       if (_status != GED_RETURN_VALUE_SUCCESS) { \
           handleGedDecoderError(__LINE__, #FIELD, _status); \
       } \
@@ -48,7 +48,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
           std::cout << "FIELD: " << #FIELD << std::endl; \
           GED_PrintFieldBitLocation(&m_currGedInst, GED_INS_FIELD_ ## FIELD); \
       } \
-      DST = GED_Get ## FIELD(&m_currGedInst, &_status); \
+      DST = decodeField(GED_INS_FIELD_ ## FIELD, #FIELD, &GED_Get ## FIELD, _status); \
       if (_status != GED_RETURN_VALUE_SUCCESS) { \
           handleGedDecoderError(__LINE__, #FIELD, _status); \
       } \
@@ -70,7 +70,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
           std::cout << "FIELD: " << #FIELD << std::endl; \
           GED_PrintFieldBitLocation(&m_currGedInst, GED_INS_FIELD_ ## FIELD); \
       } \
-      DST = GED_Get ## FIELD(&m_currGedInst, &_STATUS); \
+      DST = decodeField(GED_INS_FIELD_ ## FIELD, #FIELD, &GED_Get ## FIELD, _STATUS); \
       if (_STATUS != GED_RETURN_VALUE_SUCCESS) { \
           handleGedDecoderError(__LINE__, #FIELD, _STATUS); \
       } \
@@ -74,6 +74,7 @@ Kernel *iga::ged::Decode(
     Kernel *k = nullptr;
     try {
         iga::Decoder decoder(m, eh);
+        decoder.setParallelism(dopts.parallelism);
         k = dopts.useNumericLabels ?
             decoder.decodeKernelNumeric(bits, bitsLen) :
             decoder.decodeKernelBlocks(bits, bitsLen);
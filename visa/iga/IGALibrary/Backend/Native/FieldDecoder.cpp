@@ -0,0 +1,628 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+#include "FieldDecoder.hpp"
+
+using namespace iga;
+using namespace iga::native;
+
+///////////////////////////////////////////////////////////////////////////
+//
+// Each instruction is decoded by walking a few static field tables: the
+// header table and then, as the opcode's operands dictate, a destination
+// and source table chosen by the operand's address mode and register file.
+// A field spec gives the field's bit location (an optional high fragment
+// covers the split address immediates) and how to normalize the raw bits.
+// Value maps that differ between platforms (e.g. type encodings) live in
+// PlatformTables.
+//
+///////////////////////////////////////////////////////////////////////////
+
+enum ValueMap : uint8_t
+{
+    RAW,  // the raw bits
+    SEXT, // the raw bits sign extended
+    // the rest index PlatformTables::maps
+    EXEC_SIZE,
+    THREAD_CTRL,
+    PRED_CTRL,
+    COND_MODIFIER,
+    MATH_FC,
+    VERT_STRIDE,
+    WIDTH,
+    HORZ_STRIDE,
+    DST_REG_FILE,
+    SRC0_REG_FILE,
+    SRC1_REG_FILE,
+    DST_TYPE,
+    SRC_REG_TYPE,
+    SRC0_IMM_TYPE,
+    SRC1_IMM_TYPE,
+    VALUE_MAP_COUNT
+};
+
+struct FieldSpec
+{
+    DecodedField field;
+    uint8_t      offset, length;
+    uint8_t      hiOffset, hiLength; // high fragment (if hiLength != 0)
+    ValueMap     map;
+};
+
+#define FIELD_SPEC(F, OFF, LEN, MAP) \
+    {DecodedField::F, OFF, LEN, 0, 0, MAP}
+#define FIELD_SPEC2(F, OFF, LEN, HIOFF, HILEN, MAP) \
+    {DecodedField::F, OFF, LEN, HIOFF, HILEN, MAP}
+
+// what an opcode decodes (FieldDecoder::OpcodeInfo::fields)
+static const uint16_t DECODE_HEADER        = 0x0001; // the common controls
+static const uint16_t DECODE_SATURATE      = 0x0002;
+static const uint16_t DECODE_COND_MODIFIER = 0x0004;
+static const uint16_t DECODE_ACC_WR_CTRL   = 0x0008;
+static const uint16_t DECODE_BRANCH_CTRL   = 0x0010;
+static const uint16_t DECODE_DST           = 0x0020;
+static const uint16_t DECODE_SRC0          = 0x0040;
+static const uint16_t DECODE_SRC1          = 0x0080;
+static const uint16_t DECODE_SRC_MODS      = 0x0100;
+static const uint16_t DECODE_JIP           = 0x0200;
+static const uint16_t DECODE_UIP           = 0x0400;
+// an immediate source is a branch target (JIP/UIP) rather than an Imm;
+// a register source means there is no JIP/UIP
+static const uint16_t DECODE_IMM_TARGETS   = 0x0800;
+// register operands must be direct GRFs
+static const uint16_t DECODE_DIRECT_GRFS   = 0x1000;
+// the instruction is decoded via GED
+static const uint16_t DECODE_GED           = 0x8000;
+
+// values of the normalized fields the decoder inspects itself
+static const uint64_t REG_FILE_GRF = 1;
+static const uint64_t REG_FILE_IMM = 2;
+static const uint64_t ADDR_MODE_INDIRECT = 1;
+
+
+///////////////////////////////////////////////////////////////////////////
+// field locations (all Gen8+ uncompacted Align1 formats)
+static const FieldSpec HEADER_FIELDS[] {
+    FIELD_SPEC(DepCtrl,         9,  2, RAW),
+    FIELD_SPEC(ChannelOffset,  11,  3, RAW), // QtrCtrl:NibCtrl
+    FIELD_SPEC(ThreadCtrl,     14,  2, THREAD_CTRL),
+    FIELD_SPEC(PredCtrl,       16,  4, PRED_CTRL),
+    FIELD_SPEC(PredInv,        20,  1, RAW),
+    FIELD_SPEC(ExecSize,       21,  3, EXEC_SIZE),
+    FIELD_SPEC(DebugCtrl,      30,  1, RAW),
+    FIELD_SPEC(FlagSubRegNum,  32,  1, RAW),
+    FIELD_SPEC(FlagRegNum,     33,  1, RAW),
+    FIELD_SPEC(MaskCtrl,       34,  1, RAW),
+};
+static const FieldSpec COND_MODIFIER_FIELD =
+    FIELD_SPEC(CondModifier,   24,  4, COND_MODIFIER);
+static const FieldSpec ACC_WR_CTRL_FIELD =
+    FIELD_SPEC(AccWrCtrl,      28,  1, RAW);
+static const FieldSpec BRANCH_CTRL_FIELD =
+    FIELD_SPEC(BranchCtrl,     28,  1, RAW);
+static const FieldSpec SATURATE_FIELD =
+    FIELD_SPEC(Saturate,       31,  1, RAW);
+static const FieldSpec ACCESS_MODE_FIELD =
+    FIELD_SPEC(AccessMode,      8,  1, RAW);
+static const FieldSpec MATH_FC_FIELD =
+    FIELD_SPEC(MathFC,         24,  4, MATH_FC);
+
+static const FieldSpec DST_FIELDS[] {
+    FIELD_SPEC(DstRegFile,     35,  2, DST_REG_FILE),
+    FIELD_SPEC(DstDataType,    37,  4, DST_TYPE),
+    FIELD_SPEC(DstHorzStride,  61,  2, HORZ_STRIDE),
+    FIELD_SPEC(DstAddrMode,    63,  1, RAW),
+};
+static const FieldSpec DST_DIRECT_FIELDS[] {
+    FIELD_SPEC(DstSubRegNum,   48,  5, RAW),
+    FIELD_SPEC(DstRegNum,      53,  8, RAW),
+};
+static const FieldSpec DST_INDIRECT_FIELDS[] {
+    FIELD_SPEC2(DstAddrImm,    48,  9, 47, 1, SEXT),
+    FIELD_SPEC(DstAddrSubRegNum, 57, 4, RAW),
+};
+
+// a source operand's tables
+struct SourceFields
+{
+    FieldSpec regFile;
+    FieldSpec regType;
+    FieldSpec immType;
+    FieldSpec srcMod;
+    FieldSpec region[4];   // AddrMode and the region
+    FieldSpec direct[2];
+    FieldSpec indirect[2];
+};
+static const SourceFields SRC0_FIELDS {
+    FIELD_SPEC(Src0RegFile,    41,  2, SRC0_REG_FILE),
+    FIELD_SPEC(Src0DataType,   43,  4, SRC_REG_TYPE),
+    FIELD_SPEC(Src0DataType,   43,  4, SRC0_IMM_TYPE),
+    FIELD_SPEC(Src0SrcMod,     77,  2, RAW), // Negate:Abs
+    {
+        FIELD_SPEC(Src0AddrMode,   79,  1, RAW),
+        FIELD_SPEC(Src0HorzStride, 80,  2, HORZ_STRIDE),
+        FIELD_SPEC(Src0Width,      82,  3, WIDTH),
+        FIELD_SPEC(Src0VertStride, 85,  4, VERT_STRIDE),
+    },
+    {
+        FIELD_SPEC(Src0SubRegNum,  64,  5, RAW),
+        FIELD_SPEC(Src0RegNum,     69,  8, RAW),
+    },
+    {
+        FIELD_SPEC2(Src0AddrImm,   64,  9, 95, 1, SEXT),
+        FIELD_SPEC(Src0AddrSubRegNum, 73, 4, RAW),
+    },
+};
+static const SourceFields SRC1_FIELDS {
+    FIELD_SPEC(Src1RegFile,    89,  2, SRC1_REG_FILE),
+    FIELD_SPEC(Src1DataType,   91,  4, SRC_REG_TYPE),
+    FIELD_SPEC(Src1DataType,   91,  4, SRC1_IMM_TYPE),
+    FIELD_SPEC(Src1SrcMod,    109,  2, RAW),
+    {
+        FIELD_SPEC(Src1AddrMode,  111,  1, RAW),
+        FIELD_SPEC(Src1HorzStride,112,  2, HORZ_STRIDE),
+        FIELD_SPEC(Src1Width,     114,  3, WIDTH),
+        FIELD_SPEC(Src1VertStride,117,  4, VERT_STRIDE),
+    },
+    {
+        FIELD_SPEC(Src1SubRegNum,  96,  5, RAW),
+        FIELD_SPEC(Src1RegNum,    101,  8, RAW),
+    },
+    {
+        FIELD_SPEC2(Src1AddrImm,   96,  9, 121, 1, SEXT),
+        FIELD_SPEC(Src1AddrSubRegNum, 105, 4, RAW),
+    },
+};
+static const FieldSpec IMM32_FIELD = FIELD_SPEC(Imm,  96, 32, RAW);
+static const FieldSpec IMM64_FIELD = FIELD_SPEC(Imm,  64, 64, RAW);
+static const FieldSpec JIP_FIELD   = FIELD_SPEC(JIP,  96, 32, SEXT);
+static const FieldSpec UIP_FIELD   = FIELD_SPEC(UIP,  64, 32, SEXT);
+
+
+///////////////////////////////////////////////////////////////////////////
+// value maps: raw bits to the value GED reports (-1 means reserved)
+#define X -1
+static const int8_t MAP_EXEC_SIZE[16] {1, 2, 4, 8, 16, 32, X, X};
+static const int8_t MAP_THREAD_CTRL_GEN8[16] {0, 1, 3, X}; // no NoPreempt
+static const int8_t MAP_THREAD_CTRL_GEN10[16] {0, 1, 3, 2};
+// Align1 predication (Align16's .x, .y, ... replace any2h and all2h)
+static const int8_t MAP_PRED_CTRL[16]
+    {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, X, X};
+// 7 is reserved between .le and .ov
+static const int8_t MAP_COND_MODIFIER[16]
+    {0, 1, 2, 3, 4, 5, 6, X, 7, 8, X, X, X, X, X, X};
+// 0 and 8 (sincos) are reserved
+static const int8_t MAP_MATH_FC[16]
+    {X, 0, 1, 2, 3, 4, 5, 6, X, 7, 8, 9, 10, 11, 12, 13};
+// 0xF is VxH
+static const int8_t MAP_VERT_STRIDE[16]
+    {0, 1, 2, 4, 8, 16, 32, X, X, X, X, X, X, X, X, 3};
+static const int8_t MAP_WIDTH[16] {1, 2, 4, 8, 16, X, X, X};
+static const int8_t MAP_HORZ_STRIDE[16] {0, 1, 2, 4};
+// ARF, GRF and IMM; src1 cannot be an ARF and the dst cannot be an IMM
+static const int8_t MAP_DST_REG_FILE[16] {0, 1, X, X};
+static const int8_t MAP_SRC0_REG_FILE[16] {0, 1, X, 2};
+static const int8_t MAP_SRC1_REG_FILE[16] {X, 1, X, 2};
+
+// GED's order: ud d uw w ub b df f uq q hf uv vf v nf
+static const int8_t MAP_REG_TYPE_GEN8[16]
+    {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, X, X, X, X, X};
+static const int8_t MAP_SRC0_IMM_TYPE_GEN8[16]
+    {0, 1, 2, 3, 11, 12, 13, 7, 8, 9, 6, 10, X, X, X, X};
+// src1 immediates are at most 32b
+static const int8_t MAP_SRC1_IMM_TYPE_GEN8[16]
+    {0, 1, 2, 3, 11, 12, 13, 7, X, X, X, 10, X, X, X, X};
+// Gen11 reorders the 64b and floating point encodings
+static const int8_t MAP_REG_TYPE_GEN11[16]
+    {0, 1, 2, 3, 4, 5, 8, 9, 10, 7, 6, 14, X, X, X, X};
+static const int8_t MAP_SRC0_IMM_TYPE_GEN11[16]
+    {0, 1, 2, 3, 11, 13, 8, 9, 10, 7, 6, 12, X, X, X, X};
+static const int8_t MAP_SRC1_IMM_TYPE_GEN11[16]
+    {0, 1, 2, 3, 11, 13, X, X, 10, 7, X, 12, X, X, X, X};
+#undef X
+
+// normalized data types with a 64b immediate
+static bool isImm64Type(uint64_t gedType)
+{
+    return gedType == 6 || gedType == 8 || gedType == 9; // df, uq, q
+}
+
+// GED reports an immediate at its type's width (sign extending d and w)
+static uint64_t normalizeImm32(uint64_t gedType, uint64_t imm)
+{
+    switch (gedType) {
+    case 1:  return (uint64_t)(int64_t)(int32_t)imm; // d
+    case 2:                                           // uw
+    case 10: return imm & 0xFFFF;                     // hf
+    case 3:  return (uint64_t)(int64_t)(int16_t)imm;  // w
+    default: return imm;
+    }
+}
+
+struct FieldDecoder::PlatformTables
+{
+    bool          hasAccessMode;
+    const int8_t *maps[VALUE_MAP_COUNT];
+};
+
+static const FieldDecoder::PlatformTables TABLES_GEN8 {
+    true,
+    {
+        nullptr, nullptr,
+        MAP_EXEC_SIZE, MAP_THREAD_CTRL_GEN8, MAP_PRED_CTRL,
+        MAP_COND_MODIFIER, MAP_MATH_FC,
+        MAP_VERT_STRIDE, MAP_WIDTH, MAP_HORZ_STRIDE,
+        MAP_DST_REG_FILE, MAP_SRC0_REG_FILE, MAP_SRC1_REG_FILE,
+        MAP_REG_TYPE_GEN8, MAP_REG_TYPE_GEN8,
+        MAP_SRC0_IMM_TYPE_GEN8, MAP_SRC1_IMM_TYPE_GEN8,
+    }
+};
+static const FieldDecoder::PlatformTables TABLES_GEN10 {
+    true,
+    {
+        nullptr, nullptr,
+        MAP_EXEC_SIZE, MAP_THREAD_CTRL_GEN10, MAP_PRED_CTRL,
+        MAP_COND_MODIFIER, MAP_MATH_FC,
+        MAP_VERT_STRIDE, MAP_WIDTH, MAP_HORZ_STRIDE,
+        MAP_DST_REG_FILE, MAP_SRC0_REG_FILE, MAP_SRC1_REG_FILE,
+        MAP_REG_TYPE_GEN8, MAP_REG_TYPE_GEN8,
+        MAP_SRC0_IMM_TYPE_GEN8, MAP_SRC1_IMM_TYPE_GEN8,
+    }
+};
+static const FieldDecoder::PlatformTables TABLES_GEN11 {
+    false,
+    {
+        nullptr, nullptr,
+        MAP_EXEC_SIZE, MAP_THREAD_CTRL_GEN10, MAP_PRED_CTRL,
+        MAP_COND_MODIFIER, MAP_MATH_FC,
+        MAP_VERT_STRIDE, MAP_WIDTH, MAP_HORZ_STRIDE,
+        MAP_DST_REG_FILE, MAP_SRC0_REG_FILE, MAP_SRC1_REG_FILE,
+        MAP_REG_TYPE_GEN11, MAP_REG_TYPE_GEN11,
+        MAP_SRC0_IMM_TYPE_GEN11, MAP_SRC1_IMM_TYPE_GEN11,
+    }
+};
+
+static const FieldDecoder::PlatformTables *lookupTables(Platform p)
+{
+    switch (p) {
+    case Platform::GEN8:
+    case Platform::GEN8LP:
+    case Platform::GEN9:
+    case Platform::GEN9LP:
+    case Platform::GEN9P5:
+        return &TABLES_GEN8;
+    case Platform::GEN10:
+        return &TABLES_GEN10;
+    case Platform::GEN11:
+        return &TABLES_GEN11;
+    default:
+        return nullptr;
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+// extraction
+static bool decodeField(
+    const MInst &mi,
+    const FieldSpec &f,
+    const int8_t *const *maps,
+    DecodedFields &fs)
+{
+    uint64_t val = mi.getField(f.offset, f.length);
+    if (f.hiLength) {
+        val |= mi.getField(f.hiOffset, f.hiLength) << f.length;
+    }
+    switch (f.map) {
+    case RAW:
+        break;
+    case SEXT: {
+        int shift = 64 - (f.length + f.hiLength);
+        val = (uint64_t)((int64_t)(val << shift) >> shift);
+        break;
+    }
+    default: {
+        int8_t mapped = maps[f.map][val];
+        if (mapped < 0) {
+            return false; // reserved: GED decodes (and diagnoses) it
+        }
+        val = (uint64_t)mapped;
+        break;
+    }
+    }
+    fs.set(f.field, val);
+    return true;
+}
+
+template <size_t N>
+static bool decodeFields(
+    const MInst &mi,
+    const FieldSpec (&fields)[N],
+    const int8_t *const *maps,
+    DecodedFields &fs)
+{
+    for (size_t i = 0; i < N; i++) {
+        if (!decodeField(mi, fields[i], maps, fs)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// decodes a source operand; on success sets immType to the immediate's
+// normalized data type or -1 if the operand is a register
+static bool decodeSource(
+    const MInst &mi,
+    const SourceFields &src,
+    uint16_t fields,
+    bool allowImm,
+    const int8_t *const *maps,
+    DecodedFields &fs,
+    int64_t &immType)
+{
+    immType = -1;
+    if (!decodeField(mi, src.regFile, maps, fs)) {
+        return false;
+    }
+    uint64_t regFile = fs.get(src.regFile.field);
+    if (regFile == REG_FILE_IMM) {
+        // only the last source may be an immediate
+        if (!allowImm || !decodeField(mi, src.immType, maps, fs)) {
+            return false;
+        }
+        immType = (int64_t)fs.get(src.immType.field);
+        return true;
+    }
+    if (!decodeField(mi, src.regType, maps, fs) ||
+        !decodeFields(mi, src.region, maps, fs))
+    {
+        return false;
+    }
+    if ((fields & DECODE_SRC_MODS) &&
+        !decodeField(mi, src.srcMod, maps, fs))
+    {
+        return false;
+    }
+    bool indirect = fs.get(src.region[0].field) == ADDR_MODE_INDIRECT;
+    if ((fields & DECODE_DIRECT_GRFS) &&
+        (indirect || regFile != REG_FILE_GRF))
+    {
+        return false;
+    }
+    return indirect ?
+        decodeFields(mi, src.indirect, maps, fs) :
+        decodeFields(mi, src.direct, maps, fs);
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+// per-opcode tables
+bool FieldDecoder::isSupported(Platform p)
+{
+    return lookupTables(p) != nullptr;
+}
+
+uint16_t FieldDecoder::fieldsFor(const Model &m, const OpSpec &os)
+{
+    if (!os.isValid() || os.isSendOrSendsFamily() ||
+        os.isTernary() || os.isMacro() || os.isGroup() ||
+        os.op == Op::JMPI || // GED requires jmpi's fixed controls
+        (os.op == Op::MOVI && m.platform >= Platform::GEN10)) // movi src1
+    {
+        return DECODE_GED;
+    }
+    if (os.format == OpSpec::NULLARY) {
+        return 0;
+    }
+
+    uint16_t fields = DECODE_HEADER;
+    if (os.supportsSaturation())
+        fields |= DECODE_SATURATE;
+    if (os.supportsFlagModifier())
+        fields |= DECODE_COND_MODIFIER;
+    if (os.supportsAccWrEn())
+        fields |= DECODE_ACC_WR_CTRL;
+    if (os.supportsBranchCtrl())
+        fields |= DECODE_BRANCH_CTRL;
+    if (os.supportsSourceModifiers())
+        fields |= DECODE_SRC_MODS;
+
+    switch (os.format) {
+    case OpSpec::BASIC_UNARY_REG:
+    case OpSpec::BASIC_UNARY_REGIMM:
+        return fields | DECODE_DST | DECODE_SRC0;
+    case OpSpec::BASIC_BINARY_REG_IMM:
+    case OpSpec::BASIC_BINARY_REG_REG:
+    case OpSpec::BASIC_BINARY_REG_REGIMM:
+        return fields | DECODE_DST | DECODE_SRC0 | DECODE_SRC1;
+    case OpSpec::MATH_UNARY_REGIMM:
+        return fields | DECODE_DIRECT_GRFS | DECODE_DST | DECODE_SRC0;
+    case OpSpec::MATH_BINARY_REG_REGIMM:
+        return fields | DECODE_DIRECT_GRFS |
+            DECODE_DST | DECODE_SRC0 | DECODE_SRC1;
+    case OpSpec::JUMP_UNARY_IMM:
+    case OpSpec::JUMP_UNARY_REG:
+    case OpSpec::JUMP_UNARY_REGIMM:
+    case OpSpec::JUMP_UNARY_CALL_REGIMM:
+    case OpSpec::JUMP_BINARY_BRC:
+    case OpSpec::JUMP_BINARY_IMM_IMM:
+        if (m.supportsSimplifiedBranches()) {
+            return DECODE_GED;
+        }
+        switch (os.op) {
+        case Op::RET:
+            return fields | DECODE_SRC0;
+        case Op::CALL:
+        case Op::CALLA:
+            return fields | DECODE_DST | DECODE_SRC1 |
+                DECODE_IMM_TARGETS | DECODE_JIP;
+        case Op::BRD:
+            return fields | DECODE_SRC0 | DECODE_IMM_TARGETS | DECODE_JIP;
+        case Op::BRC:
+            return fields | DECODE_SRC0 | DECODE_IMM_TARGETS |
+                DECODE_JIP | DECODE_UIP;
+        default:
+            if (os.format == OpSpec::JUMP_UNARY_IMM) {
+                return fields | DECODE_JIP;
+            }
+            return fields | DECODE_JIP | DECODE_UIP;
+        }
+    case OpSpec::SYNC_UNARY:
+        return fields | DECODE_SRC0;
+    default:
+        return DECODE_GED;
+    }
+}
+
+FieldDecoder::FieldDecoder(const Model &model)
+    : m_model(model)
+    , m_tables(lookupTables(model.platform))
+{
+    for (unsigned opc = 0; opc < 128; opc++) {
+        const OpSpec &os = m_model.lookupOpSpecByCode(opc);
+        m_opcodes[opc].os = &os;
+        m_opcodes[opc].fields = fieldsFor(m_model, os);
+        if (os.isValid() && os.op == Op::MATH) {
+            // the function control selects the format
+            m_opcodes[opc].fields = 0;
+        }
+    }
+    const OpSpec &math = m_model.lookupOpSpec(Op::MATH);
+    for (unsigned fc = 0; fc < 16; fc++) {
+        const OpSpec *sub = nullptr;
+        if (math.isValid() && math.isGroup()) {
+            sub = &m_model.lookupGroupSubOp(Op::MATH, fc);
+        }
+        m_mathFunctions[fc].os = sub;
+        m_mathFunctions[fc].fields =
+            sub ? fieldsFor(m_model, *sub) : DECODE_GED;
+    }
+}
+
+const OpSpec *FieldDecoder::decode(const MInst &mi, DecodedFields &fs) const
+{
+    fs.clear();
+    if (m_tables == nullptr || mi.isCompact()) {
+        return nullptr;
+    }
+    const int8_t *const *maps = m_tables->maps;
+
+    const OpcodeInfo &oi = m_opcodes[mi.getField(0, 7)];
+    uint16_t fields = oi.fields;
+    if (oi.os->isValid() && oi.os->op == Op::MATH) {
+        if (!decodeField(mi, MATH_FC_FIELD, maps, fs)) {
+            return nullptr;
+        }
+        fields = m_mathFunctions[mi.getField(24, 4)].fields;
+    }
+    if (fields & DECODE_GED) {
+        return nullptr;
+    }
+
+    if (m_tables->hasAccessMode && (fields & DECODE_HEADER)) {
+        decodeField(mi, ACCESS_MODE_FIELD, maps, fs);
+        if (fs.get(DecodedField::AccessMode) != 0) {
+            return nullptr; // Align16
+        }
+    }
+    if (fields & DECODE_HEADER) {
+        if (!decodeFields(mi, HEADER_FIELDS, maps, fs)) {
+            return nullptr;
+        }
+    }
+    if ((fields & DECODE_SATURATE) &&
+        !decodeField(mi, SATURATE_FIELD, maps, fs))
+    {
+        return nullptr;
+    }
+    if ((fields & DECODE_COND_MODIFIER) &&
+        !decodeField(mi, COND_MODIFIER_FIELD, maps, fs))
+    {
+        return nullptr;
+    }
+    if (fields & DECODE_ACC_WR_CTRL) {
+        decodeField(mi, ACC_WR_CTRL_FIELD, maps, fs);
+    }
+    if (fields & DECODE_BRANCH_CTRL) {
+        decodeField(mi, BRANCH_CTRL_FIELD, maps, fs);
+    }
+
+    if (fields & DECODE_DST) {
+        if (!decodeFields(mi, DST_FIELDS, maps, fs)) {
+            return nullptr;
+        }
+        bool indirect =
+            fs.get(DecodedField::DstAddrMode) == ADDR_MODE_INDIRECT;
+        if ((fields & DECODE_DIRECT_GRFS) && (indirect ||
+            fs.get(DecodedField::DstRegFile) != REG_FILE_GRF))
+        {
+            return nullptr;
+        }
+        if (!(indirect ?
+            decodeFields(mi, DST_INDIRECT_FIELDS, maps, fs) :
+            decodeFields(mi, DST_DIRECT_FIELDS, maps, fs)))
+        {
+            return nullptr;
+        }
+    }
+
+    int64_t immType = -1;
+    if (fields & DECODE_SRC0) {
+        if (!decodeSource(mi, SRC0_FIELDS, fields,
+            !(fields & DECODE_SRC1), maps, fs, immType))
+        {
+            return nullptr;
+        }
+    }
+    if (fields & DECODE_SRC1) {
+        if (!decodeSource(mi, SRC1_FIELDS, fields,
+            true, maps, fs, immType))
+        {
+            return nullptr;
+        }
+    }
+
+    if (fields & DECODE_IMM_TARGETS) {
+        if (immType < 0) {
+            fields &= ~(DECODE_JIP | DECODE_UIP);
+        }
+    } else if (immType >= 0) {
+        if (isImm64Type((uint64_t)immType)) {
+            decodeField(mi, IMM64_FIELD, maps, fs);
+        } else {
+            decodeField(mi, IMM32_FIELD, maps, fs);
+            fs.set(DecodedField::Imm,
+                normalizeImm32(
+                    (uint64_t)immType, fs.get(DecodedField::Imm)));
+        }
+    }
+    if (fields & DECODE_JIP) {
+        decodeField(mi, JIP_FIELD, maps, fs);
+    }
+    if (fields & DECODE_UIP) {
+        decodeField(mi, UIP_FIELD, maps, fs);
+    }
+    return oi.os;
+}
@@ -0,0 +1,120 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+#ifndef IGA_BACKEND_NATIVE_FIELDDECODER_HPP
+#define IGA_BACKEND_NATIVE_FIELDDECODER_HPP
+
+#include "MInst.hpp"
+#include "../../Models/Models.hpp"
+
+#include <cstdint>
+
+namespace iga {namespace native
+{
+    // The fields the table-driven decoder extracts.  Each name matches the
+    // GED field carrying the same information so that the GED decoder can
+    // serve its field accessors from a natively decoded instruction
+    // (see Backend/GED/DecoderCommon.hpp).
+#define IGA_NATIVE_DECODED_FIELDS(F) \
+    F(AccessMode) F(DepCtrl) F(ChannelOffset) F(ThreadCtrl) \
+    F(PredCtrl) F(PredInv) F(ExecSize) F(CondModifier) F(MathFC) \
+    F(AccWrCtrl) F(BranchCtrl) F(DebugCtrl) F(Saturate) \
+    F(FlagRegNum) F(FlagSubRegNum) F(MaskCtrl) \
+    F(DstRegFile) F(DstDataType) F(DstAddrMode) F(DstHorzStride) \
+    F(DstRegNum) F(DstSubRegNum) F(DstAddrSubRegNum) F(DstAddrImm) \
+    F(Src0RegFile) F(Src0DataType) F(Src0AddrMode) F(Src0SrcMod) \
+    F(Src0VertStride) F(Src0Width) F(Src0HorzStride) \
+    F(Src0RegNum) F(Src0SubRegNum) F(Src0AddrSubRegNum) F(Src0AddrImm) \
+    F(Src1RegFile) F(Src1DataType) F(Src1AddrMode) F(Src1SrcMod) \
+    F(Src1VertStride) F(Src1Width) F(Src1HorzStride) \
+    F(Src1RegNum) F(Src1SubRegNum) F(Src1AddrSubRegNum) F(Src1AddrImm) \
+    F(Imm) F(JIP) F(UIP)
+
+    enum class DecodedField
+    {
+#define IGA_NATIVE_DECODED_FIELD_ENUM(F) F,
+        IGA_NATIVE_DECODED_FIELDS(IGA_NATIVE_DECODED_FIELD_ENUM)
+#undef IGA_NATIVE_DECODED_FIELD_ENUM
+        COUNT
+    };
+    static_assert((int)DecodedField::COUNT <= 64,
+        "DecodedFields tracks presence in a single 64b mask");
+
+    // the field values of one instruction; only present fields are valid
+    struct DecodedFields
+    {
+        uint64_t present;
+        uint64_t values[(int)DecodedField::COUNT];
+
+        void clear() {present = 0;}
+        bool has(DecodedField f) const {
+            return (present & (1ull << (int)f)) != 0;
+        }
+        uint64_t get(DecodedField f) const {return values[(int)f];}
+        void set(DecodedField f, uint64_t val) {
+            values[(int)f] = val;
+            present |= 1ull << (int)f;
+        }
+    };
+
+    // Decodes all the fields of an uncompacted instruction in one pass
+    // using bit-extraction tables precomputed per opcode and operand format.
+    //
+    // Values are normalized the way GED reports them: ExecSize and Width
+    // are channel counts, strides are element counts, address immediates
+    // are sign extended, immediates are truncated to their type and
+    // enumerated fields use GED's enumeration order.  Instructions with a
+    // reserved encoding in any field are left to GED (and its diagnostic).
+    class FieldDecoder
+    {
+    public:
+        FieldDecoder(const Model &model);
+
+        static bool isSupported(Platform p);
+
+        // Returns the instruction's OpSpec (the parent op for groups such
+        // as math) or nullptr if the instruction must be decoded by GED;
+        // that is the case for compacted, Align16, send, ternary and macro
+        // instructions as well as unmapped opcodes.
+        const OpSpec *decode(const MInst &mi, DecodedFields &fs) const;
+
+        struct PlatformTables;
+
+    private:
+        struct OpcodeInfo {
+            const OpSpec *os;
+            uint16_t      fields; // bitset of DECODE_*
+        };
+
+        const Model            &m_model;
+        const PlatformTables   *m_tables;
+        OpcodeInfo              m_opcodes[128];
+        OpcodeInfo              m_mathFunctions[16];
+
+        static uint16_t fieldsFor(const Model &m, const OpSpec &os);
+    };
+}} // iga::native::*
+
+#endif // IGA_BACKEND_NATIVE_FIELDDECODER_HPP
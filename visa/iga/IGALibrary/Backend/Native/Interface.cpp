@@ -24,7 +24,9 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 ======================= end_copyright_notice ==================================*/
 #include "Interface.hpp"
+#include "FieldDecoder.hpp"
 #include "InstEncoder.hpp"
+#include "../GED/Decoder.hpp"
 #include "../BitProcessor.hpp"
 #include "../../strings.hpp"
 
@@ -394,14 +396,12 @@ bool iga::native::IsDecodeSupported(
     const Model &m,
     const DecoderOpts &opts)
 {
-    switch (m.platform)
-    {
-    case Platform::GEN10: break;
-    default: break;
-    }
-    return false;
+    return FieldDecoder::isSupported(m.platform);
 }
 
+// The native decoder decodes instruction fields with precomputed tables
+// (FieldDecoder) and builds the IR with the GED decoder's instruction
+// logic; the latter decodes what the tables don't cover with GED.
 Kernel *iga::native::Decode(
     const Model &m,
     const DecoderOpts &dopts,
@@ -409,43 +409,29 @@ Kernel *iga::native::Decode(
     const void *bits,
     size_t bitsLen)
 {
+    IGA_ASSERT(FieldDecoder::isSupported(m.platform),
+        "invalid platform for decode; "
+        "caller should have checked via iga::native::IsDecodeSupported");
     Kernel *k = nullptr;
-    switch (m.platform)
-    {
-    case Platform::GEN10:
-    default:
-        IGA_ASSERT_FALSE("invalid platform for decode; "
-            "caller should have checked via iga::native::IsDecodeSupported");
-    }
-
-/*
-    // if valid, the kernel k contains all the instructions in a single block
-    // if we are asked for symbolic labels, we do that here
-    if (k && !dopts.useNumericLabels) {
-        const BlockList &bl = k->getBlockList();
-        if (bl.empty()) {
-            return k; // empty kernel
-        }
-        IGA_ASSERT(bl.size() == 1, "expected only one block");
-
-        auto blockStarts = Block::inferBlocks(
-            eh,
-            bitsLen,
-            k->getMemManager(),
-            insts);
-        for (auto bitr : blockStarts) {
-            k->appendBlock(bitr.second);
-        }
-
-        delete k;
-        k = copy;
+    try {
+        iga::Decoder decoder(m, eh);
+        decoder.enableNativeDecoding(dopts.verifyNative);
+        decoder.setParallelism(dopts.parallelism);
+        k = dopts.useNumericLabels ?
+            decoder.decodeKernelNumeric(bits, bitsLen) :
+            decoder.decodeKernelBlocks(bits, bitsLen);
+    } catch (FatalError) {
+        // error already reported
     }
-*/
-
     return k;
 }
 
 
+bool iga::native::IsDecodeFieldsSupported(const Model &m)
+{
+    return false;
+}
+
 void iga::native::DecodeFields(
     Loc loc,
     const Model &m,
@@ -458,7 +444,8 @@ void iga::native::DecodeFields(
     case Platform::GEN10:
     default:
         IGA_ASSERT_FALSE("invalid platform for decode; "
-            "caller should have checked via iga::native::IsDecodeSupported");
+            "caller should have checked via "
+            "iga::native::IsDecodeFieldsSupported");
     }
 }
 
@@ -489,7 +476,8 @@ CompactionResult iga::native::DebugCompaction(
     case Platform::GEN10:
     default:
         IGA_ASSERT_FALSE("invalid platform for decode; "
-            "caller should have checked via iga::native::IsDecodeSupported");
+            "caller should have checked via "
+            "iga::native::IsDecodeFieldsSupported");
     }
     return CompactionResult::CR_NO_FORMAT;
 }
@@ -75,6 +75,7 @@ namespace iga {namespace native
         size_t bitsLen);
 
     // for -Xifs and -Xdcmp
+    bool IsDecodeFieldsSupported(const Model &m);
     void DecodeFields(
         Loc loc,
         const Model &model,
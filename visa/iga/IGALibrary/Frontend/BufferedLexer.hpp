@@ -64,15 +64,16 @@ struct Token {
 };
 
 static void WriteTokenContext(
-    const std::string &inp,
+    const char *inp,
+    size_t inpLen,
     const struct Loc &loc,
     std::ostream &os)
 {
-    if (loc.offset >= (PC)inp.size()) {
+    if (loc.offset >= (PC)inpLen) {
         os << "<<EOF>>" << std::endl;
     } else if (loc.line > 0) {
         size_t k = loc.offset - loc.col + 1;
-        while (k < inp.size() && inp[k] != '\n' && inp[k] != '\r')
+        while (k < inpLen && inp[k] != '\n' && inp[k] != '\r')
             os << inp[k++];
         os << std::endl;
         if (loc.col > 0) {
@@ -92,13 +93,14 @@ static void WriteTokenContext(
 
 static std::string GetTokenString(
     const Token &token,
-    const std::string &inp)
+    const char *inp,
+    size_t inpLen)
 {
     std::stringstream ss;
     ss << token.loc.line << "." << token.loc.col << ": (" <<
         token.loc.offset << "/" << token.loc.extent << "): " <<
         LexemeString(token.lexeme) << std::endl;
-    WriteTokenContext(inp, token.loc, ss);
+    WriteTokenContext(inp, inpLen, token.loc, ss);
     return ss.str();
 }
 
@@ -106,20 +108,28 @@ class BufferedLexer {
     std::vector<Token>  m_tokens;
     size_t              m_offset, m_mark; // token index of the scanner
 
-    const std::string   m_input;
+    // tokens are (offset,extent) views into the caller's text; the caller
+    // must keep the input alive for the lifetime of the lexer
+    const char         *m_input;
+    size_t              m_inputLength;
 
     Token               m_eof;
 
 public:
-    BufferedLexer(const std::string &inp)
+    BufferedLexer(const char *inp, size_t inpLen)
         : m_offset(0), m_mark(0)
         , m_input(inp)
+        , m_inputLength(inpLen)
         , m_eof(Lexeme::END_OF_FILE, 0, 0, 0, 0)
     {
+        // roughly one token per every few characters of assembly;
+        // avoids repeated vector growth on large listings
+        m_tokens.reserve(inpLen / 4 + 1);
+
         yyscan_t yy;
 
         yylex_init(&yy);
-        yy_scan_string(inp.c_str(), yy);
+        yy_scan_bytes(inp, (int)inpLen, yy);
         yyset_lineno(1, yy);
         yyset_column(1, yy);
 
@@ -159,7 +169,8 @@ public:
 
         yylex_destroy(yy);
     }
-    const std::string &GetSource() const {return m_input;}
+    const char *GetSource() const {return m_input;}
+    size_t GetSourceLength() const {return m_inputLength;}
 
     size_t GetTokenOffset() const {
         return m_offset;
@@ -174,12 +185,12 @@ public:
         SetTokenOffset(m_mark);
     }
 
-    void DumpTokens(std::ostream &out, const std::string &inp) const {
+    void DumpTokens(std::ostream &out) const {
         for (auto t : m_tokens) {
             out << "AT" << t.loc.line << "." << t.loc.col <<
             "(" << t.loc.offset << ":" << t.loc.extent  << ": " <<
             LexemeString(t.lexeme) << std::endl;
-            WriteTokenContext(inp,t.loc,out);
+            WriteTokenContext(m_input,m_inputLength,t.loc,out);
         }
     }
 
@@ -187,7 +198,7 @@ public:
         os << "LEXER: Next " << n << " lookaheads are:\n";
         for (int i = 0; i < n; i++) {
             const Token &tk = Next(i);
-            os << "  " << GetTokenString(tk, m_input).c_str() << "\n";
+            os << "  " << GetTokenString(tk, m_input, m_inputLength).c_str() << "\n";
             if (tk.lexeme == Lexeme::END_OF_FILE) {
                 break;
             }
@@ -44,6 +44,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <cstring>
 #include <iomanip>
 #include <sstream>
+#include <thread>
 #include <vector>
 
 // shows formatting output in realtime to stderr (for stepping through code)
@@ -142,17 +143,21 @@ public:
         bits = (const uint8_t *)vbits;
 
         for (const Block *b : k.getBlockList()) {
-            if (!opts.numericLabels) {
-                formatLabel(b->getPC());
-                emit(':');
-                newline();
-            }
-
+            formatBlockLabel(*b);
             formatBlockContents(*b);
         }
     }
 
 
+    void formatBlockLabel(const Block& b) {
+        if (!opts.numericLabels) {
+            formatLabel(b.getPC());
+            emit(':');
+            newline();
+        }
+    }
+
+
     void formatBlockContents(const Block& b) {
         for (const auto &i : b.getInstList()) {
             formatInstruction(*i);
@@ -979,6 +984,75 @@ void Formatter::formatInstOpts(
 //
 // Public interfaces into the kernel
 
+// the least number of block labels and instructions worth formatting on
+// a separate thread
+static const size_t PARALLEL_FORMAT_MIN_ITEMS = 2048;
+
+// Splits the kernel into even runs of block labels and instructions and
+// formats each run to its own stream on its own thread.  Diagnostics and
+// output are concatenated in kernel order, so the result matches
+// formatting the whole kernel on one thread.
+static void FormatKernelParallel(
+    ErrorHandler& e,
+    std::ostream& o,
+    const FormatOpts& opts,
+    const Kernel& k,
+    const uint8_t *bits,
+    size_t threads)
+{
+    // a block label (inst == nullptr) or an instruction and its bits
+    struct Item {
+        const Block       *block;
+        const Instruction *inst;
+        size_t             bitsOff;
+    };
+    std::vector<Item> items;
+    size_t bitsOff = 0;
+    for (const Block *b : k.getBlockList()) {
+        items.push_back({b, nullptr, bitsOff});
+        for (const Instruction *i : b->getInstList()) {
+            items.push_back({b, i, bitsOff});
+            bitsOff += i->hasInstOpt(InstOpt::COMPACTED) ? 8 : 16;
+        }
+    }
+
+    std::vector<std::stringstream> outs(threads);
+    std::vector<ErrorHandler> errs(threads);
+    auto formatItems = [&](size_t t) {
+        Formatter f(errs[t], outs[t], opts);
+        size_t end = (t + 1)*items.size()/threads;
+        for (size_t ix = t*items.size()/threads; ix < end; ix++) {
+            const Item &it = items[ix];
+            if (it.inst == nullptr) {
+                f.formatBlockLabel(*it.block);
+            } else {
+                f.formatInstruction(
+                    *it.inst, bits ? bits + it.bitsOff : nullptr);
+                f.newline();
+            }
+        }
+    };
+    std::vector<std::thread> workers;
+    for (size_t t = 1; t < threads; t++) {
+        workers.emplace_back(formatItems, t);
+    }
+    formatItems(0);
+    for (auto &w : workers) {
+        w.join();
+    }
+
+    for (size_t t = 0; t < threads; t++) {
+        o << outs[t].str();
+        for (const auto &d : errs[t].getErrors()) {
+            e.reportError(d.at, d.message);
+        }
+        for (const auto &d : errs[t].getWarnings()) {
+            e.reportWarning(d.at, d.message);
+        }
+    }
+}
+
+
 void FormatKernel(
     ErrorHandler& e,
     std::ostream& o,
@@ -988,6 +1062,16 @@ void FormatKernel(
 {
     IGA_ASSERT(k.getModel().platform == opts.platform,
         "kernel and options must have same platform");
+    if (opts.parallelism > 1 && opts.labeler == nullptr) {
+        size_t items = k.getBlockList().size() + k.getInstructionCount();
+        size_t threads = std::min<size_t>(
+            opts.parallelism, items/PARALLEL_FORMAT_MIN_ITEMS);
+        if (threads > 1) {
+            FormatKernelParallel(
+                e, o, opts, k, (const uint8_t *)bits, threads);
+            return;
+        }
+    }
     Formatter f(e, o, opts);
     f.formatKernel(k, (const uint8_t *)bits);
 }
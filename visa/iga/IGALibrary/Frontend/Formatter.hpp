@@ -57,6 +57,10 @@ namespace iga {
         bool              printInstBits = true;
         bool              printLdSt = false;
         DepAnalysis      *liveAnalysis = nullptr;
+        // formats large kernels on up to this many threads (0 or 1 formats
+        // on the calling thread); a labeler forces the calling thread only
+        // since it needn't be thread-safe
+        unsigned          parallelism = 0;
 
         // format with default labels
         FormatOpts(Platform _platform)
@@ -33,9 +33,15 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../IR/Types.hpp"
 #include "../strings.hpp"
 
+#include <algorithm>
+#include <cctype>
+#include <cstring>
 #include <limits>
 #include <map>
+#include <memory>
+#include <set>
 #include <string>
+#include <thread>
 #include <vector>
 
 
@@ -146,10 +152,11 @@ static const IdentMap<MathMacroExt> MATHMACROREGS_OLDSTYLE = {
 GenParser::GenParser(
     const Model &model,
     InstBuilder &handler,
-    const std::string &inp,
+    const char *inp,
+    size_t inpLen,
     ErrorHandler &eh,
     const ParseOpts &pots)
-    : Parser(inp,eh)
+    : Parser(inp,inpLen,eh)
     , m_model(model)
     , m_handler(handler)
     , m_parseOpts(pots)
@@ -923,10 +930,11 @@ public:
     KernelParser(
         const Model &model,
         InstBuilder &handler,
-        const std::string &inp,
+        const char *inp,
+        size_t inpLen,
         ErrorHandler &eh,
         const ParseOpts &pots)
-        : GenParser(model, handler, inp, eh, pots)
+        : GenParser(model, handler, inp, inpLen, eh, pots)
         , m_defaultExecutionSize(ExecSize::SIMD1)
         , m_defaultRegisterType(Type::INVALID)
     {
@@ -2972,17 +2980,248 @@ private:
 }; // class KernelParser
 
 
+// the least number of characters worth parsing on a separate thread
+static const size_t PARALLEL_PARSE_MIN_CHUNK = 64*1024;
+
+
+// Finds the starts of lines that begin with a label definition (outside
+// comments) at least 'minChunk' characters apart; the kernel text can be
+// split at these and the pieces parsed independently.
+static std::vector<size_t> FindLabelSplits(
+    const char *inp, size_t len, size_t minChunk)
+{
+    auto isIdentStart = [](char c) {return isalpha((unsigned char)c) || c == '_';};
+    auto isIdent = [](char c) {return isalnum((unsigned char)c) || c == '_';};
+    auto isSpace = [](char c) {return c == ' ' || c == '\t' || c == '\r';};
+
+    std::vector<size_t> splits(1, 0);
+    bool inComment = false; // within /* ... */
+    size_t i = 0;
+    while (i < len) {
+        // i is the start of a line; "LABEL:" followed by nothing
+        // but a comment is a label definition (c.f. LookingAtLabelDef)
+        if (!inComment && i - splits.back() >= minChunk) {
+            size_t k = i;
+            while (k < len && isSpace(inp[k]))
+                k++;
+            if (k < len && isIdentStart(inp[k])) {
+                while (k < len && isIdent(inp[k]))
+                    k++;
+                while (k < len && isSpace(inp[k]))
+                    k++;
+                if (k < len && inp[k] == ':') {
+                    k++;
+                    while (k < len && isSpace(inp[k]))
+                        k++;
+                    if (k == len || inp[k] == '\n' ||
+                        (inp[k] == '/' && k + 1 < len && inp[k + 1] == '/'))
+                    {
+                        splits.push_back(i);
+                    }
+                }
+            }
+        }
+        // skip to the next line
+        while (i < len && inp[i] != '\n') {
+            if (inComment) {
+                if (inp[i] == '*' && i + 1 < len && inp[i + 1] == '/') {
+                    inComment = false;
+                    i++;
+                }
+            } else if (inp[i] == '/' && i + 1 < len && inp[i + 1] == '*') {
+                inComment = true;
+                i++;
+            } else if (inp[i] == '/' && i + 1 < len && inp[i + 1] == '/') {
+                while (i + 1 < len && inp[i + 1] != '\n')
+                    i++;
+            } else if (inp[i] == '"' || inp[i] == '\'') {
+                // string and character literals end on the same line
+                char q = inp[i];
+                while (i + 1 < len && inp[i + 1] != q && inp[i + 1] != '\n')
+                    i += inp[i + 1] == '\\' ? 2 : 1;
+                if (i + 1 < len && inp[i + 1] == q)
+                    i++;
+            }
+            i++;
+        }
+        i++; // the newline
+    }
+    return splits;
+}
+
+
+// Parses a kernel in pieces split at label definitions, each on its own
+// thread with its own kernel, and then copies the blocks into a new kernel
+// resolving labels across pieces by name.  Returns nullptr if that isn't
+// possible or something goes wrong (legacy directives and numeric labels
+// depend on what precedes them, and errors must be diagnosed exactly as a
+// serial parse would); the caller then parses the kernel serially.
+static Kernel *ParseGenKernelParallel(
+    const Model &m,
+    const char *inp,
+    size_t len,
+    iga::ErrorHandler &e,
+    const ParseOpts &popts)
+{
+    std::vector<size_t> splits = FindLabelSplits(
+        inp,
+        len,
+        std::max<size_t>(len/popts.parallelism, PARALLEL_PARSE_MIN_CHUNK));
+    if (splits.size() < 2) {
+        return nullptr;
+    }
+    splits.push_back(len);
+
+    struct Piece {
+        std::unique_ptr<Kernel>      kernel;
+        ErrorHandler                 errors;
+        std::unique_ptr<InstBuilder> builder;
+        std::set<const Block *>      defined; // the kernel's blocks
+        bool                         failed = false;
+        uint32_t                     line = 1; // starting line
+
+        ~Piece() {
+            // the kernel only destroys the blocks it defines; labels
+            // defined in other pieces are left to us
+            if (builder) {
+                for (const auto &lb : builder->getBlocks()) {
+                    if (defined.find(lb.second) == defined.end())
+                        lb.second->~Block();
+                }
+            }
+        }
+    };
+    size_t numPieces = splits.size() - 1;
+    std::vector<Piece> pieces(numPieces);
+    for (size_t i = 1; i < numPieces; i++) {
+        pieces[i].line = pieces[i - 1].line + (uint32_t)std::count(
+            inp + splits[i - 1], inp + splits[i], '\n');
+    }
+    auto parsePiece = [&](size_t i) {
+        Piece &p = pieces[i];
+        try {
+            p.kernel.reset(new Kernel(m));
+            p.builder.reset(new InstBuilder(p.kernel.get(), p.errors));
+            p.builder->allowUndefinedLabels();
+            KernelParser kp(
+                m,
+                *p.builder,
+                inp + splits[i],
+                splits[i + 1] - splits[i],
+                p.errors,
+                popts);
+            kp.ParseListing();
+            for (const Block *b : p.kernel->getBlockList()) {
+                p.defined.insert(b);
+            }
+        } catch (...) {
+            p.failed = true;
+        }
+    };
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < numPieces; i++) {
+        workers.emplace_back(parsePiece, i);
+    }
+    parsePiece(0);
+    for (auto &w : workers) {
+        w.join();
+    }
+
+    // every label must be defined exactly once in all the pieces
+    std::set<std::string> defined;
+    for (const Piece &p : pieces) {
+        if (p.failed || p.errors.hasErrors() || p.builder->hasNumericLabels())
+            return nullptr;
+        for (const auto &lb : p.builder->getBlocks()) {
+            if (p.defined.find(lb.second) != p.defined.end() &&
+                !defined.insert(lb.first).second)
+            {
+                return nullptr;
+            }
+        }
+    }
+    for (const Piece &p : pieces) {
+        for (const auto &lb : p.builder->getBlocks()) {
+            if (defined.find(lb.first) == defined.end())
+                return nullptr;
+        }
+    }
+
+    // copy the blocks out in order, adjusting PCs, ids, and locations
+    Kernel *k = new Kernel(m);
+    std::map<std::string,Block *> blocks;
+    for (const std::string &lbl : defined) {
+        blocks[lbl] = k->createBlock();
+    }
+    int32_t pc = 0;
+    int id = 1;
+    for (size_t i = 0; i < numPieces; i++) {
+        Piece &p = pieces[i];
+        auto relocate = [&](Loc loc) {
+            if (loc.line > 0) {
+                loc.line += p.line - 1;
+                loc.offset += (PC)splits[i];
+            }
+            return loc;
+        };
+        std::map<const Block *,Block *> blockMap;
+        for (const auto &lb : p.builder->getBlocks()) {
+            blockMap[lb.second] = blocks[lb.first];
+        }
+        int32_t piecePc = pc;
+        for (Block *pb : p.kernel->getBlockList()) {
+            Block *b = blockMap[pb];
+            b->setPC(piecePc + pb->getPC());
+            b->setLoc(relocate(pb->getLoc()));
+            for (const Instruction *pi : pb->getInstList()) {
+                Instruction *inst = new (&k->getMemManager()) Instruction(*pi);
+                inst->setPC(piecePc + pi->getPC());
+                inst->setID(id++);
+                inst->setLoc(relocate(pi->getLoc()));
+                for (unsigned s = 0; s < inst->getSourceCount(); s++) {
+                    const Operand &op = inst->getSource(s);
+                    if (op.getKind() == Operand::Kind::LABEL) {
+                        inst->setLabelSource(
+                            (SourceIndex)s,
+                            blockMap[op.getTargetBlock()],
+                            op.getType());
+                    }
+                }
+                b->appendInstruction(inst);
+                pc = inst->getPC() +
+                    (inst->hasInstOpt(InstOpt::COMPACTED) ? 8 : 16);
+            }
+            k->appendBlock(b);
+        }
+        for (const auto &d : p.errors.getWarnings()) {
+            e.reportWarning(relocate(d.at), d.message);
+        }
+    }
+    return k;
+}
+
+
 Kernel *iga::ParseGenKernel(
     const Model &m,
     const char *inp,
     iga::ErrorHandler &e,
     const ParseOpts &popts)
 {
+    size_t len = strlen(inp);
+    if (popts.parallelism > 1 && !popts.supportLegacyDirectives) {
+        if (len >= 2*PARALLEL_PARSE_MIN_CHUNK) {
+            Kernel *k = ParseGenKernelParallel(m, inp, len, e, popts);
+            if (k) {
+                return k;
+            }
+        }
+    }
+
     Kernel *k = new Kernel(m);
 
     InstBuilder h(k, e);
 
-    KernelParser p(m, h, inp, e, popts);
+    KernelParser p(m, h, inp, len, e, popts);
     try {
         p.ParseListing();
     } catch (SyntaxError) {
@@ -48,6 +48,9 @@ namespace iga {
         // sets the maximum number of fatal syntax errors allowable
         // before we give up on the parse
         size_t maxSyntaxErrors = 3;
+        // parses large kernels on up to this many threads
+        // (0 or 1 parses on the calling thread)
+        unsigned parallelism = 0;
 
         ParseOpts() { }
     };
@@ -78,7 +81,8 @@ namespace iga {
         GenParser(
             const Model &model,
             InstBuilder &handler,
-            const std::string &inp,
+            const char *inp,
+            size_t inpLen,
             ErrorHandler &eh,
             const ParseOpts &pots);
 
@@ -45,7 +45,8 @@ namespace iga
     void Parser::ShowCurrentLexicalContext(
         std::ostream &os, const Loc &loc) const
     {
-        WriteTokenContext(m_lexer.GetSource(), loc, os);
+        WriteTokenContext(
+            m_lexer.GetSource(), m_lexer.GetSourceLength(), loc, os);
     }
 
     //////////////////////////////////////////////////////////////////////
@@ -117,7 +118,8 @@ namespace iga
     }
 
     std::string Parser::GetTokenAsString(const Token &token) const {
-        return m_lexer.GetSource().substr(token.loc.offset, token.loc.extent);
+        return std::string(
+            m_lexer.GetSource() + token.loc.offset, token.loc.extent);
     }
 
     //////////////////////////////////////////////////////////////////////
@@ -174,7 +176,7 @@ namespace iga
     // IDENTIFIER and RAW STRING MANIPULATION
     bool Parser::PrefixAtEq(size_t off, const char *pfx) const {
         size_t slen = strlen(pfx);
-        if (off + slen > m_lexer.GetSource().size())
+        if (off + slen > m_lexer.GetSourceLength())
             return false;
         return strncmp(pfx,&m_lexer.GetSource()[off],slen) == 0;
     }
@@ -220,7 +222,7 @@ namespace iga
             return false;
         size_t slen = strlen(eq);
         if (slen != tk.loc.extent ||
-            tk.loc.offset + slen > m_lexer.GetSource().size())
+            tk.loc.offset + slen > m_lexer.GetSourceLength())
             return false;
         const char *str = &m_lexer.GetSource()[tk.loc.offset];
         return strncmp(eq,str,slen) == 0;
@@ -239,7 +241,7 @@ namespace iga
     void Parser::ParseFltFrom(const Loc loc, double &value) {
         // swap this out with something more platform implementation
         // independent (strtod may be slightly different on MS and non-MS
-        const char *val_start = m_lexer.GetSource().c_str() + loc.offset;
+        const char *val_start = m_lexer.GetSource() + loc.offset;
         char *val_end;
         value = strtod(val_start,&val_end);
         if (val_end - val_start != loc.extent) {
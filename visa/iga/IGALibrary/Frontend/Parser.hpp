@@ -75,8 +75,8 @@ namespace iga
         BufferedLexer                  m_lexer;
         ErrorHandler                  &m_errorHandler;
     public:
-        Parser(const std::string &inp, ErrorHandler &errHandler)
-            : m_lexer(inp)
+        Parser(const char *inp, size_t inpLen, ErrorHandler &errHandler)
+            : m_lexer(inp, inpLen)
             , m_errorHandler(errHandler)
         {
         }
@@ -258,7 +258,7 @@ namespace iga
 
         template <typename T>
         void ParseIntFrom(size_t off, size_t len, T &value) {
-            const std::string &src = m_lexer.GetSource();
+            const char *src = m_lexer.GetSource();
             value = 0;
             if (len > 2 &&
                 src[off] == '0' &&
@@ -163,6 +163,8 @@ class InstBuilder {
 
     uint32_t                    m_pc; // current PC
     uint32_t                    m_nextId; // next instruction id
+    // references to labels defined elsewhere are okay (see ParseGenKernel)
+    bool                        m_allowUndefinedLabels;
 
 
 
@@ -271,11 +273,19 @@ public:
         , m_errorHandler(e)
         , m_kernel(kernel)
         , m_currBlock(nullptr)
+        , m_allowUndefinedLabels(false)
     {
     }
 
     ErrorHandler &errorHandler() {return m_errorHandler;}
 
+    // For building a piece of a kernel: label references that the piece
+    // never defines are left as empty blocks for the caller to resolve.
+    void allowUndefinedLabels() {m_allowUndefinedLabels = true;}
+    // all blocks referenced or defined, by label
+    const BlockMap &getBlocks() const {return m_blocks;}
+    bool hasNumericLabels() const {return !m_blocksNumericTargets.empty();}
+
 
     // Called at the beginning of the program
     void ProgramStart() {
@@ -298,7 +308,9 @@ public:
         {
             Block *b = itr->first;
             bool notNumericLabel = m_blocksNumericTargets.find(b) == m_blocksNumericTargets.end();
-            if (notNumericLabel && m_blocksDefd.find(b) == m_blocksDefd.end()) {
+            if (notNumericLabel && !m_allowUndefinedLabels &&
+                m_blocksDefd.find(b) == m_blocksDefd.end())
+            {
                 // not a numeric label and never defined
                 m_errorHandler.reportError(itr->second, "undefined label");
             }
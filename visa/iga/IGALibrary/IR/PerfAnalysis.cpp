@@ -0,0 +1,400 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+#include "PerfAnalysis.hpp"
+#include "RegSet.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <string>
+
+using namespace iga;
+
+// The ALU/math figures and the SFID-indexed send latencies follow the vISA
+// local scheduler's SKL latency table. No other platform has measured
+// numbers, so every platform uses this model.
+static const PerfModel SKL_PERF_MODEL = {
+    "SKL",
+    12, 2,  10, 4,  18, 4,  22, 8,  2,
+    {48, 48, 298, 198, 398, 198, 48, 48, 48, 58, 398, 48, 398, 198, 198, 198},
+    4,  2, 1
+};
+
+const PerfModel &PerfModel::lookup(Platform)
+{
+    return SKL_PERF_MODEL;
+}
+
+// blocks inside a loop are assumed to run this many times per enclosing
+// loop (up to PERF_MAX_LOOP_DEPTH levels) when ranking them
+static const uint64_t PERF_LOOP_TRIP_ESTIMATE = 8;
+static const int PERF_MAX_LOOP_DEPTH = 4;
+
+// scoreboard slots: one per GRF, then a0, acc0-3 and f0-1
+static const int SB_A0 = (int)RS_GRF_R_REGS;
+static const int SB_ACC = SB_A0 + 1;
+static const int SB_F = SB_ACC + (int)RS_ARF_ACC_REGS;
+static const int SB_SLOTS = SB_F + (int)RS_ARF_F_REGS;
+
+template <typename F>
+static void forEachSlot(const RegSet &rs, F f)
+{
+    const auto &bs = rs.getBitSet();
+    const size_t GRFS_PER_CHUNK = 8;
+    for (size_t r = 0; r < RS_GRF_R_REGS; r += GRFS_PER_CHUNK) {
+        if (!bs.testAny(
+            RS_GRF_R_START + r*RS_GRF_R_BPR, GRFS_PER_CHUNK*RS_GRF_R_BPR))
+        {
+            continue;
+        }
+        for (size_t k = r; k < r + GRFS_PER_CHUNK; k++) {
+            if (bs.testAny(RS_GRF_R_START + k*RS_GRF_R_BPR, RS_GRF_R_BPR)) {
+                f((int)k);
+            }
+        }
+    }
+    if (bs.testAny(RS_ARF_A_START, RS_ARF_A_REGS*RS_ARF_A_BPR)) {
+        f(SB_A0);
+    }
+    for (size_t k = 0; k < RS_ARF_ACC_REGS; k++) {
+        if (bs.testAny(RS_ARF_ACC_START + k*RS_ARF_ACC_BPR, RS_ARF_ACC_BPR)) {
+            f(SB_ACC + (int)k);
+        }
+    }
+    for (size_t k = 0; k < RS_ARF_F_REGS; k++) {
+        if (bs.testAny(RS_ARF_F_START + k*RS_ARF_F_BPR, RS_ARF_F_BPR)) {
+            f(SB_F + (int)k);
+        }
+    }
+}
+
+// issue cycles and result latency of one instruction
+static void instructionCost(
+    const PerfModel &pm, const Instruction &i, int &occupancy, int &latency)
+{
+    const OpSpec &os = i.getOpSpec();
+    if (os.isSendOrSendsFamily()) {
+        int sfid = 0xA; // data cache if the descriptor is in a register
+        auto exDesc = i.getExtMsgDescriptor();
+        if (exDesc.type == SendDescArg::IMM) {
+            sfid = (int)(exDesc.imm & 0xF);
+        }
+        occupancy = pm.sendOccupancy;
+        latency = pm.sendLatency[sfid];
+        return;
+    }
+    if (os.isBranching()) {
+        occupancy = pm.branchCycles;
+        latency = 0;
+        return;
+    }
+
+    switch (i.getOp()) {
+    case Op::MATH_FDIV:
+    case Op::MATH_POW:
+        occupancy = pm.mathLongOccupancy;
+        latency = pm.mathLongLatency;
+        break;
+    case Op::BFE: case Op::BFI1: case Op::BFI2: case Op::BFREV:
+    case Op::CBIT: case Op::FBH: case Op::FBL:
+    case Op::DP2: case Op::DP3: case Op::DP4: case Op::DPH:
+    case Op::LINE: case Op::LRP: case Op::MAC: case Op::MACH: case Op::PLN:
+        occupancy = pm.complexOccupancy;
+        latency = pm.complexLatency;
+        break;
+    default:
+        if (i.getGroupOp() == Op::MATH) {
+            occupancy = pm.mathOccupancy;
+            latency = pm.mathLatency;
+        } else {
+            occupancy = pm.aluOccupancy;
+            latency = pm.aluLatency;
+        }
+        break;
+    }
+
+    // occupancies are for one GRF's worth of data (e.g. SIMD8 :f);
+    // scale by the widest of the destination and first source
+    int typeBits = 32;
+    if (os.supportsDestination()) {
+        typeBits = TypeSizeInBitsWithDefault(i.getDestination().getType(), 32);
+    }
+    if (i.getSourceCount() > 0) {
+        typeBits = std::max(typeBits,
+            TypeSizeInBitsWithDefault(i.getSource(0).getType(), 32));
+    }
+    size_t bytes = (size_t)i.getExecSize() * (size_t)typeBits / 8;
+    size_t grfs = (bytes + RS_GRF_R_BPR - 1) / RS_GRF_R_BPR;
+    occupancy *= (int)std::max<size_t>(1, grfs);
+}
+
+// two distinct GRF sources of a ternary op read in the same cycle from
+// the same bank stall the read (src1/src2 on these parts)
+static bool hasBankConflict(const PerfModel &pm, const Instruction &i)
+{
+    if (!i.getOpSpec().isTernary() || i.isMacro()) {
+        return false;
+    }
+    const Operand &s1 = i.getSource(1), &s2 = i.getSource(2);
+    if (s1.getKind() != Operand::Kind::DIRECT ||
+        s2.getKind() != Operand::Kind::DIRECT ||
+        s1.getDirRegName() != RegName::GRF_R ||
+        s2.getDirRegName() != RegName::GRF_R)
+    {
+        return false;
+    }
+    int r1 = s1.getDirRegRef().regNum, r2 = s2.getDirRegRef().regNum;
+    return r1 != r2 && r1 % pm.grfBanks == r2 % pm.grfBanks;
+}
+
+static void analyzeBlock(const PerfModel &pm, const Block &b, BlockPerf &bp)
+{
+    uint64_t ready[SB_SLOTS];
+    bool fromSend[SB_SLOTS];
+    std::fill(ready, ready + SB_SLOTS, 0);
+    std::fill(fromSend, fromSend + SB_SLOTS, false);
+
+    uint64_t cycle = 0;
+    for (const Instruction *i : b.getInstList()) {
+        bool isSend = i->getOpSpec().isSendOrSendsFamily();
+        InstSrcs srcs = InstSrcs::compute(*i);
+        InstDsts dsts = InstDsts::compute(*i);
+
+        // in-order issue waits for every register read (RAW) and
+        // every register still being written (WAW)
+        uint64_t aluWait = cycle, sendWait = cycle;
+        auto waitOn = [&] (int slot) {
+            if (fromSend[slot]) {
+                sendWait = std::max(sendWait, ready[slot]);
+            } else {
+                aluWait = std::max(aluWait, ready[slot]);
+            }
+        };
+        forEachSlot(srcs.unionOf(), waitOn);
+        forEachSlot(dsts.unionOf(), waitOn);
+        uint64_t issueAt = std::max(aluWait, sendWait);
+        if (sendWait >= aluWait) {
+            bp.sendStallCycles += issueAt - cycle;
+        } else {
+            bp.dependencyStallCycles += issueAt - cycle;
+        }
+
+        int occupancy = 0, latency = 0;
+        instructionCost(pm, *i, occupancy, latency);
+        if (hasBankConflict(pm, *i)) {
+            bp.bankConflicts++;
+            bp.bankConflictCycles += pm.bankConflictCycles;
+            occupancy += pm.bankConflictCycles;
+        }
+        bp.issueCycles += occupancy;
+        bp.instructions++;
+        if (isSend) {
+            bp.sends++;
+        }
+
+        cycle = issueAt + occupancy;
+        uint64_t resultAt = cycle + latency;
+        forEachSlot(dsts.unionOf(), [&] (int slot) {
+            ready[slot] = resultAt;
+            fromSend[slot] = isSend;
+        });
+    }
+    bp.cycles = cycle;
+}
+
+static void accumulate(BlockPerf &into, const BlockPerf &bp)
+{
+    into.instructions += bp.instructions;
+    into.sends += bp.sends;
+    into.issueCycles += bp.issueCycles;
+    into.dependencyStallCycles += bp.dependencyStallCycles;
+    into.sendStallCycles += bp.sendStallCycles;
+    into.bankConflicts += bp.bankConflicts;
+    into.bankConflictCycles += bp.bankConflictCycles;
+    into.cycles += bp.cycles;
+    into.weightedCycles += bp.weightedCycles;
+}
+
+PerfAnalysis iga::ComputePerfAnalysis(const Kernel &k)
+{
+    PerfAnalysis pa;
+    pa.model = &k.getModel();
+    const PerfModel &pm = PerfModel::lookup(k.getModel().platform);
+    pa.perfModel = &pm;
+
+    const BlockList &bl = k.getBlockList();
+    std::vector<const Block *> blocks(bl.begin(), bl.end());
+    pa.blocks.resize(blocks.size());
+    for (size_t bi = 0; bi < blocks.size(); bi++) {
+        pa.blocks[bi].block = blocks[bi];
+    }
+
+    // loop nesting from backward branches: every block from the target
+    // up to the branching block is inside that loop
+    auto indexOf = [&] (const Block *b) {
+        auto it = std::lower_bound(blocks.begin(), blocks.end(), b,
+            [] (const Block *x, const Block *y) {
+                return x->getPC() < y->getPC();
+            });
+        return it != blocks.end() && *it == b ?
+            (size_t)(it - blocks.begin()) : blocks.size();
+    };
+    for (size_t bi = 0; bi < blocks.size(); bi++) {
+        for (const Instruction *i : blocks[bi]->getInstList()) {
+            if (!i->isBranching()) {
+                continue;
+            }
+            size_t head = blocks.size();
+            for (unsigned s = 0; s < i->getSourceCount(); s++) {
+                const Operand &op = i->getSource(s);
+                const Block *t = op.getKind() == Operand::Kind::LABEL ?
+                    op.getTargetBlock() : nullptr;
+                if (t && t->getPC() <= i->getPC()) {
+                    head = std::min(head, indexOf(t));
+                }
+            }
+            for (size_t b = head; b <= bi && b < blocks.size(); b++) {
+                pa.blocks[b].loopDepth++;
+            }
+        }
+    }
+
+    for (BlockPerf &bp : pa.blocks) {
+        analyzeBlock(pm, *bp.block, bp);
+        bp.weightedCycles = bp.cycles;
+        for (int d = 0; d < std::min(bp.loopDepth, PERF_MAX_LOOP_DEPTH); d++) {
+            bp.weightedCycles *= PERF_LOOP_TRIP_ESTIMATE;
+        }
+        accumulate(pa.total, bp);
+    }
+    return pa;
+}
+
+// hottest first; ties in PC order
+static std::vector<const BlockPerf *> hottestBlocks(
+    const PerfAnalysis &pa, size_t maxBlocks)
+{
+    std::vector<const BlockPerf *> hot;
+    for (const BlockPerf &bp : pa.blocks) {
+        hot.push_back(&bp);
+    }
+    std::stable_sort(hot.begin(), hot.end(),
+        [] (const BlockPerf *a, const BlockPerf *b) {
+            return a->weightedCycles > b->weightedCycles;
+        });
+    if (maxBlocks != 0 && hot.size() > maxBlocks) {
+        hot.resize(maxBlocks);
+    }
+    return hot;
+}
+
+// same as the disassembler's default labels
+static std::string blockLabel(const BlockPerf &bp)
+{
+    return "L" + std::to_string(bp.block->getPC());
+}
+
+void iga::FormatPerfAnalysis(
+    std::ostream &os, const PerfAnalysis &pa, size_t maxBlocks)
+{
+    const BlockPerf &t = pa.total;
+    os << "platform: " << pa.model->name << "\n";
+    os << "latency model: " << pa.perfModel->name <<
+        " (cycle counts are " << pa.perfModel->name << " estimates)\n";
+    os << "instructions: " << t.instructions <<
+        " in " << pa.blocks.size() << " blocks (" << t.sends << " sends)\n";
+    os << "estimated cycles: " << t.cycles <<
+        " (" << t.weightedCycles << " weighted by loop depth)\n";
+    os << "  issue:             " << t.issueCycles << "\n";
+    os << "  dependency stalls: " << t.dependencyStallCycles << "\n";
+    os << "  send stalls:       " << t.sendStallCycles << "\n";
+    os << "  bank conflicts:    " << t.bankConflicts <<
+        " (" << t.bankConflictCycles << " cycles)\n";
+
+    os << "hottest blocks:\n";
+    os << std::setw(12) << std::left << "  block" << std::right <<
+        std::setw(8) << "pc" <<
+        std::setw(7) << "depth" <<
+        std::setw(7) << "insts" <<
+        std::setw(7) << "sends" <<
+        std::setw(10) << "cycles" <<
+        std::setw(12) << "weighted" <<
+        std::setw(10) << "issue" <<
+        std::setw(10) << "dep" <<
+        std::setw(10) << "send" <<
+        std::setw(6) << "bank" << "\n";
+    for (const BlockPerf *bp : hottestBlocks(pa, maxBlocks)) {
+        os << "  " << std::setw(10) << std::left << blockLabel(*bp) <<
+            std::right <<
+            std::setw(8) << bp->block->getPC() <<
+            std::setw(7) << bp->loopDepth <<
+            std::setw(7) << bp->instructions <<
+            std::setw(7) << bp->sends <<
+            std::setw(10) << bp->cycles <<
+            std::setw(12) << bp->weightedCycles <<
+            std::setw(10) << bp->issueCycles <<
+            std::setw(10) << bp->dependencyStallCycles <<
+            std::setw(10) << bp->sendStallCycles <<
+            std::setw(6) << bp->bankConflicts << "\n";
+    }
+}
+
+static void formatJSONCounters(std::ostream &os, const BlockPerf &bp)
+{
+    os << "\"instructions\": " << bp.instructions <<
+        ", \"sends\": " << bp.sends <<
+        ", \"cycles\": " << bp.cycles <<
+        ", \"weighted_cycles\": " << bp.weightedCycles <<
+        ", \"issue_cycles\": " << bp.issueCycles <<
+        ", \"dependency_stall_cycles\": " << bp.dependencyStallCycles <<
+        ", \"send_stall_cycles\": " << bp.sendStallCycles <<
+        ", \"bank_conflicts\": " << bp.bankConflicts <<
+        ", \"bank_conflict_cycles\": " << bp.bankConflictCycles;
+}
+
+void iga::FormatPerfAnalysisJSON(
+    std::ostream &os, const PerfAnalysis &pa, size_t maxBlocks)
+{
+    os << "{\n";
+    os << "  \"platform\": \"" << pa.model->name << "\",\n";
+    os << "  \"latency_model\": \"" << pa.perfModel->name << "\",\n";
+    os << "  \"blocks\": " << pa.blocks.size() << ",\n";
+    os << "  \"total\": {";
+    formatJSONCounters(os, pa.total);
+    os << "},\n";
+    os << "  \"hottest_blocks\": [";
+    bool first = true;
+    for (const BlockPerf *bp : hottestBlocks(pa, maxBlocks)) {
+        os << (first ? "\n" : ",\n");
+        first = false;
+        os << "    {\"label\": \"" << blockLabel(*bp) << "\"" <<
+            ", \"pc\": " << bp->block->getPC() <<
+            ", \"loop_depth\": " << bp->loopDepth << ", ";
+        formatJSONCounters(os, *bp);
+        os << "}";
+    }
+    os << (first ? "]\n" : "\n  ]\n");
+    os << "}\n";
+}
@@ -0,0 +1,105 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+
+#ifndef _IGA_IR_PERFANALYSIS_HPP
+#define _IGA_IR_PERFANALYSIS_HPP
+
+#include "../IR/Kernel.hpp"
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace iga
+{
+    // The latency/occupancy model for the static performance estimate.
+    // Latencies are issue-to-result in EU cycles and occupancies are issue
+    // cycles for a SIMD8 32-bit operation (wider operations scale by the
+    // number of GRFs they touch).  The figures are coarse and meant for
+    // ranking blocks and comparing binaries, not predicting run time.
+    struct PerfModel
+    {
+        const char  *name; // platform the figures were measured on
+        int          aluLatency, aluOccupancy; // add, mov, sel, ...
+        int          complexLatency, complexOccupancy; // dp*, mac, lrp, bf*
+        int          mathLatency, mathOccupancy;
+        int          mathLongLatency, mathLongOccupancy; // fdiv, pow
+        int          sendOccupancy;
+        int          sendLatency[16]; // indexed by SFID
+        int          branchCycles; // pipeline cost of a control-flow op
+        int          grfBanks;
+        int          bankConflictCycles; // per conflicting ternary read
+
+        // Only SKL numbers are available; every platform gets the SKL
+        // model, and the reports say so.
+        static const PerfModel &lookup(Platform p);
+    };
+
+    struct BlockPerf
+    {
+        const Block *block = nullptr;
+        // number of loops (backward branches) enclosing this block
+        int          loopDepth = 0;
+        size_t       instructions = 0;
+        size_t       sends = 0;
+        // cycles spent issuing instructions
+        uint64_t     issueCycles = 0;
+        // cycles the in-order pipeline waits on ALU/math results
+        uint64_t     dependencyStallCycles = 0;
+        // cycles the pipeline waits on send (memory, sampler, ...) results
+        uint64_t     sendStallCycles = 0;
+        // ternary instructions reading two GRFs from the same bank
+        size_t       bankConflicts = 0;
+        uint64_t     bankConflictCycles = 0;
+        // estimated cycles for one execution of the block
+        uint64_t     cycles = 0;
+        // cycles scaled by an assumed trip count per enclosing loop;
+        // this is what blocks are ranked by
+        uint64_t     weightedCycles = 0;
+    };
+
+    struct PerfAnalysis
+    {
+        const Model             *model = nullptr;
+        const PerfModel         *perfModel = nullptr;
+        // in kernel (PC) order
+        std::vector<BlockPerf>   blocks;
+        BlockPerf                total; // sums (block and depth are unset)
+    };
+
+    // Estimates per-block cycles with an in-order scoreboard over each
+    // block; results in flight are not carried across block boundaries.
+    PerfAnalysis ComputePerfAnalysis(const Kernel &k);
+
+    // Reports the kernel totals and the 'maxBlocks' hottest blocks
+    // (0 reports every block) as text or as a JSON object.
+    void FormatPerfAnalysis(
+        std::ostream &os, const PerfAnalysis &pa, size_t maxBlocks);
+    void FormatPerfAnalysisJSON(
+        std::ostream &os, const PerfAnalysis &pa, size_t maxBlocks);
+} // namespace iga
+
+#endif // _IGA_IR_PERFANALYSIS_HPP
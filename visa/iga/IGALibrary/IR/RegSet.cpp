@@ -70,7 +70,7 @@ bool RegSet::setDstRegion(
         hz = 1;
     }
 
-    size_t baseAddr = relativeAddressOf(*rsi, rr, typeSizeBits/8);
+    size_t baseAddr = relativeAddressOf(*rsi, rr, typeSizeBits);
     bool added = false;
     for (size_t ch = 0; ch < execSize; ch++) {
         size_t offset = ch*hz*typeSizeBits/8;
@@ -362,7 +362,7 @@ bool RegSet::addDestinationOutputs(const Instruction &i, RegSet &rs)
             ar,
             Region::DST1,
             execSize,
-            typeSizeBits/8);
+            typeSizeBits);
     }
     Region rgn = op.getRegion();
     switch (op.getKind()) {
@@ -394,7 +394,7 @@ bool RegSet::addDestinationOutputs(const Instruction &i, RegSet &rs)
                 op.getDirRegRef(),
                 op.getRegion(),
                 execSize,
-                typeSizeBits/8);
+                typeSizeBits);
         }
         break;
     case Operand::Kind::MACRO: {
@@ -405,7 +405,7 @@ bool RegSet::addDestinationOutputs(const Instruction &i, RegSet &rs)
             op.getDirRegRef(),
             Region::DST1,
             execSize,
-            typeSizeBits/8);
+            typeSizeBits);
         auto MathMacroReg = op.getMathMacroExt();
         if (MathMacroReg != MathMacroExt::NOMME && MathMacroReg != MathMacroExt::INVALID) {
             // and the math macro register
@@ -416,7 +416,7 @@ bool RegSet::addDestinationOutputs(const Instruction &i, RegSet &rs)
                 mmeRegRef,
                 Region::DST1,
                 execSize,
-                typeSizeBits/8);
+                typeSizeBits);
         }
         break;
     }
@@ -429,7 +429,7 @@ bool RegSet::addDestinationOutputs(const Instruction &i, RegSet &rs)
             op.getIndAddrReg(),
             Region::DST1,
             1, // one element only
-            2); // :w is 16-bits
+            16); // :w is 16-bits
         break;
     default:
         break;
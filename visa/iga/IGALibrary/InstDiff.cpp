@@ -281,7 +281,7 @@ iga_status_t iga::DecodeFields(
     const Model *model = Model::LookupModel(p);
     if (model == nullptr) {
         return IGA_UNSUPPORTED_PLATFORM;
-    } else if (!iga::native::IsDecodeSupported(*model, DecoderOpts())) {
+    } else if (!iga::native::IsDecodeFieldsSupported(*model)) {
         return IGA_UNSUPPORTED_PLATFORM;
     }
 
@@ -342,7 +342,7 @@ iga_status_t iga::DiffFieldsFromPCs(
     const Model *model = Model::LookupModel(p);
     if (model == nullptr) {
         return IGA_UNSUPPORTED_PLATFORM;
-    } else if (!iga::native::IsDecodeSupported(*model, DecoderOpts())) {
+    } else if (!iga::native::IsDecodeFieldsSupported(*model)) {
         return IGA_UNSUPPORTED_PLATFORM;
     }
 
@@ -723,7 +723,7 @@ iga_status_t iga::DebugCompaction(
     const Model *model = Model::LookupModel(p);
     if (model == nullptr) {
         return IGA_UNSUPPORTED_PLATFORM;
-    } else if (!iga::native::IsDecodeSupported(*model, DecoderOpts())) {
+    } else if (!iga::native::IsDecodeFieldsSupported(*model)) {
         return IGA_UNSUPPORTED_PLATFORM;
     }
 
@@ -9,6 +9,7 @@
 #include "../Frontend/KernelParser.hpp"
 #include "../IR/DUAnalysis.hpp"
 #include "../IR/IRChecker.hpp"
+#include "../IR/PerfAnalysis.hpp"
 #include "../strings.hpp"
 #include "../version.hpp"
 
@@ -19,6 +20,7 @@
 #include <vector>
 #include <ostream>
 #include <sstream>
+#include <thread>
 
 
 using namespace iga;
@@ -289,6 +291,9 @@ public:
         ParseOpts popts;
         popts.supportLegacyDirectives =
             (aopts.syntax_opts & IGA_SYNTAX_OPT_LEGACY_SYNTAX) != 0;
+        if (aopts.syntax_opts & IGA_SYNTAX_OPT_PARALLEL) {
+            popts.parallelism = std::thread::hardware_concurrency();
+        }
         Kernel *kernel = iga::ParseGenKernel(m_model, inp, errHandler, popts);
         if (kernel && !errHandler.hasErrors() && aopts.enabled_warnings) {
             // check semantics if we parsed without error && they haven't
@@ -392,6 +397,9 @@ public:
             (dopts.formatting_opts & IGA_FORMATTING_OPT_PRINT_DEPS) != 0;
         fopts.printLdSt =
             (dopts.formatting_opts & IGA_FORMATTING_OPT_PRINT_LDST) != 0;
+        if (dopts.decoder_opts & IGA_DECODING_OPT_PARALLEL) {
+            fopts.parallelism = std::thread::hardware_concurrency();
+        }
         return fopts;
     }
 
@@ -428,6 +436,11 @@ public:
         checkForLegacyFields(dopts, errHandler);
         DecoderOpts dopts2(
             (dopts.formatting_opts & IGA_FORMATTING_OPT_NUMERIC_LABELS) != 0);
+        dopts2.verifyNative =
+            (dopts.decoder_opts & IGA_DECODING_OPT_NATIVE_VERIFY) != 0;
+        if (dopts.decoder_opts & IGA_DECODING_OPT_PARALLEL) {
+            dopts2.parallelism = std::thread::hardware_concurrency();
+        }
         if ((dopts.decoder_opts & IGA_DECODING_OPT_NATIVE) == 0) {
             if (!iga::ged::IsDecodeSupported(m_model,dopts2)) {
                 return IGA_UNSUPPORTED_PLATFORM;
@@ -505,6 +518,55 @@ public:
     }
 
 
+    iga_status_t analyzePerf(
+        const iga_perf_options_t &popts,
+        const void *bits,
+        uint32_t bitsLen,
+        char **output)
+    {
+        *output = &m_empty_string[0];
+
+        iga::Kernel *k = nullptr;
+        iga::ErrorHandler errHandler;
+        iga_disassemble_options_t dopts = IGA_DISASSEMBLE_OPTIONS_INIT();
+        dopts.decoder_opts = popts.decoder_opts;
+        iga_status_t st = disassembleKernel(
+            errHandler,
+            dopts,
+            bits,
+            bitsLen,
+            k);
+        if (k != nullptr) {
+            PerfAnalysis pa = ComputePerfAnalysis(*k);
+            std::stringstream ss;
+            if (popts.perf_opts & IGA_PERF_OPT_JSON) {
+                FormatPerfAnalysisJSON(ss, pa, popts.max_blocks);
+            } else {
+                FormatPerfAnalysis(ss, pa, popts.max_blocks);
+            }
+            delete k;
+
+            // the report shares the disassembly text buffer
+            if (m_disassemble_text) {
+                free(m_disassemble_text);
+            }
+            std::string report = ss.str();
+            m_disassemble_text = (char *)malloc(report.size() + 1);
+            if (!m_disassemble_text) {
+                return IGA_OUT_OF_MEM;
+            }
+            memcpy(m_disassemble_text, report.c_str(), report.size() + 1);
+            *output = m_disassemble_text;
+        }
+
+        iga_status_t tst = translateDiagnostics(errHandler);
+        if (errHandler.hasErrors()) {
+            return IGA_DECODE_ERROR;
+        }
+        return st != IGA_SUCCESS ? st : tst;
+    }
+
+
     iga_status_t disassembleInstruction(
         iga_disassemble_options_t &dopts,
         const void *bits,
@@ -751,6 +813,32 @@ iga_status_t  iga_disassemble(
         ctx, dopts, input, input_size, fmt_label_name, fmt_label_ctx, kernel_text);
 }
 
+iga_status_t  iga_context_analyze_perf(
+    iga_context_t ctx,
+    const iga_perf_options_t *popts,
+    const void *input,
+    uint32_t input_size,
+    char **report_text)
+{
+    RETURN_INVALID_ARG_ON_NULL(ctx);
+    RETURN_INVALID_ARG_ON_NULL(popts);
+    if (input == nullptr && input_size != 0)
+        return IGA_INVALID_ARG;
+    RETURN_INVALID_ARG_ON_NULL(report_text);
+    if (popts->cb > sizeof(*popts)) {
+        return IGA_VERSION_ERROR;
+    }
+    iga_perf_options_t poptsInternal = IGA_PERF_OPTIONS_INIT();
+    MEMCPY(&poptsInternal, popts, popts->cb);
+
+    CAST_CONTEXT(ctx_obj, ctx);
+    return ctx_obj->analyzePerf(
+        poptsInternal,
+        input,
+        input_size,
+        report_text);
+}
+
 iga_status_t  iga_disassemble_instruction(
     iga_context_t ctx,
     const iga_disassemble_options_t *dopts,
@@ -1123,6 +1211,8 @@ iga_status_t  iga_get_interface(iga_functions_t *funcs)
     funcs->iga_opspec_op = &iga_opspec_op;
     funcs->iga_opspec_parent_op = &iga_opspec_parent_op;
 
+    funcs->iga_context_analyze_perf = &iga_context_analyze_perf;
+
     return IGA_SUCCESS;
 }
 
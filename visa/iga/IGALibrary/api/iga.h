@@ -254,6 +254,8 @@ static_assert(sizeof(iga_assemble_options_t) == 6*4,
 #define IGA_SYNTAX_OPT_LEGACY_SYNTAX   0x00000001u
 /* enables syntax extensions */
 #define IGA_SYNTAX_OPT_EXTENSIONS      0x00000002u
+/* parses large kernels on several threads (split at label definitions) */
+#define IGA_SYNTAX_OPT_PARALLEL        0x00000004u
 
 
 /*
@@ -391,6 +393,12 @@ static_assert(sizeof(iga_disassemble_options_t) == 5*4,
 
 /* uses the native decoder for decoding the kernel */
 #define IGA_DECODING_OPT_NATIVE   0x00000001u
+/* with IGA_DECODING_OPT_NATIVE, also decodes with GED and warns on any
+ * difference (a debugging aid; this is slower than either decoder) */
+#define IGA_DECODING_OPT_NATIVE_VERIFY   0x00000002u
+/* decodes and formats large kernels on several threads
+ * (a user label callback, fmt_label_name, is still called on one thread) */
+#define IGA_DECODING_OPT_PARALLEL   0x00000004u
 /* just the default decoding opts */
 #define IGA_DECODING_OPTS_DEFAULT \
     (0u)
@@ -498,6 +506,62 @@ IGA_API  iga_status_t  iga_disassemble_instruction(
     void *fmt_label_ctx,
     char **kernel_text);
 
+
+/*
+ * This structure contains options to the 'iga_context_analyze_perf' call.
+ */
+typedef struct {
+    uint32_t     cb;           /* set to sizeof(iga_perf_options_t) */
+    uint32_t     decoder_opts; /* opts for the decoding phase */
+    uint32_t     perf_opts;    /* bitset of IGA_PERF_OPT_* */
+    uint32_t     max_blocks;   /* hottest blocks to report (0 reports all) */
+} iga_perf_options_t;
+
+static_assert(sizeof(iga_perf_options_t) == 4*4,
+    "wrong size for iga_perf_options_t");
+
+/* emits the report as a JSON object instead of text */
+#define IGA_PERF_OPT_JSON   0x00000001u
+/* just the default analysis opts */
+#define IGA_PERF_OPTS_DEFAULT \
+    (0u)
+
+/* A default value for iga_perf_options_t */
+#define IGA_PERF_OPTIONS_INIT() \
+    {sizeof(iga_perf_options_t), \
+     IGA_DECODING_OPTS_DEFAULT, /* decoder_opts */ \
+     IGA_PERF_OPTS_DEFAULT, /* perf_opts */ \
+     10 /* max_blocks */ }
+
+/*
+ * Decodes kernel bits and statically estimates their performance from a
+ * per-platform latency model: per-block cycles, send stall exposure,
+ * register bank conflicts and register dependency stalls.  Blocks are
+ * ranked by cycles weighted by their loop depth.  No device is needed.
+ *
+ * PARAMETERS:
+ *  ctx             an iga context
+ *  popts           the analysis options
+ *  input           the instructions to analyze
+ *  input_size      the size of the 'input' in bytes
+ *  report_text     a pointer containing the NUL-terminated report; this
+ *                  has the same lifetime as the text returned by
+ *                  'iga_context_disassemble'
+ *
+ * RETURNS:
+ *  IGA_SUCCESS         upon success
+ *  IGA_INVALID_ARG     if an argument is NULL
+ *  IGA_INVALID_OBJECT  if ctx has already been destroyed
+ *  IGA_DECODE_ERROR    upon failure to decode the kernel; specific error
+ *                      messages may be retrieved via 'iga_context_get_errors'
+ */
+IGA_API  iga_status_t  iga_context_analyze_perf(
+    iga_context_t ctx,
+    const iga_perf_options_t *popts,
+    const void *input,
+    uint32_t input_size,
+    char **report_text);
+
 /*
  * A diagnostic message (e.g. error or warning)
  *
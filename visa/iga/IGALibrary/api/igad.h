@@ -115,6 +115,14 @@ typedef iga_status_t(CDECLATTRIBUTE * pIGADisassembleInstruction)(
     void *fmt_label_ctx,
     char **kernel_text);
 
+#define IGA_CONTEXT_ANALYZE_PERF_STR "iga_context_analyze_perf"
+typedef iga_status_t(CDECLATTRIBUTE * pIGAContextAnalyzePerf)(
+    iga_context_t ctx,
+    const iga_perf_options_t *popts,
+    const void *input,
+    uint32_t input_size,
+    char **report_text);
+
 #define IGA_CONTEXT_GET_ERRORS_STR "iga_context_get_errors"
 typedef iga_status_t(CDECLATTRIBUTE * pIGAContextGetErrors)(
     iga_context_t ctx,
@@ -340,6 +348,8 @@ typedef struct
     pIGAOpspecDescription               iga_opspec_description;
     pIGAOpspecOp                        iga_opspec_op;
     pIGAOpspecParentOp                  iga_opspec_parent_op;
+
+    pIGAContextAnalyzePerf              iga_context_analyze_perf;
 } iga_functions_t;
 
 /*
@@ -116,15 +116,25 @@ class Context {
 
     // assembles a string into bits, returns warning if applicable
     // failure will throw an igax::AssembleError of some sort
-    // (see subclasses below)
+    // (see subclasses below); IGA_SYNTAX_OPT_PARALLEL parses large
+    // kernels on several threads
     AsmResult assembleFromString(
         const std::string &text,
         const iga_assemble_options_t &opts = IGA_ASSEMBLE_OPTIONS_INIT());
-    // Disassembles a sequence of bits to a string
+    // Disassembles a sequence of bits to a string;
+    // IGA_DECODING_OPT_PARALLEL decodes and formats large kernels on
+    // several threads
     DisResult disassembleToString(
         const void *bits,
         const size_t bitsLen,
         const iga_disassemble_options_t &opts = IGA_DISASSEMBLE_OPTIONS_INIT());
+    // Decodes a sequence of bits and returns a static performance report
+    // (text, or JSON with IGA_PERF_OPT_JSON); failures throw the same
+    // errors as disassembleToString
+    DisResult analyzePerformance(
+        const void *bits,
+        const size_t bitsLen,
+        const iga_perf_options_t &opts = IGA_PERF_OPTIONS_INIT());
 };
 
 // parent class for all IGA API errors
@@ -367,6 +377,37 @@ inline DisResult Context::disassembleToString(
     return result;
 }
 
+inline DisResult Context::analyzePerformance(
+    const void *bits,
+    const size_t bitsLen,
+    const iga_perf_options_t &opts)
+{
+    char *text;
+    iga_status_t st = iga_context_analyze_perf(
+        context,
+        &opts,
+        bits,
+        (uint32_t)bitsLen,
+        &text);
+    if (st != IGA_SUCCESS) {
+        std::vector<Diagnostic> errs;
+        if (st != IGA_UNSUPPORTED_PLATFORM) {
+            errs = igax::getErrors(context);
+        }
+        if (st == IGA_DECODE_ERROR) {
+            throw DecodeError("iga_context_analyze_perf", errs, bits, bitsLen);
+        } else {
+            throw DisassembleError(
+                st, "iga_context_analyze_perf", errs, bits, bitsLen);
+        }
+    }
+
+    DisResult result;
+    result.value = text;
+    result.warnings = getWarnings(context);
+    return result;
+}
+
 inline void Error::emit(std::ostream &os) const {
     os << api << ": " << iga_status_to_string(status);
 }
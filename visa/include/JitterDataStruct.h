@@ -72,6 +72,11 @@ typedef struct _CM_JIT_INFO {
 
     void* freeGRFInfo;
     unsigned int freeGRFInfoSize;
+
+    // Number of three-source instructions whose GRF sources read from the
+    // same register bank, one entry per BBInfo entry. Kept out of
+    // CM_BB_INFO so that its layout stays unchanged; new fields go last.
+    unsigned *BBNumBankConflicts;
 } FINALIZER_INFO;
 
 #define MAX_ERROR_MSG_LEN               511
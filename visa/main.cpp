@@ -25,7 +25,13 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 ======================= end_copyright_notice ==================================*/
 
 #include <iostream>
+#include <iomanip>
 #include <fstream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
 
 #include "BuildIR.h"
 #include "visa_igc_common_header.h"
@@ -45,6 +51,13 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "EnumFiles.hpp"
 #endif
 
+#if !defined(DLL_MODE) && !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 using namespace std;
 
 ///
@@ -70,6 +83,14 @@ void parseWrapper(const char *fileName, int argc, const char *argv[], Options &o
 _THREAD CISA_IR_Builder * pCisaBuilder = NULL;
 
 #ifndef DLL_MODE
+/// Returns true if a string ends with an expected suffix.
+static bool endsWith(const std::string &str, const std::string &suf)
+{
+    if (str.length() < suf.length())
+        return false;
+    return 0 == str.compare(str.length() - suf.length(), suf.length(), suf);
+}
+
 void parseNativeRelocs(CISA_IR_Builder* cisaBuilder)
 {
     if (cisaBuilder->m_options.getOptionCstr(vISA_RelocFilename))
@@ -94,62 +115,110 @@ void parseNativeRelocs(CISA_IR_Builder* cisaBuilder)
     }
 }
 
-void parse(const char *fileName, std::string testName, int argc, const char *argv[], Options &opt)
+// A whole .isa file, mapped read-only where mmap is available and read into a
+// heap buffer otherwise. readIsaBinaryNG() decodes straight out of it.
+class IsaFileBuffer
 {
-    vISA::Mem_Manager phyRegMem(PHY_REG_MEM_SIZE);
-    vISA::PhyRegPool phyRegPool(phyRegMem, opt.getuInt32Option(vISA_TotalGRFNum));
+public:
+    IsaFileBuffer() : buf(NULL), size(0), mapped(false) {}
+    ~IsaFileBuffer() { release(); }
 
-    // read in common isa binary file
-    int c;
-    char *buf;
-    FILE *commonISAInput = NULL;
-    long file_size;
-    unsigned byte_pos = 0;
-    common_isa_header commonISAHeader;
-    vISA::Mem_Manager globalMem(KERNEL_MEM_SIZE);
+    bool open(const char* fileName);
+    void release();
 
-    // open common isa file
-    if ((commonISAInput = fopen(fileName, "rb")) == NULL)
-    {
-        fprintf(stderr, "Cannot open file %s\n", fileName);
-        exit(1);
-    }
+    const char* data() const { return buf; }
+    size_t getSize() const { return size; }
 
-    fseek(commonISAInput, 0, SEEK_END);
-    file_size = ftell(commonISAInput);
-    fseek(commonISAInput, 0, SEEK_SET);
+private:
+    IsaFileBuffer(const IsaFileBuffer&) = delete;
+    IsaFileBuffer& operator=(const IsaFileBuffer&) = delete;
 
-    buf = (char*)globalMem.alloc(file_size + 1);
-    char *buf_ptr = buf;
-    while ((c = fgetc(commonISAInput)) != EOF) {
-        *buf_ptr = c;
-        buf_ptr++;
-    }
+    char* buf;
+    size_t size;
+    bool mapped;
+};
 
-    processCommonISAHeader(commonISAHeader, byte_pos, buf, &globalMem);
-    fclose(commonISAInput);
-    vISA::Mem_Manager mem(4096);
+bool IsaFileBuffer::open(const char* fileName)
+{
+    release();
 
-    /// Try opening the file.
-    FILE* isafile = fopen(fileName, "rb");
-    if (!isafile) {
-        cerr << "Failure, unable to be opened." << endl;
-        exit(EXIT_FAILURE);
+#ifndef _WIN32
+    int fd = ::open(fileName, O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+    {
+        void* base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (base != MAP_FAILED)
+        {
+            ::close(fd);
+            buf = (char*)base;
+            size = (size_t)st.st_size;
+            mapped = true;
+            return true;
+        }
     }
+    ::close(fd);
+#endif
 
-    /// Calculate file size.
+    FILE* isafile = fopen(fileName, "rb");
+    if (!isafile)
+    {
+        return false;
+    }
     fseek(isafile, 0, SEEK_END);
-    long isafilesize = ftell(isafile);
+    long fileSize = ftell(isafile);
     rewind(isafile);
-
-    /// Reading file into buffer.
-    char* isafilebuf = (char*)mem.alloc(isafilesize);
-    if (isafilesize != fread(isafilebuf, 1, isafilesize, isafile))
+    if (fileSize <= 0)
     {
-        cerr << "Unable to read entire file into buffer." << endl;
-        exit(EXIT_FAILURE);
+        fclose(isafile);
+        return false;
     }
+    buf = (char*)malloc(fileSize);
+    size = (size_t)fileSize;
+    bool readAll = buf && fread(buf, 1, size, isafile) == size;
     fclose(isafile);
+    if (!readAll)
+    {
+        release();
+        return false;
+    }
+    return true;
+}
+
+void IsaFileBuffer::release()
+{
+#ifndef _WIN32
+    if (mapped)
+    {
+        munmap(buf, size);
+    }
+    else
+#endif
+    {
+        free(buf);
+    }
+    buf = NULL;
+    size = 0;
+    mapped = false;
+}
+
+void parse(const char *fileName, std::string testName, int argc, const char *argv[], Options &opt)
+{
+    vISA::Mem_Manager phyRegMem(PHY_REG_MEM_SIZE);
+    vISA::PhyRegPool phyRegPool(phyRegMem, opt.getuInt32Option(vISA_TotalGRFNum));
+
+    // map in common isa binary file
+    IsaFileBuffer isafile;
+    if (!isafile.open(fileName))
+    {
+        fprintf(stderr, "Cannot open file %s\n", fileName);
+        exit(1);
+    }
+    const char* isafilebuf = isafile.data();
 
     TARGET_PLATFORM platform = getGenxPlatform();
     CM_VISA_BUILDER_OPTION builderOption =
@@ -183,6 +252,145 @@ void parse(const char *fileName, std::string testName, int argc, const char *arg
         exit(1);
     }
 }
+
+struct ReplayResult
+{
+    std::string fileName;
+    int status;
+    double phaseUS[TIMER_NUM_TIMERS];
+};
+
+// Compile one .isa file through the GEN path on the calling thread and record
+// its per-phase times. Timers, platform and the parser builder are
+// thread-local. The encoder bit positions are process-wide but written only
+// once, by the first InitPlatform(), so workers share them read-only.
+static void replayIsaFile(ReplayResult& result, TARGET_PLATFORM platform, int argc, const char *argv[])
+{
+    result.status = CM_FAILURE;
+    std::fill(result.phaseUS, result.phaseUS + TIMER_NUM_TIMERS, 0.0);
+
+    IsaFileBuffer isafile;
+    if (!isafile.open(result.fileName.c_str()))
+    {
+        return;
+    }
+
+    CISA_IR_Builder* cisa_builder = NULL;
+    VISA_WA_TABLE visaWaTable;
+    if (CISA_IR_Builder::CreateBuilder(cisa_builder, vISA_MEDIA, CM_CISA_BUILDER_GEN, platform,
+        argc, argv, &visaWaTable, true) != CM_SUCCESS)
+    {
+        return;
+    }
+    parseNativeRelocs(cisa_builder);
+
+    vector<VISAKernel*> kernels;
+    if (readIsaBinaryNG(isafile.data(), cisa_builder, kernels, NULL, COMMON_ISA_MAJOR_VER, COMMON_ISA_MINOR_VER))
+    {
+        std::string testName = result.fileName.substr(0, result.fileName.find_last_of("."));
+        cisa_builder->setTestName(testName);
+        result.status = cisa_builder->Compile("");
+
+        for (unsigned i = 0; i < TIMER_NUM_TIMERS; i++)
+        {
+            result.phaseUS[i] = getTimerUS(i);
+        }
+    }
+    CISA_IR_Builder::DestroyBuilder(cisa_builder);
+}
+
+// Benchmark driver: replay every .isa file of a directory through the finalizer
+// on -replayThreads workers and report per-file and accumulated per-phase times.
+static int replayIsaDir(const char *dirName, int argc, const char *argv[], Options &opt)
+{
+    std::string dir = dirName;
+#ifdef _WIN32
+    const char sep = '\\';
+#else
+    const char sep = '/';
+#endif
+    if (!dir.empty() && dir.back() != sep)
+    {
+        dir += sep;
+    }
+
+    std::list<std::string> filesList;
+    dirListFiles(dir.c_str(), filesList);
+
+    std::vector<ReplayResult> results;
+    for (auto& fName : filesList)
+    {
+        if (endsWith(fName, ".isa"))
+        {
+            results.push_back(ReplayResult());
+            results.back().fileName = fName;
+        }
+    }
+    if (results.empty())
+    {
+        std::cout << "ERROR: no .isa files found in " << dirName << std::endl;
+        return 1;
+    }
+
+    unsigned numThreads = opt.getuInt32Option(vISA_ReplayThreads);
+    if (numThreads == 0)
+    {
+        numThreads = std::thread::hardware_concurrency();
+    }
+    numThreads = std::max(1u, std::min(numThreads, (unsigned)results.size()));
+
+    TARGET_PLATFORM platform = getGenxPlatform();
+    std::atomic<unsigned> nextFile(0);
+    auto worker = [&]()
+    {
+        for (unsigned i = nextFile++; i < results.size(); i = nextFile++)
+        {
+            replayIsaFile(results[i], platform, argc, argv);
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < numThreads; i++)
+    {
+        workers.emplace_back(worker);
+    }
+    for (auto& w : workers)
+    {
+        w.join();
+    }
+    double wallUS = std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - start).count();
+
+    double totalUS[TIMER_NUM_TIMERS] = {};
+    unsigned numFailed = 0;
+    std::cout << std::fixed << std::setprecision(3);
+    for (auto& result : results)
+    {
+        std::cout << std::left << std::setw(64) << result.fileName << " "
+            << (result.status == CM_SUCCESS ? "ok    " : "FAILED")
+            << std::right << std::setw(12) << result.phaseUS[TIMER_TOTAL] / 1000.0 << " ms\n";
+        numFailed += result.status != CM_SUCCESS;
+        for (unsigned i = 0; i < TIMER_NUM_TIMERS; i++)
+        {
+            totalUS[i] += result.phaseUS[i];
+        }
+    }
+
+    std::cout << "\nper-phase time over " << results.size() << " files (ms):\n";
+    for (unsigned i = 0; i < TIMER_NUM_TIMERS; i++)
+    {
+        if (totalUS[i] > 0.0)
+        {
+            std::cout << std::left << std::setw(28) << getTimerName(i)
+                << std::right << std::setw(14) << totalUS[i] / 1000.0 << "\n";
+        }
+    }
+    std::cout << "wall time: " << wallUS / 1000.0 << " ms on " << numThreads << " thread(s), "
+        << numFailed << " failed" << std::endl;
+
+    return numFailed ? 1 : 0;
+}
 #endif
 
 #ifdef DLL_MODE
@@ -359,14 +567,6 @@ DLL_EXPORT void getJITVersion(unsigned int& majorV, unsigned int& minorV )
 
 #else
 
-/// Returns true if a string ends with an expected suffix.
-static bool endsWith(const std::string &str, const std::string &suf)
-{
-    if (str.length() < suf.length())
-        return false;
-    return 0 == str.compare(str.length() - suf.length(), suf.length(), suf);
-}
-
 int main( int argc, const char *argv[] )
 {
     char fileName[256];
@@ -432,6 +632,13 @@ int main( int argc, const char *argv[] )
         return 1;
     }
 
+    if (opt.getOptionCstr(vISA_ReplayDir))
+    {
+        const char* replayDir;
+        opt.getOption(vISA_ReplayDir, replayDir);
+        return replayIsaDir(replayDir, argc - startPos, &argv[startPos], opt);
+    }
+
     //
     // for debug print lex results to stdout (default)
     // for release open "lex.out" and redirect lex results